@@ -76,6 +76,10 @@
 #if defined(HAVE_LINUX_SENDFILE) || defined(HAVE_SOLARIS_SENDFILE)
 #define MHD_LINUX_SOLARIS_SENDFILE 1
 #endif /* HAVE_LINUX_SENDFILE || HAVE_SOLARIS_SENDFILE */
+#if defined(HAVE_SPLICE)
+/* Have Linux-style splice() function usable for pipe-backed responses. */
+#define _MHD_HAVE_SPLICE
+#endif /* HAVE_SPLICE */
 
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
 #  ifndef MHD_USE_THREADS
@@ -1548,7 +1548,26 @@ enum MHD_FLAG
    * Not compatible with #MHD_USE_INTERNAL_POLLING_THREAD.
    * @note Available since #MHD_VERSION 0x00097707
    */
-  MHD_USE_NO_THREAD_SAFETY = 1U << 19
+  MHD_USE_NO_THREAD_SAFETY = 1U << 19,
+
+  /**
+   * Use Linux io_uring for the event loop of the internal polling
+   * thread(s).  New connections are accepted by several accept requests
+   * kept in flight, incoming data is received into the kernel-selected
+   * buffers and small replies are sent by the send requests linked to
+   * the receive requests for the next request.  All requests of the
+   * thread are submitted together, so with many active keep-alive
+   * connections a request is processed with much less than one system
+   * call on average.
+   * This flag implies #MHD_USE_EPOLL, which is used as a fallback if
+   * io_uring is not supported by the kernel (or not allowed) and for
+   * the TLS connections.
+   * Requires #MHD_USE_INTERNAL_POLLING_THREAD and not compatible with
+   * #MHD_USE_THREAD_PER_CONNECTION.
+   * @sa ::MHD_FEATURE_IO_URING
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_USE_IO_URING = 1U << 20
 
 };
 
@@ -1651,6 +1670,42 @@ enum MHD_DAuthBindNonce
   MHD_DAUTH_BIND_NONCE_CLIENT_IP = 1 << 3
 } _MHD_FLAGS_ENUM;
 
+/**
+ * Values for #MHD_OPTION_LISTEN_SHARDING.
+ *
+ * These values select how incoming connections are distributed between
+ * the worker threads of the thread pool.
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+enum MHD_ListenSharding
+{
+  /**
+   * All workers in the thread pool poll the same listening socket.
+   * Every new connection wakes up all the workers, only one of them
+   * accepts the connection.
+   * This is default value.
+   */
+  MHD_LISTEN_SHARDING_NONE = 0,
+
+  /**
+   * Each worker in the thread pool uses its own listening socket bound to
+   * the same address and port with SO_REUSEPORT.  The kernel balances
+   * new connections between the sockets, only one worker is woken up
+   * for each new connection.
+   */
+  MHD_LISTEN_SHARDING_REUSEPORT = 1,
+
+  /**
+   * The same as #MHD_LISTEN_SHARDING_REUSEPORT, but the kernel is
+   * additionally asked to select the listening socket by the number of
+   * the CPU that has processed the incoming packet (by classic BPF
+   * program or by SO_INCOMING_CPU, if supported by the platform).
+   * Works best when the number of the workers matches the number of CPUs
+   * and NIC queues are bound to the CPUs.
+   */
+  MHD_LISTEN_SHARDING_REUSEPORT_CPU = 2
+} _MHD_FIXED_ENUM;
+
 /**
  * @brief MHD options.
  *
@@ -2197,6 +2252,309 @@ enum MHD_OPTION
    * @note Available since #MHD_VERSION 0x00097709
    */
   MHD_OPTION_DIGEST_AUTH_DEFAULT_MAX_NC = 42
+  ,
+  /**
+   * Use a separate listening socket for each worker thread.
+   * Can be used only together with #MHD_OPTION_THREAD_POOL_SIZE and only
+   * when the listening socket is created by MHD (not with
+   * #MHD_OPTION_LISTEN_SOCKET) for IP (not UNIX) addresses.
+   * The listening socket is created with SO_REUSEPORT and every worker
+   * gets an additional listening socket bound to the same address,
+   * so the kernel distributes new connections between the workers
+   * instead of waking up all the workers for every new connection.
+   * This option should be followed by an `unsigned int` argument with
+   * one of #MHD_ListenSharding values.
+   * The socket returned by #MHD_DAEMON_INFO_LISTEN_FD and by
+   * #MHD_quiesce_daemon() is the socket of the first worker, other
+   * sockets are managed by MHD.
+   * Ignored (with warning) if thread pool is not used.
+   * @sa ::MHD_FEATURE_LISTEN_SHARDING
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_LISTEN_SHARDING = 43
+  ,
+
+  /**
+   * The maximum number of new connections accepted in one turn of
+   * the event loop.
+   * Followed by an `unsigned int` argument.
+   * The rest of pending connections is accepted on the next turns.
+   * Larger values reduce the number of wake-ups at high rate of new
+   * connections, smaller values give more time for processing of
+   * the already accepted connections.
+   * Zero means the default value (10).
+   * Used only with non-blocking listen socket.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_ACCEPT_BATCH_SIZE = 44
+  ,
+
+  /**
+   * Register the listen socket shared by the workers of the thread pool
+   * with the 'EPOLLEXCLUSIVE' flag, so only one (or a few) of the workers
+   * are woken up for the new connection instead of all the workers.
+   * Followed by an `int` argument, non-zero value enables the mode.
+   * Used only with #MHD_USE_EPOLL and #MHD_OPTION_THREAD_POOL_SIZE when
+   * every worker does not have its own listen socket (see
+   * #MHD_OPTION_LISTEN_SHARDING), ignored otherwise.
+   * If the kernel does not support 'EPOLLEXCLUSIVE', the listen socket is
+   * registered in the usual way.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE = 45
+  ,
+
+  /**
+   * The size of the array for the events returned by one call of
+   * 'epoll_wait()'.
+   * Followed by an `unsigned int` argument.
+   * Larger values allow to collect more ready connections by one system
+   * call at high load, smaller values reduce the memory usage.
+   * Zero means the default value (128), values larger than 65536 are
+   * reduced to 65536.
+   * Used only with #MHD_USE_EPOLL (and #MHD_USE_IO_URING), ignored
+   * otherwise.  With thread pool every worker gets its own array of
+   * the specified size.
+   * @sa #MHD_DAEMON_INFO_EPOLL_STATS
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_EPOLL_EVENTS_SIZE = 46
+  ,
+
+  /**
+   * Process the ready connections in batches.
+   * Followed by an `int` argument, non-zero value enables the mode.
+   * By default every ready connection is processed completely (receiving,
+   * processing, sending) before the next connection.  In the batch mode
+   * all ready connections are collected first, then the data is received
+   * for all of them, then all of them are processed, then the replies
+   * are sent.  The same code is run for many connections in a row, which
+   * may improve the CPU caches usage when many connections are ready at
+   * the same time.
+   * Used only with #MHD_USE_EPOLL (and #MHD_USE_IO_URING), ignored
+   * otherwise.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_EPOLL_BATCH_PROCESSING = 47
+  ,
+
+  /**
+   * Use the coarse time for the connections activity tracking.
+   * Followed by an `int` argument, non-zero value enables the mode.
+   * By default the system clock is read every time when any data is
+   * received or sent over the connection.  In the coarse mode the clock
+   * is read once per event loop iteration (after waiting for the network
+   * events) and all connections processed in the same iteration get the
+   * same timestamp.  This reduces the number of the clock reads at high
+   * load, while the connection timeouts may be detected later by the
+   * duration of one iteration of the event loop.
+   * Ignored with #MHD_USE_THREAD_PER_CONNECTION.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_COARSE_ACTIVITY_TIME = 48
+  ,
+
+  /**
+   * The maximum number of the unused connection memory pools kept
+   * for the reuse by each thread processing the connections.
+   * Followed by an `unsigned int` argument.
+   * When the connection is closed, its memory pool is zeroed (only
+   * the used part of the pool) and kept for the next connection instead
+   * of being freed.  This saves the memory allocation (mmap() for large
+   * pools) for every new connection at the cost of keeping up to this
+   * number of pools (each #MHD_OPTION_CONNECTION_MEMORY_LIMIT bytes)
+   * allocated while the daemon is running.
+   * The default is zero (the pools are not kept).
+   * Ignored with #MHD_USE_THREAD_PER_CONNECTION.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_CONNECTION_MEMORY_POOL_CACHE = 49
+  ,
+
+  /**
+   * The number of the connection memory pools allocated from the single
+   * reserved memory area (the slab) by each thread processing
+   * the connections.
+   * Followed by an `unsigned int` argument.
+   * The slab is backed by the huge pages if they are reserved in
+   * the system, otherwise the transparent huge pages are requested for
+   * the slab (if supported by the platform).  This reduces the number of
+   * the TLB misses when many connections are served.  The memory of
+   * the slab is allocated when it is used for the first time by the
+   * thread processing the connections, so in thread pool mode each worker
+   * gets the memory local to its NUMA node (with the default memory policy).
+   * The pools from the slab are not freed until the daemon is stopped.
+   * If more connections are used, the pools for them are allocated
+   * individually.
+   * The default is zero (the slab is not used).
+   * Ignored with #MHD_USE_THREAD_PER_CONNECTION and on platforms without
+   * mmap().
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB = 50
+  ,
+
+  /**
+   * Size the connection read buffers according to the observed traffic.
+   * Followed by an `int` argument, non-zero value enables the mode.
+   * By default half of the connection memory pool is used for the read
+   * buffer of every new request.  In the adaptive mode the daemon tracks
+   * the typical size of the request header and the request body (as
+   * reported by the "Content-Length:" header) and starts the read buffers
+   * with the size sufficient for the typical request.  The rest of
+   * the memory pool is left for the reply and the application, and
+   * smaller part of the pool needs to be cleared between the requests.
+   * The read buffers are still grown (within the memory pool) if
+   * the request is larger than usual, the total memory per connection
+   * is still limited by #MHD_OPTION_CONNECTION_MEMORY_LIMIT.
+   * In the adaptive mode the statistics of the buffers usage are
+   * available by #MHD_DAEMON_INFO_BUFFER_STATS.
+   * Ignored with #MHD_USE_THREAD_PER_CONNECTION.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS = 51
+  ,
+
+  /**
+   * Measure the duration of the phases of the requests processing.
+   * Followed by an `int` argument, non-zero value enables the timing.
+   * When enabled, the time spent by each request in each phase (see
+   * #MHD_RequestPhase) is recorded in the histograms, which are available
+   * by #MHD_DAEMON_INFO_PHASE_HISTOGRAMS.  The timing needs a few reads
+   * of the monotonic clock for each request.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_CONNECTION_PHASE_TIMING = 52
+  ,
+
+  /**
+   * Use the kernel TLS (kTLS) offload for sending on HTTPS connections.
+   * Followed by an `int` argument, non-zero value enables the offload.
+   * When GnuTLS has installed the TLS session keys in the kernel (this
+   * requires the "tls" kernel module, the GnuTLS version 3.7.3 or later
+   * and kTLS enabled in the GnuTLS configuration), the reply data is
+   * written to the socket by the plain send(), writev() and sendfile()
+   * calls and encrypted by the kernel.  This avoids copying of the file
+   * data to the user space for the responses created by
+   * #MHD_create_response_from_fd() and similar functions.
+   * If kTLS is not available for the connection, the data is encrypted
+   * by GnuTLS as usual.  The received data is always processed by GnuTLS.
+   * The number of connections with the offload is reported in
+   * #MHD_DaemonStats.tls_ktls_send.
+   * Valid only for daemons with #MHD_USE_TLS.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_HTTPS_KTLS = 53
+  ,
+
+  /**
+   * Enable the TLS session tickets (RFC 5077, RFC 8446) with the keys
+   * managed by the daemon.
+   * Followed by an `unsigned int` argument with the lifetime of the tickets
+   * in seconds.  The master ticket key is randomly generated when
+   * the daemon is started and shared by all threads of the daemon.
+   * With GnuTLS 3.6.4 and later the tickets are encrypted by the keys
+   * derived from the master key and rotated by GnuTLS with the period
+   * based on the lifetime; the tickets encrypted by the previous derived
+   * key are still accepted after the rotation.  With older GnuTLS versions
+   * the key is replaced by the new random key when the lifetime has
+   * passed; the tickets issued with the previous key are not accepted
+   * after the replacement and the clients perform the full handshake.
+   * Zero value (the default) disables the session tickets.
+   * The number of the resumed sessions is reported in
+   * #MHD_DaemonStats.tls_resumed.
+   * Valid only for daemons with #MHD_USE_TLS.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_HTTPS_SESSION_TICKETS = 54
+  ,
+
+  /**
+   * Enable the cache of the TLS sessions for the resumption by the session
+   * ID (used by TLS 1.2 clients without the tickets support).
+   * Followed by an `unsigned int` argument with the maximum number of
+   * the sessions in the cache.  The cache is kept in the memory of
+   * the process and shared by all threads of the daemon.  When the cache
+   * is full, the oldest sessions are replaced.  The lifetime of the cached
+   * sessions is set by #MHD_OPTION_HTTPS_SESSION_TICKETS (if used) or
+   * the GnuTLS default is used.
+   * Zero value (the default) disables the cache.
+   * Valid only for daemons with #MHD_USE_TLS.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_HTTPS_SESSION_CACHE = 55
+  ,
+
+  /**
+   * Perform the TLS handshakes in the dedicated threads.
+   * Followed by an `unsigned int` argument with the number of
+   * the handshake threads.  When the handshake of the new connection can
+   * make progress, the connection is parked and the handshake step
+   * (including the public key cryptography) is performed by one of
+   * the handshake threads, the daemon thread(s) continue to process other
+   * connections.  When the step is performed, the connection is returned
+   * to its daemon thread.  The handshake threads are shared by all
+   * worker threads of the daemon.
+   * The PSK credentials callback (see #MHD_OPTION_GNUTLS_PSK_CRED_HANDLER)
+   * and other GnuTLS callbacks used during the handshake are called from
+   * the handshake threads.
+   * Valid only for daemons with #MHD_USE_TLS and
+   * #MHD_USE_INTERNAL_POLLING_THREAD without
+   * #MHD_USE_THREAD_PER_CONNECTION.
+   * Zero value (the default) disables the handshake threads.
+   * The number of the offloaded handshake steps is reported in
+   * #MHD_DaemonStats.tls_hs_offloaded.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_HTTPS_HANDSHAKE_THREADS = 56
+  ,
+
+  /**
+   * Send the large response data with MSG_ZEROCOPY, without copying
+   * the data to the kernel buffers.
+   * Followed by a `size_t` argument with the minimal size of the data
+   * sent by a single send call to use the zero-copy send.
+   * Used only for the responses with the data in memory (created by
+   * #MHD_create_response_from_buffer() and similar functions or by
+   * #MHD_create_response_from_iovec()) sent over plain (non-TLS)
+   * TCP connections.
+   * The kernel sends the data directly from the memory of the response,
+   * so the response is kept (and the data must stay unchanged) until
+   * the kernel reports the send as completed, even if #MHD_destroy_response()
+   * has been called and the connection has been closed.  The closed
+   * connection waits for the completion for up to 5 seconds, then it is
+   * reset.
+   * Zero copy is efficient only for large sends, the recommended threshold
+   * is at least 16 KiB.
+   * Zero value (the default) disables zero-copy sends.
+   * Ignored on platforms without MSG_ZEROCOPY support (only Linux 4.14 or
+   * later is supported).
+   * The amount of the data sent with MSG_ZEROCOPY is reported in
+   * #MHD_DaemonStats.bytes_sent_zerocopy.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_SEND_ZEROCOPY_THRESHOLD = 57
+  ,
+
+  /**
+   * Size the sendfile() calls according to the free space in the socket
+   * send buffer.
+   * Followed by an `int` argument, non-zero value enables the mode.
+   * By default the responses created by #MHD_create_response_from_fd() and
+   * similar functions are sent by sendfile() in the fixed chunks (128 KiB,
+   * 2 MiB with #MHD_USE_THREAD_PER_CONNECTION).  When the client reads
+   * slower than the data is sent, most of the chunk does not fit the send
+   * buffer and the file data read by the kernel for the call is dropped.
+   * In the adaptive mode, when the previous call has filled the send buffer,
+   * the next chunk is limited by the space left in the send buffer (but
+   * it is not smaller than 16 KiB).  The fast connections still use
+   * the full chunks.
+   * Ignored on platforms other than Linux and for the blocking sockets.
+   * The number of sendfile() calls that have filled the send buffer is
+   * reported in #MHD_DaemonStats.sendfile_partial.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK = 58
 
 } _MHD_FIXED_ENUM;
 
@@ -2621,6 +2979,56 @@ enum MHD_DaemonInfoType
    * value will be real port number.
    */
   MHD_DAEMON_INFO_BIND_PORT
+  ,
+
+  /**
+   * Request the statistics of the epoll event loop.
+   * No extra arguments should be passed.
+   * For the daemon with thread pool the values are summarised over all
+   * worker threads.
+   * The values are updated by the threads processing the events, the
+   * result may be not exact if the daemon is running.
+   * Returns NULL if the daemon does not use #MHD_USE_EPOLL.
+   * @sa #MHD_OPTION_EPOLL_EVENTS_SIZE
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_DAEMON_INFO_EPOLL_STATS
+  ,
+
+  /**
+   * Request the statistics of the connection buffers usage.
+   * No extra arguments should be passed.
+   * For the daemon with thread pool the values are summarised over all
+   * worker threads.
+   * The values are updated by the threads processing the connections,
+   * the result may be not exact if the daemon is running.
+   * Returns NULL if #MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS is not enabled.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_DAEMON_INFO_BUFFER_STATS
+  ,
+
+  /**
+   * Request the statistics of the daemon operations.
+   * No extra arguments should be passed.
+   * The statistics are collected separately by each thread processing
+   * the connections without locks and summarised when requested.
+   * The values are updated while the daemon is running, the result may
+   * be not exact (the counters may be not synchronised with each other).
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_DAEMON_INFO_STATS
+  ,
+
+  /**
+   * Request the histograms of the duration of the request phases.
+   * No extra arguments should be passed.
+   * The histograms are collected separately by each thread processing
+   * the connections without locks and summarised when requested.
+   * Returns NULL if #MHD_OPTION_CONNECTION_PHASE_TIMING is not enabled.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_DAEMON_INFO_PHASE_HISTOGRAMS
 } _MHD_FIXED_ENUM;
 
 
@@ -3702,6 +4110,296 @@ MHD_lookup_connection_value_n (struct MHD_Connection *connection,
                                size_t *value_size_ptr);
 
 
+/**
+ * The identifiers of the well-known request headers.
+ * The names of the request headers are matched with these identifiers
+ * when the request is parsed, so the headers can be found by
+ * #MHD_lookup_connection_header_by_id() without comparing the strings.
+ * @note Available since #MHD_VERSION 0x01000200
+ * @ingroup request
+ */
+enum MHD_HeaderId
+{
+  /**
+   * The header is not one of the well-known headers.
+   */
+  MHD_HEADER_ID_UNKNOWN = 0
+  ,
+
+  /**
+   * The "Accept" header.
+   */
+  MHD_HEADER_ID_ACCEPT = 1
+  ,
+
+  /**
+   * The "Accept-Charset" header.
+   */
+  MHD_HEADER_ID_ACCEPT_CHARSET = 2
+  ,
+
+  /**
+   * The "Accept-Encoding" header.
+   */
+  MHD_HEADER_ID_ACCEPT_ENCODING = 3
+  ,
+
+  /**
+   * The "Accept-Language" header.
+   */
+  MHD_HEADER_ID_ACCEPT_LANGUAGE = 4
+  ,
+
+  /**
+   * The "Access-Control-Request-Headers" header.
+   */
+  MHD_HEADER_ID_ACCESS_CONTROL_REQUEST_HEADERS = 5
+  ,
+
+  /**
+   * The "Access-Control-Request-Method" header.
+   */
+  MHD_HEADER_ID_ACCESS_CONTROL_REQUEST_METHOD = 6
+  ,
+
+  /**
+   * The "Authorization" header.
+   */
+  MHD_HEADER_ID_AUTHORIZATION = 7
+  ,
+
+  /**
+   * The "Cache-Control" header.
+   */
+  MHD_HEADER_ID_CACHE_CONTROL = 8
+  ,
+
+  /**
+   * The "Connection" header.
+   */
+  MHD_HEADER_ID_CONNECTION = 9
+  ,
+
+  /**
+   * The "Content-Encoding" header.
+   */
+  MHD_HEADER_ID_CONTENT_ENCODING = 10
+  ,
+
+  /**
+   * The "Content-Length" header.
+   */
+  MHD_HEADER_ID_CONTENT_LENGTH = 11
+  ,
+
+  /**
+   * The "Content-Type" header.
+   */
+  MHD_HEADER_ID_CONTENT_TYPE = 12
+  ,
+
+  /**
+   * The "Cookie" header.
+   */
+  MHD_HEADER_ID_COOKIE = 13
+  ,
+
+  /**
+   * The "Date" header.
+   */
+  MHD_HEADER_ID_DATE = 14
+  ,
+
+  /**
+   * The "Expect" header.
+   */
+  MHD_HEADER_ID_EXPECT = 15
+  ,
+
+  /**
+   * The "Forwarded" header.
+   */
+  MHD_HEADER_ID_FORWARDED = 16
+  ,
+
+  /**
+   * The "From" header.
+   */
+  MHD_HEADER_ID_FROM = 17
+  ,
+
+  /**
+   * The "Host" header.
+   */
+  MHD_HEADER_ID_HOST = 18
+  ,
+
+  /**
+   * The "If-Match" header.
+   */
+  MHD_HEADER_ID_IF_MATCH = 19
+  ,
+
+  /**
+   * The "If-Modified-Since" header.
+   */
+  MHD_HEADER_ID_IF_MODIFIED_SINCE = 20
+  ,
+
+  /**
+   * The "If-None-Match" header.
+   */
+  MHD_HEADER_ID_IF_NONE_MATCH = 21
+  ,
+
+  /**
+   * The "If-Range" header.
+   */
+  MHD_HEADER_ID_IF_RANGE = 22
+  ,
+
+  /**
+   * The "If-Unmodified-Since" header.
+   */
+  MHD_HEADER_ID_IF_UNMODIFIED_SINCE = 23
+  ,
+
+  /**
+   * The "Keep-Alive" header.
+   */
+  MHD_HEADER_ID_KEEP_ALIVE = 24
+  ,
+
+  /**
+   * The "Max-Forwards" header.
+   */
+  MHD_HEADER_ID_MAX_FORWARDS = 25
+  ,
+
+  /**
+   * The "Origin" header.
+   */
+  MHD_HEADER_ID_ORIGIN = 26
+  ,
+
+  /**
+   * The "Pragma" header.
+   */
+  MHD_HEADER_ID_PRAGMA = 27
+  ,
+
+  /**
+   * The "Priority" header.
+   */
+  MHD_HEADER_ID_PRIORITY = 28
+  ,
+
+  /**
+   * The "Proxy-Authorization" header.
+   */
+  MHD_HEADER_ID_PROXY_AUTHORIZATION = 29
+  ,
+
+  /**
+   * The "Range" header.
+   */
+  MHD_HEADER_ID_RANGE = 30
+  ,
+
+  /**
+   * The "Referer" header.
+   */
+  MHD_HEADER_ID_REFERER = 31
+  ,
+
+  /**
+   * The "Sec-WebSocket-Extensions" header.
+   */
+  MHD_HEADER_ID_SEC_WEBSOCKET_EXTENSIONS = 32
+  ,
+
+  /**
+   * The "Sec-WebSocket-Key" header.
+   */
+  MHD_HEADER_ID_SEC_WEBSOCKET_KEY = 33
+  ,
+
+  /**
+   * The "Sec-WebSocket-Protocol" header.
+   */
+  MHD_HEADER_ID_SEC_WEBSOCKET_PROTOCOL = 34
+  ,
+
+  /**
+   * The "Sec-WebSocket-Version" header.
+   */
+  MHD_HEADER_ID_SEC_WEBSOCKET_VERSION = 35
+  ,
+
+  /**
+   * The "TE" header.
+   */
+  MHD_HEADER_ID_TE = 36
+  ,
+
+  /**
+   * The "Trailer" header.
+   */
+  MHD_HEADER_ID_TRAILER = 37
+  ,
+
+  /**
+   * The "Transfer-Encoding" header.
+   */
+  MHD_HEADER_ID_TRANSFER_ENCODING = 38
+  ,
+
+  /**
+   * The "Upgrade" header.
+   */
+  MHD_HEADER_ID_UPGRADE = 39
+  ,
+
+  /**
+   * The "User-Agent" header.
+   */
+  MHD_HEADER_ID_USER_AGENT = 40
+  ,
+
+  /**
+   * The "Via" header.
+   */
+  MHD_HEADER_ID_VIA = 41
+};
+
+
+/**
+ * Get the value of the well-known request header by the identifier.
+ * The function does not compare the names of the headers, the identifiers
+ * are assigned when the request headers are parsed or added by
+ * #MHD_set_connection_value() (and similar functions).
+ * If the request has several headers with the same name, the value of the
+ * first header is returned.
+ * @param connection the connection to get values from
+ * @param hdr_id the identifier of the header to look for
+ * @param[out] value_ptr the pointer to variable, which will be set to found value,
+ *                       will not be updated if header not found,
+ *                       could be NULL to just check for presence of the header
+ * @param[out] value_size_ptr the pointer variable, which will set to found value,
+ *                            will not be updated if header not found,
+ *                            could be NULL
+ * @return #MHD_YES if header is found,
+ *         #MHD_NO otherwise or if @a hdr_id is #MHD_HEADER_ID_UNKNOWN.
+ * @note Available since #MHD_VERSION 0x01000200
+ * @ingroup request
+ */
+_MHD_EXTERN enum MHD_Result
+MHD_lookup_connection_header_by_id (struct MHD_Connection *connection,
+                                    enum MHD_HeaderId hdr_id,
+                                    const char **value_ptr,
+                                    size_t *value_size_ptr);
+
+
 /**
  * Queue a response to be transmitted to the client (as soon as
  * possible but after #MHD_AccessHandlerCallback returns).
@@ -6147,6 +6845,329 @@ MHD_set_connection_option (struct MHD_Connection *connection,
                            ...);
 
 
+/**
+ * The statistics of the epoll event loop.
+ * @see #MHD_DAEMON_INFO_EPOLL_STATS
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+struct MHD_DaemonEpollStats
+{
+  /**
+   * The number of wake-ups with at least one event reported.
+   * With #MHD_USE_IO_URING the wake-ups with at least one completion
+   * are counted.
+   */
+  uint64_t wakeups;
+
+  /**
+   * The total number of the events reported for all wake-ups.
+   * The average number of events per wake-up is @a events / @a wakeups.
+   */
+  uint64_t events;
+
+  /**
+   * The number of the calls of 'epoll_wait()' that filled the events
+   * array completely.  A large value relative to @a wakeups indicates
+   * that #MHD_OPTION_EPOLL_EVENTS_SIZE should be increased.
+   */
+  uint64_t full_batches;
+
+  /**
+   * The largest number of events reported for a single wake-up.
+   */
+  unsigned int max_events;
+};
+
+
+/**
+ * The statistics of the connection buffers usage.
+ * @see #MHD_DAEMON_INFO_BUFFER_STATS
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+struct MHD_DaemonBufferStats
+{
+  /**
+   * The number of times the read buffers were grown.
+   */
+  uint64_t read_grows;
+
+  /**
+   * The number of times the read buffers were shrunk to the size of
+   * the data in the buffer.
+   */
+  uint64_t read_shrinks;
+
+  /**
+   * The number of times the write buffers were grown.
+   */
+  uint64_t write_grows;
+
+  /**
+   * The moving average of the read buffer size needed by the requests
+   * (the size of the request header and the request body, limited by
+   * the size of the memory pool).  The starting size of the read buffers
+   * is based on this value.  Zero if no requests have been processed yet.
+   * For the daemon with thread pool the largest value of all worker
+   * threads is reported.
+   */
+  size_t avg_request_size;
+};
+
+
+/**
+ * The statistics of the daemon operations.
+ * All values are counted since the start of the daemon.
+ * @see #MHD_DAEMON_INFO_STATS
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+struct MHD_DaemonStats
+{
+  /**
+   * The number of the connections accepted for processing.
+   */
+  uint64_t conns_accepted;
+
+  /**
+   * The number of the connections rejected because of the connection
+   * limits, by the acceptance policy callback or because of the lack of
+   * resources.
+   */
+  uint64_t conns_rejected;
+
+  /**
+   * The number of the connections rejected because of the limit of
+   * connections per IP address.  Included in @a conns_rejected.
+   */
+  uint64_t per_ip_limit_hits;
+
+  /**
+   * The number of the closed connections.
+   */
+  uint64_t conns_closed;
+
+  /**
+   * The number of the connections closed because of the timeout.
+   * Included in @a conns_closed.
+   */
+  uint64_t conns_timed_out;
+
+  /**
+   * The number of the requests with the reply sent completely.
+   */
+  uint64_t requests_served;
+
+  /**
+   * The number of the bytes received from the clients (after decryption
+   * for TLS connections).
+   */
+  uint64_t bytes_received;
+
+  /**
+   * The number of the bytes sent by send() (or by TLS library).
+   */
+  uint64_t bytes_sent_send;
+
+  /**
+   * The number of the bytes sent by writev() or sendmsg().
+   */
+  uint64_t bytes_sent_writev;
+
+  /**
+   * The number of the bytes sent by sendfile().
+   */
+  uint64_t bytes_sent_sendfile;
+
+  /**
+   * The number of the bytes sent by splice().
+   */
+  uint64_t bytes_sent_splice;
+
+  /**
+   * The number of the connections suspended.
+   */
+  uint64_t suspends;
+
+  /**
+   * The number of the connections resumed.
+   */
+  uint64_t resumes;
+
+  /**
+   * The number of the completed TLS handshakes.
+   */
+  uint64_t tls_handshakes;
+
+  /**
+   * The number of the failed TLS handshakes.
+   */
+  uint64_t tls_handshake_failures;
+
+  /**
+   * The number of the TLS connections with kernel TLS used for sending.
+   * @see #MHD_OPTION_HTTPS_KTLS
+   */
+  uint64_t tls_ktls_send;
+
+  /**
+   * The number of the TLS handshakes that resumed the previous session
+   * (by the session ticket or by the session ID).
+   * @see #MHD_OPTION_HTTPS_SESSION_TICKETS, #MHD_OPTION_HTTPS_SESSION_CACHE
+   */
+  uint64_t tls_resumed;
+
+  /**
+   * The number of the TLS handshake steps performed by the handshake
+   * threads.
+   * @see #MHD_OPTION_HTTPS_HANDSHAKE_THREADS
+   */
+  uint64_t tls_hs_offloaded;
+
+  /**
+   * The number of the bytes sent with MSG_ZEROCOPY.  Included in
+   * @a bytes_sent_send and @a bytes_sent_writev.
+   * @see #MHD_OPTION_SEND_ZEROCOPY_THRESHOLD
+   */
+  uint64_t bytes_sent_zerocopy;
+
+  /**
+   * The number of the completion notifications of the zero-copy sends with
+   * the data copied by the kernel (the network interface does not support
+   * zero-copy sending, for example the loopback interface).
+   * @see #MHD_OPTION_SEND_ZEROCOPY_THRESHOLD
+   */
+  uint64_t zerocopy_copied;
+
+  /**
+   * The high-water mark of the connection memory pools usage: the largest
+   * amount of the memory pool used by a request (the read buffer,
+   * the request headers and the application allocations) when the reply
+   * started.  The write buffer is not counted as it takes all free space
+   * of the pool.
+   */
+  uint64_t pool_max_used;
+
+  /**
+   * The number of the sendfile() calls that sent less data than requested
+   * (the socket send buffer has been filled).
+   * @see #MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK
+   */
+  uint64_t sendfile_partial;
+};
+
+
+/**
+ * The phases of the request processing measured by
+ * #MHD_OPTION_CONNECTION_PHASE_TIMING.
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+enum MHD_RequestPhase
+{
+  /**
+   * From the acceptance of the connection (including the TLS handshake,
+   * if any) to the first byte of the first request on the connection.
+   */
+  MHD_REQUEST_PHASE_ACCEPT_TO_FIRST_BYTE = 0
+  ,
+
+  /**
+   * From the first byte of the request to the end of the request header.
+   */
+  MHD_REQUEST_PHASE_HEADER_PARSE = 1
+  ,
+
+  /**
+   * The total time spent in the access handler callbacks for
+   * the request.
+   */
+  MHD_REQUEST_PHASE_HANDLER = 2
+  ,
+
+  /**
+   * From the end of the request header to the start of sending of
+   * the reply.  Includes the receiving of the request body and
+   * the access handler callbacks.
+   */
+  MHD_REQUEST_PHASE_FIRST_REPLY_BYTE = 3
+  ,
+
+  /**
+   * From the start of sending of the reply to the end of the reply.
+   */
+  MHD_REQUEST_PHASE_BODY_TRANSMIT = 4
+  ,
+
+  /**
+   * From the end of the previous reply to the first byte of the next
+   * request on the same (keep-alive) connection.
+   */
+  MHD_REQUEST_PHASE_KEEPALIVE_IDLE = 5
+  ,
+
+  /**
+   * The number of the phases.
+   */
+  MHD_REQUEST_PHASE_COUNT = 6
+} _MHD_FIXED_ENUM;
+
+
+/**
+ * The number of the buckets in each phase histogram.
+ * The histograms are log-linear with the durations in microseconds:
+ * the buckets 0 to 3 count the durations of 0, 1, 2 and 3 microseconds,
+ * each next power of two is split into four buckets of the same width.
+ * The bucket number @a i (where @a i >= 4) counts the durations from
+ * `(4 + i % 4) << (i / 4 - 1)` microseconds (inclusive) to
+ * `(5 + i % 4) << (i / 4 - 1)` microseconds (exclusive).
+ * The last bucket counts also all longer durations (about 235 seconds
+ * and longer).
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+#define MHD_PHASE_HISTOGRAM_BUCKETS 104
+
+
+/**
+ * The histogram of the duration of one request phase.
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+struct MHD_PhaseHistogram
+{
+  /**
+   * The number of the measured durations.
+   */
+  uint64_t count;
+
+  /**
+   * The sum of all measured durations, in microseconds.
+   */
+  uint64_t sum_us;
+
+  /**
+   * The longest measured duration, in microseconds.
+   */
+  uint64_t max_us;
+
+  /**
+   * The number of the durations in each bucket.
+   * @see #MHD_PHASE_HISTOGRAM_BUCKETS
+   */
+  uint64_t buckets[MHD_PHASE_HISTOGRAM_BUCKETS];
+};
+
+
+/**
+ * The histograms of the duration of the request phases.
+ * @see #MHD_DAEMON_INFO_PHASE_HISTOGRAMS
+ * @note Available since #MHD_VERSION 0x01000200
+ */
+struct MHD_DaemonPhaseHistograms
+{
+  /**
+   * The histograms, indexed by #MHD_RequestPhase values.
+   */
+  struct MHD_PhaseHistogram phases[MHD_REQUEST_PHASE_COUNT];
+};
+
+
 /**
  * Information about an MHD daemon.
  */
@@ -6191,6 +7212,28 @@ union MHD_DaemonInfo
    * daemon, especially if #MHD_USE_AUTO was set.
    */
   enum MHD_FLAG flags;
+
+  /**
+   * Statistics of the event loop, for #MHD_DAEMON_INFO_EPOLL_STATS.
+   */
+  struct MHD_DaemonEpollStats epoll_stats;
+
+  /**
+   * Statistics of the connection buffers, for #MHD_DAEMON_INFO_BUFFER_STATS.
+   */
+  struct MHD_DaemonBufferStats buffer_stats;
+
+  /**
+   * Statistics of the daemon operations, for #MHD_DAEMON_INFO_STATS.
+   */
+  struct MHD_DaemonStats stats;
+
+  /**
+   * Histograms of the request phases,
+   * for #MHD_DAEMON_INFO_PHASE_HISTOGRAMS.
+   * The histograms are too large to be embedded in this union.
+   */
+  const struct MHD_DaemonPhaseHistograms *phase_histograms;
 };
 
 
@@ -6503,7 +7546,23 @@ enum MHD_FEATURE
    * @sa #MHD_OPTION_APP_FD_SETSIZE
    * @note Available since #MHD_VERSION 0x00097705
    */
-  MHD_FEATURE_FLEXIBLE_FD_SETSIZE = 34
+  MHD_FEATURE_FLEXIBLE_FD_SETSIZE = 34,
+
+  /**
+   * Get whether MHD supports per-worker listening sockets with kernel-side
+   * load balancing of the new connections.
+   * @sa #MHD_OPTION_LISTEN_SHARDING
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_FEATURE_LISTEN_SHARDING = 35,
+
+  /**
+   * Get whether io_uring is supported.  If supported then flag
+   * #MHD_USE_IO_URING can be used.  The return value reflects both
+   * the build configuration and the ability of the running kernel.
+   * @note Available since #MHD_VERSION 0x01000200
+   */
+  MHD_FEATURE_IO_URING = 36
 };
 
 #define MHD_FEATURE_HTTPS_COOKIE_PARSING _MHD_DEPR_IN_MACRO ( \
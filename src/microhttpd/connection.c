@@ -32,6 +32,7 @@
 #include "response.h"
 #include "mhd_mono_clock.h"
 #include "mhd_str.h"
+#include "mhd_hdr_ids.h"
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
 #include "mhd_locks.h"
 #endif
@@ -46,6 +47,9 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 #endif /* HAVE_FREEBSD_SENDFILE || HAVE_DARWIN_SENDFILE */
+#ifdef _MHD_HAVE_SPLICE
+#include <sys/ioctl.h>
+#endif /* _MHD_HAVE_SPLICE */
 #ifdef HTTPS_SUPPORT
 #include "connection_https.h"
 #endif /* HTTPS_SUPPORT */
@@ -54,7 +58,12 @@
 #include <sys/param.h>
 #endif /* HAVE_SYS_PARAM_H */
 #include "mhd_send.h"
+#include "mhd_trace.h"
 #include "mhd_assert.h"
+#ifdef IO_URING_SUPPORT
+#include "mhd_uring.h"
+#include <poll.h>
+#endif /* IO_URING_SUPPORT */
 
 /**
  * Get whether bare LF in HTTP header and other protocol elements
@@ -712,6 +721,69 @@ MHD_connection_alloc_memory_ (struct MHD_Connection *connection,
 }
 
 
+#ifdef IO_URING_SUPPORT
+/**
+ * Receive data for the connection served by the daemon's io_uring.
+ * The data already received by the ring is used first.  If no data is
+ * available and no receive request is in flight, the data is received
+ * directly from the socket (after resume or if the ring has no free
+ * buffers).
+ *
+ * @param connection the MHD connection structure
+ * @param buf where to write received data to
+ * @param size maximum size of @a buf (in bytes)
+ * @return the number of bytes received,
+ *         -1 on error, errno is set
+ */
+static ssize_t
+uring_recv_ (struct MHD_Connection *connection,
+             void *buf,
+             size_t size)
+{
+  struct MHD_UringConn_ *const uc = connection->uring;
+  struct MHD_Uring_ *const ring = connection->daemon->uring;
+
+  if (uc->has_buf)
+  {
+    size_t len;
+
+    len = uc->data_size - uc->data_off;
+    if (len > size)
+      len = size;
+    memcpy (buf,
+            MHD_uring_buf_ (ring, uc->bid) + uc->data_off,
+            len);
+    uc->data_off += len;
+    if (uc->data_off == uc->data_size)
+    {
+      uc->has_buf = false;
+      (void) MHD_uring_buf_release_ (ring, uc->bid);
+      /* Wait for the next receive completion */
+      connection->epoll_state &=
+        ~((enum MHD_EpollState) MHD_EPOLL_STATE_READ_READY);
+    }
+    return (ssize_t) len;
+  }
+  if (0 != uc->err)
+  {
+    errno = uc->err;
+    return -1;
+  }
+  if (uc->eof)
+    return 0;
+  if (uc->recv_pending)
+  {
+    errno = EAGAIN;
+    return -1;
+  }
+  return MHD_recv_ (connection->socket_fd,
+                    buf,
+                    size);
+}
+
+
+#endif /* IO_URING_SUPPORT */
+
 /**
  * Callback for receiving data from the socket.
  *
@@ -736,6 +808,13 @@ recv_param_adapter (struct MHD_Connection *connection,
   if (i > MHD_SCKT_SEND_MAX_SIZE_)
     i = MHD_SCKT_SEND_MAX_SIZE_; /* return value limit */
 
+#ifdef IO_URING_SUPPORT
+  if (NULL != connection->uring)
+    ret = uring_recv_ (connection,
+                       other,
+                       i);
+  else
+#endif /* IO_URING_SUPPORT */
   ret = MHD_recv_ (connection->socket_fd,
                    other,
                    i);
@@ -864,6 +943,148 @@ MHD_get_connection_values_n (struct MHD_Connection *connection,
 }
 
 
+/**
+ * The minimal number of slots in the hash index of the request headers.
+ * Must be a power of two.
+ */
+#define MHD_HDR_INDEX_MIN_SIZE 16
+
+/**
+ * The minimal number of the request headers to build the hash index.
+ * With the smaller number of the headers the list walk is fast enough
+ * and the pool memory is not spent for the index.
+ */
+#define MHD_HDR_INDEX_MIN_HEADERS 8
+
+
+/**
+ * Add the request header to the hash index.
+ * The index load factor is kept at or below 3/4 so the probe sequences
+ * are always terminated by an empty slot.
+ * @param idx the index to use, must be built
+ * @param hdr the header to add
+ * @return true if header has been added,
+ *         false if the index has no space for the new header
+ */
+static bool
+hdr_index_add (struct MHD_HeaderIndex_ *idx,
+               struct MHD_HTTP_Req_Header *hdr)
+{
+  const size_t mask = idx->size - 1;
+  const uint32_t hash = MHD_str_hash_caseless_bin_n_ (hdr->header,
+                                                      hdr->header_size);
+  size_t i;
+
+  mhd_assert (NULL != idx->slots);
+  mhd_assert (NULL != hdr->header);
+  if ((idx->used + 1) * 4 > idx->size * 3)
+    return false;
+
+  i = ((size_t) hash) & mask;
+  while (NULL != idx->slots[i].hdr)
+    i = (i + 1) & mask;
+  idx->slots[i].hdr = hdr;
+  idx->slots[i].hash = hash;
+  idx->used++;
+  return true;
+}
+
+
+/**
+ * Build the hash index of the request headers of #MHD_HEADER_KIND.
+ * The index is allocated in the connection memory pool. If the pool
+ * has not enough free space or the request has only a few headers,
+ * the index is not built and the headers are looked up in the list.
+ * @param c the connection to use
+ */
+static void
+build_headers_index (struct MHD_Connection *c)
+{
+  struct MHD_HeaderIndex_ *const idx = &c->rq.headers_index;
+  struct MHD_HTTP_Req_Header *pos;
+  size_t num_hdrs;
+  size_t size;
+  size_t unused;
+
+  mhd_assert (NULL == idx->slots);
+  num_hdrs = 0;
+  for (pos = c->rq.headers_received; NULL != pos; pos = pos->next)
+  {
+    if (MHD_HEADER_KIND == pos->kind)
+      num_hdrs++;
+  }
+  if (MHD_HDR_INDEX_MIN_HEADERS > num_hdrs)
+    return;
+  size = MHD_HDR_INDEX_MIN_SIZE;
+  while (size < num_hdrs * 2)
+  {
+    if (size > (SIZE_MAX / sizeof (idx->slots[0])) / 2)
+      return; /* Too many headers */
+    size *= 2;
+  }
+  idx->slots = (struct MHD_HeaderIndexSlot_ *)
+               MHD_pool_try_alloc (c->pool,
+                                   size * sizeof (idx->slots[0]),
+                                   &unused);
+  if (NULL == idx->slots)
+    return; /* Not enough space in the pool, use the list */
+  memset (idx->slots, 0, size * sizeof (idx->slots[0]));
+  idx->size = size;
+  idx->used = 0;
+  for (pos = c->rq.headers_received; NULL != pos; pos = pos->next)
+  {
+    if (MHD_HEADER_KIND != pos->kind)
+      continue;
+    if (! hdr_index_add (idx, pos))
+      mhd_assert (0); /* Cannot happen, the index has enough space */
+  }
+}
+
+
+/**
+ * Find the first request header with the given name in the hash index.
+ * @param idx the index to use, must be built
+ * @param key the name of the header
+ * @param key_size the length of @a key in bytes
+ * @param[in,out] slot_pos the position of the slot to continue the search
+ *                         from, set to SIZE_MAX to start a new search;
+ *                         updated with the position of the found slot
+ * @return the pointer to the found header,
+ *         NULL if no (more) headers with such name
+ */
+static struct MHD_HTTP_Req_Header *
+hdr_index_find (const struct MHD_HeaderIndex_ *idx,
+                const char *key,
+                size_t key_size,
+                size_t *slot_pos)
+{
+  const size_t mask = idx->size - 1;
+  const uint32_t hash = MHD_str_hash_caseless_bin_n_ (key, key_size);
+  size_t i;
+
+  mhd_assert (NULL != idx->slots);
+  if (SIZE_MAX == *slot_pos)
+    i = ((size_t) hash) & mask;
+  else
+    i = (*slot_pos + 1) & mask;
+  for ( ; NULL != idx->slots[i].hdr; i = (i + 1) & mask)
+  {
+    const struct MHD_HeaderIndexSlot_ *const slot = idx->slots + i;
+    if ( (hash == slot->hash) &&
+         (key_size == slot->hdr->header_size) &&
+         ( (key == slot->hdr->header) ||
+           (MHD_str_equal_caseless_bin_n_ (key,
+                                           slot->hdr->header,
+                                           key_size)) ) )
+    {
+      *slot_pos = i;
+      return slot->hdr;
+    }
+  }
+  return NULL;
+}
+
+
 /**
  * This function can be used to add an arbitrary entry to connection.
  * Internal version of #MHD_set_connection_value_n() without checking
@@ -892,7 +1113,7 @@ MHD_set_connection_value_n_nocheck_ (struct MHD_Connection *connection,
   struct MHD_HTTP_Req_Header *pos;
 
   pos = MHD_connection_alloc_memory_ (connection,
-                                      sizeof (struct MHD_HTTP_Res_Header));
+                                      sizeof (struct MHD_HTTP_Req_Header));
   if (NULL == pos)
     return MHD_NO;
   pos->header = key;
@@ -900,6 +1121,10 @@ MHD_set_connection_value_n_nocheck_ (struct MHD_Connection *connection,
   pos->value = value;
   pos->value_size = value_size;
   pos->kind = kind;
+  if ((MHD_HEADER_KIND == kind) && (NULL != key))
+    pos->hdr_id = MHD_get_header_id_ (key, key_size);
+  else
+    pos->hdr_id = MHD_HEADER_ID_UNKNOWN;
   pos->next = NULL;
   /* append 'pos' to the linked list of headers */
   if (NULL == connection->rq.headers_received_tail)
@@ -912,6 +1137,14 @@ MHD_set_connection_value_n_nocheck_ (struct MHD_Connection *connection,
     connection->rq.headers_received_tail->next = pos;
     connection->rq.headers_received_tail = pos;
   }
+  if ( (MHD_HEADER_KIND == kind) &&
+       (NULL != key) &&
+       (NULL != connection->rq.headers_index.slots) )
+  {
+    /* The header is added by the application after the index was built */
+    if (! hdr_index_add (&connection->rq.headers_index, pos))
+      connection->rq.headers_index.slots = NULL; /* Fallback to the list */
+  }
   return MHD_YES;
 }
 
@@ -1067,7 +1300,17 @@ MHD_lookup_connection_value_n (struct MHD_Connection *connection,
   if (NULL == connection)
     return MHD_NO;
 
-  if (NULL == key)
+  if ( (MHD_HEADER_KIND == kind) &&
+       (NULL != key) &&
+       (NULL != connection->rq.headers_index.slots) )
+  {
+    size_t slot_pos = SIZE_MAX;
+    pos = hdr_index_find (&connection->rq.headers_index,
+                          key,
+                          key_size,
+                          &slot_pos);
+  }
+  else if (NULL == key)
   {
     for (pos = connection->rq.headers_received; NULL != pos; pos = pos->next)
     {
@@ -1104,14 +1347,76 @@ MHD_lookup_connection_value_n (struct MHD_Connection *connection,
 
 
 /**
- * Check whether request header contains particular token.
+ * Get a value of the well-known request header by the identifier.
+ * If the request has several headers with the same name, the value of the
+ * first header is returned.
+ * @param connection the connection to get values from
+ * @param hdr_id the identifier of the header to look for
+ * @param[out] value_ptr the pointer to variable, which will be set to found value,
+ *                       will not be updated if header not found,
+ *                       could be NULL to just check for presence of the header
+ * @param[out] value_size_ptr the pointer variable, which will set to found value,
+ *                            will not be updated if header not found,
+ *                            could be NULL
+ * @return #MHD_YES if header is found,
+ *         #MHD_NO otherwise.
+ * @ingroup request
+ */
+_MHD_EXTERN enum MHD_Result
+MHD_lookup_connection_header_by_id (struct MHD_Connection *connection,
+                                    enum MHD_HeaderId hdr_id,
+                                    const char **value_ptr,
+                                    size_t *value_size_ptr)
+{
+  struct MHD_HTTP_Req_Header *pos;
+
+  if ((NULL == connection) || (MHD_HEADER_ID_UNKNOWN == hdr_id))
+    return MHD_NO;
+
+  if (NULL != connection->rq.headers_index.slots)
+  {
+    const char *name;
+    size_t name_len;
+    size_t slot_pos = SIZE_MAX;
+
+    name = MHD_get_header_name_ (hdr_id,
+                                 &name_len);
+    if (NULL == name)
+      return MHD_NO;
+    pos = hdr_index_find (&connection->rq.headers_index,
+                          name,
+                          name_len,
+                          &slot_pos);
+  }
+  else
+  {
+    for (pos = connection->rq.headers_received; NULL != pos; pos = pos->next)
+    {
+      if (hdr_id == pos->hdr_id)
+        break;
+    }
+  }
+
+  if (NULL == pos)
+    return MHD_NO;
+
+  if (NULL != value_ptr)
+    *value_ptr = pos->value;
+
+  if (NULL != value_size_ptr)
+    *value_size_ptr = pos->value_size;
+
+  return MHD_YES;
+}
+
+
+/**
+ * Check whether the well-known request header contains particular token.
  *
  * Token could be surrounded by spaces and tabs and delimited by comma.
- * Case-insensitive match used for header names and tokens.
+ * Case-insensitive match used for tokens.
  * @param connection the connection to get values from
- * @param header     the header name
- * @param header_len the length of header, not including optional
- *                   terminating null-character
+ * @param hdr_id     the identifier of the header
  * @param token      the token to find
  * @param token_len  the length of token, not including optional
  *                   terminating null-character.
@@ -1119,26 +1424,41 @@ MHD_lookup_connection_value_n (struct MHD_Connection *connection,
  *         false otherwise
  */
 static bool
-MHD_lookup_header_token_ci (const struct MHD_Connection *connection,
-                            const char *header,
-                            size_t header_len,
-                            const char *token,
-                            size_t token_len)
+MHD_lookup_header_id_token_ci (const struct MHD_Connection *connection,
+                               enum MHD_HeaderId hdr_id,
+                               const char *token,
+                               size_t token_len)
 {
   struct MHD_HTTP_Req_Header *pos;
 
-  if ((NULL == connection) || (NULL == header) || (0 == header[0]) ||
+  if ((NULL == connection) || (MHD_HEADER_ID_UNKNOWN == hdr_id) ||
       (NULL == token) || (0 == token[0]))
     return false;
 
+  if (NULL != connection->rq.headers_index.slots)
+  {
+    const char *name;
+    size_t name_len;
+    size_t slot_pos = SIZE_MAX;
+
+    name = MHD_get_header_name_ (hdr_id,
+                                 &name_len);
+    if (NULL == name)
+      return false;
+    while (NULL != (pos = hdr_index_find (&connection->rq.headers_index,
+                                          name,
+                                          name_len,
+                                          &slot_pos)))
+    {
+      if (MHD_str_has_token_caseless_ (pos->value, token, token_len))
+        return true;
+    }
+    return false;
+  }
+
   for (pos = connection->rq.headers_received; NULL != pos; pos = pos->next)
   {
-    if ((0 != (pos->kind & MHD_HEADER_KIND)) &&
-        (header_len == pos->header_size) &&
-        ( (header == pos->header) ||
-          (MHD_str_equal_caseless_bin_n_ (header,
-                                          pos->header,
-                                          header_len)) ) &&
+    if ((hdr_id == pos->hdr_id) &&
         (MHD_str_has_token_caseless_ (pos->value, token, token_len)))
       return true;
   }
@@ -1147,19 +1467,19 @@ MHD_lookup_header_token_ci (const struct MHD_Connection *connection,
 
 
 /**
- * Check whether request header contains particular static @a tkn.
+ * Check whether the well-known request header contains particular
+ * static @a tkn.
  *
  * Token could be surrounded by spaces and tabs and delimited by comma.
- * Case-insensitive match used for header names and tokens.
+ * Case-insensitive match used for tokens.
  * @param c   the connection to get values from
- * @param h   the static string of header name
+ * @param id  the identifier of the header
  * @param tkn the static string of token to find
  * @return true if token is found in specified header,
  *         false otherwise
  */
-#define MHD_lookup_header_s_token_ci(c,h,tkn) \
-  MHD_lookup_header_token_ci ((c),(h),MHD_STATICSTR_LEN_ (h), \
-                              (tkn),MHD_STATICSTR_LEN_ (tkn))
+#define MHD_lookup_header_id_s_token_ci(c,id,tkn) \
+  MHD_lookup_header_id_token_ci ((c),(id),(tkn),MHD_STATICSTR_LEN_ (tkn))
 
 
 /**
@@ -1181,13 +1501,10 @@ need_100_continue (struct MHD_Connection *connection)
     return false;
 
   if (MHD_NO ==
-      MHD_lookup_connection_value_n (connection,
-                                     MHD_HEADER_KIND,
-                                     MHD_HTTP_HEADER_EXPECT,
-                                     MHD_STATICSTR_LEN_ ( \
-                                       MHD_HTTP_HEADER_EXPECT),
-                                     &expect,
-                                     NULL))
+      MHD_lookup_connection_header_by_id (connection,
+                                          MHD_HEADER_ID_EXPECT,
+                                          &expect,
+                                          NULL))
     return false;
 
   if (MHD_str_equal_caseless_ (expect,
@@ -1254,6 +1571,7 @@ MHD_connection_close_ (struct MHD_Connection *connection,
   mhd_assert ( (! MHD_D_IS_USING_THREADS_ (daemon)) || \
                MHD_thread_handle_ID_is_current_thread_ (connection->tid) );
 #endif /* MHD_USE_THREADS */
+  MHD_TRACE2_ (conn__close, connection, (int) termination_code);
   if ( (NULL != daemon->notify_completed) &&
        (connection->rq.client_aware) )
     daemon->notify_completed (daemon->notify_completed_cls,
@@ -1268,7 +1586,10 @@ MHD_connection_close_ (struct MHD_Connection *connection,
   }
   if (NULL != connection->pool)
   {
-    MHD_pool_destroy (connection->pool);
+    /* With thread-per-connection the cache is disabled and the pool is
+       destroyed */
+    MHD_pool_cache_put (&daemon->pool_cache,
+                        connection->pool);
     connection->pool = NULL;
   }
 
@@ -1450,6 +1771,13 @@ try_ready_normal_body (struct MHD_Connection *connection)
     return MHD_YES;
   }
 #endif /* _MHD_HAVE_SENDFILE */
+#if defined(_MHD_HAVE_SPLICE)
+  if (MHD_resp_sender_splice == connection->rp.resp_sender)
+  {
+    /* will use splice, no need to bother response crc */
+    return MHD_YES;
+  }
+#endif /* _MHD_HAVE_SPLICE */
 
   ret = response->crc (response->crc_cls,
                        connection->rp.rsp_write_position,
@@ -1568,6 +1896,41 @@ try_ready_chunked_body (struct MHD_Connection *connection,
   if (left_to_send < size_to_fill)
     size_to_fill = (size_t) left_to_send;
 
+#if defined(_MHD_HAVE_SPLICE)
+  if ( (MHD_resp_sender_splice == connection->rp.resp_sender) &&
+       (0 != left_to_send) )
+  {
+    int avail;
+    /* The size of the chunk must be known before the chunk data is
+       sent. Use the amount of data already available in the pipe, the
+       data itself is moved later by splice(). */
+    if ( (0 == ioctl (response->fd, FIONREAD, &avail)) &&
+         (0 < avail) )
+    {
+      size_t chunk_size = (size_t) avail;
+      if (size_to_fill < chunk_size)
+        chunk_size = size_to_fill;
+      chunk_hdr_len = MHD_uint32_to_strx ((uint32_t) chunk_size, chunk_hdr,
+                                          sizeof(chunk_hdr));
+      mhd_assert (chunk_hdr_len != 0);
+      mhd_assert (chunk_hdr_len < sizeof(chunk_hdr));
+      *p_finished = false;
+      memcpy (connection->write_buffer,
+              chunk_hdr,
+              chunk_hdr_len);
+      connection->write_buffer[chunk_hdr_len] = '\r';
+      connection->write_buffer[chunk_hdr_len + 1] = '\n';
+      connection->write_buffer_send_offset = 0;
+      connection->write_buffer_append_offset = chunk_hdr_len + 2;
+      connection->rp.splice_left = chunk_size;
+      return MHD_YES;
+    }
+    /* No data in the pipe yet or the amount of data is unknown.
+       Use the standard reader for this chunk: it waits for the data or
+       for the end of the stream. */
+  }
+#endif /* _MHD_HAVE_SPLICE */
+
   if (0 == left_to_send)
     /* nothing to send, don't bother calling crc */
     ret = MHD_CONTENT_READER_END_OF_STREAM;
@@ -1723,17 +2086,17 @@ keepalive_possible (struct MHD_Connection *connection)
   if (! MHD_IS_HTTP_VER_SUPPORTED (c->rq.http_ver))
     return MHD_CONN_MUST_CLOSE;
 
-  if (MHD_lookup_header_s_token_ci (c,
-                                    MHD_HTTP_HEADER_CONNECTION,
-                                    "close"))
+  if (MHD_lookup_header_id_s_token_ci (c,
+                                       MHD_HEADER_ID_CONNECTION,
+                                       "close"))
     return MHD_CONN_MUST_CLOSE;
 
   if ((MHD_HTTP_VER_1_0 == connection->rq.http_ver) ||
       (0 != (connection->rp.response->flags & MHD_RF_HTTP_1_0_SERVER)))
   {
-    if (MHD_lookup_header_s_token_ci (connection,
-                                      MHD_HTTP_HEADER_CONNECTION,
-                                      "Keep-Alive"))
+    if (MHD_lookup_header_id_s_token_ci (connection,
+                                         MHD_HEADER_ID_CONNECTION,
+                                         "Keep-Alive"))
       return MHD_CONN_USE_KEEPALIVE;
 
     return MHD_CONN_MUST_CLOSE;
@@ -1833,17 +2196,88 @@ get_date_str (char *date)
 }
 
 
+#ifdef MHD_USE_DATE_CACHE
+/**
+ * Produce time stamp, use the daemon-wide cached value if it was
+ * generated during the current second of the monotonic clock.
+ *
+ * Result is NOT null-terminated.
+ * Result is always 29 bytes long.
+ *
+ * @param daemon the daemon to use
+ * @param[out] date where to write the time stamp, with
+ *             at least 29 bytes available space.
+ * @return true if the time stamp has been written,
+ *         false if the current time cannot be converted
+ */
+static bool
+get_date_str_cached (struct MHD_Daemon *daemon,
+                     char *date)
+{
+  struct MHD_DateCache_ *const cache =
+    &(MHD_get_master (daemon)->date_cache);
+  const uint32_t mono_sec =
+    ((uint32_t) MHD_monotonic_sec_counter ()) + 1;
+  uint32_t buf[MHD_DATE_CACHE_WORDS_];
+  uint32_t seq;
+  unsigned int i;
+
+  seq = mhd_atomic_u32_load_acq_ (&cache->seq);
+  if ( (0 == (seq & 1)) &&
+       (mono_sec == mhd_atomic_u32_load_rlx_ (&cache->mono_sec)) )
+  {
+    for (i = 0; i < MHD_DATE_CACHE_WORDS_; ++i)
+      buf[i] = mhd_atomic_u32_load_rlx_ (cache->date + i);
+    mhd_atomic_fence_acq_ ();
+    if (seq == mhd_atomic_u32_load_rlx_ (&cache->seq))
+    {
+      memcpy (date, buf, 29);
+      return true;
+    }
+  }
+
+  /* The cached value is outdated or is being updated */
+  buf[MHD_DATE_CACHE_WORDS_ - 1] = 0;
+  if (! get_date_str ((char *) buf))
+    return false;
+  memcpy (date, buf, 29);
+
+  /* Update the cache, if no other thread is updating it right now */
+  seq = mhd_atomic_u32_load_rlx_ (&cache->seq);
+  if ( (0 == (seq & 1)) &&
+       mhd_atomic_u32_cas_acq_ (&cache->seq, seq, seq + 1) )
+  {
+    mhd_atomic_fence_rel_ ();
+    for (i = 0; i < MHD_DATE_CACHE_WORDS_; ++i)
+      mhd_atomic_u32_store_rlx_ (cache->date + i, buf[i]);
+    mhd_atomic_u32_store_rlx_ (&cache->mono_sec, mono_sec);
+    mhd_atomic_u32_store_rel_ (&cache->seq, seq + 2);
+  }
+  return true;
+}
+
+
+#endif /* MHD_USE_DATE_CACHE */
+
+
 /**
  * Produce HTTP DATE header.
  * Result is always 37 bytes long (plus one terminating null).
  *
+ * @param daemon the daemon to use
  * @param[out] header where to write the header, with
  *             at least 38 bytes available space.
  */
 static bool
-get_date_header (char *header)
+get_date_header (struct MHD_Daemon *daemon,
+                 char *header)
 {
+#ifdef MHD_USE_DATE_CACHE
+  if (! get_date_str_cached (daemon, header + 6))
+#else  /* ! MHD_USE_DATE_CACHE */
+  (void) daemon; /* Mute compiler warning */
   if (! get_date_str (header + 6))
+#endif /* ! MHD_USE_DATE_CACHE */
   {
     header[0] = 0;
     return false;
@@ -1861,6 +2295,68 @@ get_date_header (char *header)
 }
 
 
+/**
+ * Get the starting size of the read buffer for the new request.
+ * In the adaptive mode the size is based on the size of the previous
+ * requests, but it is never larger than the default size.
+ * @param d the daemon of the connection
+ * @param def_size the default size of the read buffer
+ * @return the starting size of the read buffer
+ */
+static size_t
+get_start_read_buffer_size (const struct MHD_Daemon *d,
+                            size_t def_size)
+{
+  size_t buf_size;
+
+  if ( (! d->adaptive_bufs) ||
+       (0 == d->read_buf_avg) )
+    return def_size;
+  /* Leave some space for the requests larger than average.
+     The average is not larger than the size of the pool. */
+  buf_size = (size_t) d->read_buf_avg;
+  buf_size += buf_size / 2;
+  if (MHD_BUF_INC_SIZE > buf_size)
+    buf_size = MHD_BUF_INC_SIZE;
+  if (def_size < buf_size)
+    return def_size;
+  return buf_size;
+}
+
+
+/**
+ * Update the average size of the read buffer needed for the requests
+ * with the size of the current request.
+ * To be called when the request header is processed.
+ * @param c the connection to use
+ */
+static void
+update_read_buffer_avg (struct MHD_Connection *c)
+{
+  struct MHD_Daemon *const d = c->daemon;
+  size_t req_size;
+
+  mhd_assert (d->adaptive_bufs);
+  req_size = c->rq.header_size;
+  if (d->pool_size < req_size)
+    req_size = d->pool_size;
+  if ( (! c->rq.have_chunked_upload) &&
+       (0 != c->rq.remaining_upload_size) )
+  {
+    /* The body of the known size is better processed at once */
+    if ((uint64_t) (d->pool_size - req_size) < c->rq.remaining_upload_size)
+      req_size = d->pool_size;
+    else
+      req_size += (size_t) c->rq.remaining_upload_size;
+  }
+  if (0 == d->read_buf_avg)
+    MHD_stats_set_ (&d->read_buf_avg, req_size);
+  else /* Exponential moving average with 1/8 weight of the new value */
+    MHD_stats_set_ (&d->read_buf_avg,
+                    d->read_buf_avg - d->read_buf_avg / 8 + req_size / 8);
+}
+
+
 /**
  * Try growing the read buffer.  We initially claim half the available
  * buffer space for the read buffer (the other half being left for
@@ -1886,7 +2382,9 @@ try_grow_read_buffer (struct MHD_Connection *connection,
   if (0 == avail_size)
     return false;               /* No more space available */
   if (0 == connection->read_buffer_size)
-    new_size = avail_size / 2;  /* Use half of available buffer for reading */
+    new_size =  /* Use half of available buffer for reading or learned size */
+               get_start_read_buffer_size (connection->daemon,
+                                           avail_size / 2);
   else
   {
     size_t grow_size;
@@ -1946,6 +2444,8 @@ try_grow_read_buffer (struct MHD_Connection *connection,
   connection->read_buffer = rb;
   mhd_assert (NULL != connection->read_buffer);
   connection->read_buffer_size = new_size;
+  if (connection->daemon->adaptive_bufs)
+    MHD_stats_add_ (&connection->daemon->buf_stats.read_grows, 1, false);
   return true;
 }
 
@@ -1984,6 +2484,8 @@ connection_shrink_read_buffer (struct MHD_Connection *connection)
     c->read_buffer = new_buf;
     c->read_buffer_size = c->read_buffer_offset;
   }
+  if (c->daemon->adaptive_bufs)
+    MHD_stats_add_ (&c->daemon->buf_stats.read_shrinks, 1, false);
 }
 
 
@@ -2009,6 +2511,9 @@ connection_maximize_write_buffer (struct MHD_Connection *connection)
   free_size = MHD_pool_get_free (pool);
   if (0 != free_size)
   {
+    MHD_stats_max_ (&c->daemon->stats.pool_max_used,
+                    MHD_pool_get_used (pool) - c->write_buffer_size,
+                    MHD_D_IS_USING_THREAD_PER_CONN_ (c->daemon));
     new_size = c->write_buffer_size + free_size;
     /* This function must not move the buffer position.
      * MHD_pool_reallocate () may return the new position only if buffer was
@@ -2024,6 +2529,8 @@ connection_maximize_write_buffer (struct MHD_Connection *connection)
     mhd_assert ((c->write_buffer == new_buf) || (NULL == c->write_buffer));
     c->write_buffer = new_buf;
     c->write_buffer_size = new_size;
+    if (c->daemon->adaptive_bufs)
+      MHD_stats_add_ (&c->daemon->buf_stats.write_grows, 1, false);
     if (c->write_buffer_send_offset == c->write_buffer_append_offset)
     {
       /* All data have been sent, reset offsets to zero. */
@@ -2602,7 +3109,7 @@ build_header_response (struct MHD_Connection *connection)
     /* Additional byte for unused zero-termination */
     if (buf_size < pos + 38)
       return MHD_NO;
-    if (get_date_header (buf + pos))
+    if (get_date_header (c->daemon, buf + pos))
       pos += 37;
   }
   /* The "Connection:" header */
@@ -2904,6 +3411,7 @@ transmit_error_response_len (struct MHD_Connection *connection,
     connection->rq.url_len = 0;
     connection->rq.headers_received = NULL;
     connection->rq.headers_received_tail = NULL;
+    connection->rq.headers_index.slots = NULL;
     connection->write_buffer = NULL;
     connection->write_buffer_size = 0;
     connection->write_buffer_send_offset = 0;
@@ -3155,12 +3663,11 @@ get_no_space_err_status_code (struct MHD_Connection *c,
     static const size_t host_field_name_len =
       MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_HOST);
     size_t host_field_name_value_len;
-    if (MHD_NO != MHD_lookup_connection_value_n (c,
-                                                 MHD_HEADER_KIND,
-                                                 MHD_HTTP_HEADER_HOST,
-                                                 host_field_name_len,
-                                                 NULL,
-                                                 &host_field_name_value_len))
+    if (MHD_NO !=
+        MHD_lookup_connection_header_by_id (c,
+                                            MHD_HEADER_ID_HOST,
+                                            NULL,
+                                            &host_field_name_value_len))
     {
       /* Calculate the minimal size of the field line: no space between
          colon and the field value, line terminated by LR */
@@ -4146,13 +4653,10 @@ parse_cookie_header (struct MHD_Connection *connection)
     (1 >= connection->daemon->client_discipline);
 
   if (MHD_NO ==
-      MHD_lookup_connection_value_n (connection,
-                                     MHD_HEADER_KIND,
-                                     MHD_HTTP_HEADER_COOKIE,
-                                     MHD_STATICSTR_LEN_ (
-                                       MHD_HTTP_HEADER_COOKIE),
-                                     &hdr,
-                                     &hdr_len))
+      MHD_lookup_connection_header_by_id (connection,
+                                          MHD_HEADER_ID_COOKIE,
+                                          &hdr,
+                                          &hdr_len))
     return MHD_PARSE_COOKIE_OK;
   if (0 == hdr_len)
     return MHD_PARSE_COOKIE_OK;
@@ -4363,21 +4867,28 @@ call_connection_handler (struct MHD_Connection *connection)
 {
   struct MHD_Daemon *daemon = connection->daemon;
   size_t processed;
+  uint64_t handler_start;
+  enum MHD_Result res;
 
   if (NULL != connection->rp.response)
     return;                     /* already queued a response */
   processed = 0;
   connection->rq.client_aware = true;
   connection->in_access_handler = true;
-  if (MHD_NO ==
-      daemon->default_handler (daemon->default_handler_cls,
-                               connection,
-                               connection->rq.url,
-                               connection->rq.method,
-                               connection->rq.version,
-                               NULL,
-                               &processed,
-                               &connection->rq.client_context))
+  handler_start = daemon->phase_timing ? MHD_monotonic_usec_counter () : 0;
+  MHD_TRACE2_ (handler__invoke, connection, processed);
+  res = daemon->default_handler (daemon->default_handler_cls,
+                                 connection,
+                                 connection->rq.url,
+                                 connection->rq.method,
+                                 connection->rq.version,
+                                 NULL,
+                                 &processed,
+                                 &connection->rq.client_context);
+  if (daemon->phase_timing)
+    connection->timing.handler += MHD_monotonic_usec_counter ()
+                                  - handler_start;
+  if (MHD_NO == res)
   {
     connection->in_access_handler = false;
     /* serious internal error, close connection */
@@ -4423,6 +4934,8 @@ process_request_body (struct MHD_Connection *connection)
     size_t to_be_processed;
     size_t left_unprocessed;
     size_t processed_size;
+    uint64_t handler_start;
+    enum MHD_Result res;
 
     instant_retry = false;
     if (connection->rq.have_chunked_upload)
@@ -4613,15 +5126,20 @@ process_request_body (struct MHD_Connection *connection)
     left_unprocessed = to_be_processed;
     connection->rq.client_aware = true;
     connection->in_access_handler = true;
-    if (MHD_NO ==
-        daemon->default_handler (daemon->default_handler_cls,
-                                 connection,
-                                 connection->rq.url,
-                                 connection->rq.method,
-                                 connection->rq.version,
-                                 buffer_head,
-                                 &left_unprocessed,
-                                 &connection->rq.client_context))
+    handler_start = daemon->phase_timing ? MHD_monotonic_usec_counter () : 0;
+    MHD_TRACE2_ (handler__invoke, connection, to_be_processed);
+    res = daemon->default_handler (daemon->default_handler_cls,
+                                   connection,
+                                   connection->rq.url,
+                                   connection->rq.method,
+                                   connection->rq.version,
+                                   buffer_head,
+                                   &left_unprocessed,
+                                   &connection->rq.client_context);
+    if (daemon->phase_timing)
+      connection->timing.handler += MHD_monotonic_usec_counter ()
+                                    - handler_start;
+    if (MHD_NO == res)
     {
       connection->in_access_handler = false;
       /* serious internal error, close connection */
@@ -4708,6 +5226,60 @@ check_write_done (struct MHD_Connection *connection,
 }
 
 
+#if defined(_MHD_HAVE_SPLICE)
+/**
+ * Read the rest of the current chunk from the pipe to the write buffer.
+ *
+ * Used when splice() cannot be used anymore, while the chunk header
+ * with the size of the chunk has been sent already.  The data of the
+ * chunk is already in the pipe.
+ * The write buffer is filled with the rest of the chunk data followed by
+ * the chunk termination.
+ *
+ * @param connection the connection to use
+ * @return true if succeed,
+ *         false if the pipe data cannot be read
+ */
+static bool
+read_spliced_chunk_rest (struct MHD_Connection *connection)
+{
+  const size_t size = connection->rp.splice_left;
+  size_t filled;
+
+  mhd_assert (0 != size);
+  mhd_assert (connection->write_buffer_send_offset == \
+              connection->write_buffer_append_offset);
+  mhd_assert (connection->write_buffer_size >= size + 2);
+
+  filled = 0;
+  while (filled < size)
+  {
+    const ssize_t res = read (connection->rp.response->fd,
+                              connection->write_buffer + filled,
+                              size - filled);
+    if (0 > res)
+    {
+      if (EINTR == errno)
+        continue;
+      return false;
+    }
+    if (0 == res)
+      return false;
+    filled += (size_t) res;
+  }
+  connection->write_buffer[size] = '\r';
+  connection->write_buffer[size + 1] = '\n';
+  connection->write_buffer_send_offset = 0;
+  connection->write_buffer_append_offset = size + 2;
+  connection->rp.rsp_write_position += size;
+  connection->rp.splice_left = 0;
+  return true;
+}
+
+
+#endif /* _MHD_HAVE_SPLICE */
+
+
 /**
  * Parse the various headers; figure out the size
  * of the upload and make sure the headers follow
@@ -4729,16 +5301,14 @@ parse_connection_headers (struct MHD_Connection *connection)
     return;
   }
 #endif /* COOKIE_SUPPORT */
+  build_headers_index (connection);
   if ( (-3 < connection->daemon->client_discipline) &&
        (MHD_IS_HTTP_VER_1_1_COMPAT (connection->rq.http_ver)) &&
        (MHD_NO ==
-        MHD_lookup_connection_value_n (connection,
-                                       MHD_HEADER_KIND,
-                                       MHD_HTTP_HEADER_HOST,
-                                       MHD_STATICSTR_LEN_ (
-                                         MHD_HTTP_HEADER_HOST),
-                                       NULL,
-                                       NULL)) )
+        MHD_lookup_connection_header_by_id (connection,
+                                            MHD_HEADER_ID_HOST,
+                                            NULL,
+                                            NULL)) )
   {
 #ifdef HAVE_MESSAGES
     MHD_DLOG (connection->daemon,
@@ -4756,13 +5326,10 @@ parse_connection_headers (struct MHD_Connection *connection)
      See RFC9112, Section 6, paragraph 4. */
   connection->rq.remaining_upload_size = 0;
   if (MHD_NO !=
-      MHD_lookup_connection_value_n (connection,
-                                     MHD_HEADER_KIND,
-                                     MHD_HTTP_HEADER_TRANSFER_ENCODING,
-                                     MHD_STATICSTR_LEN_ (
-                                       MHD_HTTP_HEADER_TRANSFER_ENCODING),
-                                     &enc,
-                                     NULL))
+      MHD_lookup_connection_header_by_id (connection,
+                                          MHD_HEADER_ID_TRANSFER_ENCODING,
+                                          &enc,
+                                          NULL))
   {
     if (! MHD_str_equal_caseless_ (enc,
                                    "chunked"))
@@ -4773,13 +5340,10 @@ parse_connection_headers (struct MHD_Connection *connection)
       return;
     }
     else if (MHD_NO !=
-             MHD_lookup_connection_value_n (connection,
-                                            MHD_HEADER_KIND,
-                                            MHD_HTTP_HEADER_CONTENT_LENGTH,
-                                            MHD_STATICSTR_LEN_ ( \
-                                              MHD_HTTP_HEADER_CONTENT_LENGTH),
-                                            NULL,
-                                            NULL))
+             MHD_lookup_connection_header_by_id (connection,
+                                                 MHD_HEADER_ID_CONTENT_LENGTH,
+                                                 NULL,
+                                                 NULL))
     {
       /* TODO: add individual settings */
       if (1 <= connection->daemon->client_discipline)
@@ -4805,13 +5369,10 @@ parse_connection_headers (struct MHD_Connection *connection)
     connection->rq.remaining_upload_size = MHD_SIZE_UNKNOWN;
   }
   else if (MHD_NO !=
-           MHD_lookup_connection_value_n (connection,
-                                          MHD_HEADER_KIND,
-                                          MHD_HTTP_HEADER_CONTENT_LENGTH,
-                                          MHD_STATICSTR_LEN_ (
-                                            MHD_HTTP_HEADER_CONTENT_LENGTH),
-                                          &clen,
-                                          &val_len))
+           MHD_lookup_connection_header_by_id (connection,
+                                               MHD_HEADER_ID_CONTENT_LENGTH,
+                                               &clen,
+                                               &val_len))
   {
     size_t num_digits;
 
@@ -5016,8 +5577,26 @@ get_request_line_inner (struct MHD_Connection *c)
 
   while (p < c->read_buffer_offset)
   {
-    const char chr = c->read_buffer[p];
+    char chr;
     bool end_of_line;
+
+    if ((0 == c->rq.hdrs.rq_line.last_ws_end) ||
+        (p != c->rq.hdrs.rq_line.last_ws_end))
+    {
+      /* Not at the end of the whitespace block. The characters, which are
+         not control characters, not spaces and not '?', have no special
+         meaning in the request line and can be skipped in bulk. */
+      const size_t plain_len =
+        MHD_str_find_delim_ (c->read_buffer + p,
+                             c->read_buffer_offset - p,
+                             '?');
+      if (0 != plain_len)
+      {
+        p += plain_len;
+        continue;
+      }
+    }
+    chr = c->read_buffer[p];
     /*
        The processing logic is different depending on the configured strictness:
 
@@ -5674,6 +6253,7 @@ get_request_line (struct MHD_Connection *c)
     return true; /* Error in processing */
 
   c->state = MHD_CONNECTION_REQ_LINE_RECEIVED;
+  MHD_TRACE3_ (request__line, c, c->rq.method, c->rq.url);
   return true;
 }
 
@@ -5772,9 +6352,30 @@ get_req_header (struct MHD_Connection *c,
   mhd_assert (p <= c->read_buffer_offset);
   while (p < c->read_buffer_offset)
   {
-    const char chr = c->read_buffer[p];
+    char chr;
     bool end_of_line;
 
+    if (0 == c->rq.hdrs.hdr.ws_start)
+    {
+      /* Not after a whitespace. The characters, which are not control
+         characters, not spaces and not a colon (in the name), have
+         no special meaning and can be skipped in bulk. */
+      const bool in_name = (! c->rq.hdrs.hdr.name_end_found) &&
+                           (! c->rq.hdrs.hdr.starts_with_ws);
+      const size_t plain_len =
+        MHD_str_find_delim_ (c->read_buffer + p,
+                             c->read_buffer_offset - p,
+                             in_name ? ':' : 0);
+      if (0 != plain_len)
+      {
+        if ((! in_name) && (0 == c->rq.hdrs.hdr.value_start))
+          c->rq.hdrs.hdr.value_start = p;
+        p += plain_len;
+        continue;
+      }
+    }
+    chr = c->read_buffer[p];
+
     mhd_assert ((0 == c->rq.hdrs.hdr.name_len) || \
                 (c->rq.hdrs.hdr.name_len < p));
     mhd_assert ((0 == c->rq.hdrs.hdr.name_len) || (0 != p));
@@ -6356,17 +6957,125 @@ get_req_headers (struct MHD_Connection *c, bool process_footers)
 }
 
 
+/**
+ * Get the connection by the node in the timeouts heap.
+ * @param node the pointer to the @a tmout_node member of the connection
+ * @return the pointer to the connection
+ */
+#define tmout_node_to_conn(node) \
+  ((struct MHD_Connection *) \
+   (void *) (((char *) (node)) - offsetof (struct MHD_Connection, tmout_node)))
+
+
+/**
+ * Get the deadline of the connection's timeout.
+ * @param c the connection to use
+ * @return the time (by the monotonic clock) when the connection is
+ *         timed out, UINT64_MAX if the connection has no timeout
+ */
+static uint64_t
+connection_get_deadline (const struct MHD_Connection *c)
+{
+  if (0 == c->connection_timeout_ms)
+    return UINT64_MAX;
+  return c->last_activity + c->connection_timeout_ms;
+}
+
+
+/**
+ * Add the connection to the daemon's timeouts tracking: to the
+ * 'normal_timeout' list if the default timeout value is used or to
+ * the 'manual_timeout' heap otherwise.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param connection the connection to add
+ */
+void
+MHD_connection_timeout_add_ (struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+
+  if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
+    XDLL_insert (daemon->normal_timeout_head,
+                 daemon->normal_timeout_tail,
+                 connection);
+  else
+    MHD_tmheap_insert_ (&daemon->manual_timeout_heap,
+                        &connection->tmout_node,
+                        connection_get_deadline (connection));
+}
+
+
+/**
+ * Remove the connection from the daemon's timeouts tracking.
+ * Does nothing if the connection with the custom timeout has been
+ * already removed from the 'manual_timeout' heap.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param connection the connection to remove
+ */
+void
+MHD_connection_timeout_remove_ (struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+
+  if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
+    XDLL_remove (daemon->normal_timeout_head,
+                 daemon->normal_timeout_tail,
+                 connection);
+  else if (MHD_tmheap_is_in_ (&daemon->manual_timeout_heap,
+                              &connection->tmout_node))
+    MHD_tmheap_remove_ (&daemon->manual_timeout_heap,
+                        &connection->tmout_node);
+}
+
+
+/**
+ * Get the connection with the earliest deadline among the connections
+ * with the custom timeouts.
+ * The outdated keys in the 'manual_timeout' heap are updated as needed,
+ * the key of the returned connection is equal to its deadline.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param daemon the daemon to use
+ * @return the connection with the earliest deadline,
+ *         NULL if no connections with the custom timeouts
+ */
+struct MHD_Connection *
+MHD_connection_timeout_get_manual_first_ (struct MHD_Daemon *daemon)
+{
+  struct MHD_TmHeapNode_ *node;
+
+  while (NULL != (node = MHD_tmheap_first_ (&daemon->manual_timeout_heap)))
+  {
+    struct MHD_Connection *const c = tmout_node_to_conn (node);
+    const uint64_t deadline = connection_get_deadline (c);
+
+    if (deadline == node->key)
+      return c;
+    /* The connection had some activity since the key was set */
+    MHD_tmheap_update_ (&daemon->manual_timeout_heap,
+                        node,
+                        deadline);
+  }
+  return NULL;
+}
+
+
 /**
  * Update the 'last_activity' field of the connection to the current time
  * and move the connection to the head of the 'normal_timeout' list if
  * the timeout for the connection uses the default value.
  *
+ * With #MHD_OPTION_COARSE_ACTIVITY_TIME the time of the current event
+ * loop iteration is used instead of the clock.
+ * Nothing is changed if the time is the same as the previous activity
+ * time: the connection is already in the right place in the list.
+ *
  * @param connection the connection that saw some activity
  */
 void
 MHD_update_last_activity_ (struct MHD_Connection *connection)
 {
   struct MHD_Daemon *daemon = connection->daemon;
+  uint64_t now;
 #if defined(MHD_USE_THREADS)
   mhd_assert (NULL == daemon->worker_pool);
 #endif /* MHD_USE_THREADS */
@@ -6377,12 +7086,24 @@ MHD_update_last_activity_ (struct MHD_Connection *connection)
   if (connection->suspended)
     return;  /* no activity on suspended connections */
 
-  connection->last_activity = MHD_monotonic_msec_counter ();
+  if (daemon->coarse_time)
+  {
+    now = daemon->loop_time;
+    /* The activity time could be set by the precise clock after
+       the start of the current iteration, never move it back */
+    if (now < connection->last_activity)
+      now = connection->last_activity;
+  }
+  else
+    now = MHD_monotonic_msec_counter ();
+  if (now == connection->last_activity)
+    return; /* The order in the timeout list is not changed */
+  connection->last_activity = now;
   if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
     return; /* each connection has personal timeout */
 
   if (connection->connection_timeout_ms != daemon->connection_timeout_ms)
-    return; /* custom timeout, no need to move it in "normal" DLL */
+    return; /* custom timeout, the key in the heap is updated lazily */
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
   MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
@@ -6399,6 +7120,66 @@ MHD_update_last_activity_ (struct MHD_Connection *connection)
 }
 
 
+/**
+ * Record the duration of the request phase in the histogram.
+ * @param d the daemon processing the connection
+ * @param phase the phase of the request
+ * @param start the time of the start of the phase, in microseconds
+ * @param end the time of the end of the phase, in microseconds
+ */
+static void
+phase_hist_record (struct MHD_Daemon *d,
+                   enum MHD_RequestPhase phase,
+                   uint64_t start,
+                   uint64_t end)
+{
+  struct MHD_PhaseHistogram *const h = d->phase_hist.phases + phase;
+  const bool shared = MHD_D_IS_USING_THREAD_PER_CONN_ (d);
+  const uint64_t dur = (end > start) ? (end - start) : 0;
+  unsigned int idx;
+
+  if (4 > dur)
+    idx = (unsigned int) dur;
+  else
+  {
+    unsigned int e; /**< the position of the most significant bit */
+
+    for (e = 2; (63 > e) && (0 != (dur >> (e + 1))); ++e)
+      (void) 0;
+    /* Four buckets for each power of two */
+    idx = 4 * (e - 1) + (unsigned int) ((dur >> (e - 2)) & 3);
+    if (MHD_PHASE_HISTOGRAM_BUCKETS <= idx)
+      idx = MHD_PHASE_HISTOGRAM_BUCKETS - 1;
+  }
+  MHD_stats_add_ (&h->count, 1, shared);
+  MHD_stats_add_ (&h->sum_us, dur, shared);
+  MHD_stats_max_ (&h->max_us, dur, shared);
+  MHD_stats_add_ (h->buckets + idx, 1, shared);
+}
+
+
+/**
+ * Record the time of the first byte of the request.
+ * @param c the connection to use
+ * @param now the current time, in microseconds
+ */
+static void
+phase_timing_first_byte (struct MHD_Connection *c,
+                         uint64_t now)
+{
+  struct MHD_PhaseTiming_ *const t = &c->timing;
+
+  t->first_byte = now;
+  t->marks |= MHD_PHASE_MARK_FIRST_BYTE_;
+  phase_hist_record (c->daemon,
+                     t->keepalive ?
+                     MHD_REQUEST_PHASE_KEEPALIVE_IDLE :
+                     MHD_REQUEST_PHASE_ACCEPT_TO_FIRST_BYTE,
+                     t->start,
+                     now);
+}
+
+
 /**
  * This function handles a particular connection when it has been
  * determined that there is data to be read off a socket. All
@@ -6500,7 +7281,13 @@ MHD_connection_handle_read (struct MHD_Connection *connection,
                              MHD_REQUEST_TERMINATED_WITH_ERROR);
     return;
   }
+  if ( (0 == connection->read_buffer_offset) &&
+       (connection->daemon->phase_timing) &&
+       (0 == (connection->timing.marks & MHD_PHASE_MARK_FIRST_BYTE_)) )
+    phase_timing_first_byte (connection,
+                             MHD_monotonic_usec_counter ());
   connection->read_buffer_offset += (size_t) bytes_read;
+  MHD_STATS_ADD_ (connection->daemon, bytes_received, bytes_read);
   MHD_update_last_activity_ (connection);
 #if DEBUG_STATES
   MHD_DLOG (connection->daemon,
@@ -6545,6 +7332,9 @@ MHD_connection_handle_read (struct MHD_Connection *connection,
                              connection->read_buffer_size,
                              connection->read_buffer_offset);
       connection->read_buffer_size = connection->read_buffer_offset;
+      if (connection->daemon->adaptive_bufs)
+        MHD_stats_add_ (&connection->daemon->buf_stats.read_shrinks, 1,
+                        false);
     }
     break;
   case MHD_CONNECTION_REQ_LINE_RECEIVED:
@@ -6677,7 +7467,14 @@ MHD_connection_handle_write (struct MHD_Connection *connection)
            (NULL == resp->data_iov) &&
            /* TODO: remove the next check as 'send_reply_body' is used */
            (0 == connection->rp.rsp_write_position) &&
-           (! connection->rp.props.chunked) )
+           (! connection->rp.props.chunked)
+#ifdef MHD_USE_MSG_ZEROCOPY
+           /* Large data is sent separately by the zero-copy sends */
+           && ( (0 == connection->daemon->zerocopy_threshold) ||
+                (connection->daemon->zerocopy_threshold > resp->data_size) ||
+                (0 != (connection->daemon->options & MHD_USE_TLS)) )
+#endif /* MHD_USE_MSG_ZEROCOPY */
+           )
       {
         mhd_assert (resp->total_size >= resp->data_size);
         mhd_assert (0 == resp->data_start);
@@ -6770,6 +7567,27 @@ MHD_connection_handle_write (struct MHD_Connection *connection)
       }
       else /* combined with the next 'if' */
 #endif /* _MHD_HAVE_SENDFILE */
+#if defined(_MHD_HAVE_SPLICE)
+      if (MHD_resp_sender_splice == connection->rp.resp_sender)
+      {
+        mhd_assert (NULL == response->data_iov);
+        ret = MHD_send_splice_ (connection);
+        if (0 == ret)
+        {
+          /* The end of the pipe stream.  The pipe responses always have
+             unknown size, the end of the reply is indicated by closing
+             the connection, the response itself is not updated. */
+          mhd_assert (MHD_SIZE_UNKNOWN == response->total_size);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+          MHD_mutex_unlock_chk_ (&response->mutex);
+#endif
+          MHD_connection_close_ (connection,
+                                 MHD_REQUEST_TERMINATED_COMPLETED_OK);
+          return;
+        }
+      }
+      else /* combined with the next 'if' */
+#endif /* _MHD_HAVE_SPLICE */
       if (NULL != response->data_iov)
       {
         ret = MHD_send_iovec_ (connection,
@@ -6828,12 +7646,88 @@ MHD_connection_handle_write (struct MHD_Connection *connection)
     mhd_assert (0);
     return;
   case MHD_CONNECTION_CHUNKED_BODY_READY:
+#if defined(_MHD_HAVE_SPLICE)
+    if ( (0 != connection->rp.splice_left) &&
+         (connection->write_buffer_send_offset ==
+          connection->write_buffer_append_offset) )
+    {
+      /* The chunk header has been sent, move the chunk data */
+      bool pipe_ok;
+
+      response = connection->rp.response;
+      pipe_ok = true;
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+      MHD_mutex_lock_chk_ (&response->mutex);
+#endif
+      if (MHD_resp_sender_splice == connection->rp.resp_sender)
+      {
+        ret = MHD_send_splice_ (connection);
+        if (0 < ret)
+        {
+          mhd_assert (connection->rp.splice_left >= (size_t) ret);
+          connection->rp.splice_left -= (size_t) ret;
+          connection->rp.rsp_write_position += (size_t) ret;
+          MHD_update_last_activity_ (connection);
+          if (0 == connection->rp.splice_left)
+          {
+            /* The chunk data has been sent, terminate the chunk */
+            connection->write_buffer[0] = '\r';
+            connection->write_buffer[1] = '\n';
+            connection->write_buffer_send_offset = 0;
+            connection->write_buffer_append_offset = 2;
+          }
+        }
+        else if (0 == ret)
+          pipe_ok = false; /* The data was in the pipe, but disappeared */
+      }
+      else
+        ret = 0;
+      if ( (MHD_resp_sender_std == connection->rp.resp_sender) && pipe_ok)
+      {
+        /* splice() cannot be used, get the rest of the chunk by read() */
+        pipe_ok = read_spliced_chunk_rest (connection);
+        ret = 0;
+      }
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+      MHD_mutex_unlock_chk_ (&response->mutex);
+#endif
+      if (! pipe_ok)
+      {
+        CONNECTION_CLOSE_ERROR (connection,
+                                _ ("Closing connection (application error " \
+                                   "generating response)."));
+        return;
+      }
+      if (ret < 0)
+      {
+        if (MHD_ERR_AGAIN_ == ret)
+          return;
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (connection->daemon,
+                  _ ("Failed to send the chunked response body for the " \
+                     "request for `%s'. Error: %s\n"),
+                  connection->rq.url,
+                  str_conn_error_ (ret));
+#endif
+        CONNECTION_CLOSE_ERROR (connection,
+                                NULL);
+        return;
+      }
+      if (0 != connection->rp.splice_left)
+        return; /* Wait for the socket to be ready for more data */
+    }
+#endif /* _MHD_HAVE_SPLICE */
     ret = MHD_send_data_ (connection,
                           &connection->write_buffer
                           [connection->write_buffer_send_offset],
                           connection->write_buffer_append_offset
                           - connection->write_buffer_send_offset,
-                          true);
+#if defined(_MHD_HAVE_SPLICE)
+                          0 == connection->rp.splice_left
+#else  /* ! _MHD_HAVE_SPLICE */
+                          true
+#endif /* ! _MHD_HAVE_SPLICE */
+                          );
     if (ret < 0)
     {
       if (MHD_ERR_AGAIN_ == ret)
@@ -6853,6 +7747,15 @@ MHD_connection_handle_write (struct MHD_Connection *connection)
     MHD_update_last_activity_ (connection);
     if (MHD_CONNECTION_CHUNKED_BODY_READY != connection->state)
       return;
+#if defined(_MHD_HAVE_SPLICE)
+    if (0 != connection->rp.splice_left)
+    {
+      /* The chunk data is still in the pipe */
+      check_write_done (connection,
+                        MHD_CONNECTION_CHUNKED_BODY_READY);
+      return;
+    }
+#endif /* _MHD_HAVE_SPLICE */
     check_write_done (connection,
                       (connection->rp.response->total_size ==
                        connection->rp.rsp_write_position) ?
@@ -6929,7 +7832,16 @@ connection_check_timedout (struct MHD_Connection *c)
     return false;
   if (0 == timeout)
     return false;
-  now = MHD_monotonic_msec_counter ();
+  if (c->daemon->coarse_time)
+  {
+    now = c->daemon->loop_time;
+    /* The activity time could be set by the precise clock after
+       the start of the current iteration */
+    if (now < c->last_activity)
+      return false;
+  }
+  else
+    now = MHD_monotonic_msec_counter ();
   since_actv = now - c->last_activity;
   /* Keep the next lines in sync with #connection_get_wait() to avoid
    * undesired side-effects like busy-waiting. */
@@ -7001,16 +7913,7 @@ cleanup_connection (struct MHD_Connection *connection)
   else
   {
     if (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
-    {
-      if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
-        XDLL_remove (daemon->normal_timeout_head,
-                     daemon->normal_timeout_tail,
-                     connection);
-      else
-        XDLL_remove (daemon->manual_timeout_head,
-                     daemon->manual_timeout_tail,
-                     connection);
-    }
+      MHD_connection_timeout_remove_ (connection);
     DLL_remove (daemon->connections_head,
                 daemon->connections_tail,
                 connection);
@@ -7041,6 +7944,92 @@ cleanup_connection (struct MHD_Connection *connection)
 }
 
 
+/**
+ * Start the timing of the new request on the connection.
+ * @param c the connection to use
+ * @param keepalive set to 'true' if the previous request has been
+ *                  processed on the same connection
+ */
+static void
+phase_timing_start (struct MHD_Connection *c,
+                    bool keepalive)
+{
+  if (! c->daemon->phase_timing)
+    return;
+  c->timing.start = MHD_monotonic_usec_counter ();
+  c->timing.handler = 0;
+  c->timing.marks = 0;
+  c->timing.keepalive = keepalive;
+  /* The next request could be already received with the previous one */
+  if (0 != c->read_buffer_offset)
+    phase_timing_first_byte (c,
+                             c->timing.start);
+}
+
+
+/**
+ * Record the timestamps of the request phases reached by the connection
+ * and the durations of the completed phases.
+ * The phases are detected by the state of the connection, several
+ * phases could be completed at once.  The time of the first byte is
+ * recorded when the request data is received.
+ * @param c the connection to use
+ */
+static void
+phase_timing_update (struct MHD_Connection *c)
+{
+  struct MHD_PhaseTiming_ *const t = &c->timing;
+  struct MHD_Daemon *const d = c->daemon;
+  uint64_t now;
+
+  if ( (MHD_CONNECTION_HEADERS_RECEIVED > c->state) ||
+       (MHD_CONNECTION_FULL_REPLY_SENT < c->state) ||
+       (0 != (t->marks & MHD_PHASE_MARK_DONE_)) )
+    return;
+  /* The clock is read only when the next mark is set */
+  now = 0;
+  if (0 == (t->marks & MHD_PHASE_MARK_HEADERS_))
+  {
+    now = MHD_monotonic_usec_counter ();
+    if (0 == (t->marks & MHD_PHASE_MARK_FIRST_BYTE_))
+      phase_timing_first_byte (c, now);
+    t->headers_received = now;
+    t->marks |= MHD_PHASE_MARK_HEADERS_;
+    phase_hist_record (d,
+                       MHD_REQUEST_PHASE_HEADER_PARSE,
+                       t->first_byte,
+                       now);
+  }
+  if (MHD_CONNECTION_HEADERS_SENDING > c->state)
+    return;
+  if (0 == (t->marks & MHD_PHASE_MARK_REPLY_))
+  {
+    if (0 == now)
+      now = MHD_monotonic_usec_counter ();
+    t->reply_start = now;
+    t->marks |= MHD_PHASE_MARK_REPLY_;
+    phase_hist_record (d,
+                       MHD_REQUEST_PHASE_FIRST_REPLY_BYTE,
+                       t->headers_received,
+                       now);
+  }
+  if (MHD_CONNECTION_FULL_REPLY_SENT != c->state)
+    return;
+  if (0 == now)
+    now = MHD_monotonic_usec_counter ();
+  t->marks |= MHD_PHASE_MARK_DONE_;
+  phase_hist_record (d,
+                     MHD_REQUEST_PHASE_BODY_TRANSMIT,
+                     t->reply_start,
+                     now);
+  if (c->rq.client_aware)
+    phase_hist_record (d,
+                       MHD_REQUEST_PHASE_HANDLER,
+                       0,
+                       t->handler);
+}
+
+
 /**
  * Set initial internal states for the connection to start reading and
  * processing incoming data.
@@ -7073,7 +8062,10 @@ MHD_connection_set_initial_state_ (struct MHD_Connection *c)
   c->continue_message_write_offset = 0;
 
   c->read_buffer_offset = 0;
-  read_buf_size = c->daemon->pool_size / 2;
+  phase_timing_start (c, false);
+
+  read_buf_size = get_start_read_buffer_size (c->daemon,
+                                              c->daemon->pool_size / 2);
   c->read_buffer
     = MHD_pool_allocate (c->pool,
                          read_buf_size,
@@ -7132,6 +8124,7 @@ connection_reset (struct MHD_Connection *connection,
 
     c->keepalive = MHD_CONN_KEEPALIVE_UNKOWN;
     c->state = MHD_CONNECTION_INIT;
+    phase_timing_start (c, true);
     c->event_loop_info =
       (0 == c->read_buffer_offset) ?
       MHD_EVENT_LOOP_INFO_READ : MHD_EVENT_LOOP_INFO_PROCESS;
@@ -7149,7 +8142,8 @@ connection_reset (struct MHD_Connection *connection,
 
     /* Reset the read buffer to the starting size,
        preserving the bytes we have already read. */
-    new_read_buf_size = c->daemon->pool_size / 2;
+    new_read_buf_size = get_start_read_buffer_size (d,
+                                                    d->pool_size / 2);
     if (c->read_buffer_offset > new_read_buf_size)
       new_read_buf_size = c->read_buffer_offset;
 
@@ -7196,7 +8190,20 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
     {     /* HTTPS connection. */
       if ((MHD_TLS_CONN_INIT <= connection->tls_state) &&
           (MHD_TLS_CONN_CONNECTED > connection->tls_state))
+      {
+#ifdef MHD_USE_THREADS
+        /* Process the result of the step performed by the handshake
+           thread without waiting for the socket readiness */
+        if (! connection->tls_hs_offloaded)
+          break;
+        (void) MHD_run_tls_handshake_ (connection);
+        if ((MHD_TLS_CONN_INIT <= connection->tls_state) &&
+            (MHD_TLS_CONN_CONNECTED > connection->tls_state))
+          break;
+#else  /* ! MHD_USE_THREADS */
         break;
+#endif /* ! MHD_USE_THREADS */
+      }
     }
 #endif /* HTTPS_SUPPORT */
 #if DEBUG_STATES
@@ -7205,6 +8212,8 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
               MHD_FUNC_,
               MHD_state_to_string (connection->state));
 #endif
+    if (daemon->phase_timing)
+      phase_timing_update (connection);
     switch (connection->state)
     {
     case MHD_CONNECTION_INIT:
@@ -7237,6 +8246,9 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
       if (MHD_CONNECTION_HEADERS_RECEIVED != connection->state)
         continue;
       connection->state = MHD_CONNECTION_HEADERS_PROCESSED;
+      MHD_TRACE2_ (headers__complete, connection, connection->rq.header_size);
+      if (connection->daemon->adaptive_bufs)
+        update_read_buffer_avg (connection);
       if (connection->suspended)
         break;
       continue;
@@ -7406,8 +8418,11 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
       if (NULL != connection->rp.response->crc)
         MHD_mutex_lock_chk_ (&connection->rp.response->mutex);
 #endif
-      if (0 == connection->rp.response->total_size)
+      if ( (0 == connection->rp.response->total_size) ||
+           (connection->rp.rsp_write_position ==
+            connection->rp.response->total_size) )
       {
+        /* The body could be sent together with the headers */
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
         if (NULL != connection->rp.response->crc)
           MHD_mutex_unlock_chk_ (&connection->rp.response->mutex);
@@ -7504,6 +8519,7 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
         /* FIXME: maybe partially reset memory pool? */
         continue;
       }
+      MHD_STATS_ADD_ (daemon, requests_served, 1);
       /* Reset connection after complete reply */
       connection_reset (connection,
                         MHD_CONN_USE_KEEPALIVE == connection->keepalive &&
@@ -7527,6 +8543,7 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
   }
   if (connection_check_timedout (connection))
   {
+    MHD_STATS_ADD_ (daemon, conns_timed_out, 1);
     MHD_connection_close_ (connection,
                            MHD_REQUEST_TERMINATED_TIMEOUT_REACHED);
     connection->in_idle = false;
@@ -7547,6 +8564,77 @@ MHD_connection_handle_idle (struct MHD_Connection *connection)
 
 
 #ifdef EPOLL_SUPPORT
+#ifdef IO_URING_SUPPORT
+/**
+ * Queue the io_uring requests needed to wait for the connection's
+ * socket readiness.
+ *
+ * @param connection connection to process
+ * @return #MHD_YES if we should continue to process the
+ *         connection (not dead yet), #MHD_NO if it died
+ */
+static enum MHD_Result
+uring_update (struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+  struct MHD_UringConn_ *const uc = connection->uring;
+  const uint64_t ud = (uint64_t) (uintptr_t) uc;
+  bool ok = true;
+
+  if (0 != (connection->epoll_state & MHD_EPOLL_STATE_SUSPENDED))
+    return MHD_YES;
+  if ( (0 != (MHD_EVENT_LOOP_INFO_READ & connection->event_loop_info)) &&
+       (0 == (connection->epoll_state & MHD_EPOLL_STATE_READ_READY)) &&
+       (! uc->recv_pending) )
+  {
+    /* Do not receive more than fits the buffer, the rest of the data
+       is kept in the socket until the connection is ready for it. */
+    ok = MHD_uring_prep_recv_ (daemon->uring,
+                               connection->socket_fd,
+                               connection->read_buffer_size
+                               - connection->read_buffer_offset,
+                               ud | MHD_URING_TAG_RECV_);
+    if (ok)
+    {
+      uc->recv_pending = true;
+      uc->pending++;
+      daemon->uring_ops++;
+    }
+  }
+  if ( ok &&
+       (MHD_EVENT_LOOP_INFO_WRITE == connection->event_loop_info) &&
+       (0 == (connection->epoll_state & MHD_EPOLL_STATE_WRITE_READY)) &&
+       (! uc->pollout_pending) &&
+       (! uc->send_pending) )
+  {
+    ok = MHD_uring_prep_poll_ (daemon->uring,
+                               connection->socket_fd,
+                               POLLOUT,
+                               ud | MHD_URING_TAG_POLLOUT_);
+    if (ok)
+    {
+      uc->pollout_pending = true;
+      uc->pending++;
+      daemon->uring_ops++;
+    }
+  }
+  if (! ok)
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to queue io_uring request: %s\n"),
+              MHD_strerror_ (errno));
+#endif
+    connection->state = MHD_CONNECTION_CLOSED;
+    cleanup_connection (connection);
+    return MHD_NO;
+  }
+  return MHD_YES;
+}
+
+
+#endif /* IO_URING_SUPPORT */
+
 /**
  * Perform epoll() processing, possibly moving the connection back into
  * the epoll() set if needed.
@@ -7572,6 +8660,11 @@ MHD_connection_epoll_update_ (struct MHD_Connection *connection)
     connection->epoll_state |= MHD_EPOLL_STATE_IN_EREADY_EDLL;
   }
 
+#ifdef IO_URING_SUPPORT
+  if (NULL != connection->uring)
+    return uring_update (connection);
+#endif /* IO_URING_SUPPORT */
+
   if ( (0 == (connection->epoll_state & MHD_EPOLL_STATE_IN_EPOLL_SET)) &&
        (0 == (connection->epoll_state & MHD_EPOLL_STATE_SUSPENDED)) &&
        ( ( (MHD_EVENT_LOOP_INFO_WRITE == connection->event_loop_info) &&
@@ -7772,23 +8865,9 @@ MHD_set_connection_option (struct MHD_Connection *connection,
 #endif
       if (! connection->suspended)
       {
-        if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
-          XDLL_remove (daemon->normal_timeout_head,
-                       daemon->normal_timeout_tail,
-                       connection);
-        else
-          XDLL_remove (daemon->manual_timeout_head,
-                       daemon->manual_timeout_tail,
-                       connection);
+        MHD_connection_timeout_remove_ (connection);
         connection->connection_timeout_ms = ((uint64_t) ui_val) * 1000;
-        if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
-          XDLL_insert (daemon->normal_timeout_head,
-                       daemon->normal_timeout_tail,
-                       connection);
-        else
-          XDLL_insert (daemon->manual_timeout_head,
-                       daemon->manual_timeout_tail,
-                       connection);
+        MHD_connection_timeout_add_ (connection);
       }
 #if defined(MHD_USE_THREADS)
       MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
@@ -8040,10 +9119,9 @@ MHD_queue_response (struct MHD_Connection *connection,
   connection->rp.response = response;
   connection->rp.responseCode = status_code;
   connection->rp.responseIcy = reply_icy;
-#if defined(_MHD_HAVE_SENDFILE)
+#if defined(_MHD_HAVE_SENDFILE) || defined(_MHD_HAVE_SPLICE)
   if ( (response->fd == -1) ||
-       (response->is_pipe) ||
-       (0 != (connection->daemon->options & MHD_USE_TLS))
+       MHD_C_IS_TLS_LIB_SEND_ (connection)
 #if defined(MHD_SEND_SPIPE_SUPPRESS_NEEDED) && \
        defined(MHD_SEND_SPIPE_SUPPRESS_POSSIBLE)
        || (! daemon->sigpipe_blocked && ! connection->sk_spipe_suppress)
@@ -8051,11 +9129,19 @@ MHD_queue_response (struct MHD_Connection *connection,
           MHD_SEND_SPIPE_SUPPRESS_POSSIBLE */
        )
     connection->rp.resp_sender = MHD_resp_sender_std;
+  else if (response->is_pipe)
+#if defined(_MHD_HAVE_SPLICE)
+    connection->rp.resp_sender = MHD_resp_sender_splice;
+#else  /* ! _MHD_HAVE_SPLICE */
+    connection->rp.resp_sender = MHD_resp_sender_std;
+#endif /* ! _MHD_HAVE_SPLICE */
   else
+#if defined(_MHD_HAVE_SENDFILE)
     connection->rp.resp_sender = MHD_resp_sender_sendfile;
-#endif /* _MHD_HAVE_SENDFILE */
-  /* FIXME: if 'is_pipe' is set, TLS is off, and we have *splice*, we could use splice()
-     to avoid two user-space copies... */
+#else  /* ! _MHD_HAVE_SENDFILE */
+    connection->rp.resp_sender = MHD_resp_sender_std;
+#endif /* ! _MHD_HAVE_SENDFILE */
+#endif /* _MHD_HAVE_SENDFILE || _MHD_HAVE_SPLICE */
 
   if ( (MHD_HTTP_MTHD_HEAD == connection->rq.http_mthd) ||
        (MHD_HTTP_OK > status_code) ||
@@ -8069,6 +9155,7 @@ MHD_queue_response (struct MHD_Connection *connection,
      * checks */
     connection->rp.rsp_write_position = response->total_size;
   }
+  MHD_TRACE2_ (response__queued, connection, status_code);
   if (MHD_CONNECTION_HEADERS_PROCESSED == connection->state)
   {
     /* response was queued "early", refuse to read body / footers or
@@ -189,6 +189,42 @@ MHD_connection_epoll_update_ (struct MHD_Connection *connection);
 
 #endif
 
+/**
+ * Add the connection to the daemon's timeouts tracking: to the
+ * 'normal_timeout' list if the default timeout value is used or to
+ * the 'manual_timeout' heap otherwise.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param connection the connection to add
+ */
+void
+MHD_connection_timeout_add_ (struct MHD_Connection *connection);
+
+
+/**
+ * Remove the connection from the daemon's timeouts tracking.
+ * Does nothing if the connection with the custom timeout has been
+ * already removed from the 'manual_timeout' heap.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param connection the connection to remove
+ */
+void
+MHD_connection_timeout_remove_ (struct MHD_Connection *connection);
+
+
+/**
+ * Get the connection with the earliest deadline among the connections
+ * with the custom timeouts.
+ * The outdated keys in the 'manual_timeout' heap are updated as needed,
+ * the key of the returned connection is equal to its deadline.
+ * @remark To be called with the daemon's 'cleanup_connection_mutex' held.
+ * @param daemon the daemon to use
+ * @return the connection with the earliest deadline,
+ *         NULL if no connections with the custom timeouts
+ */
+struct MHD_Connection *
+MHD_connection_timeout_get_manual_first_ (struct MHD_Daemon *daemon);
+
+
 /**
  * Update the 'last_activity' field of the connection to the current time
  * and move the connection to the head of the 'normal_timeout' list if
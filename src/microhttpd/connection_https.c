@@ -35,6 +35,9 @@
 #include "response.h"
 #include "mhd_mono_clock.h"
 #include <gnutls/gnutls.h>
+#ifdef HAVE_GNUTLS_KTLS
+#include <gnutls/socket.h>
+#endif /* HAVE_GNUTLS_KTLS */
 #include "mhd_send.h"
 
 
@@ -145,12 +148,40 @@ MHD_run_tls_handshake_ (struct MHD_Connection *connection)
     if (_MHD_ON != connection->sk_nodelay)
       MHD_connection_set_nodelay_state_ (connection, true);
 #endif
+#ifdef MHD_USE_THREADS
+    if (connection->tls_hs_offloaded)
+    {
+      /* The step has been performed by the handshake thread */
+      connection->tls_hs_offloaded = false;
+      ret = connection->tls_hs_ret;
+    }
+    else if ( (NULL != connection->daemon->tls_hs_pool) &&
+              MHD_tls_hs_pool_submit_ (connection->daemon->tls_hs_pool,
+                                       connection) )
+      return false; /* The connection is suspended until the step is done */
+    else
+#endif /* MHD_USE_THREADS */
     ret = gnutls_handshake (connection->tls_session);
     if (ret == GNUTLS_E_SUCCESS)
     {
       /* set connection TLS state to enable HTTP processing */
       connection->tls_state = MHD_TLS_CONN_CONNECTED;
       MHD_update_last_activity_ (connection);
+      MHD_STATS_ADD_ (connection->daemon, tls_handshakes, 1);
+      if (0 != gnutls_session_is_resumed (connection->tls_session))
+        MHD_STATS_ADD_ (connection->daemon, tls_resumed, 1);
+#ifdef HAVE_GNUTLS_KTLS
+      /* GnuTLS sets up kernel TLS when the handshake is completed.
+         The TLS library does not buffer outgoing data with kernel TLS,
+         the data can be sent directly to the socket from this point. */
+      if (connection->daemon->https_ktls &&
+          (0 != (GNUTLS_KTLS_SEND
+                 & gnutls_transport_is_ktls_enabled (connection->tls_session))))
+      {
+        connection->tls_ktls_send = true;
+        MHD_STATS_ADD_ (connection->daemon, tls_ktls_send, 1);
+      }
+#endif /* HAVE_GNUTLS_KTLS */
       return true;
     }
     if ( (GNUTLS_E_AGAIN == ret) ||
@@ -162,6 +193,7 @@ MHD_run_tls_handshake_ (struct MHD_Connection *connection)
     }
     /* handshake failed */
     connection->tls_state = MHD_TLS_CONN_TLS_FAILED;
+    MHD_STATS_ADD_ (connection->daemon, tls_handshake_failures, 1);
 #ifdef HAVE_MESSAGES
     MHD_DLOG (connection->daemon,
               _ ("Error: received handshake message out of context.\n"));
@@ -46,12 +46,8 @@
 #include "mhd_send.h"
 #include "mhd_align.h"
 #include "mhd_str.h"
+#include "mhd_trace.h"
 
-#ifdef MHD_USE_SYS_TSEARCH
-#include <search.h>
-#else  /* ! MHD_USE_SYS_TSEARCH */
-#include "tsearch.h"
-#endif /* ! MHD_USE_SYS_TSEARCH */
 
 #ifdef HTTPS_SUPPORT
 #include "connection_https.h"
@@ -73,6 +69,14 @@
 #endif /* HAVE_SIGNAL_H */
 #endif /* MHD_USE_POSIX_THREADS */
 
+#ifdef HAVE_LINUX_FILTER_H
+#include <linux/filter.h>
+#endif /* HAVE_LINUX_FILTER_H */
+#ifdef IO_URING_SUPPORT
+#include "mhd_uring.h"
+#include <poll.h>
+#endif /* IO_URING_SUPPORT */
+
 /**
  * Default connection limit.
  */
@@ -87,6 +91,35 @@
  */
 #define MHD_POOL_SIZE_DEFAULT (32 * 1024)
 
+/**
+ * Default maximum number of connections accepted in one turn.
+ */
+#define MHD_ACCEPT_BATCH_SIZE_DEFAULT 10
+
+#ifdef IO_URING_SUPPORT
+/**
+ * The number of the submission queue entries in the daemon's io_uring.
+ * The queue is flushed automatically when full.
+ */
+#define MHD_URING_SQ_SIZE 256
+
+/**
+ * The number of the completion queue entries in the daemon's io_uring.
+ */
+#define MHD_URING_CQ_SIZE 4096
+
+/**
+ * The number of the receive buffers provided to the daemon's io_uring.
+ * When all buffers are in use, the data is received by the recv() call.
+ */
+#define MHD_URING_BUF_NUM 64
+
+/**
+ * The size of the single receive buffer provided to the daemon's io_uring.
+ */
+#define MHD_URING_BUF_SIZE (16 * 1024)
+#endif /* IO_URING_SUPPORT */
+
 
 /* Forward declarations. */
 
@@ -129,6 +162,19 @@ static enum MHD_Result
 MHD_epoll (struct MHD_Daemon *daemon,
            int32_t millisec);
 
+#ifdef IO_URING_SUPPORT
+/**
+ * Detach the closed connection from the daemon's io_uring.
+ *
+ * @param daemon the daemon of the connection
+ * @param connection the connection to detach
+ */
+static void
+uring_conn_detach (struct MHD_Daemon *daemon,
+                   struct MHD_Connection *connection);
+
+#endif /* IO_URING_SUPPORT */
+
 #endif /* EPOLL_SUPPORT */
 
 #ifdef _AUTOINIT_FUNCS_ARE_SUPPORTED
@@ -216,94 +262,6 @@ MHD_free (void *ptr)
 }
 
 
-/**
- * Maintain connection count for single address.
- */
-struct MHD_IPCount
-{
-  /**
-   * Address family. AF_INET or AF_INET6 for now.
-   */
-  int family;
-
-  /**
-   * Actual address.
-   */
-  union
-  {
-    /**
-     * IPv4 address.
-     */
-    struct in_addr ipv4;
-#ifdef HAVE_INET6
-    /**
-     * IPv6 address.
-     */
-    struct in6_addr ipv6;
-#endif
-  } addr;
-
-  /**
-   * Counter.
-   */
-  unsigned int count;
-};
-
-
-/**
- * Lock shared structure for IP connection counts and connection DLLs.
- *
- * @param daemon handle to daemon where lock is
- */
-static void
-MHD_ip_count_lock (struct MHD_Daemon *daemon)
-{
-  mhd_assert (NULL == daemon->master);
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  MHD_mutex_lock_chk_ (&daemon->per_ip_connection_mutex);
-#else
-  (void) daemon;
-#endif
-}
-
-
-/**
- * Unlock shared structure for IP connection counts and connection DLLs.
- *
- * @param daemon handle to daemon where lock is
- */
-static void
-MHD_ip_count_unlock (struct MHD_Daemon *daemon)
-{
-  mhd_assert (NULL == daemon->master);
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  MHD_mutex_unlock_chk_ (&daemon->per_ip_connection_mutex);
-#else
-  (void) daemon;
-#endif
-}
-
-
-/**
- * Tree comparison function for IP addresses (supplied to tsearch() family).
- * We compare everything in the struct up through the beginning of the
- * 'count' field.
- *
- * @param a1 first address to compare
- * @param a2 second address to compare
- * @return -1, 0 or 1 depending on result of compare
- */
-static int
-MHD_ip_addr_compare (const void *a1,
-                     const void *a2)
-{
-  return memcmp (a1,
-                 a2,
-                 offsetof (struct MHD_IPCount,
-                           count));
-}
-
-
 /**
  * Parse address and initialize @a key using the address.
  *
@@ -315,7 +273,7 @@ MHD_ip_addr_compare (const void *a1,
 static enum MHD_Result
 MHD_ip_addr_to_key (const struct sockaddr_storage *addr,
                     socklen_t addrlen,
-                    struct MHD_IPCount *key)
+                    struct MHD_IPLimitKey_ *key)
 {
   memset (key,
           0,
@@ -363,71 +321,49 @@ MHD_ip_addr_to_key (const struct sockaddr_storage *addr,
  * @param addr address to add (or increment counter)
  * @param addrlen number of bytes in @a addr
  * @return Return #MHD_YES if IP below limit, #MHD_NO if IP has surpassed limit.
- *   Also returns #MHD_NO if fails to allocate memory.
+ *   Also returns #MHD_NO if memory allocation for the new address failed.
  */
 static enum MHD_Result
 MHD_ip_limit_add (struct MHD_Daemon *daemon,
                   const struct sockaddr_storage *addr,
                   socklen_t addrlen)
 {
-  struct MHD_IPCount *newkeyp;
-  struct MHD_IPCount *keyp;
-  struct MHD_IPCount **nodep;
-  enum MHD_Result result;
+  struct MHD_IPLimitKey_ key;
 
   daemon = MHD_get_master (daemon);
   /* Ignore if no connection limit assigned */
   if (0 == daemon->per_ip_connection_limit)
     return MHD_YES;
 
-  newkeyp = (struct MHD_IPCount *) malloc (sizeof(struct MHD_IPCount));
-  if (NULL == newkeyp)
-    return MHD_NO;
-
   /* Initialize key */
   if (MHD_NO == MHD_ip_addr_to_key (addr,
                                     addrlen,
-                                    newkeyp))
-  {
-    free (newkeyp);
+                                    &key))
     return MHD_YES; /* Allow unhandled address types through */
-  }
-
-  MHD_ip_count_lock (daemon);
 
-  /* Search for the IP address */
-  nodep = (struct MHD_IPCount **) tsearch (newkeyp,
-                                           &daemon->per_ip_connection_count,
-                                           &MHD_ip_addr_compare);
-  if (NULL == nodep)
+  switch (MHD_iplimit_add_ (daemon->per_ip_table,
+                            &key,
+                            daemon->per_ip_connection_limit))
   {
-    MHD_ip_count_unlock (daemon);
-    free (newkeyp);
+  case MHD_IPLIMIT_OK_:
+    return MHD_YES;
+  case MHD_IPLIMIT_OVER_LIMIT_:
+    MHD_stats_add_ (&daemon->stats.per_ip_limit_hits, 1, true);
+    break;
+  case MHD_IPLIMIT_NO_SPACE_:
+  default:
 #ifdef HAVE_MESSAGES
     MHD_DLOG (daemon,
               _ ("Failed to add IP connection count node.\n"));
 #endif
-    return MHD_NO;
+    break;
   }
-  keyp = *nodep;
-  /* Test if there is room for another connection; if so,
-   * increment count */
-  result = (keyp->count < daemon->per_ip_connection_limit) ? MHD_YES : MHD_NO;
-  if (MHD_NO != result)
-    ++keyp->count;
-  MHD_ip_count_unlock (daemon);
-
-  /* If we got an existing node back, free the one we created */
-  if (keyp != newkeyp)
-    free (newkeyp);
-
-  return result;
+  return MHD_NO;
 }
 
 
 /**
- * Decrement connection count for IP address, removing from table
- * count reaches 0.
+ * Decrement connection count for IP address.
  *
  * @param daemon handle to daemon where connection counts are tracked
  * @param addr address to remove (or decrement counter)
@@ -438,9 +374,7 @@ MHD_ip_limit_del (struct MHD_Daemon *daemon,
                   const struct sockaddr_storage *addr,
                   socklen_t addrlen)
 {
-  struct MHD_IPCount search_key;
-  struct MHD_IPCount *found_key;
-  void **nodep;
+  struct MHD_IPLimitKey_ key;
 
   daemon = MHD_get_master (daemon);
   /* Ignore if no connection limit assigned */
@@ -449,37 +383,16 @@ MHD_ip_limit_del (struct MHD_Daemon *daemon,
   /* Initialize search key */
   if (MHD_NO == MHD_ip_addr_to_key (addr,
                                     addrlen,
-                                    &search_key))
+                                    &key))
     return;
 
-  MHD_ip_count_lock (daemon);
-
-  /* Search for the IP address */
-  if (NULL == (nodep = tfind (&search_key,
-                              &daemon->per_ip_connection_count,
-                              &MHD_ip_addr_compare)))
+  if (! MHD_iplimit_del_ (daemon->per_ip_table,
+                          &key))
   {
     /* Something's wrong if we couldn't find an IP address
      * that was previously added */
     MHD_PANIC (_ ("Failed to find previously-added IP address.\n"));
   }
-  found_key = (struct MHD_IPCount *) *nodep;
-  /* Validate existing count for IP address */
-  if (0 == found_key->count)
-  {
-    MHD_PANIC (_ ("Previously-added IP address had counter of zero.\n"));
-  }
-  /* Remove the node entirely if count reduces to 0 */
-  if (0 == --found_key->count)
-  {
-    tdelete (found_key,
-             &daemon->per_ip_connection_count,
-             &MHD_ip_addr_compare);
-    MHD_ip_count_unlock (daemon);
-    free (found_key);
-  }
-  else
-    MHD_ip_count_unlock (daemon);
 }
 
 
@@ -1285,6 +1198,10 @@ MHD_get_fdset2 (struct MHD_Daemon *daemon,
  * @param write_ready set if the socket is ready for writing
  * @param force_close set if a hard error was detected on the socket;
  *        if this information is not available, simply pass #MHD_NO
+ * @param sock_err_only set if the only reported condition is the pending
+ *        socket error (POLLERR), which may be caused by the completions
+ *        of the zero-copy sends; must not be set if any disconnect,
+ *        invalid socket or out-of-band condition was reported
  * @return #MHD_YES to continue normally,
  *         #MHD_NO if a serious error was encountered and the
  *         connection is to be closed.
@@ -1293,7 +1210,8 @@ static enum MHD_Result
 call_handlers (struct MHD_Connection *con,
                bool read_ready,
                bool write_ready,
-               bool force_close)
+               bool force_close,
+               bool sock_err_only)
 {
   enum MHD_Result ret;
   bool states_info_processed = false;
@@ -1312,6 +1230,14 @@ call_handlers (struct MHD_Connection *con,
   if (con->tls_read_ready)
     read_ready = true;
 #endif /* HTTPS_SUPPORT */
+#ifdef MHD_USE_MSG_ZEROCOPY
+  /* The completions of the zero-copy sends are reported as the socket
+     error, any other condition still closes the connection */
+  if (MHD_send_zc_reap_ (con) && sock_err_only)
+    force_close = false;
+#else  /* ! MHD_USE_MSG_ZEROCOPY */
+  (void) sock_err_only; /* Unused. Silent compiler warning. */
+#endif /* MHD_USE_MSG_ZEROCOPY */
   if ( (0 != (MHD_EVENT_LOOP_INFO_READ & con->event_loop_info)) &&
        (read_ready || (force_close && con->sk_nonblck)) )
   {
@@ -2222,7 +2148,8 @@ thread_main_handle_connection (void *data)
                          FD_ISSET (con->socket_fd,
                                    &ws),
                          FD_ISSET (con->socket_fd,
-                                   &es)) )
+                                   &es),
+                         false))
         goto exit;
     }
 #ifdef HAVE_POLL
@@ -2302,7 +2229,9 @@ thread_main_handle_connection (void *data)
           call_handlers (con,
                          (0 != (p[0].revents & POLLIN)),
                          (0 != (p[0].revents & POLLOUT)),
-                         (0 != (p[0].revents & MHD_POLL_REVENTS_ERR_DISC)) ))
+                         (0 != (p[0].revents & MHD_POLL_REVENTS_ERR_DISC)),
+                         (POLLERR ==
+                          (p[0].revents & MHD_POLL_REVENTS_ERR_DISC)) ))
         goto exit;
     }
 #endif
@@ -2361,6 +2290,10 @@ exit:
     /* 'socket_fd' can be used in other thread to signal shutdown.
      * To avoid data races, do not close socket here. Daemon will
      * use more connections only after cleanup anyway. */
+#ifdef MHD_USE_MSG_ZEROCOPY
+    if (! daemon->shutdown)
+      MHD_send_zc_wait_ (con);
+#endif /* MHD_USE_MSG_ZEROCOPY */
   }
   if ( (MHD_ITC_IS_VALID_ (daemon->itc)) &&
        (! MHD_itc_activate_ (daemon->itc, "t")) )
@@ -2617,6 +2550,9 @@ new_connection_prepare_ (struct MHD_Daemon *daemon,
     connection->sk_corked = _MHD_UNKNOWN;
     connection->sk_nodelay = _MHD_UNKNOWN;
   }
+#ifdef MHD_USE_MSG_ZEROCOPY
+  connection->zc_sk_state = _MHD_UNKNOWN;
+#endif /* MHD_USE_MSG_ZEROCOPY */
 
   if (0 < addrlen)
   {
@@ -2775,6 +2711,20 @@ new_connection_prepare_ (struct MHD_Daemon *daemon,
 #endif
       return NULL;
     }
+    if ( (NULL != daemon->tls_tickets) &&
+         (! MHD_tls_tickets_enable_ (daemon->tls_tickets,
+                                     connection->tls_session)) )
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("Failed to enable TLS session tickets.\n"));
+#else  /* ! HAVE_MESSAGES */
+      (void) 0; /* Mute compiler warning */
+#endif /* ! HAVE_MESSAGES */
+    }
+    if (NULL != daemon->tls_sess_cache)
+      MHD_tls_sess_cache_attach_ (daemon->tls_sess_cache,
+                                  connection->tls_session);
 #if (GNUTLS_VERSION_NUMBER + 0 >= 0x030109) && ! defined(_WIN64)
     gnutls_transport_set_int (connection->tls_session,
                               (int) (client_socket));
@@ -2877,8 +2827,9 @@ new_connection_process_ (struct MHD_Daemon *daemon,
   /* Allocate memory pool in the processing thread so
    * intensively used memory area is allocated in "good"
    * (for the thread) memory region. It is important with
-   * NUMA and/or complex cache hierarchy. */
-  connection->pool = MHD_pool_create (daemon->pool_size);
+   * NUMA and/or complex cache hierarchy.
+   * The cached pools were allocated by the same thread. */
+  connection->pool = MHD_pool_cache_get (&daemon->pool_cache);
   if (NULL == connection->pool)
   { /* 'pool' creation failed */
 #ifdef HAVE_MESSAGES
@@ -2923,6 +2874,7 @@ new_connection_process_ (struct MHD_Daemon *daemon,
       MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
 
       MHD_connection_set_initial_state_ (connection);
+      MHD_TRACE2_ (conn__accept, connection, connection->socket_fd);
 
       if (NULL != daemon->notify_connection)
         daemon->notify_connection (daemon->notify_connection_cls,
@@ -2968,6 +2920,38 @@ new_connection_process_ (struct MHD_Daemon *daemon,
 #ifdef EPOLL_SUPPORT
         if (MHD_D_IS_USING_EPOLL_ (daemon))
         {
+#ifdef IO_URING_SUPPORT
+          if (NULL != daemon->uring)
+          {
+            connection->uring = (struct MHD_UringConn_ *)
+                                MHD_calloc_ (1, sizeof (struct MHD_UringConn_));
+            if (NULL == connection->uring)
+            {
+              eno = errno;
+#ifdef HAVE_MESSAGES
+              MHD_DLOG (daemon,
+                        _ ("Error allocating memory: %s\n"),
+                        MHD_strerror_ (eno));
+#endif
+            }
+            else
+            {
+              /* The first data is often available right after accept(),
+                 try to receive it directly, the ring is used when there
+                 is nothing to receive. */
+              connection->uring->connection = connection;
+              connection->epoll_state |= MHD_EPOLL_STATE_READ_READY
+                                         | MHD_EPOLL_STATE_WRITE_READY
+                                         | MHD_EPOLL_STATE_IN_EREADY_EDLL;
+              EDLL_insert (daemon->eready_head,
+                           daemon->eready_tail,
+                           connection);
+
+              return MHD_YES;  /* *** Function success exit point *** */
+            }
+          }
+          else
+#endif /* IO_URING_SUPPORT */
           if (0 == (daemon->options & MHD_USE_TURBO))
           {
             struct epoll_event event;
@@ -3029,7 +3013,8 @@ new_connection_process_ (struct MHD_Daemon *daemon,
       daemon->connections--;
       MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
     }
-    MHD_pool_destroy (connection->pool);
+    MHD_pool_cache_put (&daemon->pool_cache,
+                        connection->pool);
   }
   /* Free resources allocated before the call of this functions */
 #ifdef HTTPS_SUPPORT
@@ -3137,7 +3122,10 @@ internal_add_connection (struct MHD_Daemon *daemon,
                                         sk_spipe_supprs,
                                         sk_is_nonip);
   if (NULL == connection)
+  {
+    MHD_stats_add_ (&daemon->stats.conns_rejected, 1, true);
     return MHD_NO;
+  }
 
   if ((external_add) &&
       MHD_D_IS_THREAD_SAFE_ (daemon))
@@ -3164,7 +3152,13 @@ internal_add_connection (struct MHD_Daemon *daemon,
     return MHD_YES;
   }
 
-  return new_connection_process_ (daemon, connection);
+  if (MHD_NO == new_connection_process_ (daemon, connection))
+  {
+    MHD_stats_add_ (&daemon->stats.conns_rejected, 1, true);
+    return MHD_NO;
+  }
+  MHD_STATS_ADD_ (daemon, conns_accepted, 1);
+  return MHD_YES;
 }
 
 
@@ -3204,8 +3198,10 @@ new_connections_list_process_ (struct MHD_Daemon *daemon)
       MHD_DLOG (daemon,
                 _ ("Failed to start serving new connection.\n"));
 #endif
-      (void) 0;
+      MHD_stats_add_ (&daemon->stats.conns_rejected, 1, true);
     }
+    else
+      MHD_STATS_ADD_ (daemon, conns_accepted, 1);
   } while (NULL != local_tail);
 
 }
@@ -3242,16 +3238,7 @@ internal_suspend_connection_ (struct MHD_Connection *connection)
     return;
   }
   if (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
-  {
-    if (connection->connection_timeout_ms == daemon->connection_timeout_ms)
-      XDLL_remove (daemon->normal_timeout_head,
-                   daemon->normal_timeout_tail,
-                   connection);
-    else
-      XDLL_remove (daemon->manual_timeout_head,
-                   daemon->manual_timeout_tail,
-                   connection);
-  }
+    MHD_connection_timeout_remove_ (connection);
   DLL_remove (daemon->connections_head,
               daemon->connections_tail,
               connection);
@@ -3260,6 +3247,14 @@ internal_suspend_connection_ (struct MHD_Connection *connection)
               daemon->suspended_connections_tail,
               connection);
   connection->suspended = true;
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+  /* The handshake offload is not reported as suspending */
+  if (! connection->tls_hs_offloaded)
+#endif /* HTTPS_SUPPORT && MHD_USE_THREADS */
+  {
+    MHD_STATS_ADD_ (daemon, suspends, 1);
+    MHD_TRACE1_ (conn__suspend, connection);
+  }
 #ifdef EPOLL_SUPPORT
   if (MHD_D_IS_USING_EPOLL_ (daemon))
   {
@@ -3365,21 +3360,67 @@ _MHD_EXTERN void
 MHD_resume_connection (struct MHD_Connection *connection)
 {
   struct MHD_Daemon *daemon = connection->daemon;
-#if defined(MHD_USE_THREADS)
-  mhd_assert (NULL == daemon->worker_pool);
-#endif /* MHD_USE_THREADS */
 
   if (0 == (daemon->options & MHD_TEST_ALLOW_SUSPEND_RESUME))
     MHD_PANIC (_ ("Cannot resume connections without enabling " \
                   "MHD_ALLOW_SUSPEND_RESUME!\n"));
+  internal_resume_connection_ (connection);
+}
+
+
+/**
+ * Internal version of ::MHD_resume_connection().
+ *
+ * @remark Can be called from any thread.
+ *
+ * @param connection the connection to resume
+ */
+void
+internal_resume_connection_ (struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *daemon = connection->daemon;
+#if defined(MHD_USE_THREADS)
+  mhd_assert (NULL == daemon->worker_pool);
+#endif /* MHD_USE_THREADS */
+  mhd_assert (0 != (daemon->options & MHD_TEST_ALLOW_SUSPEND_RESUME));
+
+#ifdef MHD_HAVE_ATOMIC_
+#ifdef UPGRADE_SUPPORT
+  /* "Upgraded" connections are resumed by the full check */
+  if (NULL == connection->urh)
+#else  /* ! UPGRADE_SUPPORT */
+  if (1)
+#endif /* ! UPGRADE_SUPPORT */
+  {
+    struct MHD_Connection *head;
+
+    connection->resuming = true;
+    if (0 != mhd_atomic_u32_xchg_ (&connection->resume_queued, 1))
+      return; /* Already queued, the daemon has not processed it yet */
+    /* Push the connection to the queue of resumed connections */
+    do
+    {
+      head = mhd_atomic_ptr_load_acq_ (&daemon->resume_queue);
+      connection->resume_next = head;
+    } while (! mhd_atomic_ptr_cas_rel_ (&daemon->resume_queue,
+                                        head,
+                                        connection));
+    if (NULL != head)
+      return; /* The daemon has been signalled already */
+  }
+  else
+#endif /* MHD_HAVE_ATOMIC_ */
+  if (1)
+  {
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+    MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
-  connection->resuming = true;
-  daemon->resuming = true;
+    connection->resuming = true;
+    daemon->resuming = true;
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+    MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
+  }
   if ( (MHD_ITC_IS_VALID_ (daemon->itc)) &&
        (! MHD_itc_activate_ (daemon->itc, "r")) )
   {
@@ -3431,8 +3472,158 @@ MHD_upgraded_connection_mark_app_closed_ (struct MHD_Connection *connection)
 #endif /* UPGRADE_SUPPORT */
 
 /**
- * Run through the suspended connections and move any that are no
- * longer suspended back to the active state.
+ * Move the suspended connection back to the active state.
+ * For the "upgraded" connection move it to the cleanup list.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc. with locked @e cleanup_connection_mutex.
+ *
+ * @param daemon daemon context
+ * @param pos the connection to resume
+ */
+static void
+resume_connection_ (struct MHD_Daemon *daemon,
+                    struct MHD_Connection *pos)
+{
+#ifdef UPGRADE_SUPPORT
+  struct MHD_UpgradeResponseHandle *const urh = pos->urh;
+#else  /* ! UPGRADE_SUPPORT */
+  static const void *const urh = NULL;
+#endif /* ! UPGRADE_SUPPORT */
+
+  mhd_assert (pos->suspended);
+  DLL_remove (daemon->suspended_connections_head,
+              daemon->suspended_connections_tail,
+              pos);
+  pos->suspended = false;
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+  if (! pos->tls_hs_offloaded)
+#endif /* HTTPS_SUPPORT && MHD_USE_THREADS */
+  {
+    MHD_STATS_ADD_ (daemon, resumes, 1);
+    MHD_TRACE1_ (conn__resume, pos);
+  }
+  if (NULL == urh)
+  {
+    DLL_insert (daemon->connections_head,
+                daemon->connections_tail,
+                pos);
+    if (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
+    {
+      /* Reset timeout timer on resume. */
+      if (0 != pos->connection_timeout_ms)
+        pos->last_activity = MHD_monotonic_msec_counter ();
+
+      MHD_connection_timeout_add_ (pos);
+    }
+#ifdef EPOLL_SUPPORT
+    if (MHD_D_IS_USING_EPOLL_ (daemon))
+    {
+      if (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EREADY_EDLL))
+        MHD_PANIC ("Resumed connection was already in EREADY set.\n");
+      /* we always mark resumed connections as ready, as we
+         might have missed the edge poll event during suspension */
+      EDLL_insert (daemon->eready_head,
+                   daemon->eready_tail,
+                   pos);
+      pos->epoll_state |= MHD_EPOLL_STATE_IN_EREADY_EDLL;
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+      /* The handshake thread has consumed all available data if the step
+         is not completed.  The connection is added back to the epoll set,
+         which reports the new data. */
+      if (! pos->tls_hs_offloaded ||
+          (GNUTLS_E_AGAIN != pos->tls_hs_ret))
+#endif /* HTTPS_SUPPORT && MHD_USE_THREADS */
+      pos->epoll_state |= MHD_EPOLL_STATE_READ_READY
+                          | MHD_EPOLL_STATE_WRITE_READY;
+      pos->epoll_state &= ~((enum MHD_EpollState) MHD_EPOLL_STATE_SUSPENDED);
+    }
+#endif
+  }
+#ifdef UPGRADE_SUPPORT
+  else
+  {
+    /* Data forwarding was finished (for TLS connections) AND
+     * application was closed upgraded connection.
+     * Insert connection into cleanup list. */
+
+    if ( (NULL != daemon->notify_completed) &&
+         (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon)) &&
+         (pos->rq.client_aware) )
+    {
+      daemon->notify_completed (daemon->notify_completed_cls,
+                                pos,
+                                &pos->rq.client_context,
+                                MHD_REQUEST_TERMINATED_COMPLETED_OK);
+      pos->rq.client_aware = false;
+    }
+    DLL_insert (daemon->cleanup_head,
+                daemon->cleanup_tail,
+                pos);
+    daemon->data_already_pending = true;
+  }
+#endif /* UPGRADE_SUPPORT */
+  pos->resuming = false;
+}
+
+
+#ifdef MHD_HAVE_ATOMIC_
+/**
+ * Take all connections from the queue of resumed connections and move
+ * them back to the active state.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc. with locked @e cleanup_connection_mutex.
+ *
+ * @param daemon daemon context
+ * @return 'true' if a connection was actually resumed,
+ *         'false' otherwise
+ */
+static bool
+resume_queue_process_ (struct MHD_Daemon *daemon)
+{
+  struct MHD_Connection *pos;
+  struct MHD_Connection *next;
+  struct MHD_Connection *list;
+  bool ret;
+
+  if (NULL == mhd_atomic_ptr_load_acq_ (&daemon->resume_queue))
+    return false;
+  pos = mhd_atomic_ptr_xchg_acq_ (&daemon->resume_queue,
+                                  (struct MHD_Connection *) NULL);
+  /* Reverse the stack to process connections in the order of resuming */
+  list = NULL;
+  while (NULL != pos)
+  {
+    next = pos->resume_next;
+    pos->resume_next = list;
+    list = pos;
+    pos = next;
+  }
+  ret = false;
+  while (NULL != (pos = list))
+  {
+    list = pos->resume_next;
+    pos->resume_next = NULL;
+    /* After this point the connection could be pushed again by
+       the next resume, 'resuming' flag is checked after the reset. */
+    (void) mhd_atomic_u32_xchg_ (&pos->resume_queued, 0);
+    /* The connection could be already resumed by the full check or
+       suspending could be cancelled */
+    if (! pos->suspended || ! pos->resuming)
+      continue;
+    resume_connection_ (daemon, pos);
+    ret = true;
+  }
+  return ret;
+}
+
+
+#endif /* MHD_HAVE_ATOMIC_ */
+
+/**
+ * Move the resumed connections back to the active state.
+ * The connections from the queue of resumed connections are processed
+ * first.  If the full check is requested by @e resuming flag, run
+ * through all suspended connections to find resumed ones.
  * @remark To be called only from thread that process
  * daemon's select()/poll()/etc.
  *
@@ -3458,6 +3649,11 @@ resume_suspended_connections (struct MHD_Daemon *daemon)
   MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
 
+#ifdef MHD_HAVE_ATOMIC_
+  if (resume_queue_process_ (daemon))
+    ret = MHD_YES;
+#endif /* MHD_HAVE_ATOMIC_ */
+
   if (daemon->resuming)
   {
     prev = daemon->suspended_connections_tail;
@@ -3472,11 +3668,13 @@ resume_suspended_connections (struct MHD_Daemon *daemon)
   {
 #ifdef UPGRADE_SUPPORT
     struct MHD_UpgradeResponseHandle *const urh = pos->urh;
-#else  /* ! UPGRADE_SUPPORT */
-    static const void *const urh = NULL;
-#endif /* ! UPGRADE_SUPPORT */
+#endif /* UPGRADE_SUPPORT */
     prev = pos->prev;
     if ( (! pos->resuming)
+#ifdef MHD_HAVE_ATOMIC_
+         /* Queued connections are processed with the queue */
+         || (0 != pos->resume_queued)
+#endif /* MHD_HAVE_ATOMIC_ */
 #ifdef UPGRADE_SUPPORT
          || ( (NULL != urh) &&
               ( (! urh->was_closed) ||
@@ -3485,91 +3683,26 @@ resume_suspended_connections (struct MHD_Daemon *daemon)
          )
       continue;
     ret = MHD_YES;
-    mhd_assert (pos->suspended);
-    DLL_remove (daemon->suspended_connections_head,
-                daemon->suspended_connections_tail,
-                pos);
-    pos->suspended = false;
-    if (NULL == urh)
+    resume_connection_ (daemon, pos);
+  }
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  if ( (used_thr_p_c) &&
+       (MHD_NO != ret) )
+  {   /* Wake up suspended connections. */
+    if (! MHD_itc_activate_ (daemon->itc,
+                             "w"))
     {
-      DLL_insert (daemon->connections_head,
-                  daemon->connections_tail,
-                  pos);
-      if (! used_thr_p_c)
-      {
-        /* Reset timeout timer on resume. */
-        if (0 != pos->connection_timeout_ms)
-          pos->last_activity = MHD_monotonic_msec_counter ();
-
-        if (pos->connection_timeout_ms == daemon->connection_timeout_ms)
-          XDLL_insert (daemon->normal_timeout_head,
-                       daemon->normal_timeout_tail,
-                       pos);
-        else
-          XDLL_insert (daemon->manual_timeout_head,
-                       daemon->manual_timeout_tail,
-                       pos);
-      }
-#ifdef EPOLL_SUPPORT
-      if (MHD_D_IS_USING_EPOLL_ (daemon))
-      {
-        if (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EREADY_EDLL))
-          MHD_PANIC ("Resumed connection was already in EREADY set.\n");
-        /* we always mark resumed connections as ready, as we
-           might have missed the edge poll event during suspension */
-        EDLL_insert (daemon->eready_head,
-                     daemon->eready_tail,
-                     pos);
-        pos->epoll_state |= MHD_EPOLL_STATE_IN_EREADY_EDLL   \
-                            | MHD_EPOLL_STATE_READ_READY
-                            | MHD_EPOLL_STATE_WRITE_READY;
-        pos->epoll_state &= ~((enum MHD_EpollState) MHD_EPOLL_STATE_SUSPENDED);
-      }
-#endif
-    }
-#ifdef UPGRADE_SUPPORT
-    else
-    {
-      /* Data forwarding was finished (for TLS connections) AND
-       * application was closed upgraded connection.
-       * Insert connection into cleanup list. */
-
-      if ( (NULL != daemon->notify_completed) &&
-           (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon)) &&
-           (pos->rq.client_aware) )
-      {
-        daemon->notify_completed (daemon->notify_completed_cls,
-                                  pos,
-                                  &pos->rq.client_context,
-                                  MHD_REQUEST_TERMINATED_COMPLETED_OK);
-        pos->rq.client_aware = false;
-      }
-      DLL_insert (daemon->cleanup_head,
-                  daemon->cleanup_tail,
-                  pos);
-      daemon->data_already_pending = true;
-    }
-#endif /* UPGRADE_SUPPORT */
-    pos->resuming = false;
-  }
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
-#endif
-  if ( (used_thr_p_c) &&
-       (MHD_NO != ret) )
-  {   /* Wake up suspended connections. */
-    if (! MHD_itc_activate_ (daemon->itc,
-                             "w"))
-    {
-#ifdef HAVE_MESSAGES
-      MHD_DLOG (daemon,
-                _ ("Failed to signal resume of connection via " \
-                   "inter-thread communication channel.\n"));
-#endif
-    }
-  }
-  return ret;
-}
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("Failed to signal resume of connection via " \
+                   "inter-thread communication channel.\n"));
+#endif
+    }
+  }
+  return ret;
+}
 
 
 /**
@@ -3788,153 +3921,93 @@ MHD_add_connection (struct MHD_Daemon *daemon,
 
 
 /**
- * Accept an incoming connection and create the MHD_Connection object for
- * it.  This function also enforces policy by way of checking with the
- * accept policy callback.
+ * Process the error of accepting the new connection.
  * @remark To be called only from thread that process
  * daemon's select()/poll()/etc.
  *
- * @param daemon handle with the listen socket
- * @return #MHD_YES on success (connections denied by policy or due
- *         to 'out of memory' and similar errors) are still considered
- *         successful as far as #MHD_accept_connection() is concerned);
- *         a return code of #MHD_NO only refers to the actual
- *         accept() system call.
+ * @param daemon the daemon with the listen socket
+ * @param err the error code of the accept() call
  */
-static enum MHD_Result
-MHD_accept_connection (struct MHD_Daemon *daemon)
+static void
+accept_error_process_ (struct MHD_Daemon *daemon,
+                       int err)
 {
-  struct sockaddr_storage addrstorage;
-  socklen_t addrlen;
-  MHD_socket s;
-  MHD_socket fd;
-  bool sk_nonbl;
-  bool sk_spipe_supprs;
-  bool sk_cloexec;
-  enum MHD_tristate sk_non_ip;
-#if defined(_DEBUG) && defined (USE_ACCEPT4)
-  const bool use_accept4 = ! daemon->avoid_accept4;
-#elif defined (USE_ACCEPT4)
-  static const bool use_accept4 = true;
-#else  /* ! USE_ACCEPT4 && ! _DEBUG */
-  static const bool use_accept4 = false;
-#endif /* ! USE_ACCEPT4 && ! _DEBUG */
-
-#ifdef MHD_USE_THREADS
-  mhd_assert ( (! MHD_D_IS_USING_THREADS_ (daemon)) || \
-               MHD_thread_handle_ID_is_current_thread_ (daemon->tid) );
-  mhd_assert (NULL == daemon->worker_pool);
-#endif /* MHD_USE_THREADS */
-
-  if ( (MHD_INVALID_SOCKET == (fd = daemon->listen_fd)) ||
-       (daemon->was_quiesced) )
-    return MHD_NO;
-
-  addrlen = (socklen_t) sizeof (addrstorage);
-  memset (&addrstorage,
-          0,
-          (size_t) addrlen);
-#ifdef HAVE_STRUCT_SOCKADDR_STORAGE_SS_LEN
-  addrstorage.ss_len = addrlen;
-#endif /* HAVE_STRUCT_SOCKADDR_STORAGE_SS_LEN */
-
-  /* Initialise with default values to avoid compiler warnings */
-  sk_nonbl = false;
-  sk_spipe_supprs = false;
-  sk_cloexec = false;
-  s = MHD_INVALID_SOCKET;
-
-#ifdef USE_ACCEPT4
-  if (use_accept4 &&
-      (MHD_INVALID_SOCKET !=
-       (s = accept4 (fd,
-                     (struct sockaddr *) &addrstorage,
-                     &addrlen,
-                     SOCK_CLOEXEC_OR_ZERO | SOCK_NONBLOCK_OR_ZERO
-                     | SOCK_NOSIGPIPE_OR_ZERO))))
-  {
-    sk_nonbl = (SOCK_NONBLOCK_OR_ZERO != 0);
-#ifndef MHD_WINSOCK_SOCKETS
-    sk_spipe_supprs = (SOCK_NOSIGPIPE_OR_ZERO != 0);
-#else  /* MHD_WINSOCK_SOCKETS */
-    sk_spipe_supprs = true; /* Nothing to suppress on W32 */
-#endif /* MHD_WINSOCK_SOCKETS */
-    sk_cloexec = (SOCK_CLOEXEC_OR_ZERO != 0);
-  }
-#endif /* USE_ACCEPT4 */
-#if defined(_DEBUG) || ! defined(USE_ACCEPT4)
-  if (! use_accept4 &&
-      (MHD_INVALID_SOCKET !=
-       (s = accept (fd,
-                    (struct sockaddr *) &addrstorage,
-                    &addrlen))))
-  {
-#ifdef MHD_ACCEPT_INHERIT_NONBLOCK
-    sk_nonbl = daemon->listen_nonblk;
-#else  /* ! MHD_ACCEPT_INHERIT_NONBLOCK */
-    sk_nonbl = false;
-#endif /* ! MHD_ACCEPT_INHERIT_NONBLOCK */
-#ifndef MHD_WINSOCK_SOCKETS
-    sk_spipe_supprs = false;
-#else  /* MHD_WINSOCK_SOCKETS */
-    sk_spipe_supprs = true; /* Nothing to suppress on W32 */
-#endif /* MHD_WINSOCK_SOCKETS */
-    sk_cloexec = false;
-  }
-#endif /* _DEBUG || !USE_ACCEPT4 */
-
-  if (MHD_INVALID_SOCKET == s)
+  /* This could be a common occurrence with multiple worker threads */
+  if (MHD_SCKT_ERR_IS_ (err,
+                        MHD_SCKT_EINVAL_))
+    return;   /* can happen during shutdown */
+  if (MHD_SCKT_ERR_IS_DISCNN_BEFORE_ACCEPT_ (err))
+    return;   /* do not print error if client just disconnected early */
+#ifdef HAVE_MESSAGES
+  if (! MHD_SCKT_ERR_IS_EAGAIN_ (err) )
+    MHD_DLOG (daemon,
+              _ ("Error accepting connection: %s\n"),
+              MHD_socket_strerr_ (err));
+#endif
+  if (MHD_SCKT_ERR_IS_LOW_RESOURCES_ (err) )
   {
-    const int err = MHD_socket_get_error_ ();
-
-    /* This could be a common occurrence with multiple worker threads */
-    if (MHD_SCKT_ERR_IS_ (err,
-                          MHD_SCKT_EINVAL_))
-      return MHD_NO;   /* can happen during shutdown */
-    if (MHD_SCKT_ERR_IS_DISCNN_BEFORE_ACCEPT_ (err))
-      return MHD_NO;   /* do not print error if client just disconnected early */
+    /* system/process out of resources */
+    if (0 == daemon->connections)
+    {
 #ifdef HAVE_MESSAGES
-    if (! MHD_SCKT_ERR_IS_EAGAIN_ (err) )
+      /* Not setting 'at_limit' flag, as there is no way it
+         would ever be cleared.  Instead trying to produce
+         bit fat ugly warning. */
       MHD_DLOG (daemon,
-                _ ("Error accepting connection: %s\n"),
-                MHD_socket_strerr_ (err));
+                _ ("Hit process or system resource limit at FIRST " \
+                   "connection. This is really bad as there is no sane " \
+                   "way to proceed. Will try busy waiting for system " \
+                   "resources to become magically available.\n"));
 #endif
-    if (MHD_SCKT_ERR_IS_LOW_RESOURCES_ (err) )
+    }
+    else
     {
-      /* system/process out of resources */
-      if (0 == daemon->connections)
-      {
-#ifdef HAVE_MESSAGES
-        /* Not setting 'at_limit' flag, as there is no way it
-           would ever be cleared.  Instead trying to produce
-           bit fat ugly warning. */
-        MHD_DLOG (daemon,
-                  _ ("Hit process or system resource limit at FIRST " \
-                     "connection. This is really bad as there is no sane " \
-                     "way to proceed. Will try busy waiting for system " \
-                     "resources to become magically available.\n"));
-#endif
-      }
-      else
-      {
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-        MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+      MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
-        daemon->at_limit = true;
+      daemon->at_limit = true;
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-        MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+      MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
 #ifdef HAVE_MESSAGES
-        MHD_DLOG (daemon,
-                  _ ("Hit process or system resource limit at %u " \
-                     "connections, temporarily suspending accept(). " \
-                     "Consider setting a lower MHD_OPTION_CONNECTION_LIMIT.\n"),
-                  (unsigned int) daemon->connections);
+      MHD_DLOG (daemon,
+                _ ("Hit process or system resource limit at %u " \
+                   "connections, temporarily suspending accept(). " \
+                   "Consider setting a lower MHD_OPTION_CONNECTION_LIMIT.\n"),
+                (unsigned int) daemon->connections);
 #endif
-      }
     }
-    return MHD_NO;
   }
+}
+
+
+/**
+ * Set up the newly accepted socket and create the MHD_Connection object
+ * for it.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
+ *
+ * @param daemon the daemon with the listen socket
+ * @param s the accepted socket
+ * @param addrstorage the address of the remote side
+ * @param addrlen the length of the address in @a addrstorage
+ * @param sk_nonbl set to 'true' if the socket is already in non-blocking
+ *                 mode
+ * @param sk_spipe_supprs set to 'true' if the socket has set SIGPIPE
+ *                        suppression
+ * @param sk_cloexec set to 'true' if the socket is already
+ *                   non-inheritable
+ */
+static void
+accepted_socket_add_ (struct MHD_Daemon *daemon,
+                      MHD_socket s,
+                      struct sockaddr_storage *addrstorage,
+                      socklen_t addrlen,
+                      bool sk_nonbl,
+                      bool sk_spipe_supprs,
+                      bool sk_cloexec)
+{
+  enum MHD_tristate sk_non_ip;
 
   sk_non_ip = daemon->listen_is_unix;
   if (0 >= addrlen)
@@ -3949,7 +4022,7 @@ MHD_accept_connection (struct MHD_Daemon *daemon)
     addrlen = 0;
     sk_non_ip = _MHD_YES; /* IP-type addresses have non-zero length */
   }
-  if (((socklen_t) sizeof (addrstorage)) < addrlen)
+  if (((socklen_t) sizeof (*addrstorage)) < addrlen)
   {
     /* Should not happen as 'sockaddr_storage' must be large enough to
      * store any address supported by the system. */
@@ -4005,7 +4078,7 @@ MHD_accept_connection (struct MHD_Daemon *daemon)
     if (! daemon->sigpipe_blocked)
     {
       (void) MHD_socket_close_ (s);
-      return MHD_NO;
+      return;
     }
 #endif /* MSG_NOSIGNAL */
   }
@@ -4021,79 +4094,237 @@ MHD_accept_connection (struct MHD_Daemon *daemon)
 #endif
   (void) internal_add_connection (daemon,
                                   s,
-                                  &addrstorage,
+                                  addrstorage,
                                   addrlen,
                                   false,
                                   sk_nonbl,
                                   sk_spipe_supprs,
                                   sk_non_ip);
-  return MHD_YES;
 }
 
 
 /**
- * Free resources associated with all closed connections.
- * (destroy responses, free buffers, etc.).  All closed
- * connections are kept in the "cleanup" doubly-linked list.
- * @remark To be called only from thread that
- * process daemon's select()/poll()/etc.
+ * Accept an incoming connection and create the MHD_Connection object for
+ * it.  This function also enforces policy by way of checking with the
+ * accept policy callback.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
  *
- * @param daemon daemon to clean up
+ * @param daemon handle with the listen socket
+ * @return #MHD_YES on success (connections denied by policy or due
+ *         to 'out of memory' and similar errors) are still considered
+ *         successful as far as #MHD_accept_connection() is concerned);
+ *         a return code of #MHD_NO only refers to the actual
+ *         accept() system call.
  */
-static void
-MHD_cleanup_connections (struct MHD_Daemon *daemon)
+static enum MHD_Result
+MHD_accept_connection (struct MHD_Daemon *daemon)
 {
-  struct MHD_Connection *pos;
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  struct sockaddr_storage addrstorage;
+  socklen_t addrlen;
+  MHD_socket s;
+  MHD_socket fd;
+  bool sk_nonbl;
+  bool sk_spipe_supprs;
+  bool sk_cloexec;
+#if defined(_DEBUG) && defined (USE_ACCEPT4)
+  const bool use_accept4 = ! daemon->avoid_accept4;
+#elif defined (USE_ACCEPT4)
+  static const bool use_accept4 = true;
+#else  /* ! USE_ACCEPT4 && ! _DEBUG */
+  static const bool use_accept4 = false;
+#endif /* ! USE_ACCEPT4 && ! _DEBUG */
+
+#ifdef MHD_USE_THREADS
   mhd_assert ( (! MHD_D_IS_USING_THREADS_ (daemon)) || \
                MHD_thread_handle_ID_is_current_thread_ (daemon->tid) );
   mhd_assert (NULL == daemon->worker_pool);
+#endif /* MHD_USE_THREADS */
 
-  MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
-#endif
-  while (NULL != (pos = daemon->cleanup_tail))
-  {
-    DLL_remove (daemon->cleanup_head,
-                daemon->cleanup_tail,
-                pos);
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-    MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
-    if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon) &&
-        (! pos->thread_joined) &&
-        (! MHD_thread_handle_ID_join_thread_ (pos->tid)) )
-      MHD_PANIC (_ ("Failed to join a thread.\n"));
-#endif
-#ifdef UPGRADE_SUPPORT
-    cleanup_upgraded_connection (pos);
-#endif /* UPGRADE_SUPPORT */
-    MHD_pool_destroy (pos->pool);
-#ifdef HTTPS_SUPPORT
-    if (NULL != pos->tls_session)
-      gnutls_deinit (pos->tls_session);
-#endif /* HTTPS_SUPPORT */
+  if ( (MHD_INVALID_SOCKET == (fd = daemon->listen_fd)) ||
+       (daemon->was_quiesced) )
+    return MHD_NO;
 
-    /* clean up the connection */
-    if (NULL != daemon->notify_connection)
-      daemon->notify_connection (daemon->notify_connection_cls,
-                                 pos,
-                                 &pos->socket_context,
-                                 MHD_CONNECTION_NOTIFY_CLOSED);
-    MHD_ip_limit_del (daemon,
-                      pos->addr,
-                      pos->addr_len);
-#ifdef EPOLL_SUPPORT
-    if (MHD_D_IS_USING_EPOLL_ (daemon))
-    {
-      if (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EREADY_EDLL))
-      {
-        EDLL_remove (daemon->eready_head,
-                     daemon->eready_tail,
-                     pos);
-        pos->epoll_state &=
-          ~((enum MHD_EpollState) MHD_EPOLL_STATE_IN_EREADY_EDLL);
-      }
-      if ( (-1 != daemon->epoll_fd) &&
-           (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EPOLL_SET)) )
+  addrlen = (socklen_t) sizeof (addrstorage);
+  memset (&addrstorage,
+          0,
+          (size_t) addrlen);
+#ifdef HAVE_STRUCT_SOCKADDR_STORAGE_SS_LEN
+  addrstorage.ss_len = addrlen;
+#endif /* HAVE_STRUCT_SOCKADDR_STORAGE_SS_LEN */
+
+  /* Initialise with default values to avoid compiler warnings */
+  sk_nonbl = false;
+  sk_spipe_supprs = false;
+  sk_cloexec = false;
+  s = MHD_INVALID_SOCKET;
+
+#ifdef USE_ACCEPT4
+  if (use_accept4 &&
+      (MHD_INVALID_SOCKET !=
+       (s = accept4 (fd,
+                     (struct sockaddr *) &addrstorage,
+                     &addrlen,
+                     SOCK_CLOEXEC_OR_ZERO | SOCK_NONBLOCK_OR_ZERO
+                     | SOCK_NOSIGPIPE_OR_ZERO))))
+  {
+    sk_nonbl = (SOCK_NONBLOCK_OR_ZERO != 0);
+#ifndef MHD_WINSOCK_SOCKETS
+    sk_spipe_supprs = (SOCK_NOSIGPIPE_OR_ZERO != 0);
+#else  /* MHD_WINSOCK_SOCKETS */
+    sk_spipe_supprs = true; /* Nothing to suppress on W32 */
+#endif /* MHD_WINSOCK_SOCKETS */
+    sk_cloexec = (SOCK_CLOEXEC_OR_ZERO != 0);
+  }
+#endif /* USE_ACCEPT4 */
+#if defined(_DEBUG) || ! defined(USE_ACCEPT4)
+  if (! use_accept4 &&
+      (MHD_INVALID_SOCKET !=
+       (s = accept (fd,
+                    (struct sockaddr *) &addrstorage,
+                    &addrlen))))
+  {
+#ifdef MHD_ACCEPT_INHERIT_NONBLOCK
+    sk_nonbl = daemon->listen_nonblk;
+#else  /* ! MHD_ACCEPT_INHERIT_NONBLOCK */
+    sk_nonbl = false;
+#endif /* ! MHD_ACCEPT_INHERIT_NONBLOCK */
+#ifndef MHD_WINSOCK_SOCKETS
+    sk_spipe_supprs = false;
+#else  /* MHD_WINSOCK_SOCKETS */
+    sk_spipe_supprs = true; /* Nothing to suppress on W32 */
+#endif /* MHD_WINSOCK_SOCKETS */
+    sk_cloexec = false;
+  }
+#endif /* _DEBUG || !USE_ACCEPT4 */
+
+  if (MHD_INVALID_SOCKET == s)
+  {
+    accept_error_process_ (daemon,
+                           MHD_socket_get_error_ ());
+    return MHD_NO;
+  }
+  accepted_socket_add_ (daemon,
+                        s,
+                        &addrstorage,
+                        addrlen,
+                        sk_nonbl,
+                        sk_spipe_supprs,
+                        sk_cloexec);
+  return MHD_YES;
+}
+
+
+/**
+ * Accept a series of incoming connections.
+ * Accepting is stopped when no more connections are pending, when
+ * the daemon is at the limit of connections or when
+ * #MHD_Daemon::accept_batch_size connections have been accepted.
+ * The rest of connections will be accepted on the next turn (level
+ * trigger is used for the listen socket).
+ * Only one connection is accepted if the listen socket is blocking.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
+ *
+ * @param daemon handle with the listen socket
+ */
+static void
+accept_connections_series (struct MHD_Daemon *daemon)
+{
+  unsigned int series_length;
+
+  mhd_assert (0 != daemon->accept_batch_size);
+  series_length = 0;
+  while ( (MHD_NO != MHD_accept_connection (daemon)) &&
+          (daemon->listen_nonblk) &&
+          (++series_length < daemon->accept_batch_size) &&
+          (daemon->connections < daemon->connection_limit) &&
+          (! daemon->at_limit) &&
+          (! daemon->shutdown) )
+    (void) 0;
+}
+
+
+/**
+ * Free resources associated with all closed connections.
+ * (destroy responses, free buffers, etc.).  All closed
+ * connections are kept in the "cleanup" doubly-linked list.
+ * @remark To be called only from thread that
+ * process daemon's select()/poll()/etc.
+ *
+ * @param daemon daemon to clean up
+ */
+static void
+MHD_cleanup_connections (struct MHD_Daemon *daemon)
+{
+  struct MHD_Connection *pos;
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  mhd_assert ( (! MHD_D_IS_USING_THREADS_ (daemon)) || \
+               MHD_thread_handle_ID_is_current_thread_ (daemon->tid) );
+  mhd_assert (NULL == daemon->worker_pool);
+
+  MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  pos = daemon->cleanup_tail;
+  while (NULL != pos)
+  {
+#ifdef MHD_HAVE_ATOMIC_
+    if (0 != pos->resume_queued)
+    {
+      /* The connection is still referenced by the queue of resumed
+         connections (the application resumed the connection that was
+         not suspended).  Keep it until the queue is processed. */
+      pos = pos->prev;
+      continue;
+    }
+#endif /* MHD_HAVE_ATOMIC_ */
+    DLL_remove (daemon->cleanup_head,
+                daemon->cleanup_tail,
+                pos);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+    if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon) &&
+        (! pos->thread_joined) &&
+        (! MHD_thread_handle_ID_join_thread_ (pos->tid)) )
+      MHD_PANIC (_ ("Failed to join a thread.\n"));
+#endif
+#ifdef UPGRADE_SUPPORT
+    cleanup_upgraded_connection (pos);
+#endif /* UPGRADE_SUPPORT */
+    MHD_pool_cache_put (&daemon->pool_cache,
+                        pos->pool);
+#ifdef HTTPS_SUPPORT
+    if (NULL != pos->tls_session)
+      gnutls_deinit (pos->tls_session);
+#endif /* HTTPS_SUPPORT */
+
+    /* clean up the connection */
+    if (NULL != daemon->notify_connection)
+      daemon->notify_connection (daemon->notify_connection_cls,
+                                 pos,
+                                 &pos->socket_context,
+                                 MHD_CONNECTION_NOTIFY_CLOSED);
+    MHD_ip_limit_del (daemon,
+                      pos->addr,
+                      pos->addr_len);
+#ifdef EPOLL_SUPPORT
+    if (MHD_D_IS_USING_EPOLL_ (daemon))
+    {
+      if (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EREADY_EDLL))
+      {
+        EDLL_remove (daemon->eready_head,
+                     daemon->eready_tail,
+                     pos);
+        pos->epoll_state &=
+          ~((enum MHD_EpollState) MHD_EPOLL_STATE_IN_EREADY_EDLL);
+      }
+#ifdef IO_URING_SUPPORT
+      if (NULL != pos->uring)
+        uring_conn_detach (daemon,
+                           pos);
+#endif /* IO_URING_SUPPORT */
+      if ( (-1 != daemon->epoll_fd) &&
+           (0 != (pos->epoll_state & MHD_EPOLL_STATE_IN_EPOLL_SET)) )
       {
         /* epoll documentation suggests that closing a FD
            automatically removes it from the epoll set; however,
@@ -4117,6 +4348,10 @@ MHD_cleanup_connections (struct MHD_Daemon *daemon)
       MHD_destroy_response (pos->rp.response);
       pos->rp.response = NULL;
     }
+#ifdef MHD_USE_MSG_ZEROCOPY
+    /* The socket is taken if the zero-copy sends are not completed */
+    MHD_send_zc_linger_ (pos);
+#endif /* MHD_USE_MSG_ZEROCOPY */
     if (MHD_INVALID_SOCKET != pos->socket_fd)
       MHD_socket_close_chk_ (pos->socket_fd);
     if (NULL != pos->addr)
@@ -4128,10 +4363,17 @@ MHD_cleanup_connections (struct MHD_Daemon *daemon)
 #endif
     daemon->connections--;
     daemon->at_limit = false;
+    MHD_STATS_ADD_ (daemon, conns_closed, 1);
+    /* The list could be modified while the mutex was unlocked */
+    pos = daemon->cleanup_tail;
   }
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
   MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
 #endif
+#ifdef MHD_USE_MSG_ZEROCOPY
+  MHD_send_zc_linger_process_ (daemon,
+                               daemon->shutdown);
+#endif /* MHD_USE_MSG_ZEROCOPY */
 }
 
 
@@ -4247,6 +4489,9 @@ MHD_get_timeout64 (struct MHD_Daemon *daemon,
   if (daemon->data_already_pending
       || (NULL != daemon->cleanup_head)
       || daemon->resuming
+#ifdef MHD_HAVE_ATOMIC_
+      || (NULL != mhd_atomic_ptr_load_acq_ (&daemon->resume_queue))
+#endif /* MHD_HAVE_ATOMIC_ */
       || daemon->have_new
       || daemon->shutdown)
   {
@@ -4279,25 +4524,44 @@ MHD_get_timeout64 (struct MHD_Daemon *daemon,
     earliest_deadline = pos->last_activity + pos->connection_timeout_ms;
   }
 
-  for (pos = daemon->manual_timeout_tail; NULL != pos; pos = pos->prevX)
+  /* custom timeouts are kept in the heap, only the root is needed */
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  pos = MHD_connection_timeout_get_manual_first_ (daemon);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  if ( (NULL != pos) &&
+       (0 != pos->connection_timeout_ms) )
   {
-    if (0 != pos->connection_timeout_ms)
+    if ( (NULL == earliest_tmot_conn) ||
+         (earliest_deadline - pos->last_activity >
+          pos->connection_timeout_ms) )
     {
-      if ( (NULL == earliest_tmot_conn) ||
-           (earliest_deadline - pos->last_activity >
-            pos->connection_timeout_ms) )
-      {
-        earliest_tmot_conn = pos;
-        earliest_deadline = pos->last_activity + pos->connection_timeout_ms;
-      }
+      earliest_tmot_conn = pos;
+      earliest_deadline = pos->last_activity + pos->connection_timeout_ms;
     }
   }
 
   if (NULL != earliest_tmot_conn)
   {
     *timeout64 = connection_get_wait (earliest_tmot_conn);
+#ifdef MHD_USE_MSG_ZEROCOPY
+    if ( (NULL != daemon->zc_linger) &&
+         (MHD_ZC_LINGER_CHECK_MS_ < *timeout64) )
+      *timeout64 = MHD_ZC_LINGER_CHECK_MS_;
+#endif /* MHD_USE_MSG_ZEROCOPY */
+    return MHD_YES;
+  }
+#ifdef MHD_USE_MSG_ZEROCOPY
+  if (NULL != daemon->zc_linger)
+  {
+    /* The sockets waiting for the zero-copy sends are not polled */
+    *timeout64 = MHD_ZC_LINGER_CHECK_MS_;
     return MHD_YES;
   }
+#endif /* MHD_USE_MSG_ZEROCOPY */
   return MHD_NO;
 }
 
@@ -4467,6 +4731,21 @@ get_timeout_millisec_int (struct MHD_Daemon *daemon,
 
 #endif /* HAVE_POLL || EPOLL_SUPPORT */
 
+/**
+ * Read the clock for the current iteration of the event loop.
+ * Must be called after waiting for the network events and before
+ * processing of the connections.
+ * @param daemon the daemon to use
+ * @see #MHD_OPTION_COARSE_ACTIVITY_TIME
+ */
+_MHD_static_inline void
+update_loop_time (struct MHD_Daemon *daemon)
+{
+  if (daemon->coarse_time)
+    daemon->loop_time = MHD_monotonic_msec_counter ();
+}
+
+
 /**
  * Internal version of #MHD_run_from_select().
  *
@@ -4520,6 +4799,8 @@ internal_run_from_select (struct MHD_Daemon *daemon,
       MHD_itc_clear_ (daemon->itc);
   }
 
+  update_loop_time (daemon);
+
   /* Reset. New value will be set when connections are processed. */
   /* Note: no-op for thread-per-connection as it is always false in that mode. */
   daemon->data_already_pending = false;
@@ -4541,7 +4822,7 @@ internal_run_from_select (struct MHD_Daemon *daemon,
       need_to_accept = daemon->listen_nonblk;  /* Try to accept if non-blocking */
 
     if (need_to_accept)
-      (void) MHD_accept_connection (daemon);
+      accept_connections_series (daemon);
   }
 
   if (! MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
@@ -4578,7 +4859,8 @@ internal_run_from_select (struct MHD_Daemon *daemon,
       call_handlers (pos,
                      r_ready,
                      w_ready,
-                     has_err);
+                     has_err,
+                     false);
     }
   }
 
@@ -5115,6 +5397,8 @@ MHD_poll_all (struct MHD_Daemon *daemon,
       return MHD_NO;
     }
 
+    update_loop_time (daemon);
+
     /* Process externally added connection if any */
     if (daemon->have_new)
       new_connections_list_process_ (daemon);
@@ -5122,7 +5406,7 @@ MHD_poll_all (struct MHD_Daemon *daemon,
     /* handle 'listen' FD */
     if ( (-1 != poll_listen) &&
          (0 != (p[poll_listen].revents & POLLIN)) )
-      (void) MHD_accept_connection (daemon);
+      accept_connections_series (daemon);
 
     /* Reset. New value will be set when connections are processed. */
     daemon->data_already_pending = false;
@@ -5141,7 +5425,9 @@ MHD_poll_all (struct MHD_Daemon *daemon,
                      0 != (p[poll_server + i].revents & POLLIN),
                      0 != (p[poll_server + i].revents & POLLOUT),
                      0 != (p[poll_server + i].revents
-                           & MHD_POLL_REVENTS_ERR_DISC));
+                           & MHD_POLL_REVENTS_ERR_DISC),
+                     POLLERR == (p[poll_server + i].revents
+                                 & MHD_POLL_REVENTS_ERR_DISC));
       i++;
     }
 #if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
@@ -5270,7 +5556,7 @@ MHD_poll_listen_socket (struct MHD_Daemon *daemon,
 
   if ( (0 <= poll_listen) &&
        (0 != (p[poll_listen].revents & POLLIN)) )
-    (void) MHD_accept_connection (daemon);
+    accept_connections_series (daemon);
   return MHD_YES;
 }
 
@@ -5313,6 +5599,12 @@ MHD_poll (struct MHD_Daemon *daemon,
  */
 #define MAX_EVENTS 128
 
+/**
+ * The maximum allowed size of the events array for the main epoll() calls.
+ * @see #MHD_OPTION_EPOLL_EVENTS_SIZE
+ */
+#define MHD_EPOLL_EVENTS_SIZE_MAX 65536
+
 
 #if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
 
@@ -5484,90 +5776,37 @@ static const char *const epoll_itc_marker = "itc_marker";
 
 
 /**
- * Do epoll()-based processing.
+ * Add the listen socket to the epoll set of the daemon.
+ * If requested, the socket is added with 'EPOLLEXCLUSIVE' flag so only
+ * one of the workers sharing the listen socket is woken up for the new
+ * connection.  If the kernel does not support the flag, the socket is
+ * added without it and the flag is not used anymore by this daemon.
  *
- * @param daemon daemon to run poll loop for
- * @param millisec the maximum time in milliseconds to wait for events,
- *                 set to '0' for non-blocking processing,
- *                 set to '-1' to wait indefinitely.
- * @return #MHD_NO on serious errors, #MHD_YES on success
+ * @param daemon the daemon to use
+ * @return #MHD_YES on success, #MHD_NO on failure
  */
 static enum MHD_Result
-MHD_epoll (struct MHD_Daemon *daemon,
-           int32_t millisec)
+epoll_add_listen_socket (struct MHD_Daemon *daemon)
 {
-#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
-  static const char *const upgrade_marker = "upgrade_ptr";
-#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
-  struct MHD_Connection *pos;
-  struct MHD_Connection *prev;
-  struct epoll_event events[MAX_EVENTS];
   struct epoll_event event;
-  int timeout_ms;
-  int num_events;
-  unsigned int i;
-  MHD_socket ls;
-#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
-  bool run_upgraded = false;
-#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
-  bool need_to_accept;
-
-  mhd_assert ((0 == (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
-              (MHD_thread_handle_ID_is_valid_ID_ (daemon->tid)));
-  mhd_assert ((0 != (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
-              (! MHD_thread_handle_ID_is_valid_ID_ (daemon->tid)));
-  mhd_assert ((0 == (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
-              (MHD_thread_handle_ID_is_current_thread_ (daemon->tid)));
 
-  if (-1 == daemon->epoll_fd)
-    return MHD_NO; /* we're down! */
-  if (daemon->shutdown)
-    return MHD_NO;
-  if ( (MHD_INVALID_SOCKET != (ls = daemon->listen_fd)) &&
-       (! daemon->was_quiesced) &&
-       (daemon->connections < daemon->connection_limit) &&
-       (! daemon->listen_socket_in_epoll) &&
-       (! daemon->at_limit) )
+  mhd_assert (MHD_INVALID_SOCKET != daemon->listen_fd);
+  mhd_assert (! daemon->listen_socket_in_epoll);
+  event.data.ptr = daemon;
+#ifdef EPOLLEXCLUSIVE
+  if (daemon->listen_epoll_exclusive)
   {
-    event.events = EPOLLIN | EPOLLRDHUP;
-    event.data.ptr = daemon;
-    if (0 != epoll_ctl (daemon->epoll_fd,
+    /* 'EPOLLRDHUP' cannot be combined with 'EPOLLEXCLUSIVE' */
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    if (0 == epoll_ctl (daemon->epoll_fd,
                         EPOLL_CTL_ADD,
-                        ls,
+                        daemon->listen_fd,
                         &event))
     {
-#ifdef HAVE_MESSAGES
-      MHD_DLOG (daemon,
-                _ ("Call to epoll_ctl failed: %s\n"),
-                MHD_socket_last_strerr_ ());
-#endif
-      return MHD_NO;
+      daemon->listen_socket_in_epoll = true;
+      return MHD_YES;
     }
-    daemon->listen_socket_in_epoll = true;
-  }
-  if ( (daemon->was_quiesced) &&
-       (daemon->listen_socket_in_epoll) )
-  {
-    if ( (0 != epoll_ctl (daemon->epoll_fd,
-                          EPOLL_CTL_DEL,
-                          ls,
-                          NULL)) &&
-         (ENOENT != errno) )   /* ENOENT can happen due to race with
-                                  #MHD_quiesce_daemon() */
-      MHD_PANIC ("Failed to remove listen FD from epoll set.\n");
-    daemon->listen_socket_in_epoll = false;
-  }
-
-#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
-  if ( ( (! daemon->upgrade_fd_in_epoll) &&
-         (-1 != daemon->epoll_upgrade_fd) ) )
-  {
-    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
-    event.data.ptr = _MHD_DROP_CONST (upgrade_marker);
-    if (0 != epoll_ctl (daemon->epoll_fd,
-                        EPOLL_CTL_ADD,
-                        daemon->epoll_upgrade_fd,
-                        &event))
+    if (EINVAL != errno)
     {
 #ifdef HAVE_MESSAGES
       MHD_DLOG (daemon,
@@ -5576,24 +5815,374 @@ MHD_epoll (struct MHD_Daemon *daemon,
 #endif
       return MHD_NO;
     }
-    daemon->upgrade_fd_in_epoll = true;
+    /* The kernel is too old, fallback to the plain mode */
+    daemon->listen_epoll_exclusive = false;
   }
-#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
-  if ( (daemon->listen_socket_in_epoll) &&
-       ( (daemon->connections == daemon->connection_limit) ||
-         (daemon->at_limit) ||
-         (daemon->was_quiesced) ) )
+#endif /* EPOLLEXCLUSIVE */
+  event.events = EPOLLIN | EPOLLRDHUP;
+  if (0 != epoll_ctl (daemon->epoll_fd,
+                      EPOLL_CTL_ADD,
+                      daemon->listen_fd,
+                      &event))
   {
-    /* we're at the connection limit, disable listen socket
- for event loop for now */
-    if (0 != epoll_ctl (daemon->epoll_fd,
-                        EPOLL_CTL_DEL,
-                        ls,
-                        NULL))
-      MHD_PANIC (_ ("Failed to remove listen FD from epoll set.\n"));
-    daemon->listen_socket_in_epoll = false;
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Call to epoll_ctl failed: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif
+    return MHD_NO;
   }
-
+  daemon->listen_socket_in_epoll = true;
+  return MHD_YES;
+}
+
+
+/**
+ * Account the events reported by the single wake-up of the event loop.
+ *
+ * @param daemon the daemon to update
+ * @param num_events the number of events reported
+ */
+static void
+epoll_stats_add (struct MHD_Daemon *daemon,
+                 unsigned int num_events)
+{
+  if (0 == num_events)
+    return;
+  MHD_stats_add_ (&daemon->epoll_stats.wakeups, 1, false);
+  MHD_stats_add_ (&daemon->epoll_stats.events, num_events, false);
+  MHD_stats_max_ (&daemon->epoll_stats.max_events, num_events, false);
+}
+
+
+/**
+ * Check the connections for the timeouts in epoll mode.
+ *
+ * @param daemon the daemon to process
+ */
+static void
+epoll_process_timeouts (struct MHD_Daemon *daemon)
+{
+  struct MHD_Connection *pos;
+  struct MHD_Connection *prev;
+  uint64_t now;
+
+  /* Handle timed-out connections; we need to do this here
+     as the epoll mechanism won't call the 'MHD_connection_handle_idle()' on everything,
+     as the other event loops do.  As timeouts do not get an explicit
+     event, we need to find those connections that might have timed out
+     here.
+
+     Connections with custom timeouts are sorted by the deadline in
+     the heap, only the expired connections are looked at. */
+  now = MHD_monotonic_msec_counter ();
+  while (1)
+  {
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+    pos = MHD_connection_timeout_get_manual_first_ (daemon);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+    /* Keep in sync with connection_check_timedout() */
+    if ( (NULL == pos) ||
+         (now <= pos->tmout_node.key) )
+      break;
+    MHD_connection_handle_idle (pos);
+    if (MHD_CONNECTION_CLOSED != pos->state)
+      break; /* Not timed out (clock jump?), check on the next turn */
+    /* Closed connection is removed from the heap here to get the next
+       expired connection, it is moved to the cleanup list later. */
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+    MHD_connection_timeout_remove_ (pos);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  }
+  /* Connections with the default timeout are sorted by prepending
+     them to the head of the list whenever we touch the connection;
+     thus it suffices to iterate from the tail until the first
+     connection is NOT timed out */
+  prev = daemon->normal_timeout_tail;
+  while (NULL != (pos = prev))
+  {
+    prev = pos->prevX;
+    MHD_connection_handle_idle (pos);
+    if (MHD_CONNECTION_CLOSED != pos->state)
+      break; /* sorted by timeout, no need to visit the rest! */
+  }
+}
+
+
+/**
+ * Remove the processed connection from the "eready" list if the
+ * connection cannot make any progress until the next event.
+ *
+ * @param daemon the daemon of the connection
+ * @param pos the processed connection
+ */
+static void
+epoll_eready_update (struct MHD_Daemon *daemon,
+                     struct MHD_Connection *pos)
+{
+  if (MHD_EPOLL_STATE_IN_EREADY_EDLL ==
+      (pos->epoll_state & (MHD_EPOLL_STATE_SUSPENDED
+                           | MHD_EPOLL_STATE_IN_EREADY_EDLL)))
+  {
+    if ( ((MHD_EVENT_LOOP_INFO_READ == pos->event_loop_info) &&
+          (0 == (pos->epoll_state & MHD_EPOLL_STATE_READ_READY)) ) ||
+         ((MHD_EVENT_LOOP_INFO_WRITE == pos->event_loop_info) &&
+          (0 == (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY)) ) ||
+         (MHD_EVENT_LOOP_INFO_CLEANUP == pos->event_loop_info) )
+    {
+      EDLL_remove (daemon->eready_head,
+                   daemon->eready_tail,
+                   pos);
+      pos->epoll_state &=
+        ~((enum MHD_EpollState) MHD_EPOLL_STATE_IN_EREADY_EDLL);
+    }
+  }
+}
+
+
+/**
+ * Process the connections ready for processing in epoll mode by
+ * separate passes: first receive the data for all connections, then
+ * process all connections, then send the data for all connections.
+ * @see #MHD_OPTION_EPOLL_BATCH_PROCESSING
+ *
+ * @param daemon the daemon to process
+ */
+static void
+epoll_process_eready_batched (struct MHD_Daemon *daemon)
+{
+  struct MHD_Connection *pos;
+  struct MHD_Connection *prev;
+
+  /* The connections are not added to or removed from the "eready" list
+     by the handlers, except the suspended connections, which are
+     removed from the list and skipped by the next passes. */
+
+  /* Receive the data, close the broken connections */
+  prev = daemon->eready_tail;
+  while (NULL != (pos = prev))
+  {
+    bool read_ready;
+
+    prev = pos->prevE;
+    if (0 != (pos->epoll_state & MHD_EPOLL_STATE_ERROR))
+    {
+      call_handlers (pos,
+                     0 != (pos->epoll_state & MHD_EPOLL_STATE_READ_READY),
+                     0 != (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY),
+                     true,
+                     false);
+      continue;
+    }
+    read_ready = (0 != (pos->epoll_state & MHD_EPOLL_STATE_READ_READY));
+#ifdef HTTPS_SUPPORT
+    if (pos->tls_read_ready)
+      read_ready = true;
+#endif /* HTTPS_SUPPORT */
+    if (read_ready &&
+        (0 != (MHD_EVENT_LOOP_INFO_READ & pos->event_loop_info)))
+      MHD_connection_handle_read (pos,
+                                  false);
+  }
+
+  /* Process the received data and the external conditions */
+  prev = daemon->eready_tail;
+  while (NULL != (pos = prev))
+  {
+    prev = pos->prevE;
+    MHD_connection_handle_idle (pos);
+  }
+
+  /* Send the data */
+  prev = daemon->eready_tail;
+  while (NULL != (pos = prev))
+  {
+    prev = pos->prevE;
+    if ( (MHD_EVENT_LOOP_INFO_WRITE == pos->event_loop_info) &&
+         (0 != (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY)) )
+    {
+      MHD_connection_handle_write (pos);
+      MHD_connection_handle_idle (pos);
+    }
+  }
+
+  prev = daemon->eready_tail;
+  while (NULL != (pos = prev))
+  {
+    prev = pos->prevE;
+    if (0 != (MHD_EVENT_LOOP_INFO_PROCESS & pos->event_loop_info))
+      daemon->data_already_pending = true;
+#ifdef HTTPS_SUPPORT
+    else if ( (pos->tls_read_ready) &&
+              (0 != (MHD_EVENT_LOOP_INFO_READ & pos->event_loop_info)) )
+      daemon->data_already_pending = true;
+#endif /* HTTPS_SUPPORT */
+    epoll_eready_update (daemon,
+                         pos);
+  }
+}
+
+
+/**
+ * Process the connections ready for processing in epoll mode.
+ *
+ * @param daemon the daemon to process
+ */
+static void
+epoll_process_eready (struct MHD_Daemon *daemon)
+{
+  struct MHD_Connection *pos;
+  struct MHD_Connection *prev;
+
+  if (daemon->epoll_batched)
+  {
+    epoll_process_eready_batched (daemon);
+    return;
+  }
+
+  /* process events for connections */
+  prev = daemon->eready_tail;
+  while (NULL != (pos = prev))
+  {
+    prev = pos->prevE;
+    /* The error state is set only if the socket error was not caused by
+       the zero-copy completions, which are reaped by MHD_epoll() */
+    call_handlers (pos,
+                   0 != (pos->epoll_state & MHD_EPOLL_STATE_READ_READY),
+                   0 != (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY),
+                   0 != (pos->epoll_state & MHD_EPOLL_STATE_ERROR),
+                   false);
+    epoll_eready_update (daemon,
+                         pos);
+  }
+}
+
+
+/**
+ * Do epoll()-based processing.
+ *
+ * @param daemon daemon to run poll loop for
+ * @param millisec the maximum time in milliseconds to wait for events,
+ *                 set to '0' for non-blocking processing,
+ *                 set to '-1' to wait indefinitely.
+ * @return #MHD_NO on serious errors, #MHD_YES on success
+ */
+static enum MHD_Result
+MHD_epoll (struct MHD_Daemon *daemon,
+           int32_t millisec)
+{
+#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
+  static const char *const upgrade_marker = "upgrade_ptr";
+#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+  struct MHD_Connection *pos;
+  struct epoll_event *events;
+  struct epoll_event event;
+  int timeout_ms;
+  int num_events;
+  int events_size;
+  unsigned int wakeup_events;
+  unsigned int i;
+  MHD_socket ls;
+#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
+  bool run_upgraded = false;
+#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+  bool need_to_accept;
+  bool level_triggered;
+
+  mhd_assert ((0 == (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
+              (MHD_thread_handle_ID_is_valid_ID_ (daemon->tid)));
+  mhd_assert ((0 != (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
+              (! MHD_thread_handle_ID_is_valid_ID_ (daemon->tid)));
+  mhd_assert ((0 == (daemon->options & MHD_USE_SELECT_INTERNALLY)) || \
+              (MHD_thread_handle_ID_is_current_thread_ (daemon->tid)));
+
+  if (-1 == daemon->epoll_fd)
+    return MHD_NO; /* we're down! */
+  if (daemon->shutdown)
+    return MHD_NO;
+  if (NULL == daemon->epoll_events)
+  {
+    mhd_assert (0 != daemon->epoll_events_size);
+    daemon->epoll_events = (struct epoll_event *)
+                           malloc (sizeof (struct epoll_event)
+                                   * daemon->epoll_events_size);
+    if (NULL == daemon->epoll_events)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("Failed to allocate memory for epoll events.\n"));
+#endif
+      return MHD_NO;
+    }
+  }
+  events = daemon->epoll_events;
+  events_size = (int) daemon->epoll_events_size;
+  if ( (MHD_INVALID_SOCKET != (ls = daemon->listen_fd)) &&
+       (! daemon->was_quiesced) &&
+       (daemon->connections < daemon->connection_limit) &&
+       (! daemon->listen_socket_in_epoll) &&
+       (! daemon->at_limit) )
+  {
+    if (MHD_NO == epoll_add_listen_socket (daemon))
+      return MHD_NO;
+  }
+  if ( (daemon->was_quiesced) &&
+       (daemon->listen_socket_in_epoll) )
+  {
+    if ( (0 != epoll_ctl (daemon->epoll_fd,
+                          EPOLL_CTL_DEL,
+                          ls,
+                          NULL)) &&
+         (ENOENT != errno) )   /* ENOENT can happen due to race with
+                                  #MHD_quiesce_daemon() */
+      MHD_PANIC ("Failed to remove listen FD from epoll set.\n");
+    daemon->listen_socket_in_epoll = false;
+  }
+
+#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
+  if ( ( (! daemon->upgrade_fd_in_epoll) &&
+         (-1 != daemon->epoll_upgrade_fd) ) )
+  {
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    event.data.ptr = _MHD_DROP_CONST (upgrade_marker);
+    if (0 != epoll_ctl (daemon->epoll_fd,
+                        EPOLL_CTL_ADD,
+                        daemon->epoll_upgrade_fd,
+                        &event))
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("Call to epoll_ctl failed: %s\n"),
+                MHD_socket_last_strerr_ ());
+#endif
+      return MHD_NO;
+    }
+    daemon->upgrade_fd_in_epoll = true;
+  }
+#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+  if ( (daemon->listen_socket_in_epoll) &&
+       ( (daemon->connections == daemon->connection_limit) ||
+         (daemon->at_limit) ||
+         (daemon->was_quiesced) ) )
+  {
+    /* we're at the connection limit, disable listen socket
+ for event loop for now */
+    if (0 != epoll_ctl (daemon->epoll_fd,
+                        EPOLL_CTL_DEL,
+                        ls,
+                        NULL))
+      MHD_PANIC (_ ("Failed to remove listen FD from epoll set.\n"));
+    daemon->listen_socket_in_epoll = false;
+  }
+
   if ( (0 != (daemon->options & MHD_TEST_ALLOW_SUSPEND_RESUME)) &&
        (MHD_NO != resume_suspended_connections (daemon)) )
     millisec = 0;
@@ -5606,17 +6195,25 @@ MHD_epoll (struct MHD_Daemon *daemon,
   daemon->data_already_pending = false;
 
   need_to_accept = false;
+  wakeup_events = 0;
   /* drain 'epoll' event queue; need to iterate as we get at most
-     MAX_EVENTS in one system call here; in practice this should
+     'epoll_events_size' in one system call here; in practice this should
      pretty much mean only one round, but better an extra loop here
      than unfair behavior... */
-  num_events = MAX_EVENTS;
-  while (MAX_EVENTS == num_events)
+  num_events = events_size;
+  /* The listen socket and the upgrade epoll FD are level-triggered and
+     are reported again by every call until they are processed, stop
+     draining when any of them is reported to avoid spinning here with
+     the small events array.  The rest of the (edge-triggered) events
+     is kept by the kernel for the next turn. */
+  level_triggered = false;
+  while ( (events_size == num_events) &&
+          (! level_triggered) )
   {
     /* update event masks */
     num_events = epoll_wait (daemon->epoll_fd,
                              events,
-                             MAX_EVENTS,
+                             events_size,
                              timeout_ms);
     if (-1 == num_events)
     {
@@ -5630,6 +6227,11 @@ MHD_epoll (struct MHD_Daemon *daemon,
 #endif
       return MHD_NO;
     }
+    /* The rest of the queue is already available, do not wait */
+    timeout_ms = 0;
+    wakeup_events += (unsigned int) num_events;
+    if (events_size == num_events)
+      MHD_stats_add_ (&daemon->epoll_stats.full_batches, 1, false);
     for (i = 0; i < (unsigned int) num_events; i++)
     {
       /* First, check for the values of `ptr` that would indicate
@@ -5642,6 +6244,7 @@ MHD_epoll (struct MHD_Daemon *daemon,
         /* activity on an upgraded connection, we process
            those in a separate epoll() */
         run_upgraded = true;
+        level_triggered = true;
         continue;
       }
 #endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
@@ -5654,6 +6257,7 @@ MHD_epoll (struct MHD_Daemon *daemon,
       }
       if (daemon == events[i].data.ptr)
       {
+        level_triggered = true;
         /* Check for error conditions on listen socket. */
         /* FIXME: Initiate MHD_quiesce_daemon() to prevent busy waiting? */
         if (0 == (events[i].events & (EPOLLERR | EPOLLHUP)))
@@ -5665,7 +6269,14 @@ MHD_epoll (struct MHD_Daemon *daemon,
          connection as 'eready'. */
       pos = events[i].data.ptr;
       /* normal processing: update read/write data */
-      if (0 != (events[i].events & (EPOLLPRI | EPOLLERR | EPOLLHUP)))
+      if ( (0 != (events[i].events & (EPOLLPRI | EPOLLERR | EPOLLHUP)))
+#ifdef MHD_USE_MSG_ZEROCOPY
+           /* The completions of the zero-copy sends are reported as
+              EPOLLERR */
+           && ( (0 != (events[i].events & (EPOLLPRI | EPOLLHUP))) ||
+                ! MHD_send_zc_reap_ (pos) )
+#endif /* MHD_USE_MSG_ZEROCOPY */
+           )
       {
         pos->epoll_state |= MHD_EPOLL_STATE_ERROR;
         if (0 == (pos->epoll_state & MHD_EPOLL_STATE_IN_EREADY_EDLL))
@@ -5706,90 +6317,572 @@ MHD_epoll (struct MHD_Daemon *daemon,
       }
     }
   }
+  epoll_stats_add (daemon,
+                   wakeup_events);
+  update_loop_time (daemon);
 
   /* Process externally added connection if any */
   if (daemon->have_new)
     new_connections_list_process_ (daemon);
 
   if (need_to_accept)
+    accept_connections_series (daemon);
+
+  epoll_process_timeouts (daemon);
+
+#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
+  if (run_upgraded || (NULL != daemon->eready_urh_head))
+    run_epoll_for_upgrade (daemon);
+#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+
+  epoll_process_eready (daemon);
+
+  return MHD_YES;
+}
+
+
+#ifdef IO_URING_SUPPORT
+
+/**
+ * Detach the closed connection from the daemon's io_uring.
+ * The requests still in flight are cancelled, the connection's io_uring
+ * context is freed when the last request is completed.
+ *
+ * @param daemon the daemon of the connection
+ * @param connection the connection to detach
+ */
+static void
+uring_conn_detach (struct MHD_Daemon *daemon,
+                   struct MHD_Connection *connection)
+{
+  struct MHD_UringConn_ *const uc = connection->uring;
+  const uint64_t ud = (uint64_t) (uintptr_t) uc;
+
+  mhd_assert (NULL != daemon->uring);
+  connection->uring = NULL;
+  if (uc->has_buf)
+  {
+    uc->has_buf = false;
+    (void) MHD_uring_buf_release_ (daemon->uring,
+                                   uc->bid);
+  }
+  if (0 == uc->pending)
+  {
+    free (uc->send_buf);
+    free (uc);
+    return;
+  }
+  /* The requests keep the socket open even after close() */
+  uc->connection = NULL;
+  if (uc->recv_pending)
+    (void) MHD_uring_prep_cancel_ (daemon->uring,
+                                   ud | MHD_URING_TAG_RECV_);
+  if (uc->pollout_pending)
+    (void) MHD_uring_prep_cancel_ (daemon->uring,
+                                   ud | MHD_URING_TAG_POLLOUT_);
+  if (uc->send_pending)
+    (void) MHD_uring_prep_cancel_ (daemon->uring,
+                                   ud | MHD_URING_TAG_SEND_);
+}
+
+
+/**
+ * Put the connection to the list of the connections ready for
+ * processing.
+ *
+ * @param daemon the daemon of the connection
+ * @param connection the connection to put
+ */
+static void
+uring_conn_set_ready (struct MHD_Daemon *daemon,
+                      struct MHD_Connection *connection)
+{
+  if (0 != (connection->epoll_state & (MHD_EPOLL_STATE_IN_EREADY_EDLL
+                                       | MHD_EPOLL_STATE_SUSPENDED)))
+    return; /* Suspended connections are marked ready on resume */
+  EDLL_insert (daemon->eready_head,
+               daemon->eready_tail,
+               connection);
+  connection->epoll_state |= MHD_EPOLL_STATE_IN_EREADY_EDLL;
+}
+
+
+/**
+ * Process the completion of the connection's request.
+ *
+ * @param daemon the daemon of the connection
+ * @param uc the io_uring context of the connection
+ * @param tag the tag of the request
+ * @param res the result of the request
+ * @param flags the flags of the completion
+ */
+static void
+uring_conn_complete (struct MHD_Daemon *daemon,
+                     struct MHD_UringConn_ *uc,
+                     uint64_t tag,
+                     int res,
+                     uint32_t flags)
+{
+  struct MHD_Connection *const pos = uc->connection;
+
+  mhd_assert (0 != uc->pending);
+  uc->pending--;
+  daemon->uring_ops--;
+  if (MHD_URING_TAG_RECV_ == tag)
   {
-    unsigned int series_length = 0;
+    uc->recv_pending = false;
+    if (0 != (flags & IORING_CQE_F_BUFFER))
+    {
+      const uint16_t bid = (uint16_t) (flags >> IORING_CQE_BUFFER_SHIFT);
 
-    /* Run 'accept' until it fails or daemon at limit of connections.
-     * Do not accept more then 10 connections at once. The rest will
-     * be accepted on next turn (level trigger is used for listen
-     * socket). */
-    while ( (MHD_NO != MHD_accept_connection (daemon)) &&
-            (series_length < 10) &&
-            (daemon->connections < daemon->connection_limit) &&
-            (! daemon->at_limit) )
-      series_length++;
+      if ((NULL != pos) && (0 < res))
+      {
+        mhd_assert (! uc->has_buf);
+        uc->bid = bid;
+        uc->has_buf = true;
+        uc->data_off = 0;
+        uc->data_size = (size_t) res;
+      }
+      else
+        (void) MHD_uring_buf_release_ (daemon->uring,
+                                       bid);
+    }
+    if (NULL != pos)
+    {
+      if (0 == res)
+        uc->eof = true;
+      else if ((0 > res) &&
+               (-ENOBUFS != res) && (-EAGAIN != res) &&
+               (-EINTR != res) && (-ECANCELED != res))
+        uc->err = -res;
+      /* With ENOBUFS and similar results the data is received
+         directly from the socket */
+      pos->epoll_state |= MHD_EPOLL_STATE_READ_READY;
+      if ( (0 != (MHD_EVENT_LOOP_INFO_READ & pos->event_loop_info)) ||
+           (pos->read_buffer_size > pos->read_buffer_offset) )
+        uring_conn_set_ready (daemon,
+                              pos);
+    }
+  }
+  else if (MHD_URING_TAG_SEND_ == tag)
+  {
+    uc->send_pending = false;
+    if (NULL != pos)
+    {
+      /* The result is reported by the next send attempt */
+      uc->send_res = res;
+      uc->send_done = true;
+      pos->epoll_state |= MHD_EPOLL_STATE_WRITE_READY;
+      uring_conn_set_ready (daemon,
+                            pos);
+    }
+  }
+  else
+  {
+    mhd_assert (MHD_URING_TAG_POLLOUT_ == tag);
+    uc->pollout_pending = false;
+    if (NULL != pos)
+    {
+      if ( (0 > res) ||
+           (0 != (((unsigned int) res) & (POLLHUP | POLLNVAL))) ||
+           ( (0 != (((unsigned int) res) & POLLERR))
+#ifdef MHD_USE_MSG_ZEROCOPY
+             /* The completions of the zero-copy sends are reported as
+                POLLERR */
+             && ! MHD_send_zc_reap_ (pos)
+#endif /* MHD_USE_MSG_ZEROCOPY */
+           ) )
+      {
+        pos->epoll_state |= MHD_EPOLL_STATE_ERROR;
+        uring_conn_set_ready (daemon,
+                              pos);
+      }
+      else
+      {
+        pos->epoll_state |= MHD_EPOLL_STATE_WRITE_READY;
+        if (MHD_EVENT_LOOP_INFO_WRITE == pos->event_loop_info)
+          uring_conn_set_ready (daemon,
+                                pos);
+      }
+    }
+  }
+  if ((NULL == pos) && (0 == uc->pending))
+  {
+    free (uc->send_buf);
+    free (uc);
   }
+}
 
-  /* Handle timed-out connections; we need to do this here
-     as the epoll mechanism won't call the 'MHD_connection_handle_idle()' on everything,
-     as the other event loops do.  As timeouts do not get an explicit
-     event, we need to find those connections that might have timed out
-     here.
 
-     Connections with custom timeouts must all be looked at, as we
-     do not bother to sort that (presumably very short) list. */
-  prev = daemon->manual_timeout_tail;
-  while (NULL != (pos = prev))
+/**
+ * Process the completion of the accept request.
+ *
+ * @param daemon the daemon to process
+ * @param acc the accept request
+ * @param res the result of the request
+ */
+static void
+uring_accept_complete (struct MHD_Daemon *daemon,
+                       struct MHD_UringAccept_ *acc,
+                       int res)
+{
+  mhd_assert (acc->pending);
+  acc->pending = false;
+  acc->cancel = false;
+  daemon->uring_accepts_num--;
+  daemon->uring_ops--;
+  if (0 > res)
+  {
+    if (-ECANCELED == res)
+      return;
+    accept_error_process_ (daemon,
+                           -res);
+    return;
+  }
+  if (daemon->shutdown)
   {
-    prev = pos->prevX;
-    MHD_connection_handle_idle (pos);
+    (void) MHD_socket_close_ (res);
+    return;
   }
-  /* Connections with the default timeout are sorted by prepending
-     them to the head of the list whenever we touch the connection;
-     thus it suffices to iterate from the tail until the first
-     connection is NOT timed out */
-  prev = daemon->normal_timeout_tail;
-  while (NULL != (pos = prev))
+  /* The address has been written by the kernel together with
+     the completion, no need to call getpeername() */
+  accepted_socket_add_ (daemon,
+                        res,
+                        &acc->addr,
+                        acc->addrlen,
+                        true,
+                        false,
+                        true);
+}
+
+
+/**
+ * Process the completion from the daemon's io_uring.
+ *
+ * @param daemon the daemon to process
+ * @param ud the user data of the completion
+ * @param res the result of the request
+ * @param flags the flags of the completion
+ */
+static void
+uring_complete (struct MHD_Daemon *daemon,
+                uint64_t ud,
+                int res,
+                uint32_t flags)
+{
+  if (0 == ud)
+    return; /* The internal request */
+  if ((MHD_URING_UD_ACCEPT_ <= ud) &&
+      (MHD_URING_UD_ACCEPT_ + MHD_URING_ACCEPT_NUM_ > ud))
+    uring_accept_complete (daemon,
+                           daemon->uring_accepts
+                           + (size_t) (ud - MHD_URING_UD_ACCEPT_),
+                           res);
+  else if (MHD_URING_UD_ITC_ == ud)
+  {
+    daemon->uring_itc_pending = false;
+    daemon->uring_ops--;
+    /* It's OK to clear ITC here as all external
+       conditions will be processed later. */
+    if (0 <= res)
+      MHD_itc_clear_ (daemon->itc);
+  }
+  else
+    uring_conn_complete (daemon,
+                         (struct MHD_UringConn_ *)
+                         (uintptr_t) (ud & ~MHD_URING_TAG_MASK_),
+                         ud & MHD_URING_TAG_MASK_,
+                         res,
+                         flags);
+}
+
+
+/**
+ * Process all available completions from the daemon's io_uring.
+ *
+ * @param daemon the daemon to process
+ * @return the number of processed completions, not counting the internal
+ *         requests
+ */
+static unsigned int
+uring_process_completions (struct MHD_Daemon *daemon)
+{
+  struct io_uring_cqe *cqe;
+  unsigned int num = 0;
+
+  while (NULL != (cqe = MHD_uring_peek_cqe_ (daemon->uring)))
+  {
+    const uint64_t ud = cqe->user_data;
+    const int res = cqe->res;
+    const uint32_t flags = cqe->flags;
+
+    MHD_uring_cqe_seen_ (daemon->uring);
+    if (0 != ud)
+      ++num;
+    uring_complete (daemon,
+                    ud,
+                    res,
+                    flags);
+  }
+  return num;
+}
+
+
+/**
+ * Queue the accept and ITC requests or cancel the accept requests,
+ * depending on the daemon's state.
+ *
+ * @param daemon the daemon to process
+ * @return 'true' on success,
+ *         'false' if requests cannot be queued
+ */
+static bool
+uring_update_daemon (struct MHD_Daemon *daemon)
+{
+  struct MHD_Uring_ *const ring = daemon->uring;
+  const bool can_accept = (MHD_INVALID_SOCKET != daemon->listen_fd) &&
+                          (! daemon->was_quiesced) &&
+                          (daemon->connections < daemon->connection_limit) &&
+                          (! daemon->at_limit);
+  unsigned int i;
+
+  for (i = 0; i < MHD_URING_ACCEPT_NUM_; ++i)
+  {
+    struct MHD_UringAccept_ *const acc = daemon->uring_accepts + i;
+
+    if (can_accept && ! acc->pending)
+    {
+      /* Do not accept more connections than allowed by the limit */
+      if (daemon->connection_limit - daemon->connections
+          <= daemon->uring_accepts_num)
+        continue;
+      acc->addrlen = (socklen_t) sizeof (acc->addr);
+      memset (&acc->addr,
+              0,
+              sizeof (acc->addr));
+      if (! MHD_uring_prep_accept_ (ring,
+                                    daemon->listen_fd,
+                                    (struct sockaddr *) &acc->addr,
+                                    &acc->addrlen,
+                                    MHD_URING_UD_ACCEPT_ + i))
+        return false;
+      acc->pending = true;
+      daemon->uring_accepts_num++;
+      daemon->uring_ops++;
+    }
+    else if (! can_accept &&
+             acc->pending &&
+             ! acc->cancel)
+    {
+      /* we're at the connection limit, stop accepting for now */
+      if (! MHD_uring_prep_cancel_ (ring,
+                                    MHD_URING_UD_ACCEPT_ + i))
+        return false;
+      acc->cancel = true;
+    }
+  }
+  if (MHD_ITC_IS_VALID_ (daemon->itc) &&
+      ! daemon->uring_itc_pending)
+  {
+    if (! MHD_uring_prep_poll_ (ring,
+                                MHD_itc_r_fd_ (daemon->itc),
+                                POLLIN,
+                                MHD_URING_UD_ITC_))
+      return false;
+    daemon->uring_itc_pending = true;
+    daemon->uring_ops++;
+  }
+  return true;
+}
+
+
+/**
+ * Create the io_uring for the daemon's thread.
+ * If the ring cannot be created, the thread uses epoll.
+ * @remark To be called only from the daemon's thread.
+ *
+ * @param daemon the daemon to use
+ * @return 'true' if io_uring is used,
+ *         'false' if epoll must be used
+ */
+static bool
+uring_start (struct MHD_Daemon *daemon)
+{
+  struct MHD_Uring_ *ring;
+
+  mhd_assert (NULL == daemon->uring);
+  ring = (struct MHD_Uring_ *) malloc (sizeof (struct MHD_Uring_));
+  if (NULL == ring)
+    return false;
+  if (! MHD_uring_init_ (ring,
+                         MHD_URING_SQ_SIZE,
+                         MHD_URING_CQ_SIZE))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to create io_uring, using epoll: %s\n"),
+              MHD_strerror_ (errno));
+#endif
+    free (ring);
+    return false;
+  }
+  if (! MHD_uring_bufs_init_ (ring,
+                              MHD_URING_BUF_NUM,
+                              MHD_URING_BUF_SIZE))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to allocate io_uring buffers, using epoll.\n"));
+#endif
+    MHD_uring_deinit_ (ring);
+    free (ring);
+    return false;
+  }
+  /* The listen socket must not be in the 'epoll' set so
+     MHD_quiesce_daemon() uses ITC to wake up the thread */
+  if (daemon->listen_socket_in_epoll)
+  {
+    if ( (0 != epoll_ctl (daemon->epoll_fd,
+                          EPOLL_CTL_DEL,
+                          daemon->listen_fd,
+                          NULL)) &&
+         (ENOENT != errno) )   /* ENOENT can happen due to race with
+                                  #MHD_quiesce_daemon() */
+      MHD_PANIC (_ ("Failed to remove listen FD from epoll set.\n"));
+    daemon->listen_socket_in_epoll = false;
+  }
+  daemon->uring_ops = 0;
+  memset (daemon->uring_accepts,
+          0,
+          sizeof (daemon->uring_accepts));
+  daemon->uring_accepts_num = 0;
+  daemon->uring_itc_pending = false;
+  daemon->uring = ring;
+  return true;
+}
+
+
+/**
+ * Destroy the io_uring of the daemon's thread.
+ * Must be called after closing of all connections.
+ * @remark To be called only from the daemon's thread.
+ *
+ * @param daemon the daemon to use
+ */
+static void
+uring_stop (struct MHD_Daemon *daemon)
+{
+  struct MHD_Uring_ *const ring = daemon->uring;
+  unsigned int i;
+
+  mhd_assert (NULL == daemon->connections_head);
+  for (i = 0; i < MHD_URING_ACCEPT_NUM_; ++i)
+  {
+    const struct MHD_UringAccept_ *const acc = daemon->uring_accepts + i;
+
+    if (acc->pending && ! acc->cancel)
+      (void) MHD_uring_prep_cancel_ (ring,
+                                     MHD_URING_UD_ACCEPT_ + i);
+  }
+  if (daemon->uring_itc_pending)
+    (void) MHD_uring_prep_cancel_ (ring,
+                                   MHD_URING_UD_ITC_);
+  /* Wait for the cancelled requests, as the kernel may still write
+     to the receive buffers */
+  for (i = 0; (0 != daemon->uring_ops) && (100 > i); ++i)
+  {
+    const int res = MHD_uring_submit_and_wait_ (ring,
+                                                10);
+    if ((0 > res) && (-ETIME != res) && (-EINTR != res) && (-EBUSY != res))
+      break;
+    (void) uring_process_completions (daemon);
+  }
+  if (0 != daemon->uring_ops)
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to cancel all io_uring requests.\n"));
+#endif
+    ring->bufs = NULL; /* Leak the buffers, they could be still used */
+  }
+  MHD_uring_deinit_ (ring);
+  free (ring);
+  daemon->uring = NULL;
+}
+
+
+/**
+ * Do io_uring-based processing.
+ * The connections are processed in the same way as in epoll mode, the
+ * readiness of the sockets is detected by the completions of the
+ * requests in the ring.  The small replies are sent by the ring as well,
+ * see uring_send() in mhd_send.c.  All queued requests are submitted and
+ * the completions are waited for by the single system call.
+ * @remark To be called only from the daemon's thread.
+ *
+ * @param daemon daemon to run the loop for
+ * @return #MHD_NO on serious errors, #MHD_YES on success
+ */
+static enum MHD_Result
+MHD_uring (struct MHD_Daemon *daemon)
+{
+  int32_t millisec;
+  int timeout_ms;
+  int res;
+
+  mhd_assert (NULL != daemon->uring);
+  mhd_assert (MHD_thread_handle_ID_is_current_thread_ (daemon->tid));
+
+  if (daemon->shutdown)
+    return MHD_NO;
+  if (! uring_update_daemon (daemon))
   {
-    prev = pos->prevX;
-    MHD_connection_handle_idle (pos);
-    if (MHD_CONNECTION_CLOSED != pos->state)
-      break; /* sorted by timeout, no need to visit the rest! */
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to queue io_uring request: %s\n"),
+              MHD_strerror_ (errno));
+#endif
+    return MHD_NO;
   }
 
-#if defined(HTTPS_SUPPORT) && defined(UPGRADE_SUPPORT)
-  if (run_upgraded || (NULL != daemon->eready_urh_head))
-    run_epoll_for_upgrade (daemon);
-#endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+  millisec = -1;
+  if ( (0 != (daemon->options & MHD_TEST_ALLOW_SUSPEND_RESUME)) &&
+       (MHD_NO != resume_suspended_connections (daemon)) )
+    millisec = 0;
 
-  /* process events for connections */
-  prev = daemon->eready_tail;
-  while (NULL != (pos = prev))
+  timeout_ms = get_timeout_millisec_int (daemon, millisec);
+
+  /* Reset. New value will be set when connections are processed. */
+  daemon->data_already_pending = false;
+
+  res = MHD_uring_submit_and_wait_ (daemon->uring,
+                                    (int32_t) timeout_ms);
+  if ((0 > res) && (-ETIME != res) && (-EINTR != res) && (-EBUSY != res))
   {
-    prev = pos->prevE;
-    call_handlers (pos,
-                   0 != (pos->epoll_state & MHD_EPOLL_STATE_READ_READY),
-                   0 != (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY),
-                   0 != (pos->epoll_state & MHD_EPOLL_STATE_ERROR));
-    if (MHD_EPOLL_STATE_IN_EREADY_EDLL ==
-        (pos->epoll_state & (MHD_EPOLL_STATE_SUSPENDED
-                             | MHD_EPOLL_STATE_IN_EREADY_EDLL)))
-    {
-      if ( ((MHD_EVENT_LOOP_INFO_READ == pos->event_loop_info) &&
-            (0 == (pos->epoll_state & MHD_EPOLL_STATE_READ_READY)) ) ||
-           ((MHD_EVENT_LOOP_INFO_WRITE == pos->event_loop_info) &&
-            (0 == (pos->epoll_state & MHD_EPOLL_STATE_WRITE_READY)) ) ||
-           (MHD_EVENT_LOOP_INFO_CLEANUP == pos->event_loop_info) )
-      {
-        EDLL_remove (daemon->eready_head,
-                     daemon->eready_tail,
-                     pos);
-        pos->epoll_state &=
-          ~((enum MHD_EpollState) MHD_EPOLL_STATE_IN_EREADY_EDLL);
-      }
-    }
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Call to io_uring_enter failed: %s\n"),
+              MHD_strerror_ (-res));
+#endif
+    return MHD_NO;
   }
+  update_loop_time (daemon);
+  epoll_stats_add (daemon,
+                   uring_process_completions (daemon));
+
+  /* Process externally added connection if any */
+  if (daemon->have_new)
+    new_connections_list_process_ (daemon);
+
+  epoll_process_timeouts (daemon);
+  epoll_process_eready (daemon);
 
   return MHD_YES;
 }
 
 
+#endif /* IO_URING_SUPPORT */
+
 #endif
 
 
@@ -5957,14 +7050,7 @@ close_connection (struct MHD_Connection *pos)
 #endif
   mhd_assert (! pos->suspended);
   mhd_assert (! pos->resuming);
-  if (pos->connection_timeout_ms == daemon->connection_timeout_ms)
-    XDLL_remove (daemon->normal_timeout_head,
-                 daemon->normal_timeout_tail,
-                 pos);
-  else
-    XDLL_remove (daemon->manual_timeout_head,
-                 daemon->manual_timeout_tail,
-                 pos);
+  MHD_connection_timeout_remove_ (pos);
   DLL_remove (daemon->connections_head,
               daemon->connections_tail,
               pos);
@@ -6013,6 +7099,11 @@ MHD_polling_thread (void *cls)
               MHD_strerror_ (errno));
 #endif /* HAVE_MESSAGES */
 #endif /* HAVE_PTHREAD_SIGMASK */
+#ifdef IO_URING_SUPPORT
+  /* The ring is created by the thread that uses it */
+  if (MHD_D_IS_USING_IO_URING_ (daemon))
+    (void) uring_start (daemon);
+#endif /* IO_URING_SUPPORT */
   while (! daemon->shutdown)
   {
 #ifdef HAVE_POLL
@@ -6020,6 +7111,11 @@ MHD_polling_thread (void *cls)
       MHD_poll (daemon, MHD_YES);
     else
 #endif /* HAVE_POLL */
+#ifdef IO_URING_SUPPORT
+    if (NULL != daemon->uring)
+      MHD_uring (daemon);
+    else
+#endif /* IO_URING_SUPPORT */
 #ifdef EPOLL_SUPPORT
     if (MHD_D_IS_USING_EPOLL_ (daemon))
       MHD_epoll (daemon, -1);
@@ -6035,6 +7131,10 @@ MHD_polling_thread (void *cls)
   if (0 != (MHD_TEST_ALLOW_SUSPEND_RESUME & daemon->options))
     resume_suspended_connections (daemon);
   close_all_connections (daemon);
+#ifdef IO_URING_SUPPORT
+  if (NULL != daemon->uring)
+    uring_stop (daemon);
+#endif /* IO_URING_SUPPORT */
 
   return (MHD_THRD_RTRN_TYPE_) 0;
 }
@@ -6179,7 +7279,7 @@ MHD_quiesce_daemon (struct MHD_Daemon *daemon)
       {
         if (0 != epoll_ctl (daemon->worker_pool[i].epoll_fd,
                             EPOLL_CTL_DEL,
-                            ret,
+                            daemon->worker_pool[i].listen_fd,
                             NULL))
           MHD_PANIC (_ ("Failed to remove listen FD from epoll set.\n"));
         daemon->worker_pool[i].listen_socket_in_epoll = false;
@@ -6192,6 +7292,13 @@ MHD_quiesce_daemon (struct MHD_Daemon *daemon)
           MHD_PANIC (_ ("Failed to signal quiesce via inter-thread " \
                         "communication channel.\n"));
       }
+#ifdef MHD_USE_LISTEN_SHARDING
+      /* Stop the kernel from routing new connections to the worker socket.
+         The socket itself is closed when the daemon is stopped. */
+      if (daemon->worker_pool[i].listen_is_shard)
+        (void) shutdown (daemon->worker_pool[i].listen_fd,
+                         SHUT_RDWR);
+#endif /* MHD_USE_LISTEN_SHARDING */
     }
 #endif
   daemon->was_quiesced = true;
@@ -7094,6 +8201,88 @@ parse_options_va (struct MHD_Daemon *daemon,
       daemon->listen_backlog_size = va_arg (ap,
                                             unsigned int);
       break;
+    case MHD_OPTION_LISTEN_SHARDING:
+      uv = va_arg (ap,
+                   unsigned int);
+#ifdef MHD_USE_LISTEN_SHARDING
+      if (((unsigned int) MHD_LISTEN_SHARDING_REUSEPORT_CPU) < uv)
+      {
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (daemon,
+                  _ ("Invalid value (%u) specified for " \
+                     "MHD_OPTION_LISTEN_SHARDING.\n"),
+                  uv);
+#endif /* HAVE_MESSAGES */
+        return MHD_NO;
+      }
+      daemon->listen_sharding = (enum MHD_ListenSharding) uv;
+#else  /* ! MHD_USE_LISTEN_SHARDING */
+      if (((unsigned int) MHD_LISTEN_SHARDING_NONE) != uv)
+      {
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (daemon,
+                  _ ("Separate listening sockets for the worker threads " \
+                     "are not supported on this platform.\n"));
+#endif /* HAVE_MESSAGES */
+        return MHD_NO;
+      }
+#endif /* ! MHD_USE_LISTEN_SHARDING */
+      break;
+    case MHD_OPTION_ACCEPT_BATCH_SIZE:
+      daemon->accept_batch_size = va_arg (ap,
+                                          unsigned int);
+      break;
+    case MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE:
+#ifdef EPOLL_SUPPORT
+      daemon->listen_epoll_exclusive = (0 != va_arg (ap,
+                                                     int));
+#else  /* ! EPOLL_SUPPORT */
+      (void) va_arg (ap,
+                     int);
+#endif /* ! EPOLL_SUPPORT */
+      break;
+    case MHD_OPTION_EPOLL_EVENTS_SIZE:
+#ifdef EPOLL_SUPPORT
+      daemon->epoll_events_size = va_arg (ap,
+                                          unsigned int);
+      if (MHD_EPOLL_EVENTS_SIZE_MAX < daemon->epoll_events_size)
+        daemon->epoll_events_size = MHD_EPOLL_EVENTS_SIZE_MAX;
+#else  /* ! EPOLL_SUPPORT */
+      (void) va_arg (ap,
+                     unsigned int);
+#endif /* ! EPOLL_SUPPORT */
+      break;
+    case MHD_OPTION_EPOLL_BATCH_PROCESSING:
+#ifdef EPOLL_SUPPORT
+      daemon->epoll_batched = (0 != va_arg (ap,
+                                            int));
+#else  /* ! EPOLL_SUPPORT */
+      (void) va_arg (ap,
+                     int);
+#endif /* ! EPOLL_SUPPORT */
+      break;
+    case MHD_OPTION_COARSE_ACTIVITY_TIME:
+      daemon->coarse_time = (0 != va_arg (ap,
+                                          int));
+      break;
+    case MHD_OPTION_CONNECTION_MEMORY_POOL_CACHE:
+      /* Only the limit is set here, the cache is initialised later */
+      daemon->pool_cache.max_num = va_arg (ap,
+                                           unsigned int);
+      break;
+    case MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB:
+      /* Only the size is set here, the cache is initialised later */
+      daemon->pool_cache.slab_num = va_arg (ap,
+                                            unsigned int);
+      break;
+    case MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS:
+      daemon->adaptive_bufs = (0 != va_arg (ap,
+                                            int));
+      break;
+    case MHD_OPTION_CONNECTION_PHASE_TIMING:
+      daemon->phase_timing = (0 != va_arg (ap,
+                                           int));
+      break;
     case MHD_OPTION_STRICT_FOR_CLIENT:
       daemon->client_discipline = va_arg (ap, int); /* Temporal assignment */
       /* Map to correct value */
@@ -7137,6 +8326,7 @@ parse_options_va (struct MHD_Daemon *daemon,
         case MHD_OPTION_CONNECTION_MEMORY_LIMIT:
         case MHD_OPTION_CONNECTION_MEMORY_INCREMENT:
         case MHD_OPTION_THREAD_STACK_SIZE:
+        case MHD_OPTION_SEND_ZEROCOPY_THRESHOLD:
           if (MHD_NO == parse_options (daemon,
                                        params,
                                        opt,
@@ -7156,6 +8346,14 @@ parse_options_va (struct MHD_Daemon *daemon,
         case MHD_OPTION_SERVER_INSANITY:
         case MHD_OPTION_DIGEST_AUTH_NONCE_BIND_TYPE:
         case MHD_OPTION_DIGEST_AUTH_DEFAULT_NONCE_TIMEOUT:
+        case MHD_OPTION_LISTEN_SHARDING:
+        case MHD_OPTION_ACCEPT_BATCH_SIZE:
+        case MHD_OPTION_EPOLL_EVENTS_SIZE:
+        case MHD_OPTION_CONNECTION_MEMORY_POOL_CACHE:
+        case MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB:
+        case MHD_OPTION_HTTPS_SESSION_TICKETS:
+        case MHD_OPTION_HTTPS_SESSION_CACHE:
+        case MHD_OPTION_HTTPS_HANDSHAKE_THREADS:
           if (MHD_NO == parse_options (daemon,
                                        params,
                                        opt,
@@ -7188,7 +8386,14 @@ parse_options_va (struct MHD_Daemon *daemon,
         case MHD_OPTION_CLIENT_DISCIPLINE_LVL:
         case MHD_OPTION_SIGPIPE_HANDLED_BY_APP:
         case MHD_OPTION_TLS_NO_ALPN:
+        case MHD_OPTION_HTTPS_KTLS:
         case MHD_OPTION_APP_FD_SETSIZE:
+        case MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE:
+        case MHD_OPTION_EPOLL_BATCH_PROCESSING:
+        case MHD_OPTION_COARSE_ACTIVITY_TIME:
+        case MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS:
+        case MHD_OPTION_CONNECTION_PHASE_TIMING:
+        case MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK:
           if (MHD_NO == parse_options (daemon,
                                        params,
                                        opt,
@@ -7314,6 +8519,103 @@ parse_options_va (struct MHD_Daemon *daemon,
                   (int) opt);
 #endif /* HAVE_MESSAGES */
       break;
+    case MHD_OPTION_HTTPS_KTLS:
+#ifdef HTTPS_SUPPORT
+      daemon->https_ktls = (va_arg (ap,
+                                    int) != 0);
+#if defined(HAVE_MESSAGES) && ! defined(HAVE_GNUTLS_KTLS)
+      if (daemon->https_ktls && (0 != (daemon->options & MHD_USE_TLS)))
+        MHD_DLOG (daemon,
+                  _ ("Kernel TLS is not supported by the GnuTLS version used " \
+                     "to build MHD, the option is ignored.\n"));
+#endif /* HAVE_MESSAGES && ! HAVE_GNUTLS_KTLS */
+#else  /* ! HTTPS_SUPPORT */
+      (void) va_arg (ap, int);
+#endif /* ! HTTPS_SUPPORT */
+#ifdef HAVE_MESSAGES
+      if (0 == (daemon->options & MHD_USE_TLS))
+        MHD_DLOG (daemon,
+                  _ ("MHD HTTPS option %d passed to MHD " \
+                     "but MHD_USE_TLS not set.\n"),
+                  (int) opt);
+#endif /* HAVE_MESSAGES */
+      break;
+    case MHD_OPTION_HTTPS_SESSION_TICKETS:
+#ifdef HTTPS_SUPPORT
+      daemon->tls_tickets_lifetime = va_arg (ap,
+                                             unsigned int);
+#else  /* ! HTTPS_SUPPORT */
+      (void) va_arg (ap, unsigned int);
+#endif /* ! HTTPS_SUPPORT */
+#ifdef HAVE_MESSAGES
+      if (0 == (daemon->options & MHD_USE_TLS))
+        MHD_DLOG (daemon,
+                  _ ("MHD HTTPS option %d passed to MHD " \
+                     "but MHD_USE_TLS not set.\n"),
+                  (int) opt);
+#endif /* HAVE_MESSAGES */
+      break;
+    case MHD_OPTION_HTTPS_SESSION_CACHE:
+#ifdef HTTPS_SUPPORT
+      daemon->tls_sess_cache_size = va_arg (ap,
+                                            unsigned int);
+#else  /* ! HTTPS_SUPPORT */
+      (void) va_arg (ap, unsigned int);
+#endif /* ! HTTPS_SUPPORT */
+#ifdef HAVE_MESSAGES
+      if (0 == (daemon->options & MHD_USE_TLS))
+        MHD_DLOG (daemon,
+                  _ ("MHD HTTPS option %d passed to MHD " \
+                     "but MHD_USE_TLS not set.\n"),
+                  (int) opt);
+#endif /* HAVE_MESSAGES */
+      break;
+    case MHD_OPTION_HTTPS_HANDSHAKE_THREADS:
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+      daemon->tls_hs_threads = va_arg (ap,
+                                       unsigned int);
+#else  /* ! HTTPS_SUPPORT || ! MHD_USE_THREADS */
+      if (0 != va_arg (ap, unsigned int))
+      {
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (daemon,
+                  _ ("The TLS handshake threads are not supported by this " \
+                     "MHD build, the option is ignored.\n"));
+#endif /* HAVE_MESSAGES */
+      }
+#endif /* ! HTTPS_SUPPORT || ! MHD_USE_THREADS */
+#ifdef HAVE_MESSAGES
+      if (0 == (daemon->options & MHD_USE_TLS))
+        MHD_DLOG (daemon,
+                  _ ("MHD HTTPS option %d passed to MHD " \
+                     "but MHD_USE_TLS not set.\n"),
+                  (int) opt);
+#endif /* HAVE_MESSAGES */
+      break;
+    case MHD_OPTION_SEND_ZEROCOPY_THRESHOLD:
+#ifdef MHD_USE_MSG_ZEROCOPY
+      daemon->zerocopy_threshold = va_arg (ap,
+                                           size_t);
+#else  /* ! MHD_USE_MSG_ZEROCOPY */
+      if (0 != va_arg (ap, size_t))
+      {
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (daemon,
+                  _ ("MSG_ZEROCOPY is not supported by this MHD build, " \
+                     "the option is ignored.\n"));
+#endif /* HAVE_MESSAGES */
+      }
+#endif /* ! MHD_USE_MSG_ZEROCOPY */
+      break;
+    case MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK:
+#if defined(_MHD_HAVE_SENDFILE)
+      daemon->sendfile_adaptive = (0 != va_arg (ap,
+                                                int));
+#else  /* ! _MHD_HAVE_SENDFILE */
+      (void) va_arg (ap,
+                     int);
+#endif /* ! _MHD_HAVE_SENDFILE */
+      break;
     case MHD_OPTION_APP_FD_SETSIZE:
       params->fdset_size_set = true;
       params->fdset_size = va_arg (ap,
@@ -7403,12 +8705,11 @@ static enum MHD_Result
 setup_epoll_to_listen (struct MHD_Daemon *daemon)
 {
   struct epoll_event event;
-  MHD_socket ls;
 
   mhd_assert (MHD_D_IS_USING_EPOLL_ (daemon));
   mhd_assert (0 == (daemon->options & MHD_USE_THREAD_PER_CONNECTION));
   mhd_assert ( (! MHD_D_IS_USING_THREADS_ (daemon)) || \
-               (MHD_INVALID_SOCKET != (ls = daemon->listen_fd)) || \
+               (MHD_INVALID_SOCKET != daemon->listen_fd) || \
                MHD_ITC_IS_VALID_ (daemon->itc) );
   daemon->epoll_fd = setup_epoll_fd (daemon);
   if (! MHD_D_IS_USING_THREADS_ (daemon)
@@ -7440,14 +8741,20 @@ setup_epoll_to_listen (struct MHD_Daemon *daemon)
       return MHD_NO;
   }
 #endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
-  if ( (MHD_INVALID_SOCKET != (ls = daemon->listen_fd)) &&
+  if ( (MHD_INVALID_SOCKET != daemon->listen_fd) &&
        (! daemon->was_quiesced) )
+  {
+    if (MHD_NO == epoll_add_listen_socket (daemon))
+      return MHD_NO;
+  }
+
+  if (MHD_ITC_IS_VALID_ (daemon->itc))
   {
     event.events = EPOLLIN | EPOLLRDHUP;
-    event.data.ptr = daemon;
+    event.data.ptr = _MHD_DROP_CONST (epoll_itc_marker);
     if (0 != epoll_ctl (daemon->epoll_fd,
                         EPOLL_CTL_ADD,
-                        ls,
+                        MHD_itc_r_fd_ (daemon->itc),
                         &event))
     {
 #ifdef HAVE_MESSAGES
@@ -7457,31 +8764,260 @@ setup_epoll_to_listen (struct MHD_Daemon *daemon)
 #endif
       return MHD_NO;
     }
-    daemon->listen_socket_in_epoll = true;
   }
+  return MHD_YES;
+}
+
+
+#endif
+
+
+#ifdef MHD_USE_LISTEN_SHARDING
+/**
+ * Create an additional listening socket for the worker daemon.
+ * The new socket is bound to the same address as the listening socket
+ * of the master daemon and joins the same SO_REUSEPORT group.
+ * @remark To be called only from MHD_start_daemon_va()
+ *
+ * @param daemon the master daemon
+ * @param worker_idx the index of the worker in the thread pool
+ * @return the new listening socket on success,
+ *         #MHD_INVALID_SOCKET on failure
+ */
+static MHD_socket
+create_listen_shard_ (struct MHD_Daemon *daemon,
+                      unsigned int worker_idx)
+{
+  const MHD_SCKT_OPT_BOOL_ on = 1;
+  struct sockaddr_storage bindaddr;
+  socklen_t addrlen;
+  MHD_socket fd;
+
+  mhd_assert (NULL == daemon->master);
+  mhd_assert (MHD_INVALID_SOCKET != daemon->listen_fd);
+  mhd_assert (MHD_LISTEN_SHARDING_NONE != daemon->listen_sharding);
+#ifndef SO_INCOMING_CPU
+  (void) worker_idx; /* Mute compiler warning */
+#endif /* ! SO_INCOMING_CPU */
+
+  memset (&bindaddr,
+          0,
+          sizeof (struct sockaddr_storage));
+  addrlen = (socklen_t) sizeof (struct sockaddr_storage);
+#ifdef HAVE_STRUCT_SOCKADDR_STORAGE_SS_LEN
+  bindaddr.ss_len = (socklen_t) addrlen;
+#endif
+  if ( (0 != getsockname (daemon->listen_fd,
+                          (struct sockaddr *) &bindaddr,
+                          &addrlen)) ||
+       (((socklen_t) sizeof (bindaddr)) < addrlen) ||
+       (0 == addrlen) )
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to get the address of the listening socket: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    return MHD_INVALID_SOCKET;
+  }
+
+  fd = MHD_socket_create_listen_ (bindaddr.ss_family);
+  if (MHD_INVALID_SOCKET == fd)
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to create socket for listening: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    return MHD_INVALID_SOCKET;
+  }
+  if (MHD_D_IS_USING_SELECT_ (daemon) &&
+      (! MHD_D_DOES_SCKT_FIT_FDSET_ (fd, daemon)) )
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Listen socket descriptor (%d) is not " \
+                 "less than daemon FD_SETSIZE value (%d).\n"),
+              (int) fd,
+              (int) MHD_D_GET_FD_SETSIZE_ (daemon));
+#endif /* HAVE_MESSAGES */
+    MHD_socket_close_chk_ (fd);
+    return MHD_INVALID_SOCKET;
+  }
+  if (0 > setsockopt (fd,
+                      SOL_SOCKET,
+                      SO_REUSEADDR,
+                      (const void *) &on,
+                      sizeof (on)))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("setsockopt failed: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+  }
+  if (0 > setsockopt (fd,
+                      SOL_SOCKET,
+                      MHD_SO_REUSEPORT_BALANCED,
+                      (const void *) &on,
+                      sizeof (on)))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("setsockopt failed: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    MHD_socket_close_chk_ (fd);
+    return MHD_INVALID_SOCKET;
+  }
+#if defined(HAVE_INET6) && defined(IPPROTO_IPV6) && defined(IPV6_V6ONLY)
+  if (AF_INET6 == bindaddr.ss_family)
+  {
+    const MHD_SCKT_OPT_BOOL_ v6_only =
+      (MHD_USE_DUAL_STACK != (daemon->options & MHD_USE_DUAL_STACK));
+    if (0 > setsockopt (fd,
+                        IPPROTO_IPV6, IPV6_V6ONLY,
+                        (const void *) &v6_only,
+                        sizeof (v6_only)))
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("setsockopt failed: %s\n"),
+                MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    }
+  }
+#endif /* HAVE_INET6 && IPPROTO_IPV6 && IPV6_V6ONLY */
+#ifdef SO_INCOMING_CPU
+  if (MHD_LISTEN_SHARDING_REUSEPORT_CPU == daemon->listen_sharding)
+  {
+    const int cpu = (int) worker_idx;
+    /* Failure is not critical, the kernel balances connections anyway */
+    (void) setsockopt (fd,
+                       SOL_SOCKET,
+                       SO_INCOMING_CPU,
+                       (const void *) &cpu,
+                       sizeof (cpu));
+  }
+#endif /* SO_INCOMING_CPU */
+  if (0 != bind (fd,
+                 (struct sockaddr *) &bindaddr,
+                 addrlen))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to bind worker listening socket to port %u: %s\n"),
+              (unsigned int) daemon->port,
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    MHD_socket_close_chk_ (fd);
+    return MHD_INVALID_SOCKET;
+  }
+#ifdef TCP_FASTOPEN
+  if (0 != (daemon->options & MHD_USE_TCP_FASTOPEN))
+  {
+    if (0 != setsockopt (fd,
+                         IPPROTO_TCP,
+                         TCP_FASTOPEN,
+                         (const void *) &daemon->fastopen_queue_size,
+                         sizeof (daemon->fastopen_queue_size)))
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("setsockopt failed: %s\n"),
+                MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    }
+  }
+#endif /* TCP_FASTOPEN */
+  if (0 != listen (fd,
+                   (int) daemon->listen_backlog_size))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to listen for connections: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    MHD_socket_close_chk_ (fd);
+    return MHD_INVALID_SOCKET;
+  }
+  if (! MHD_socket_nonblocking_ (fd))
+  {
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("Failed to set nonblocking mode on listening socket: %s\n"),
+              MHD_socket_last_strerr_ ());
+#endif /* HAVE_MESSAGES */
+    MHD_socket_close_chk_ (fd);
+    return MHD_INVALID_SOCKET;
+  }
+  return fd;
+}
+
 
-  if (MHD_ITC_IS_VALID_ (daemon->itc))
+/**
+ * Ask the kernel to pick the listening socket from the SO_REUSEPORT group
+ * by the number of the CPU that processes the incoming packet.
+ * Failures are not critical: the kernel balances connections by hash
+ * of the addresses anyway.
+ * @remark To be called only from MHD_start_daemon_va()
+ *
+ * @param daemon the master daemon
+ */
+static void
+setup_listen_shards_cpu_steering_ (struct MHD_Daemon *daemon)
+{
+  mhd_assert (NULL == daemon->master);
+  mhd_assert (MHD_INVALID_SOCKET != daemon->listen_fd);
+  mhd_assert (MHD_LISTEN_SHARDING_REUSEPORT_CPU == daemon->listen_sharding);
+  mhd_assert (2 <= daemon->worker_pool_size);
+#ifdef SO_INCOMING_CPU
+  if (1)
   {
-    event.events = EPOLLIN | EPOLLRDHUP;
-    event.data.ptr = _MHD_DROP_CONST (epoll_itc_marker);
-    if (0 != epoll_ctl (daemon->epoll_fd,
-                        EPOLL_CTL_ADD,
-                        MHD_itc_r_fd_ (daemon->itc),
-                        &event))
+    static const int cpu = 0;
+    (void) setsockopt (daemon->listen_fd,
+                       SOL_SOCKET,
+                       SO_INCOMING_CPU,
+                       (const void *) &cpu,
+                       sizeof (cpu));
+  }
+#endif /* SO_INCOMING_CPU */
+#if defined(HAVE_LINUX_FILTER_H) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (1)
+  {
+    /* The sockets are added to the group in the order of the workers,
+     * the program returns the index of the socket in the group. */
+    struct sock_filter code[] = {
+      /* A = number of the current CPU */
+      { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t) (SKF_AD_OFF + SKF_AD_CPU) },
+      /* A = A % number of the workers */
+      { BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint32_t) daemon->worker_pool_size },
+      /* return A */
+      { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog prog;
+
+    prog.len = (unsigned short) (sizeof (code) / sizeof (code[0]));
+    prog.filter = code;
+    if (0 != setsockopt (daemon->listen_fd,
+                         SOL_SOCKET,
+                         SO_ATTACH_REUSEPORT_CBPF,
+                         (const void *) &prog,
+                         sizeof (prog)))
     {
 #ifdef HAVE_MESSAGES
       MHD_DLOG (daemon,
-                _ ("Call to epoll_ctl failed: %s\n"),
+                _ ("Failed to attach CPU steering program to the listening " \
+                   "socket: %s\n"),
                 MHD_socket_last_strerr_ ());
-#endif
-      return MHD_NO;
+#endif /* HAVE_MESSAGES */
     }
   }
-  return MHD_YES;
+#endif /* HAVE_LINUX_FILTER_H && SO_ATTACH_REUSEPORT_CBPF */
 }
 
 
-#endif
+#endif /* MHD_USE_LISTEN_SHARDING */
 
 
 /**
@@ -7731,6 +9267,13 @@ MHD_start_daemon_va (unsigned int flags,
     return NULL;
 
   /* Check for invalid combinations of flags. */
+  if (0 != (*pflags & MHD_USE_IO_URING))
+  {
+    if ((0 == (*pflags & MHD_USE_INTERNAL_POLLING_THREAD)) ||
+        (0 != (*pflags & MHD_USE_THREAD_PER_CONNECTION)))
+      return NULL;
+    *pflags |= MHD_USE_EPOLL; /* Used as a fallback */
+  }
   if ((0 != (*pflags & MHD_USE_POLL)) && (0 != (*pflags & MHD_USE_EPOLL)))
     return NULL;
   if ((0 != (*pflags & MHD_USE_EPOLL)) &&
@@ -7918,6 +9461,28 @@ MHD_start_daemon_va (unsigned int flags,
           || (NULL != daemon->notify_connection)) )
     *pflags |= MHD_USE_ITC; /* requires ITC */
 
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+  if (0 != daemon->tls_hs_threads)
+  {
+    if ( (0 == (*pflags & MHD_USE_TLS)) ||
+         (! MHD_D_IS_USING_THREADS_ (daemon)) ||
+         MHD_D_IS_USING_THREAD_PER_CONN_ (daemon) )
+    {
+#ifdef HAVE_MESSAGES
+      if (0 != (*pflags & MHD_USE_TLS))
+        MHD_DLOG (daemon,
+                  _ ("The TLS handshake threads can be used only with " \
+                     "the internal polling thread(s) without " \
+                     "MHD_USE_THREAD_PER_CONNECTION, " \
+                     "the option is ignored.\n"));
+#endif /* HAVE_MESSAGES */
+      daemon->tls_hs_threads = 0;
+    }
+    else
+      *pflags |= MHD_ALLOW_SUSPEND_RESUME; /* Used to park the connections */
+  }
+#endif /* HTTPS_SUPPORT && MHD_USE_THREADS */
+
 #ifdef _DEBUG
 #ifdef HAVE_MESSAGES
   MHD_DLOG (daemon,
@@ -7925,6 +9490,37 @@ MHD_start_daemon_va (unsigned int flags,
 #endif /* HAVE_MESSAGES */
 #endif /* _DEBUG */
 
+  if (0 != (*pflags & MHD_USE_IO_URING))
+  {
+#ifdef IO_URING_SUPPORT
+    const char *no_uring_reason = NULL;
+#ifdef HTTPS_SUPPORT
+    if (0 != (*pflags & MHD_USE_TLS))
+      no_uring_reason = _ ("TLS is used");
+    else
+#endif /* HTTPS_SUPPORT */
+    if (! MHD_uring_is_supported_ ())
+      no_uring_reason = _ ("the kernel does not support io_uring or " \
+                           "it is not permitted");
+    if (NULL != no_uring_reason)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("io_uring is not used as %s, using epoll.\n"),
+                no_uring_reason);
+#endif /* HAVE_MESSAGES */
+      *pflags &= ~((enum MHD_FLAG) MHD_USE_IO_URING);
+    }
+#else  /* ! IO_URING_SUPPORT */
+#ifdef HAVE_MESSAGES
+    MHD_DLOG (daemon,
+              _ ("io_uring support is not enabled in this build of " \
+                 "MHD, using epoll.\n"));
+#endif /* HAVE_MESSAGES */
+    *pflags &= ~((enum MHD_FLAG) MHD_USE_IO_URING);
+#endif /* ! IO_URING_SUPPORT */
+  }
+
   if ( (0 != (*pflags & MHD_USE_ITC))
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
        && (0 == daemon->worker_pool_size)
@@ -8051,6 +9647,85 @@ MHD_start_daemon_va (unsigned int flags,
   }
 #endif
 
+#ifdef MHD_USE_LISTEN_SHARDING
+  if (MHD_LISTEN_SHARDING_NONE != daemon->listen_sharding)
+  {
+    if (0 == daemon->worker_pool_size)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD_OPTION_LISTEN_SHARDING is ignored as thread pool " \
+                   "is not used.\n"));
+#endif /* HAVE_MESSAGES */
+      daemon->listen_sharding = MHD_LISTEN_SHARDING_NONE;
+    }
+    else if (MHD_INVALID_SOCKET != daemon->listen_fd)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD_OPTION_LISTEN_SHARDING is ignored as application " \
+                   "provided the listen socket.\n"));
+#endif /* HAVE_MESSAGES */
+      daemon->listen_sharding = MHD_LISTEN_SHARDING_NONE;
+    }
+    else if (0 != (*pflags & MHD_USE_NO_LISTEN_SOCKET))
+      daemon->listen_sharding = MHD_LISTEN_SHARDING_NONE;
+    else if (0 > daemon->listening_address_reuse)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD_OPTION_LISTEN_SHARDING cannot be used together " \
+                   "with the exclusive address use.\n"));
+#endif /* HAVE_MESSAGES */
+      goto free_and_fail;
+    }
+    else
+    {
+      /* Each worker listens on its own socket, the listen socket shutdown
+         cannot be used to signal all workers. */
+      *pflags |= MHD_USE_ITC;
+      daemon->options |= MHD_USE_ITC;
+    }
+  }
+#endif /* MHD_USE_LISTEN_SHARDING */
+
+  if (0 == daemon->accept_batch_size)
+    daemon->accept_batch_size = MHD_ACCEPT_BATCH_SIZE_DEFAULT;
+  if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
+    daemon->coarse_time = false; /* Every connection has its own loop */
+  daemon->loop_time = MHD_monotonic_msec_counter ();
+  if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
+  {
+    /* Pools are freed in connection threads */
+    daemon->pool_cache.max_num = 0;
+    daemon->pool_cache.slab_num = 0;
+    /* The learned values would be shared by the connection threads */
+    daemon->adaptive_bufs = false;
+  }
+  MHD_pool_cache_init (&daemon->pool_cache,
+                       daemon->pool_size,
+                       daemon->pool_cache.max_num,
+                       daemon->pool_cache.slab_num);
+#ifdef EPOLL_SUPPORT
+  if (0 == daemon->epoll_events_size)
+    daemon->epoll_events_size = MAX_EVENTS;
+#endif /* EPOLL_SUPPORT */
+#ifdef EPOLL_SUPPORT
+  if (daemon->listen_epoll_exclusive)
+  {
+    if ( (! MHD_D_IS_USING_EPOLL_ (daemon)) ||
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+         (0 == daemon->worker_pool_size) ||
+#endif /* MHD_USE_POSIX_THREADS || MHD_USE_W32_THREADS */
+         (0 != (*pflags & MHD_USE_NO_LISTEN_SOCKET)) )
+      daemon->listen_epoll_exclusive = false; /* Nothing to share */
+#ifdef MHD_USE_LISTEN_SHARDING
+    else if (MHD_LISTEN_SHARDING_NONE != daemon->listen_sharding)
+      daemon->listen_epoll_exclusive = false; /* Sockets are not shared */
+#endif /* MHD_USE_LISTEN_SHARDING */
+  }
+#endif /* EPOLL_SUPPORT */
+
   if ( (MHD_INVALID_SOCKET == daemon->listen_fd) &&
        (0 == (*pflags & MHD_USE_NO_LISTEN_SOCKET)) )
   {
@@ -8395,6 +10070,44 @@ MHD_start_daemon_va (unsigned int flags,
 #endif /* MHD_WINSOCK_SOCKETS */
     }
 
+#ifdef MHD_USE_LISTEN_SHARDING
+    if (MHD_LISTEN_SHARDING_NONE != daemon->listen_sharding)
+    {
+      if ( (PF_INET == domain)
+#ifdef HAVE_INET6
+           || (PF_INET6 == domain)
+#endif /* HAVE_INET6 */
+           )
+      {
+        /* All workers' sockets must be in the same balancing group */
+        if (0 > setsockopt (listen_fd,
+                            SOL_SOCKET,
+                            MHD_SO_REUSEPORT_BALANCED,
+                            (const void *) &on,
+                            sizeof (on)))
+        {
+#ifdef HAVE_MESSAGES
+          MHD_DLOG (daemon,
+                    _ ("setsockopt failed: %s\n"),
+                    MHD_socket_last_strerr_ ());
+#endif
+          MHD_socket_close_chk_ (listen_fd);
+          listen_fd = MHD_INVALID_SOCKET;
+          goto free_and_fail;
+        }
+      }
+      else
+      {
+#ifdef HAVE_MESSAGES
+        MHD_DLOG (daemon,
+                  _ ("MHD_OPTION_LISTEN_SHARDING is ignored as listen " \
+                     "socket is not an IP socket.\n"));
+#endif
+        daemon->listen_sharding = MHD_LISTEN_SHARDING_NONE;
+      }
+    }
+#endif /* MHD_USE_LISTEN_SHARDING */
+
     /* check for user supplied sockaddr */
     daemon->listen_fd = listen_fd;
 
@@ -8465,6 +10178,10 @@ MHD_start_daemon_va (unsigned int flags,
       listen_fd = MHD_INVALID_SOCKET;
       goto free_and_fail;
     }
+#ifdef MHD_USE_LISTEN_SHARDING
+    if (MHD_LISTEN_SHARDING_REUSEPORT_CPU == daemon->listen_sharding)
+      setup_listen_shards_cpu_steering_ (daemon);
+#endif /* MHD_USE_LISTEN_SHARDING */
   }
   else
   {
@@ -8683,20 +10400,75 @@ MHD_start_daemon_va (unsigned int flags,
   }
 #endif /* EPOLL_SUPPORT */
 
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-  if (! MHD_mutex_init_ (&daemon->per_ip_connection_mutex))
+  if (0 != daemon->per_ip_connection_limit)
   {
+    daemon->per_ip_table =
+      MHD_iplimit_create_ (daemon->connection_limit,
+                           MHD_monotonic_msec_counter ()
+                           ^ (uint64_t) (uintptr_t) daemon);
+    if (NULL == daemon->per_ip_table)
+    {
 #ifdef HAVE_MESSAGES
-    MHD_DLOG (daemon,
-              _ ("MHD failed to initialize IP connection limit mutex.\n"));
+      MHD_DLOG (daemon,
+                _ ("MHD failed to initialize IP connection limit table.\n"));
 #endif
-    if (MHD_INVALID_SOCKET != listen_fd)
-      MHD_socket_close_chk_ (listen_fd);
-    goto free_and_fail;
+      if (MHD_INVALID_SOCKET != listen_fd)
+        MHD_socket_close_chk_ (listen_fd);
+      goto free_and_fail;
+    }
   }
-#endif
 
 #ifdef HTTPS_SUPPORT
+  if ( (0 != (*pflags & MHD_USE_TLS)) &&
+       (0 != daemon->tls_tickets_lifetime) )
+  {
+    daemon->tls_tickets = MHD_tls_tickets_create_ (daemon->tls_tickets_lifetime);
+    if (NULL == daemon->tls_tickets)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD failed to initialize TLS session tickets keys.\n"));
+#endif
+      if (MHD_INVALID_SOCKET != listen_fd)
+        MHD_socket_close_chk_ (listen_fd);
+      goto free_and_fail;
+    }
+  }
+#ifdef MHD_USE_THREADS
+  if (0 != daemon->tls_hs_threads)
+  {
+    daemon->tls_hs_pool = MHD_tls_hs_pool_create_ (daemon->tls_hs_threads,
+                                                   daemon->thread_stack_size);
+    if (NULL == daemon->tls_hs_pool)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD failed to start TLS handshake threads.\n"));
+#endif
+      if (MHD_INVALID_SOCKET != listen_fd)
+        MHD_socket_close_chk_ (listen_fd);
+      goto free_and_fail;
+    }
+  }
+#endif /* MHD_USE_THREADS */
+  if ( (0 != (*pflags & MHD_USE_TLS)) &&
+       (0 != daemon->tls_sess_cache_size) )
+  {
+    daemon->tls_sess_cache =
+      MHD_tls_sess_cache_create_ (daemon->tls_sess_cache_size,
+                                  MHD_monotonic_msec_counter ()
+                                  ^ (uint64_t) (uintptr_t) daemon);
+    if (NULL == daemon->tls_sess_cache)
+    {
+#ifdef HAVE_MESSAGES
+      MHD_DLOG (daemon,
+                _ ("MHD failed to initialize TLS sessions cache.\n"));
+#endif
+      if (MHD_INVALID_SOCKET != listen_fd)
+        MHD_socket_close_chk_ (listen_fd);
+      goto free_and_fail;
+    }
+  }
   /* initialize HTTPS daemon certificate aspects & send / recv functions */
   if ( (0 != (*pflags & MHD_USE_TLS)) &&
        (0 != MHD_TLS_init (daemon)) )
@@ -8707,9 +10479,6 @@ MHD_start_daemon_va (unsigned int flags,
 #endif
     if (MHD_INVALID_SOCKET != listen_fd)
       MHD_socket_close_chk_ (listen_fd);
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-    MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
-#endif
     goto free_and_fail;
   }
 #endif /* HTTPS_SUPPORT */
@@ -8737,7 +10506,6 @@ MHD_start_daemon_va (unsigned int flags,
         MHD_DLOG (daemon,
                   _ ("Failed to initialise internal lists mutex.\n"));
 #endif
-        MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
         if (MHD_INVALID_SOCKET != listen_fd)
           MHD_socket_close_chk_ (listen_fd);
         goto free_and_fail;
@@ -8748,7 +10516,6 @@ MHD_start_daemon_va (unsigned int flags,
         MHD_DLOG (daemon,
                   _ ("Failed to initialise mutex.\n"));
 #endif
-        MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
         MHD_mutex_destroy_chk_ (&daemon->cleanup_connection_mutex);
         if (MHD_INVALID_SOCKET != listen_fd)
           MHD_socket_close_chk_ (listen_fd);
@@ -8775,7 +10542,6 @@ MHD_start_daemon_va (unsigned int flags,
                   MHD_strerror_ (errno));
 #endif /* HAVE_MESSAGES */
         MHD_mutex_destroy_chk_ (&daemon->new_connections_mutex);
-        MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
         MHD_mutex_destroy_chk_ (&daemon->cleanup_connection_mutex);
         if (MHD_INVALID_SOCKET != listen_fd)
           MHD_socket_close_chk_ (listen_fd);
@@ -8875,10 +10641,34 @@ MHD_start_daemon_va (unsigned int flags,
         d->connection_limit = conns_per_thread;
         if (i < leftover_conns)
           ++d->connection_limit;
+#ifdef MHD_USE_LISTEN_SHARDING
+        /* The first worker uses the listen socket of the master daemon */
+        d->listen_is_shard = false;
+        if ((MHD_LISTEN_SHARDING_NONE != daemon->listen_sharding) &&
+            (0 != i))
+        {
+          d->listen_fd = create_listen_shard_ (daemon,
+                                               i);
+          if (MHD_INVALID_SOCKET == d->listen_fd)
+          {
+            if (MHD_ITC_IS_VALID_ (d->itc))
+              MHD_itc_destroy_chk_ (d->itc);
+            MHD_mutex_destroy_chk_ (&d->new_connections_mutex);
+            MHD_mutex_destroy_chk_ (&d->cleanup_connection_mutex);
+            goto thread_failed;
+          }
+          d->listen_is_shard = true;
+          d->listen_nonblk = true;
+        }
+#endif /* MHD_USE_LISTEN_SHARDING */
 #ifdef EPOLL_SUPPORT
         if (MHD_D_IS_USING_EPOLL_ (d) &&
             (MHD_NO == setup_epoll_to_listen (d)) )
         {
+#ifdef MHD_USE_LISTEN_SHARDING
+          if (d->listen_is_shard)
+            MHD_socket_close_chk_ (d->listen_fd);
+#endif /* MHD_USE_LISTEN_SHARDING */
           if (MHD_ITC_IS_VALID_ (d->itc))
             MHD_itc_destroy_chk_ (d->itc);
           MHD_mutex_destroy_chk_ (&d->new_connections_mutex);
@@ -8887,10 +10677,7 @@ MHD_start_daemon_va (unsigned int flags,
         }
 #endif
         /* Some members must be used only in master daemon */
-#if defined(MHD_USE_THREADS)
-        memset (&d->per_ip_connection_mutex, 0x7F,
-                sizeof(d->per_ip_connection_mutex));
-#endif /* MHD_USE_THREADS */
+        d->per_ip_table = NULL;
 #ifdef DAUTH_SUPPORT
         d->nnc = NULL;
         d->nonce_nc_size = 0;
@@ -8922,6 +10709,10 @@ MHD_start_daemon_va (unsigned int flags,
 #endif
           /* Free memory for this worker; cleanup below handles
            * all previously-created workers. */
+#ifdef MHD_USE_LISTEN_SHARDING
+          if (d->listen_is_shard)
+            MHD_socket_close_chk_ (d->listen_fd);
+#endif /* MHD_USE_LISTEN_SHARDING */
           MHD_mutex_destroy_chk_ (&d->cleanup_connection_mutex);
           if (MHD_ITC_IS_VALID_ (d->itc))
             MHD_itc_destroy_chk_ (d->itc);
@@ -8940,7 +10731,6 @@ MHD_start_daemon_va (unsigned int flags,
       MHD_DLOG (daemon,
                 _ ("Failed to initialise internal lists mutex.\n"));
 #endif
-      MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
       if (MHD_INVALID_SOCKET != listen_fd)
         MHD_socket_close_chk_ (listen_fd);
       goto free_and_fail;
@@ -8952,7 +10742,6 @@ MHD_start_daemon_va (unsigned int flags,
                 _ ("Failed to initialise mutex.\n"));
 #endif
       MHD_mutex_destroy_chk_ (&daemon->cleanup_connection_mutex);
-      MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
       if (MHD_INVALID_SOCKET != listen_fd)
         MHD_socket_close_chk_ (listen_fd);
       goto free_and_fail;
@@ -8978,7 +10767,6 @@ thread_failed:
     if (MHD_INVALID_SOCKET != listen_fd)
       MHD_socket_close_chk_ (listen_fd);
     listen_fd = MHD_INVALID_SOCKET;
-    MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
     if (NULL != daemon->worker_pool)
       free (daemon->worker_pool);
     goto free_and_fail;
@@ -9022,7 +10810,17 @@ free_and_fail:
   MHD_mutex_destroy_chk_ (&daemon->nnc_lock);
 #endif
 #endif
+  if (NULL != daemon->per_ip_table)
+    MHD_iplimit_destroy_ (daemon->per_ip_table);
 #ifdef HTTPS_SUPPORT
+#ifdef MHD_USE_THREADS
+  if (NULL != daemon->tls_hs_pool)
+    MHD_tls_hs_pool_destroy_ (daemon->tls_hs_pool);
+#endif /* MHD_USE_THREADS */
+  if (NULL != daemon->tls_tickets)
+    MHD_tls_tickets_destroy_ (daemon->tls_tickets);
+  if (NULL != daemon->tls_sess_cache)
+    MHD_tls_sess_cache_destroy_ (daemon->tls_sess_cache);
   if (0 != (*pflags & MHD_USE_TLS))
   {
     gnutls_priority_deinit (daemon->priority_cache);
@@ -9254,6 +11052,17 @@ close_all_connections (struct MHD_Daemon *daemon)
 #endif
     close_connection (pos);
   }
+#ifdef MHD_HAVE_ATOMIC_
+  /* Release the closed connections still referenced by the queue of
+     resumed connections */
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  MHD_mutex_lock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+  (void) resume_queue_process_ (daemon);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+  MHD_mutex_unlock_chk_ (&daemon->cleanup_connection_mutex);
+#endif
+#endif /* MHD_HAVE_ATOMIC_ */
   MHD_cleanup_connections (daemon);
 }
 
@@ -9287,6 +11096,14 @@ MHD_stop_daemon (struct MHD_Daemon *daemon)
   /* Slave daemons must be stopped by master daemon. */
   mhd_assert ( (NULL == daemon->master) || (daemon->shutdown) );
 
+#if defined(HTTPS_SUPPORT) && defined(MHD_USE_THREADS)
+  /* Finish the queued handshake steps while the daemon threads are
+     running, the connections must be resumed before closing */
+  if ( (NULL == daemon->master) &&
+       (NULL != daemon->tls_hs_pool) )
+    MHD_tls_hs_pool_stop_ (daemon->tls_hs_pool);
+#endif /* HTTPS_SUPPORT && MHD_USE_THREADS */
+
   daemon->shutdown = true;
   if (daemon->was_quiesced)
     fd = MHD_INVALID_SOCKET; /* Do not use FD if daemon was quiesced */
@@ -9381,6 +11198,7 @@ MHD_stop_daemon (struct MHD_Daemon *daemon)
 #if defined(UPGRADE_SUPPORT) && defined(HTTPS_SUPPORT)
     mhd_assert (NULL == daemon->urh_head);
 #endif /* UPGRADE_SUPPORT && HTTPS_SUPPORT */
+    MHD_pool_cache_clear (&daemon->pool_cache);
 
     if (MHD_ITC_IS_VALID_ (daemon->itc))
       MHD_itc_destroy_chk_ (daemon->itc);
@@ -9394,12 +11212,21 @@ MHD_stop_daemon (struct MHD_Daemon *daemon)
         (-1 != daemon->epoll_upgrade_fd) )
       MHD_socket_close_chk_ (daemon->epoll_upgrade_fd);
 #endif /* HTTPS_SUPPORT && UPGRADE_SUPPORT */
+    free (daemon->epoll_events);
 #endif /* EPOLL_SUPPORT */
 
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
     MHD_mutex_destroy_chk_ (&daemon->cleanup_connection_mutex);
     MHD_mutex_destroy_chk_ (&daemon->new_connections_mutex);
 #endif
+#ifdef MHD_USE_LISTEN_SHARDING
+    if (daemon->listen_is_shard)
+    {     /* The worker owns its listening socket */
+      mhd_assert (NULL != daemon->master);
+      if (MHD_INVALID_SOCKET != daemon->listen_fd)
+        MHD_socket_close_chk_ (daemon->listen_fd);
+    }
+#endif /* MHD_USE_LISTEN_SHARDING */
   }
 
   if (NULL == daemon->master)
@@ -9424,6 +11251,14 @@ MHD_stop_daemon (struct MHD_Daemon *daemon)
       if (daemon->psk_cred)
         gnutls_psk_free_server_credentials (daemon->psk_cred);
     }
+#ifdef MHD_USE_THREADS
+    if (NULL != daemon->tls_hs_pool)
+      MHD_tls_hs_pool_destroy_ (daemon->tls_hs_pool);
+#endif /* MHD_USE_THREADS */
+    if (NULL != daemon->tls_tickets)
+      MHD_tls_tickets_destroy_ (daemon->tls_tickets);
+    if (NULL != daemon->tls_sess_cache)
+      MHD_tls_sess_cache_destroy_ (daemon->tls_sess_cache);
 #endif /* HTTPS_SUPPORT */
 
 #ifdef DAUTH_SUPPORT
@@ -9433,14 +11268,129 @@ MHD_stop_daemon (struct MHD_Daemon *daemon)
     MHD_mutex_destroy_chk_ (&daemon->nnc_lock);
 #endif
 #endif
-#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
-    MHD_mutex_destroy_chk_ (&daemon->per_ip_connection_mutex);
-#endif
+    if (NULL != daemon->per_ip_table)
+      MHD_iplimit_destroy_ (daemon->per_ip_table);
+    if (NULL != daemon->phase_hist_info)
+      free (daemon->phase_hist_info);
     free (daemon);
   }
 }
 
 
+/**
+ * Add the buffers statistics of the daemon to the collected statistics.
+ * @param d the daemon to get the statistics from
+ * @param[in,out] st the statistics to update
+ */
+static void
+buffer_stats_collect_ (struct MHD_Daemon *d,
+                       struct MHD_DaemonBufferStats *st)
+{
+  struct MHD_BufferStats_ *const bs = &d->buf_stats;
+  uint64_t avg_size;
+
+  st->read_grows += MHD_stats_read_ (&bs->read_grows);
+  st->read_shrinks += MHD_stats_read_ (&bs->read_shrinks);
+  st->write_grows += MHD_stats_read_ (&bs->write_grows);
+  avg_size = MHD_stats_read_ (&d->read_buf_avg);
+  if (st->avg_request_size < avg_size)
+    st->avg_request_size = (size_t) avg_size;
+}
+
+
+#ifdef EPOLL_SUPPORT
+/**
+ * Add the event loop statistics of the daemon to the collected statistics.
+ * @param d the daemon to get the statistics from
+ * @param[in,out] st the statistics to update
+ */
+static void
+epoll_stats_collect_ (struct MHD_Daemon *d,
+                      struct MHD_DaemonEpollStats *st)
+{
+  struct MHD_EpollStats_ *const es = &d->epoll_stats;
+  uint64_t max_events;
+
+  st->wakeups += MHD_stats_read_ (&es->wakeups);
+  st->events += MHD_stats_read_ (&es->events);
+  st->full_batches += MHD_stats_read_ (&es->full_batches);
+  max_events = MHD_stats_read_ (&es->max_events);
+  if (st->max_events < max_events)
+    st->max_events = (unsigned int) max_events;
+}
+
+
+#endif /* EPOLL_SUPPORT */
+
+/**
+ * Add the statistics of the daemon to the collected statistics.
+ * @param d the daemon to get the statistics from
+ * @param[in,out] st the statistics to update
+ */
+static void
+daemon_stats_collect_ (struct MHD_Daemon *d,
+                       struct MHD_DaemonStats *st)
+{
+  struct MHD_DaemonStats *const ds = &d->stats;
+  uint64_t pool_max_used;
+
+  st->conns_accepted += MHD_stats_read_ (&ds->conns_accepted);
+  st->conns_rejected += MHD_stats_read_ (&ds->conns_rejected);
+  st->per_ip_limit_hits += MHD_stats_read_ (&ds->per_ip_limit_hits);
+  st->conns_closed += MHD_stats_read_ (&ds->conns_closed);
+  st->conns_timed_out += MHD_stats_read_ (&ds->conns_timed_out);
+  st->requests_served += MHD_stats_read_ (&ds->requests_served);
+  st->bytes_received += MHD_stats_read_ (&ds->bytes_received);
+  st->bytes_sent_send += MHD_stats_read_ (&ds->bytes_sent_send);
+  st->bytes_sent_writev += MHD_stats_read_ (&ds->bytes_sent_writev);
+  st->bytes_sent_sendfile += MHD_stats_read_ (&ds->bytes_sent_sendfile);
+  st->bytes_sent_splice += MHD_stats_read_ (&ds->bytes_sent_splice);
+  st->suspends += MHD_stats_read_ (&ds->suspends);
+  st->resumes += MHD_stats_read_ (&ds->resumes);
+  st->tls_handshakes += MHD_stats_read_ (&ds->tls_handshakes);
+  st->tls_handshake_failures += MHD_stats_read_ (&ds->tls_handshake_failures);
+  st->tls_ktls_send += MHD_stats_read_ (&ds->tls_ktls_send);
+  st->tls_resumed += MHD_stats_read_ (&ds->tls_resumed);
+  st->tls_hs_offloaded += MHD_stats_read_ (&ds->tls_hs_offloaded);
+  st->bytes_sent_zerocopy += MHD_stats_read_ (&ds->bytes_sent_zerocopy);
+  st->zerocopy_copied += MHD_stats_read_ (&ds->zerocopy_copied);
+  pool_max_used = MHD_stats_read_ (&ds->pool_max_used);
+  if (st->pool_max_used < pool_max_used)
+    st->pool_max_used = pool_max_used;
+  st->sendfile_partial += MHD_stats_read_ (&ds->sendfile_partial);
+}
+
+
+/**
+ * Add the histograms of the request phases of the daemon to the collected
+ * histograms.
+ * @param d the daemon to get the histograms from
+ * @param[in,out] ph the histograms to update
+ */
+static void
+daemon_phase_hist_collect_ (struct MHD_Daemon *d,
+                            struct MHD_DaemonPhaseHistograms *ph)
+{
+  unsigned int p;
+
+  for (p = 0; p < MHD_REQUEST_PHASE_COUNT; p++)
+  {
+    struct MHD_PhaseHistogram *const src = d->phase_hist.phases + p;
+    struct MHD_PhaseHistogram *const dst = ph->phases + p;
+    uint64_t max_us;
+    unsigned int b;
+
+    dst->count += MHD_stats_read_ (&src->count);
+    dst->sum_us += MHD_stats_read_ (&src->sum_us);
+    max_us = MHD_stats_read_ (&src->max_us);
+    if (dst->max_us < max_us)
+      dst->max_us = max_us;
+    for (b = 0; b < MHD_PHASE_HISTOGRAM_BUCKETS; b++)
+      dst->buckets[b] += MHD_stats_read_ (src->buckets + b);
+  }
+}
+
+
 /**
  * Obtain information about the given daemon.
  * The returned pointer is invalidated with the next call of this function or
@@ -9509,6 +11459,95 @@ MHD_get_daemon_info (struct MHD_Daemon *daemon,
   case MHD_DAEMON_INFO_BIND_PORT:
     daemon->daemon_info_dummy_port.port = daemon->port;
     return &daemon->daemon_info_dummy_port;
+  case MHD_DAEMON_INFO_EPOLL_STATS:
+#ifdef EPOLL_SUPPORT
+    if (! MHD_D_IS_USING_EPOLL_ (daemon))
+      return NULL;
+    if (1)
+    {
+      struct MHD_DaemonEpollStats *const st =
+        &daemon->daemon_info_dummy_epoll_stats.epoll_stats;
+      memset (st, 0, sizeof(*st));
+      epoll_stats_collect_ (daemon, st);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+      if (NULL != daemon->worker_pool)
+      {
+        unsigned int i;
+        /* Collect the statistics stored in the workers. */
+        for (i = 0; i < daemon->worker_pool_size; i++)
+          epoll_stats_collect_ (daemon->worker_pool + i, st);
+      }
+#endif
+    }
+    return &daemon->daemon_info_dummy_epoll_stats;
+#else  /* ! EPOLL_SUPPORT */
+    return NULL;
+#endif /* ! EPOLL_SUPPORT */
+  case MHD_DAEMON_INFO_BUFFER_STATS:
+    if (! daemon->adaptive_bufs)
+      return NULL;
+    if (1)
+    {
+      struct MHD_DaemonBufferStats *const st =
+        &daemon->daemon_info_dummy_buffer_stats.buffer_stats;
+      memset (st, 0, sizeof(*st));
+      buffer_stats_collect_ (daemon, st);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+      if (NULL != daemon->worker_pool)
+      {
+        unsigned int i;
+        /* Collect the statistics stored in the workers. */
+        for (i = 0; i < daemon->worker_pool_size; i++)
+          buffer_stats_collect_ (daemon->worker_pool + i, st);
+      }
+#endif
+    }
+    return &daemon->daemon_info_dummy_buffer_stats;
+  case MHD_DAEMON_INFO_STATS:
+    if (1)
+    {
+      struct MHD_DaemonStats *const st =
+        &daemon->daemon_info_dummy_stats.stats;
+      memset (st, 0, sizeof(*st));
+      /* The master daemon counts the connections rejected before
+         the connections are passed to the workers. */
+      daemon_stats_collect_ (daemon, st);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+      if (NULL != daemon->worker_pool)
+      {
+        unsigned int i;
+        for (i = 0; i < daemon->worker_pool_size; i++)
+          daemon_stats_collect_ (daemon->worker_pool + i, st);
+      }
+#endif
+    }
+    return &daemon->daemon_info_dummy_stats;
+  case MHD_DAEMON_INFO_PHASE_HISTOGRAMS:
+    if (! daemon->phase_timing)
+      return NULL;
+    if (NULL == daemon->phase_hist_info)
+    {
+      daemon->phase_hist_info =
+        (struct MHD_DaemonPhaseHistograms *)
+        malloc (sizeof(struct MHD_DaemonPhaseHistograms));
+      if (NULL == daemon->phase_hist_info)
+        return NULL;
+    }
+    memset (daemon->phase_hist_info, 0, sizeof(*daemon->phase_hist_info));
+    daemon_phase_hist_collect_ (daemon,
+                                daemon->phase_hist_info);
+#if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
+    if (NULL != daemon->worker_pool)
+    {
+      unsigned int i;
+      for (i = 0; i < daemon->worker_pool_size; i++)
+        daemon_phase_hist_collect_ (daemon->worker_pool + i,
+                                    daemon->phase_hist_info);
+    }
+#endif
+    daemon->daemon_info_dummy_phase_hist.phase_histograms =
+      daemon->phase_hist_info;
+    return &daemon->daemon_info_dummy_phase_hist;
   default:
     return NULL;
   }
@@ -9784,6 +11823,18 @@ MHD_is_feature_supported (enum MHD_FEATURE feature)
 #else  /* ! HAS_FD_SETSIZE_OVERRIDABLE */
     return MHD_NO;
 #endif /* ! HAS_FD_SETSIZE_OVERRIDABLE */
+  case MHD_FEATURE_LISTEN_SHARDING:
+#ifdef MHD_USE_LISTEN_SHARDING
+    return MHD_YES;
+#else  /* ! MHD_USE_LISTEN_SHARDING */
+    return MHD_NO;
+#endif /* ! MHD_USE_LISTEN_SHARDING */
+  case MHD_FEATURE_IO_URING:
+#ifdef IO_URING_SUPPORT
+    return MHD_uring_is_supported_ () ? MHD_YES : MHD_NO;
+#else  /* ! IO_URING_SUPPORT */
+    return MHD_NO;
+#endif /* ! IO_URING_SUPPORT */
 
   default:
     break;
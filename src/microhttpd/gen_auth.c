@@ -96,17 +96,11 @@ find_auth_rq_header_ (const struct MHD_Connection *c, enum MHD_AuthType type,
 
   for (h = c->rq.headers_received; NULL != h; h = h->next)
   {
-    if (MHD_HEADER_KIND != h->kind)
-      continue;
-    if (MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_AUTHORIZATION) != h->header_size)
+    if (MHD_HEADER_ID_AUTHORIZATION != h->hdr_id)
       continue;
+    mhd_assert (MHD_HEADER_KIND == h->kind);
     if (token_len > h->value_size)
       continue;
-    if (! MHD_str_equal_caseless_bin_n_ (MHD_HTTP_HEADER_AUTHORIZATION,
-                                         h->header,
-                                         MHD_STATICSTR_LEN_ ( \
-                                           MHD_HTTP_HEADER_AUTHORIZATION)))
-      continue;
     if (! MHD_str_equal_caseless_bin_n_ (h->value, token, token_len))
       continue;
     /* Match only if token string is full header value or token is
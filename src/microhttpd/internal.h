@@ -60,9 +60,19 @@
 #include "mhd_threads.h"
 #endif
 #include "mhd_locks.h"
+#include "mhd_atomic.h"
 #include "mhd_sockets.h"
 #include "mhd_itc_types.h"
 #include "mhd_str_types.h"
+#include "mhd_tmheap.h"
+#include "memorypool.h"
+#include "mhd_iplimit.h"
+#ifdef HTTPS_SUPPORT
+#include "mhd_tls_sess.h"
+#ifdef MHD_USE_THREADS
+#include "mhd_tls_hs.h"
+#endif /* MHD_USE_THREADS */
+#endif /* HTTPS_SUPPORT */
 #if defined(BAUTH_SUPPORT) || defined(DAUTH_SUPPORT)
 #include "gen_auth.h"
 #endif /* BAUTH_SUPPORT || DAUTH_SUPPORT*/
@@ -395,6 +405,55 @@ struct MHD_HTTP_Req_Header
    */
   enum MHD_ValueKind kind;
 
+  /**
+   * The identifier of the well-known header.
+   * #MHD_HEADER_ID_UNKNOWN for other headers and for values of other kinds.
+   */
+  enum MHD_HeaderId hdr_id;
+
+};
+
+
+/**
+ * The slot in the hash index of the request headers.
+ */
+struct MHD_HeaderIndexSlot_
+{
+  /**
+   * The indexed header, NULL if slot is empty.
+   */
+  struct MHD_HTTP_Req_Header *hdr;
+
+  /**
+   * The caseless hash of the name of the header.
+   * @see #MHD_str_hash_caseless_bin_n_()
+   */
+  uint32_t hash;
+};
+
+
+/**
+ * The hash index of the request headers of #MHD_HEADER_KIND.
+ * Open addressing with linear probing is used, so the headers with
+ * the same name are found in the same order as in the list of headers.
+ */
+struct MHD_HeaderIndex_
+{
+  /**
+   * The array of slots, allocated in the connection memory pool.
+   * NULL if the index is not built.
+   */
+  struct MHD_HeaderIndexSlot_ *slots;
+
+  /**
+   * The number of elements in @a slots, always a power of two.
+   */
+  size_t size;
+
+  /**
+   * The number of used slots.
+   */
+  size_t used;
 };
 
 
@@ -1115,6 +1174,12 @@ struct MHD_Request
    */
   struct MHD_HTTP_Req_Header *headers_received_tail;
 
+  /**
+   * The hash index of the request headers, built when all request
+   * headers are received.
+   */
+  struct MHD_HeaderIndex_ headers_index;
+
   /**
    * Number of bytes we had in the HTTP header, set once we
    * pass #MHD_CONNECTION_HEADERS_RECEIVED.
@@ -1255,13 +1320,14 @@ struct MHD_Reply_Properties
   bool chunked; /**< Use chunked encoding for reply */
 };
 
-#if defined(_MHD_HAVE_SENDFILE)
+#if defined(_MHD_HAVE_SENDFILE) || defined(_MHD_HAVE_SPLICE)
 enum MHD_resp_sender_
 {
   MHD_resp_sender_std = 0,
-  MHD_resp_sender_sendfile
+  MHD_resp_sender_sendfile,
+  MHD_resp_sender_splice
 };
-#endif /* _MHD_HAVE_SENDFILE */
+#endif /* _MHD_HAVE_SENDFILE || _MHD_HAVE_SPLICE */
 
 /**
  * Reply-specific values.
@@ -1302,16 +1368,278 @@ struct MHD_Reply
    */
   struct MHD_iovec_track_ resp_iov;
 
-#if defined(_MHD_HAVE_SENDFILE)
+#if defined(_MHD_HAVE_SENDFILE) || defined(_MHD_HAVE_SPLICE)
   enum MHD_resp_sender_ resp_sender;
+#endif /* _MHD_HAVE_SENDFILE || _MHD_HAVE_SPLICE */
+
+#if defined(_MHD_HAVE_SENDFILE)
+  /**
+   * 'true' if the last sendfile() call has sent less data than requested,
+   * i.e. the socket send buffer has been filled.
+   * @see #MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK
+   */
+  bool sf_buf_full;
 #endif /* _MHD_HAVE_SENDFILE */
 
+#if defined(_MHD_HAVE_SPLICE)
+  /**
+   * The number of bytes of the current chunk still to be moved from
+   * the pipe to the socket by splice().
+   * Used only for chunked replies with #MHD_resp_sender_splice.
+   */
+  size_t splice_left;
+#endif /* _MHD_HAVE_SPLICE */
+
   /**
    * Reply-specific properties
    */
   struct MHD_Reply_Properties props;
 };
 
+#ifdef MHD_USE_MSG_ZEROCOPY
+/**
+ * The socket waiting for the completion of the zero-copy sends,
+ * see mhd_send.h
+ */
+struct MHD_ZcLinger_;
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
+#ifdef IO_URING_SUPPORT
+/**
+ * The io_uring instance, see mhd_uring.h
+ */
+struct MHD_Uring_;
+
+/**
+ * The user data value of the completions for the ITC
+ */
+#define MHD_URING_UD_ITC_ ((uint64_t) 1)
+
+/**
+ * The user data value of the completions for the first accept request,
+ * the next requests use the next values
+ */
+#define MHD_URING_UD_ACCEPT_ ((uint64_t) 2)
+
+/**
+ * The number of the accept requests kept in flight in the daemon's
+ * io_uring
+ */
+#define MHD_URING_ACCEPT_NUM_ 8
+
+/**
+ * The tag of the user data for the receive completions,
+ * combined with the pointer to #MHD_UringConn_
+ */
+#define MHD_URING_TAG_RECV_ ((uint64_t) 1)
+
+/**
+ * The tag of the user data for the send readiness completions,
+ * combined with the pointer to #MHD_UringConn_
+ */
+#define MHD_URING_TAG_POLLOUT_ ((uint64_t) 2)
+
+/**
+ * The tag of the user data for the send completions,
+ * combined with the pointer to #MHD_UringConn_
+ */
+#define MHD_URING_TAG_SEND_ ((uint64_t) 3)
+
+/**
+ * The mask of the tag bits in the user data
+ */
+#define MHD_URING_TAG_MASK_ ((uint64_t) 3)
+
+/**
+ * The accept request in the daemon's io_uring.
+ * The kernel writes the address of the client to the storage of the
+ * request, so each request in flight needs its own storage.
+ */
+struct MHD_UringAccept_
+{
+  /**
+   * The address of the accepted client
+   */
+  struct sockaddr_storage addr;
+
+  /**
+   * The size of @a addr, updated by the kernel
+   */
+  socklen_t addrlen;
+
+  /**
+   * Set to 'true' if the request is in flight
+   */
+  bool pending;
+
+  /**
+   * Set to 'true' if the cancellation of the request has been queued
+   */
+  bool cancel;
+};
+
+/**
+ * The state of the connection's socket in the daemon's io_uring.
+ * The structure is allocated separately from the connection as it must
+ * be kept until all the requests for the socket are completed by
+ * the kernel.
+ */
+struct MHD_UringConn_
+{
+  /**
+   * The connection, NULL if the connection has been closed while
+   * some requests are still in flight.
+   */
+  struct MHD_Connection *connection;
+
+  /**
+   * The size of the received data in the buffer @a bid
+   */
+  size_t data_size;
+
+  /**
+   * The offset of the data not yet consumed by the connection
+   */
+  size_t data_off;
+
+  /**
+   * The number of requests in flight
+   */
+  unsigned int pending;
+
+  /**
+   * The copy of the data being sent by the ring,
+   * NULL if not allocated yet
+   */
+  char *send_buf;
+
+  /**
+   * The allocated size of @a send_buf
+   */
+  size_t send_buf_size;
+
+  /**
+   * The size of the data of the last send request
+   */
+  size_t send_size;
+
+  /**
+   * The error reported by the receive completion, zero if none
+   */
+  int err;
+
+  /**
+   * The result of the last send request, valid if @a send_done is set
+   */
+  int send_res;
+
+  /**
+   * The ID of the provided buffer with the received data
+   */
+  uint16_t bid;
+
+  /**
+   * Set to 'true' if buffer @a bid holds the received data
+   */
+  bool has_buf;
+
+  /**
+   * Set to 'true' if the receive request is in flight
+   */
+  bool recv_pending;
+
+  /**
+   * Set to 'true' if the send readiness request is in flight
+   */
+  bool pollout_pending;
+
+  /**
+   * Set to 'true' if the send request is in flight
+   */
+  bool send_pending;
+
+  /**
+   * Set to 'true' if the send request has been completed, but the
+   * result has not been reported to the connection yet
+   */
+  bool send_done;
+
+  /**
+   * Set to 'true' if the remote side has closed the connection
+   */
+  bool eof;
+};
+#endif /* IO_URING_SUPPORT */
+
+
+/**
+ * The timestamps of the request phases.
+ * Used only if #MHD_OPTION_CONNECTION_PHASE_TIMING is enabled.
+ */
+struct MHD_PhaseTiming_
+{
+  /**
+   * The time when the connection was accepted or the previous reply on
+   * the connection was completed, in microseconds.
+   */
+  uint64_t start;
+
+  /**
+   * The time when the first byte of the request was received,
+   * in microseconds.
+   */
+  uint64_t first_byte;
+
+  /**
+   * The time when the request header was received, in microseconds.
+   */
+  uint64_t headers_received;
+
+  /**
+   * The time when the sending of the reply was started, in microseconds.
+   */
+  uint64_t reply_start;
+
+  /**
+   * The total time spent in the access handler callbacks for the current
+   * request, in microseconds.
+   */
+  uint64_t handler;
+
+  /**
+   * The bitmask of the recorded timestamps, see #MHD_PHASE_MARK_FIRST_BYTE_
+   * and the other marks.
+   */
+  unsigned int marks;
+
+  /**
+   * 'true' if the current request is not the first request on
+   * the connection.
+   */
+  bool keepalive;
+};
+
+/**
+ * The mark of the recorded @a first_byte timestamp
+ */
+#define MHD_PHASE_MARK_FIRST_BYTE_ (1u << 0)
+
+/**
+ * The mark of the recorded @a headers_received timestamp
+ */
+#define MHD_PHASE_MARK_HEADERS_ (1u << 1)
+
+/**
+ * The mark of the recorded @a reply_start timestamp
+ */
+#define MHD_PHASE_MARK_REPLY_ (1u << 2)
+
+/**
+ * The mark of the completed reply
+ */
+#define MHD_PHASE_MARK_DONE_ (1u << 3)
+
+
 /**
  * State kept for each HTTP request.
  */
@@ -1342,10 +1670,8 @@ struct MHD_Connection
 
   /**
    * Next pointer for the XDLL organizing connections by timeout.
-   * This DLL can be either the
-   * 'manual_timeout_head/manual_timeout_tail' or the
-   * 'normal_timeout_head/normal_timeout_tail', depending on whether a
-   * custom timeout is set for the connection.
+   * This DLL is the 'normal_timeout_head/normal_timeout_tail', used
+   * only if a custom timeout is not set for the connection.
    */
   struct MHD_Connection *nextX;
 
@@ -1354,6 +1680,12 @@ struct MHD_Connection
    */
   struct MHD_Connection *prevX;
 
+  /**
+   * The node in the daemon's @e manual_timeout_heap, used only if
+   * a custom timeout is set for the connection.
+   */
+  struct MHD_TmHeapNode_ tmout_node;
+
   /**
    * Reference to the MHD_Daemon struct.
    */
@@ -1468,6 +1800,12 @@ struct MHD_Connection
    */
   uint64_t last_activity;
 
+  /**
+   * The timestamps of the phases of the current request.
+   * Used only if #MHD_OPTION_CONNECTION_PHASE_TIMING is enabled.
+   */
+  struct MHD_PhaseTiming_ timing;
+
   /**
    * After how many milliseconds of inactivity should
    * this connection time out?
@@ -1508,6 +1846,41 @@ struct MHD_Connection
    */
   enum MHD_tristate sk_nodelay;
 
+#ifdef MHD_USE_MSG_ZEROCOPY
+  /**
+   * Tracks SO_ZEROCOPY state of the connection socket.
+   * @see #MHD_OPTION_SEND_ZEROCOPY_THRESHOLD
+   */
+  enum MHD_tristate zc_sk_state;
+
+  /**
+   * The number of the zero-copy sends performed on the socket.
+   * Matches the next notification ID used by the kernel.
+   */
+  uint32_t zc_sent;
+
+  /**
+   * The number of the zero-copy sends reported as completed by the kernel.
+   */
+  uint32_t zc_done;
+
+  /**
+   * The response with the data used by the zero-copy sends not completed
+   * yet.  The reference is held by the connection until all zero-copy
+   * sends are completed.
+   */
+  struct MHD_Response *zc_response;
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
+#if defined(_MHD_HAVE_SENDFILE)
+  /**
+   * The cached size of the socket send buffer (SO_SNDBUF), zero if
+   * not known yet.
+   * @see #MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK
+   */
+  int sf_sndbuf;
+#endif /* _MHD_HAVE_SENDFILE */
+
   /**
    * Has this socket been closed for reading (i.e.  other side closed
    * the connection)?  If so, we must completely close the connection
@@ -1557,6 +1930,14 @@ struct MHD_Connection
    * What is the state of this socket in relation to epoll?
    */
   enum MHD_EpollState epoll_state;
+
+#ifdef IO_URING_SUPPORT
+  /**
+   * The state of the socket in the daemon's io_uring,
+   * NULL if io_uring is not used for this connection.
+   */
+  struct MHD_UringConn_ *uring;
+#endif /* IO_URING_SUPPORT */
 #endif
 
   /**
@@ -1601,6 +1982,33 @@ struct MHD_Connection
    * even though the socket is not?
    */
   bool tls_read_ready;
+
+  /**
+   * Set to 'true' if the encryption of the sent data is offloaded to
+   * the kernel (kernel TLS) so the data can be sent directly to
+   * the socket.
+   * @see #MHD_OPTION_HTTPS_KTLS
+   */
+  bool tls_ktls_send;
+
+#ifdef MHD_USE_THREADS
+  /**
+   * Set to 'true' when the handshake step is queued to the pool of
+   * the handshake threads, reset when the result of the step is processed.
+   * @see #MHD_OPTION_HTTPS_HANDSHAKE_THREADS
+   */
+  bool tls_hs_offloaded;
+
+  /**
+   * The result of the handshake step performed by the handshake thread.
+   */
+  int tls_hs_ret;
+
+  /**
+   * The next connection in the queue of the pool of the handshake threads.
+   */
+  struct MHD_Connection *tls_hs_next;
+#endif /* MHD_USE_THREADS */
 #endif /* HTTPS_SUPPORT */
 
   /**
@@ -1620,6 +2028,23 @@ struct MHD_Connection
    */
   volatile bool resuming;
 
+#ifdef MHD_HAVE_ATOMIC_
+  /**
+   * The next connection in the daemon's queue of resumed connections.
+   * Written by the thread pushing the connection to the queue, read by
+   * the daemon thread after taking the whole queue.
+   */
+  struct MHD_Connection *resume_next;
+
+  /**
+   * Non-zero if the connection is in the daemon's queue of resumed
+   * connections (or is being pushed to the queue).
+   * Used to push the connection only once if it is resumed several times
+   * before the daemon processes the queue.
+   */
+  volatile uint32_t resume_queued;
+#endif /* MHD_HAVE_ATOMIC_ */
+
   /**
    * Special member to be returned by #MHD_get_connection_info()
    */
@@ -1851,6 +2276,116 @@ typedef size_t
                     char *uri);
 
 
+#if defined(MHD_USE_THREADS) && defined(MHD_SO_REUSEPORT_BALANCED) && \
+  defined(MHD_USE_GETSOCKNAME)
+/**
+ * Indicate that separate listening sockets for the worker threads
+ * are supported.
+ */
+#define MHD_USE_LISTEN_SHARDING 1
+#endif /* MHD_USE_THREADS && MHD_SO_REUSEPORT_BALANCED && MHD_USE_GETSOCKNAME */
+
+
+#ifdef MHD_HAVE_ATOMIC_
+/**
+ * Indicate that the daemon-wide cache of the 'Date:' header is used.
+ */
+#define MHD_USE_DATE_CACHE 1
+
+/**
+ * The size of the cached date string, in 32-bit words.
+ * The string is 29 characters long.
+ */
+#define MHD_DATE_CACHE_WORDS_ 8
+
+/**
+ * The daemon-wide cache of the formatted date for the 'Date:' header.
+ * The cache is protected by the sequence lock: the writer makes @a seq
+ * odd while the data is updated, the readers check that @a seq is even
+ * and has not been changed while the data was copied.
+ * All members are accessed only by atomic operations.
+ */
+struct MHD_DateCache_
+{
+  /**
+   * The sequence counter.
+   */
+  volatile uint32_t seq;
+
+  /**
+   * The value of the monotonic seconds counter (plus one) when
+   * @a date was generated, zero if @a date was never generated.
+   */
+  volatile uint32_t mono_sec;
+
+  /**
+   * The formatted date string, not null-terminated.
+   */
+  volatile uint32_t date[MHD_DATE_CACHE_WORDS_];
+};
+#endif /* MHD_HAVE_ATOMIC_ */
+
+
+/**
+ * The statistics of the connection buffers usage, stored by the thread
+ * processing the connections.
+ * The values are read by #MHD_stats_read_() and summarised as
+ * struct MHD_DaemonBufferStats.
+ * @see #MHD_DAEMON_INFO_BUFFER_STATS
+ */
+struct MHD_BufferStats_
+{
+  /**
+   * The number of times the read buffers were grown.
+   */
+  uint64_t read_grows;
+
+  /**
+   * The number of times the read buffers were shrunk.
+   */
+  uint64_t read_shrinks;
+
+  /**
+   * The number of times the write buffers were grown.
+   */
+  uint64_t write_grows;
+};
+
+
+#ifdef EPOLL_SUPPORT
+/**
+ * The statistics of the event loop, stored by the thread processing
+ * the events.
+ * The values are read by #MHD_stats_read_() and summarised as
+ * struct MHD_DaemonEpollStats.
+ * @see #MHD_DAEMON_INFO_EPOLL_STATS
+ */
+struct MHD_EpollStats_
+{
+  /**
+   * The number of wake-ups with at least one event reported.
+   */
+  uint64_t wakeups;
+
+  /**
+   * The total number of the events reported for all wake-ups.
+   */
+  uint64_t events;
+
+  /**
+   * The number of the calls of 'epoll_wait()' that filled the events
+   * array completely.
+   */
+  uint64_t full_batches;
+
+  /**
+   * The largest number of events reported for a single wake-up.
+   */
+  uint64_t max_events;
+};
+#endif /* EPOLL_SUPPORT */
+
+
 /**
  * State kept for each MHD daemon.  All connections are kept in two
  * doubly-linked lists.  The first one reflects the state of the
@@ -1949,6 +2484,35 @@ struct MHD_Daemon
    */
   bool listen_socket_in_epoll;
 
+#ifdef IO_URING_SUPPORT
+  /**
+   * The io_uring of the daemon's thread, NULL if io_uring is not used.
+   * Created and used only by the daemon's thread, the 'epoll' FD is not
+   * used when io_uring is active.
+   */
+  struct MHD_Uring_ *uring;
+
+  /**
+   * The number of the requests in flight in the @e uring
+   */
+  unsigned int uring_ops;
+
+  /**
+   * The accept requests of the @e uring
+   */
+  struct MHD_UringAccept_ uring_accepts[MHD_URING_ACCEPT_NUM_];
+
+  /**
+   * The number of the accept requests in flight
+   */
+  unsigned int uring_accepts_num;
+
+  /**
+   * Set to 'true' if the ITC poll request is in flight
+   */
+  bool uring_itc_pending;
+#endif /* IO_URING_SUPPORT */
+
 #ifdef UPGRADE_SUPPORT
 #ifdef HTTPS_SUPPORT
   /**
@@ -1986,7 +2550,7 @@ struct MHD_Daemon
    *
    * All connections by default start in this list; if a custom
    * timeout that does not match @e connection_timeout_ms is set, they
-   * are moved to the @e manual_timeout_head-XDLL.
+   * are moved to the @e manual_timeout_heap.
    * Not used in MHD_USE_THREAD_PER_CONNECTION mode as each thread
    * needs only one connection-specific timeout.
    */
@@ -2000,19 +2564,15 @@ struct MHD_Daemon
   struct MHD_Connection *normal_timeout_tail;
 
   /**
-   * Head of the XDLL of ALL connections with a non-default/custom
-   * timeout, unsorted.  MHD will do a O(n) scan over this list to
-   * determine the current timeout.
+   * The heap of ALL connections with a non-default/custom timeout,
+   * sorted by the deadline (the earliest at the root).
+   * The keys are updated lazily: the key of the connection is not
+   * changed by the activity on the connection, so the key may be
+   * smaller than the real deadline.  The key of the root is updated
+   * and the heap is re-sorted when the earliest deadline is needed.
    * Not used in MHD_USE_THREAD_PER_CONNECTION mode.
    */
-  struct MHD_Connection *manual_timeout_head;
-
-  /**
-   * Tail of the XDLL of ALL connections with a non-default/custom
-   * timeout, unsorted.
-   * Not used in MHD_USE_THREAD_PER_CONNECTION mode.
-   */
-  struct MHD_Connection *manual_timeout_tail;
+  struct MHD_TmHeap_ manual_timeout_heap;
 
   /**
    * Function to call to check if we should accept or reject an
@@ -2110,6 +2670,135 @@ struct MHD_Daemon
    */
   bool listen_nonblk;
 
+  /**
+   * The mode of distribution of the new connections between the workers.
+   * @see #MHD_OPTION_LISTEN_SHARDING
+   */
+  enum MHD_ListenSharding listen_sharding;
+
+  /**
+   * 'true' if @e listen_fd is the own listening socket of the worker daemon,
+   * which must be closed by the worker daemon.
+   * Always 'false' for the master daemon.
+   */
+  bool listen_is_shard;
+
+  /**
+   * The maximum number of connections accepted in one turn of the event
+   * loop.
+   * @see #MHD_OPTION_ACCEPT_BATCH_SIZE
+   */
+  unsigned int accept_batch_size;
+
+  /**
+   * 'true' if the connections activity is stamped by @a loop_time
+   * instead of reading the clock for every network operation.
+   * @see #MHD_OPTION_COARSE_ACTIVITY_TIME
+   */
+  bool coarse_time;
+
+  /**
+   * The time of the current iteration of the event loop, used as
+   * the activity time for the connections if @a coarse_time is set.
+   * Updated only by the thread processing the events.
+   */
+  uint64_t loop_time;
+
+  /**
+   * The cache of the unused connection memory pools.
+   * Used only by the thread processing the connections of this daemon.
+   * @see #MHD_OPTION_CONNECTION_MEMORY_POOL_CACHE,
+   *      #MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB
+   */
+  struct MemoryPoolCache pool_cache;
+
+  /**
+   * 'true' if the starting size of the read buffers is learned from
+   * the processed requests.
+   * @see #MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS
+   */
+  bool adaptive_bufs;
+
+  /**
+   * The moving average of the read buffer size needed for the requests.
+   * Zero if no requests have been processed yet.
+   * Used only if @a adaptive_bufs is set.  Written by #MHD_stats_set_()
+   * only by the thread processing the connections.
+   */
+  uint64_t read_buf_avg;
+
+  /**
+   * The statistics of the connection buffers usage.
+   * Updated only if @a adaptive_bufs is set, only by the thread
+   * processing the connections.
+   * @see #MHD_DAEMON_INFO_BUFFER_STATS
+   */
+  struct MHD_BufferStats_ buf_stats;
+
+  /**
+   * The statistics of the daemon operations.
+   * Updated without locks by the thread processing the connections, the
+   * atomic operations are used if the statistics could be updated by
+   * several threads.
+   * @see #MHD_DAEMON_INFO_STATS, #MHD_STATS_ADD_()
+   */
+  struct MHD_DaemonStats stats;
+
+  /**
+   * 'true' if the duration of the request phases is measured.
+   * @see #MHD_OPTION_CONNECTION_PHASE_TIMING
+   */
+  bool phase_timing;
+
+  /**
+   * The histograms of the duration of the request phases.
+   * Updated like @a stats, only if @a phase_timing is set.
+   * @see #MHD_DAEMON_INFO_PHASE_HISTOGRAMS
+   */
+  struct MHD_DaemonPhaseHistograms phase_hist;
+
+  /**
+   * The summarised histograms returned by #MHD_get_daemon_info().
+   * Allocated when requested for the first time.
+   */
+  struct MHD_DaemonPhaseHistograms *phase_hist_info;
+
+#ifdef EPOLL_SUPPORT
+  /**
+   * 'true' if the listen socket shared by the workers should be added
+   * to the epoll set with the 'EPOLLEXCLUSIVE' flag.
+   * @see #MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE
+   */
+  bool listen_epoll_exclusive;
+
+  /**
+   * The number of elements in @e epoll_events.
+   * @see #MHD_OPTION_EPOLL_EVENTS_SIZE
+   */
+  unsigned int epoll_events_size;
+
+  /**
+   * The array for the events returned by epoll_wait().
+   * Allocated by the thread processing the events on the first use.
+   */
+  struct epoll_event *epoll_events;
+
+  /**
+   * 'true' if the ready connections are processed by separate passes
+   * for receiving, processing and sending.
+   * @see #MHD_OPTION_EPOLL_BATCH_PROCESSING
+   */
+  bool epoll_batched;
+
+  /**
+   * The statistics of the event loop.
+   * Updated only by the thread processing the events, read by
+   * #MHD_stats_read_().
+   * @see #MHD_DAEMON_INFO_EPOLL_STATS
+   */
+  struct MHD_EpollStats_ epoll_stats;
+#endif /* EPOLL_SUPPORT */
+
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
   /**
    * Worker daemons (one per thread)
@@ -2118,9 +2807,11 @@ struct MHD_Daemon
 #endif
 
   /**
-   * Table storing number of connections per IP
+   * Table storing number of connections per IP.
+   * Used only by the master daemon, NULL if
+   * #MHD_OPTION_PER_IP_CONNECTION_LIMIT is not used.
    */
-  void *per_ip_connection_count;
+  struct MHD_IPLimitTable_ *per_ip_table;
 
   /**
    * Number of active parallel connections.
@@ -2140,6 +2831,30 @@ struct MHD_Daemon
    */
   size_t pool_increment;
 
+#if defined(_MHD_HAVE_SENDFILE)
+  /**
+   * 'true' if the sendfile() chunks are sized according to the free space
+   * in the socket send buffer.
+   * @see #MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK
+   */
+  bool sendfile_adaptive;
+#endif /* _MHD_HAVE_SENDFILE */
+
+#ifdef MHD_USE_MSG_ZEROCOPY
+  /**
+   * The minimal size of the response data sent with MSG_ZEROCOPY.
+   * Zero if zero-copy sends are disabled.
+   * @see #MHD_OPTION_SEND_ZEROCOPY_THRESHOLD
+   */
+  size_t zerocopy_threshold;
+
+  /**
+   * The list of the sockets of the closed connections waiting for
+   * the completion of the zero-copy sends.
+   */
+  struct MHD_ZcLinger_ *zc_linger;
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
 #if defined(MHD_USE_POSIX_THREADS) || defined(MHD_USE_W32_THREADS)
   /**
    * Size of threads created by MHD.
@@ -2157,13 +2872,8 @@ struct MHD_Daemon
   MHD_thread_handle_ID_ tid;
 
   /**
-   * Mutex for per-IP connection counts.
-   */
-  MHD_mutex_ per_ip_connection_mutex;
-
-  /**
-   * Mutex for (modifying) access to the "cleanup", "normal_timeout" and
-   * "manual_timeout" DLLs.
+   * Mutex for (modifying) access to the "cleanup", "normal_timeout"
+   * DLLs and "manual_timeout" heap.
    */
   MHD_mutex_ cleanup_connection_mutex;
 
@@ -2220,9 +2930,21 @@ struct MHD_Daemon
 
   /*
    * Do we need to process resuming connections?
+   * When set, all suspended connections are checked.
    */
   volatile bool resuming;
 
+#ifdef MHD_HAVE_ATOMIC_
+  /**
+   * The head of the lock-free (multiple producers, single consumer) stack
+   * of the resumed connections, linked by @e resume_next.
+   * The connections are pushed by #MHD_resume_connection() and the whole
+   * stack is taken by the daemon thread, so only the resumed connections
+   * are processed instead of all suspended connections.
+   */
+  struct MHD_Connection *volatile resume_queue;
+#endif /* MHD_HAVE_ATOMIC_ */
+
   /**
    * Indicate that new connections in @e new_connections_head list
    * need to be processed.
@@ -2389,6 +3111,53 @@ struct MHD_Daemon
    */
   bool disable_alpn;
 
+  /**
+   * true if the kernel TLS should be used for sending when available.
+   * @see #MHD_OPTION_HTTPS_KTLS
+   */
+  bool https_ktls;
+
+  /**
+   * The lifetime of the TLS session tickets, in seconds.
+   * Zero if the tickets are disabled.
+   * @see #MHD_OPTION_HTTPS_SESSION_TICKETS
+   */
+  unsigned int tls_tickets_lifetime;
+
+  /**
+   * The maximum number of the sessions in the TLS sessions cache.
+   * Zero if the cache is disabled.
+   * @see #MHD_OPTION_HTTPS_SESSION_CACHE
+   */
+  unsigned int tls_sess_cache_size;
+
+  /**
+   * The keys of the TLS session tickets.
+   * Created by the master daemon, shared by the worker daemons.
+   */
+  struct MHD_TlsTickets_ *tls_tickets;
+
+  /**
+   * The cache of the TLS sessions.
+   * Created by the master daemon, shared by the worker daemons.
+   */
+  struct MHD_TlsSessCache_ *tls_sess_cache;
+
+#ifdef MHD_USE_THREADS
+  /**
+   * The number of the TLS handshake threads.
+   * Zero if the handshakes are performed by the daemon threads.
+   * @see #MHD_OPTION_HTTPS_HANDSHAKE_THREADS
+   */
+  unsigned int tls_hs_threads;
+
+  /**
+   * The pool of the TLS handshake threads.
+   * Created by the master daemon, shared by the worker daemons.
+   */
+  struct MHD_TlsHsPool_ *tls_hs_pool;
+#endif /* MHD_USE_THREADS */
+
   #endif /* HTTPS_SUPPORT */
 
 #ifdef DAUTH_SUPPORT
@@ -2453,6 +3222,14 @@ struct MHD_Daemon
    */
   unsigned int listen_backlog_size;
 
+#ifdef MHD_USE_DATE_CACHE
+  /**
+   * The cache of the 'Date:' header value.
+   * Used only in the master daemon, the workers use the master's cache.
+   */
+  struct MHD_DateCache_ date_cache;
+#endif /* MHD_USE_DATE_CACHE */
+
   /* TODO: replace with a single member */
   /**
    * The value to be returned by #MHD_get_daemon_info()
@@ -2464,8 +3241,28 @@ struct MHD_Daemon
    * The value to be returned by #MHD_get_daemon_info()
    */
   union MHD_DaemonInfo daemon_info_dummy_epoll_fd;
+
+  /**
+   * The value to be returned by #MHD_get_daemon_info()
+   */
+  union MHD_DaemonInfo daemon_info_dummy_epoll_stats;
 #endif /* EPOLL_SUPPORT */
 
+  /**
+   * The value to be returned by #MHD_get_daemon_info()
+   */
+  union MHD_DaemonInfo daemon_info_dummy_buffer_stats;
+
+  /**
+   * The value to be returned by #MHD_get_daemon_info()
+   */
+  union MHD_DaemonInfo daemon_info_dummy_stats;
+
+  /**
+   * The value to be returned by #MHD_get_daemon_info()
+   */
+  union MHD_DaemonInfo daemon_info_dummy_phase_hist;
+
   /**
    * The value to be returned by #MHD_get_daemon_info()
    */
@@ -2550,6 +3347,21 @@ struct MHD_Daemon
 #define MHD_D_IS_USING_EPOLL_(d) ((void) (d), 0)
 #endif /* select() only */
 
+#ifdef IO_URING_SUPPORT
+/**
+ * Checks whether the @a d daemon is requested to use io_uring.
+ * The daemon's thread may still fallback to epoll if the ring cannot be
+ * created, check for non-NULL @a uring member of the daemon to detect
+ * the active io_uring.
+ */
+#define MHD_D_IS_USING_IO_URING_(d) (0 != ((d)->options & MHD_USE_IO_URING))
+#else  /* ! IO_URING_SUPPORT */
+/**
+ * Checks whether the @a d daemon is requested to use io_uring
+ */
+#define MHD_D_IS_USING_IO_URING_(d) ((void) (d), 0)
+#endif /* ! IO_URING_SUPPORT */
+
 #if defined(MHD_USE_THREADS)
 /**
  * Checks whether the @a d daemon is using internal polling thread
@@ -2595,6 +3407,23 @@ struct MHD_Daemon
 #define MHD_D_GET_FD_SETSIZE_(d) (FD_SETSIZE)
 #endif /* ! HAS_FD_SETSIZE_OVERRIDABLE */
 
+#ifdef HTTPS_SUPPORT
+/**
+ * Checks whether the data of the @a c connection must be sent by TLS
+ * library functions (encrypted in user space).
+ * If kernel TLS is used for sending, the data can be sent by plain
+ * socket functions (including vector send and sendfile()).
+ */
+#define MHD_C_IS_TLS_LIB_SEND_(c) \
+  ((0 != ((c)->daemon->options & MHD_USE_TLS)) && ! (c)->tls_ktls_send)
+#else  /* ! HTTPS_SUPPORT */
+/**
+ * Checks whether the data of the @a c connection must be sent by TLS
+ * library functions (encrypted in user space).
+ */
+#define MHD_C_IS_TLS_LIB_SEND_(c) ((void) (c), 0)
+#endif /* ! HTTPS_SUPPORT */
+
 /**
  * Check whether socket @a sckt fits fd_sets used by the daemon @a d
  */
@@ -2889,6 +3718,17 @@ void
 internal_suspend_connection_ (struct MHD_Connection *connection);
 
 
+/**
+ * Internal version of ::MHD_resume_connection().
+ *
+ * @remark Can be called from any thread.
+ *
+ * @param connection the connection to resume
+ */
+void
+internal_resume_connection_ (struct MHD_Connection *connection);
+
+
 /**
  * Trace up to and return master daemon. If the supplied daemon
  * is a master, then return the daemon itself.
@@ -2911,6 +3751,110 @@ MHD_get_master (struct MHD_Daemon *const daemon)
 }
 
 
+/**
+ * Add the value to the statistics counter.
+ * If the counter is updated only by one thread, the atomic read and
+ * write are used to avoid the locked instructions.
+ * @param counter the counter to update
+ * @param val the value to add
+ * @param shared set to 'true' if the counter could be updated by
+ *               several threads at the same time
+ */
+_MHD_static_inline void
+MHD_stats_add_ (uint64_t *counter,
+                uint64_t val,
+                bool shared)
+{
+#ifdef MHD_HAVE_ATOMIC_U64_
+  if (shared)
+    mhd_atomic_u64_add_rlx_ (counter, val);
+  else
+    mhd_atomic_u64_store_rlx_ (counter,
+                               mhd_atomic_u64_load_rlx_ (counter) + val);
+#else  /* ! MHD_HAVE_ATOMIC_U64_ */
+  (void) shared; /* The counters are not exact without atomics */
+  *counter += val;
+#endif /* ! MHD_HAVE_ATOMIC_U64_ */
+}
+
+
+/**
+ * Update the statistics value to be not smaller than given value.
+ * @param value the value to update
+ * @param val the new value
+ * @param shared set to 'true' if the value could be updated by
+ *               several threads at the same time
+ */
+_MHD_static_inline void
+MHD_stats_max_ (uint64_t *value,
+                uint64_t val,
+                bool shared)
+{
+#ifdef MHD_HAVE_ATOMIC_U64_
+  uint64_t cur;
+
+  cur = mhd_atomic_u64_load_rlx_ (value);
+  while (cur < val)
+  {
+    if (! shared)
+    {
+      mhd_atomic_u64_store_rlx_ (value, val);
+      break;
+    }
+    if (mhd_atomic_u64_cas_rlx_ (value, cur, val))
+      break;
+    cur = mhd_atomic_u64_load_rlx_ (value);
+  }
+#else  /* ! MHD_HAVE_ATOMIC_U64_ */
+  (void) shared; /* The values are not exact without atomics */
+  if (*value < val)
+    *value = val;
+#endif /* ! MHD_HAVE_ATOMIC_U64_ */
+}
+
+
+/**
+ * Set the statistics value updated only by one thread.
+ * @param value the value to update
+ * @param val the new value
+ */
+_MHD_static_inline void
+MHD_stats_set_ (uint64_t *value,
+                uint64_t val)
+{
+#ifdef MHD_HAVE_ATOMIC_U64_
+  mhd_atomic_u64_store_rlx_ (value, val);
+#else  /* ! MHD_HAVE_ATOMIC_U64_ */
+  *value = val;
+#endif /* ! MHD_HAVE_ATOMIC_U64_ */
+}
+
+
+/**
+ * Add the value to the statistics counter of the daemon.
+ * With thread-per-connection the counters are updated by the connection
+ * threads, the atomic addition is used.
+ * @param d the daemon processing the connection
+ * @param field the name of the member of struct MHD_DaemonStats
+ * @param val the value to add
+ */
+#define MHD_STATS_ADD_(d,field,val) \
+  MHD_stats_add_ (&((d)->stats.field), (uint64_t) (val), \
+                  MHD_D_IS_USING_THREAD_PER_CONN_ (d))
+
+
+/**
+ * Read the statistics value.
+ * @param ptr the pointer to the value
+ * @return the value
+ */
+#ifdef MHD_HAVE_ATOMIC_U64_
+#define MHD_stats_read_(ptr) mhd_atomic_u64_load_rlx_ (ptr)
+#else  /* ! MHD_HAVE_ATOMIC_U64_ */
+#define MHD_stats_read_(ptr) (*(ptr))
+#endif /* ! MHD_HAVE_ATOMIC_U64_ */
+
+
 #ifdef UPGRADE_SUPPORT
 /**
  * Mark upgraded connection as closed by application.
@@ -257,6 +257,26 @@ struct MemoryPool
    * 'false' if pool was malloc'ed, 'true' if mmapped (VirtualAlloc'ed for W32).
    */
   bool is_mmap;
+
+  /**
+   * 'true' if all unallocated bytes of the pool (between @a pos and @a end)
+   * are zeros.
+   * The pool functions zero-out the memory when it is returned to the pool,
+   * so once the pool has been zeroed completely, only the allocated parts
+   * need to be zeroed on reset.
+   */
+  bool free_is_zero;
+
+  /**
+   * 'true' if the pool memory is a part of the slab of the pools cache.
+   * Such pools are never destroyed, they are always returned to the cache.
+   */
+  bool is_slab;
+
+  /**
+   * The next pool in the cache of unused pools.
+   */
+  struct MemoryPool *next_cached;
 };
 
 
@@ -315,13 +335,17 @@ MHD_pool_create (size_t max)
       return NULL;
     }
     pool->is_mmap = false;
+    pool->free_is_zero = false;
   }
 #if defined(MAP_ANONYMOUS) || defined(_WIN32)
   else
   {
     pool->is_mmap = true;
+    pool->free_is_zero = true; /* New anonymous mappings are zero-filled */
   }
 #endif /* _WIN32 || MAP_ANONYMOUS */
+  pool->is_slab = false;
+  pool->next_cached = NULL;
   mhd_assert (0 == (((uintptr_t) pool->memory) % ALIGN_SIZE));
   pool->pos = 0;
   pool->end = alloc_size;
@@ -343,6 +367,7 @@ MHD_pool_destroy (struct MemoryPool *pool)
   if (NULL == pool)
     return;
 
+  mhd_assert (! pool->is_slab);
   mhd_assert (pool->end >= pool->pos);
   mhd_assert (pool->size >= pool->end - pool->pos);
   mhd_assert (pool->pos == ROUND_TO_ALIGN (pool->pos));
@@ -384,6 +409,22 @@ MHD_pool_get_free (struct MemoryPool *pool)
 }
 
 
+/**
+ * Check how much memory of the @a pool is allocated
+ *
+ * @param pool pool to check
+ * @return number of bytes allocated from the @a pool (both from
+ *         the start and from the end of the pool)
+ */
+size_t
+MHD_pool_get_used (struct MemoryPool *pool)
+{
+  mhd_assert (pool->end >= pool->pos);
+  mhd_assert (pool->size >= pool->end - pool->pos);
+  return pool->size - (pool->end - pool->pos);
+}
+
+
 /**
  * Allocate size bytes from the pool.
  *
@@ -753,7 +794,30 @@ MHD_pool_reset (struct MemoryPool *pool,
                copy_bytes);
   }
   /* technically not needed, but safer to zero out */
-  if (pool->size > copy_bytes)
+  if (pool->free_is_zero)
+  {
+    /* Only the allocated parts of the pool may have non-zero bytes */
+    size_t end_zero;  /** The start of the area "from the end" to zero-out */
+
+    if (pool->pos > copy_bytes)
+    {
+      _MHD_UNPOISON_MEMORY (pool->memory + copy_bytes, \
+                            pool->pos - copy_bytes);
+      memset (&pool->memory[copy_bytes],
+              0,
+              pool->pos - copy_bytes);
+    }
+    end_zero = (pool->end > copy_bytes) ? pool->end : copy_bytes;
+    if (pool->size > end_zero)
+    {
+      _MHD_UNPOISON_MEMORY (pool->memory + end_zero, \
+                            pool->size - end_zero);
+      memset (&pool->memory[end_zero],
+              0,
+              pool->size - end_zero);
+    }
+  }
+  else if (pool->size > copy_bytes)
   {
     size_t to_zero;   /** Size of area to zero-out */
 
@@ -788,6 +852,7 @@ MHD_pool_reset (struct MemoryPool *pool,
             0,
             to_zero);
   }
+  pool->free_is_zero = true;
   pool->pos = ROUND_TO_ALIGN_PLUS_RED_ZONE (new_size);
   pool->end = pool->size;
   _MHD_POISON_MEMORY (((uint8_t *) pool->memory) + new_size, \
@@ -796,4 +861,279 @@ MHD_pool_reset (struct MemoryPool *pool,
 }
 
 
+/**
+ * The alignment of the slab size and the size of the pools in the slab.
+ * Matches the size of the huge page on the most common platforms.
+ */
+#define MHD_SLAB_ALIGN_ ((size_t) 2 * 1024 * 1024)
+
+/**
+ * The alignment of the pools in the slab, the common size of the cache
+ * line.
+ */
+#define MHD_SLAB_POOL_ALIGN_ ((size_t) 64)
+
+
+/**
+ * Initialise the cache of the unused memory pools.
+ *
+ * @param cache the cache to initialise
+ * @param pool_size the size of the pools in the cache
+ * @param max_num the maximum number of the pools kept in the cache,
+ *                zero to disable caching
+ * @param slab_num the number of the pools in the slab,
+ *                 zero to not use the slab
+ */
+void
+MHD_pool_cache_init (struct MemoryPoolCache *cache,
+                     size_t pool_size,
+                     unsigned int max_num,
+                     unsigned int slab_num)
+{
+  mhd_assert (0 < pool_size);
+  cache->head = NULL;
+  cache->pool_size = pool_size;
+  cache->num = 0;
+  cache->max_num = max_num;
+  cache->slab = NULL;
+  cache->slab_size = 0;
+  cache->slab_pools = NULL;
+  cache->slab_num = slab_num;
+  cache->slab_used = 0;
+  cache->slab_free = NULL;
+}
+
+
+/**
+ * Map the slab memory and allocate the handles for the pools in the slab.
+ *
+ * The huge pages are used if available.  The memory is not touched here,
+ * the pages are allocated when the pools are used for the first time, so
+ * with the default "local" memory policy the memory is allocated on
+ * the NUMA node of the thread using the cache.
+ *
+ * @param cache the cache to use
+ * @return 'true' if the slab has been created,
+ *         'false' otherwise
+ */
+static bool
+pool_cache_create_slab (struct MemoryPoolCache *cache)
+{
+#if defined(MAP_ANONYMOUS) && ! defined(_WIN32)
+  size_t slab_pool_size;
+  size_t slab_size;
+  void *slab;
+
+  mhd_assert (NULL == cache->slab);
+  mhd_assert (0 != cache->slab_num);
+  slab_pool_size = cache->pool_size + MHD_SLAB_POOL_ALIGN_ - 1;
+  slab_pool_size -= slab_pool_size % MHD_SLAB_POOL_ALIGN_;
+  if ((SIZE_MAX - MHD_SLAB_ALIGN_) / cache->slab_num < slab_pool_size)
+    return false; /* Too large */
+  slab_size = slab_pool_size * cache->slab_num + MHD_SLAB_ALIGN_ - 1;
+  slab_size -= slab_size % MHD_SLAB_ALIGN_;
+
+  cache->slab_pools = malloc (sizeof (struct MemoryPool) * cache->slab_num);
+  if (NULL == cache->slab_pools)
+    return false;
+  slab = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  /* Works only if the huge pages have been reserved in the system */
+  slab = mmap (NULL,
+               slab_size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+               -1,
+               0);
+#endif /* MAP_HUGETLB */
+  if (MAP_FAILED == slab)
+  {
+    slab = mmap (NULL,
+                 slab_size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0);
+    if (MAP_FAILED == slab)
+    {
+      free (cache->slab_pools);
+      cache->slab_pools = NULL;
+      return false;
+    }
+#ifdef MADV_HUGEPAGE
+    /* Ask for the transparent huge pages, failure is not critical */
+    (void) madvise (slab,
+                    slab_size,
+                    MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+  }
+  mhd_assert (0 == (((uintptr_t) slab) % ALIGN_SIZE));
+  cache->slab = (uint8_t *) slab;
+  cache->slab_size = slab_size;
+  cache->slab_pool_size = slab_pool_size;
+  return true;
+#else  /* _WIN32 || ! MAP_ANONYMOUS */
+  (void) cache; /* Mute compiler warning */
+  return false;
+#endif /* _WIN32 || ! MAP_ANONYMOUS */
+}
+
+
+/**
+ * Get the next unused pool from the slab.
+ *
+ * @param cache the cache to use
+ * @return the new pool,
+ *         NULL if the slab is not used or all pools in the slab are used
+ */
+static struct MemoryPool *
+pool_cache_get_slab_pool (struct MemoryPoolCache *cache)
+{
+  struct MemoryPool *pool;
+
+  if (cache->slab_used >= cache->slab_num)
+    return NULL;
+  if ( (NULL == cache->slab) &&
+       (! pool_cache_create_slab (cache)) )
+  {
+    cache->slab_num = 0; /* Do not try again */
+    return NULL;
+  }
+  pool = cache->slab_pools + cache->slab_used;
+  pool->memory = cache->slab + cache->slab_pool_size * cache->slab_used;
+  pool->size = cache->slab_pool_size;
+  pool->pos = 0;
+  pool->end = pool->size;
+  pool->is_mmap = true;
+  pool->free_is_zero = true; /* New anonymous mappings are zero-filled */
+  pool->is_slab = true;
+  pool->next_cached = NULL;
+  cache->slab_used++;
+  _MHD_POISON_MEMORY (pool->memory, pool->size);
+  return pool;
+}
+
+
+/**
+ * Get the memory pool from the cache or create the new pool if
+ * the cache is empty.
+ *
+ * @param cache the cache to use
+ * @return the pool with all memory available,
+ *         NULL on error
+ */
+struct MemoryPool *
+MHD_pool_cache_get (struct MemoryPoolCache *cache)
+{
+  struct MemoryPool *pool;
+
+  pool = cache->slab_free;
+  if (NULL != pool)
+  {
+    mhd_assert (pool->is_slab);
+    cache->slab_free = pool->next_cached;
+  }
+  else
+  {
+    pool = cache->head;
+    if (NULL == pool)
+    {
+      pool = pool_cache_get_slab_pool (cache);
+      if (NULL == pool)
+        return MHD_pool_create (cache->pool_size);
+      return pool;
+    }
+    mhd_assert (0 < cache->num);
+    cache->head = pool->next_cached;
+    cache->num--;
+  }
+  mhd_assert (0 == pool->pos);
+  mhd_assert (pool->size == pool->end);
+  pool->next_cached = NULL;
+  return pool;
+}
+
+
+/**
+ * Return the memory pool to the cache.
+ * The pool is reset and kept in the cache if the cache is not full,
+ * otherwise the pool is destroyed.
+ * The pools from the slab are always kept.
+ *
+ * @param cache the cache to use
+ * @param pool the pool to put to the cache, NULL is tolerated
+ */
+void
+MHD_pool_cache_put (struct MemoryPoolCache *cache,
+                    struct MemoryPool *pool)
+{
+  if (NULL == pool)
+    return;
+  if ( (! pool->is_slab) &&
+       (cache->num >= cache->max_num) )
+  {
+    MHD_pool_destroy (pool);
+    return;
+  }
+  /* Zero-out only the used parts of the pool */
+  (void) MHD_pool_reset (pool,
+                         NULL,
+                         0,
+                         0);
+  if (pool->is_slab)
+  {
+    pool->next_cached = cache->slab_free;
+    cache->slab_free = pool;
+    return;
+  }
+  pool->next_cached = cache->head;
+  cache->head = pool;
+  cache->num++;
+}
+
+
+/**
+ * Destroy all memory pools in the cache and release the slab.
+ * All pools from the slab must be returned to the cache before this call.
+ * The cache can be used again after this call.
+ *
+ * @param cache the cache to clear
+ */
+void
+MHD_pool_cache_clear (struct MemoryPoolCache *cache)
+{
+  struct MemoryPool *pool;
+
+  while (NULL != (pool = cache->head))
+  {
+    cache->head = pool->next_cached;
+    MHD_pool_destroy (pool);
+  }
+  cache->num = 0;
+  if (NULL != cache->slab)
+  {
+#ifdef _DEBUG
+    unsigned int num_free;
+
+    num_free = 0;
+    for (pool = cache->slab_free; NULL != pool; pool = pool->next_cached)
+      num_free++;
+    mhd_assert (cache->slab_used == num_free);
+#endif /* _DEBUG */
+    _MHD_UNPOISON_MEMORY (cache->slab, cache->slab_size);
+#if defined(MAP_ANONYMOUS) && ! defined(_WIN32)
+    munmap (cache->slab,
+            cache->slab_size);
+#else  /* _WIN32 || ! MAP_ANONYMOUS */
+    abort ();
+#endif /* _WIN32 || ! MAP_ANONYMOUS */
+    free (cache->slab_pools);
+    cache->slab = NULL;
+    cache->slab_pools = NULL;
+    cache->slab_used = 0;
+    cache->slab_free = NULL;
+  }
+}
+
+
 /* end of memorypool.c */
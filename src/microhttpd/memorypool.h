@@ -34,6 +34,7 @@
 #ifdef HAVE_STDDEF_H
 #include <stddef.h>
 #endif /* HAVE_STDDEF_H */
+#include <stdint.h>
 #ifdef HAVE_STDBOOL_H
 #include <stdbool.h>
 #endif
@@ -45,6 +46,68 @@
  */
 struct MemoryPool;
 
+/**
+ * The cache of the unused memory pools.
+ * The cache is not thread-safe, it must be used only by a single thread.
+ */
+struct MemoryPoolCache
+{
+  /**
+   * The head of the list of the cached pools.
+   */
+  struct MemoryPool *head;
+
+  /**
+   * The size of the pools created for the cache.
+   */
+  size_t pool_size;
+
+  /**
+   * The number of the pools in the cache.
+   */
+  unsigned int num;
+
+  /**
+   * The maximum number of the pools in the cache.
+   */
+  unsigned int max_num;
+
+  /**
+   * The memory reserved for the pools, NULL if not allocated yet.
+   */
+  uint8_t *slab;
+
+  /**
+   * The size of the @a slab memory.
+   */
+  size_t slab_size;
+
+  /**
+   * The size of each pool in the @a slab.
+   */
+  size_t slab_pool_size;
+
+  /**
+   * The handles of the pools in the @a slab.
+   */
+  struct MemoryPool *slab_pools;
+
+  /**
+   * The number of the pools in the @a slab, zero if the slab is not used.
+   */
+  unsigned int slab_num;
+
+  /**
+   * The number of the pools taken from the @a slab.
+   */
+  unsigned int slab_used;
+
+  /**
+   * The list of the unused pools from the @a slab.
+   */
+  struct MemoryPool *slab_free;
+};
+
 /**
  * Initialize values for memory pools
  */
@@ -161,6 +224,17 @@ size_t
 MHD_pool_get_free (struct MemoryPool *pool);
 
 
+/**
+ * Check how much memory of the @a pool is allocated
+ *
+ * @param pool pool to check
+ * @return number of bytes allocated from the @a pool (both from
+ *         the start and from the end of the pool)
+ */
+size_t
+MHD_pool_get_used (struct MemoryPool *pool);
+
+
 /**
  * Deallocate a block of memory obtained from the pool.
  *
@@ -198,4 +272,62 @@ MHD_pool_reset (struct MemoryPool *pool,
                 size_t copy_bytes,
                 size_t new_size);
 
+
+/**
+ * Initialise the cache of the unused memory pools.
+ *
+ * If @a slab_num is not zero, the first @a slab_num pools are allocated
+ * from the single memory area (backed by the huge pages if possible),
+ * which is reserved when the first pool is requested.  The pools from
+ * the slab are always returned to the cache, regardless of @a max_num.
+ *
+ * @param cache the cache to initialise
+ * @param pool_size the size of the pools in the cache
+ * @param max_num the maximum number of the pools kept in the cache,
+ *                zero to disable caching
+ * @param slab_num the number of the pools in the slab,
+ *                 zero to not use the slab
+ */
+void
+MHD_pool_cache_init (struct MemoryPoolCache *cache,
+                     size_t pool_size,
+                     unsigned int max_num,
+                     unsigned int slab_num);
+
+
+/**
+ * Get the memory pool from the cache or create the new pool if
+ * the cache is empty.
+ *
+ * @param cache the cache to use
+ * @return the pool with all memory available,
+ *         NULL on error
+ */
+struct MemoryPool *
+MHD_pool_cache_get (struct MemoryPoolCache *cache);
+
+
+/**
+ * Return the memory pool to the cache.
+ * The pool is reset and kept in the cache if the cache is not full,
+ * otherwise the pool is destroyed.
+ *
+ * @param cache the cache to use
+ * @param pool the pool to put to the cache, NULL is tolerated
+ */
+void
+MHD_pool_cache_put (struct MemoryPoolCache *cache,
+                    struct MemoryPool *pool);
+
+
+/**
+ * Destroy all memory pools in the cache and release the slab.
+ * All pools from the slab must be returned to the cache before this call.
+ * The cache can be used again after this call.
+ *
+ * @param cache the cache to clear
+ */
+void
+MHD_pool_cache_clear (struct MemoryPoolCache *cache);
+
 #endif
@@ -0,0 +1,287 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/**
+ * @file microhttpd/mhd_atomic.h
+ * @brief  Header for platform-independent atomic operations
+ *
+ * Provides minimal set of lock-free operations on 32-bit values and
+ * pointers.
+ * Operations are available only if #MHD_HAVE_ATOMIC_ is defined,
+ * callers must provide fallback (typically based on mutex) otherwise.
+ * Operations on 64-bit values are available only if #MHD_HAVE_ATOMIC_U64_
+ * is defined.
+ * Any function can be implemented as macro, so avoid variable
+ * modification in function parameters.
+ *
+ * Suffixes of the operations names define the memory order:
+ * "_rlx_" - relaxed, "_acq_" - acquire, "_rel_" - release.
+ * Platform implementation may use stronger memory order.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_ATOMIC_H
+#define MHD_ATOMIC_H 1
+
+#include "mhd_options.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED) && \
+  defined(__GCC_ATOMIC_INT_LOCK_FREE) && (2 == __GCC_ATOMIC_INT_LOCK_FREE)
+/* GCC >= 4.7 or clang */
+#  define MHD_ATOMIC_GCC_BUILTINS_ 1
+#elif defined(_MSC_FULL_VER) && defined(_WIN32)
+#  define MHD_ATOMIC_W32_INTERLOCKED_ 1
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN 1
+#  endif /* !WIN32_LEAN_AND_MEAN */
+#  include <windows.h>
+#endif
+
+#if defined(MHD_ATOMIC_GCC_BUILTINS_) || defined(MHD_ATOMIC_W32_INTERLOCKED_)
+/**
+ * Defined if lock-free atomic operations are available
+ */
+#define MHD_HAVE_ATOMIC_ 1
+#endif
+
+
+#if defined(MHD_ATOMIC_GCC_BUILTINS_)
+/**
+ * Atomically read the value.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @return the value of the variable
+ */
+#define mhd_atomic_u32_load_rlx_(ptr) \
+  ((uint32_t) __atomic_load_n ((ptr), __ATOMIC_RELAXED))
+
+/**
+ * Atomically read the value, later memory accesses of the current thread
+ * are not reordered before the read.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @return the value of the variable
+ */
+#define mhd_atomic_u32_load_acq_(ptr) \
+  ((uint32_t) __atomic_load_n ((ptr), __ATOMIC_ACQUIRE))
+
+/**
+ * Atomically write the value.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @param val the value to write
+ */
+#define mhd_atomic_u32_store_rlx_(ptr,val) \
+  __atomic_store_n ((ptr), (uint32_t) (val), __ATOMIC_RELAXED)
+
+/**
+ * Atomically write the value, previous memory accesses of the current
+ * thread are not reordered after the write.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @param val the value to write
+ */
+#define mhd_atomic_u32_store_rel_(ptr,val) \
+  __atomic_store_n ((ptr), (uint32_t) (val), __ATOMIC_RELEASE)
+
+/**
+ * Atomically replace the value with @a desired if the current value is
+ * equal to @a expected.
+ * Acquire memory order is used when the value is replaced.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @param expected the expected current value
+ * @param desired the value to set
+ * @return boolean 'true' if the value has been replaced,
+ *         'false' otherwise
+ */
+#define mhd_atomic_u32_cas_acq_(ptr,expected,desired) \
+  mhd_atomic_u32_cas_acq_impl_ ((ptr), (expected), (desired))
+
+_MHD_static_inline bool
+mhd_atomic_u32_cas_acq_impl_ (volatile uint32_t *ptr,
+                              uint32_t expected,
+                              uint32_t desired)
+{
+  return __atomic_compare_exchange_n (ptr, &expected, desired, 0,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Atomically replace the value, the previous value is returned.
+ * Full memory barrier: the memory accesses of the current thread are not
+ * reordered with the operation.
+ * @param ptr the pointer to the 'volatile uint32_t' variable
+ * @param val the value to write
+ * @return the previous value of the variable
+ */
+#define mhd_atomic_u32_xchg_(ptr,val) \
+  ((uint32_t) __atomic_exchange_n ((ptr), (uint32_t) (val), __ATOMIC_SEQ_CST))
+
+/**
+ * Atomically read the pointer, later memory accesses of the current
+ * thread are not reordered before the read.
+ * @param pptr the pointer to the 'volatile' pointer variable
+ * @return the value of the pointer
+ */
+#define mhd_atomic_ptr_load_acq_(pptr) \
+  __atomic_load_n ((pptr), __ATOMIC_ACQUIRE)
+
+/**
+ * Atomically replace the pointer with @a desired if the current value is
+ * equal to @a expected.
+ * Release memory order is used when the value is replaced.
+ * @param pptr the pointer to the 'volatile' pointer variable
+ * @param expected the expected current value
+ * @param desired the value to set
+ * @return boolean 'true' if the value has been replaced,
+ *         'false' otherwise
+ */
+#define mhd_atomic_ptr_cas_rel_(pptr,expected,desired) \
+  mhd_atomic_ptr_cas_rel_impl_ ((void *volatile *) (pptr), \
+                                (void *) (expected), (void *) (desired))
+
+_MHD_static_inline bool
+mhd_atomic_ptr_cas_rel_impl_ (void *volatile *pptr,
+                              void *expected,
+                              void *desired)
+{
+  return __atomic_compare_exchange_n (pptr, &expected, desired, 0,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Atomically replace the pointer, the previous value is returned.
+ * Later memory accesses of the current thread are not reordered before
+ * the operation.
+ * @param pptr the pointer to the 'volatile' pointer variable
+ * @param val the value to write
+ * @return the previous value of the pointer
+ */
+#define mhd_atomic_ptr_xchg_acq_(pptr,val) \
+  __atomic_exchange_n ((pptr), (val), __ATOMIC_ACQUIRE)
+
+
+/**
+ * Memory fence: memory reads before the fence are not reordered with
+ * memory accesses after the fence.
+ */
+#define mhd_atomic_fence_acq_() __atomic_thread_fence (__ATOMIC_ACQUIRE)
+
+/**
+ * Memory fence: memory writes after the fence are not reordered with
+ * memory accesses before the fence.
+ */
+#define mhd_atomic_fence_rel_() __atomic_thread_fence (__ATOMIC_RELEASE)
+
+#elif defined(MHD_ATOMIC_W32_INTERLOCKED_)
+/* All Interlocked functions are full barriers */
+#define mhd_atomic_u32_load_rlx_(ptr) \
+  ((uint32_t) InterlockedOr ((volatile LONG *) (ptr), 0))
+#define mhd_atomic_u32_load_acq_(ptr) mhd_atomic_u32_load_rlx_ (ptr)
+#define mhd_atomic_u32_store_rlx_(ptr,val) \
+  ((void) InterlockedExchange ((volatile LONG *) (ptr), (LONG) (val)))
+#define mhd_atomic_u32_store_rel_(ptr,val) mhd_atomic_u32_store_rlx_ (ptr,val)
+#define mhd_atomic_u32_cas_acq_(ptr,expected,desired) \
+  (((LONG) (expected)) == \
+   InterlockedCompareExchange ((volatile LONG *) (ptr), (LONG) (desired), \
+                               (LONG) (expected)))
+#define mhd_atomic_u32_xchg_(ptr,val) \
+  ((uint32_t) InterlockedExchange ((volatile LONG *) (ptr), (LONG) (val)))
+#define mhd_atomic_ptr_load_acq_(pptr) \
+  InterlockedCompareExchangePointer ((PVOID volatile *) (pptr), NULL, NULL)
+#define mhd_atomic_ptr_cas_rel_(pptr,expected,desired) \
+  (((PVOID) (expected)) == \
+   InterlockedCompareExchangePointer ((PVOID volatile *) (pptr), \
+                                      (PVOID) (desired), (PVOID) (expected)))
+#define mhd_atomic_ptr_xchg_acq_(pptr,val) \
+  InterlockedExchangePointer ((PVOID volatile *) (pptr), (PVOID) (val))
+#define mhd_atomic_fence_acq_() MemoryBarrier ()
+#define mhd_atomic_fence_rel_() MemoryBarrier ()
+#endif /* MHD_ATOMIC_W32_INTERLOCKED_ */
+
+
+#if defined(MHD_ATOMIC_GCC_BUILTINS_) && \
+  defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (2 == __GCC_ATOMIC_LLONG_LOCK_FREE)
+/**
+ * Defined if lock-free atomic operations on 64-bit values are available
+ */
+#define MHD_HAVE_ATOMIC_U64_ 1
+
+/**
+ * Atomically read the value.
+ * @param ptr the pointer to the 'volatile uint64_t' variable
+ * @return the value of the variable
+ */
+#define mhd_atomic_u64_load_rlx_(ptr) \
+  ((uint64_t) __atomic_load_n ((ptr), __ATOMIC_RELAXED))
+
+/**
+ * Atomically write the value.
+ * @param ptr the pointer to the 'volatile uint64_t' variable
+ * @param val the value to write
+ */
+#define mhd_atomic_u64_store_rlx_(ptr,val) \
+  __atomic_store_n ((ptr), (uint64_t) (val), __ATOMIC_RELAXED)
+
+/**
+ * Atomically add the value.
+ * @param ptr the pointer to the 'volatile uint64_t' variable
+ * @param val the value to add
+ */
+#define mhd_atomic_u64_add_rlx_(ptr,val) \
+  ((void) __atomic_fetch_add ((ptr), (uint64_t) (val), __ATOMIC_RELAXED))
+
+/**
+ * Atomically replace the value with @a desired if the current value is
+ * equal to @a expected.
+ * @param ptr the pointer to the 'volatile uint64_t' variable
+ * @param expected the expected current value
+ * @param desired the value to set
+ * @return boolean 'true' if the value has been replaced,
+ *         'false' otherwise
+ */
+#define mhd_atomic_u64_cas_rlx_(ptr,expected,desired) \
+  mhd_atomic_u64_cas_rlx_impl_ ((ptr), (expected), (desired))
+
+_MHD_static_inline bool
+mhd_atomic_u64_cas_rlx_impl_ (volatile uint64_t *ptr,
+                              uint64_t expected,
+                              uint64_t desired)
+{
+  return __atomic_compare_exchange_n (ptr, &expected, desired, 0,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+
+#elif defined(MHD_ATOMIC_W32_INTERLOCKED_) && defined(_WIN64)
+#define MHD_HAVE_ATOMIC_U64_ 1
+#define mhd_atomic_u64_load_rlx_(ptr) \
+  ((uint64_t) InterlockedOr64 ((volatile LONG64 *) (ptr), 0))
+#define mhd_atomic_u64_store_rlx_(ptr,val) \
+  ((void) InterlockedExchange64 ((volatile LONG64 *) (ptr), (LONG64) (val)))
+#define mhd_atomic_u64_add_rlx_(ptr,val) \
+  ((void) InterlockedExchangeAdd64 ((volatile LONG64 *) (ptr), (LONG64) (val)))
+#define mhd_atomic_u64_cas_rlx_(ptr,expected,desired) \
+  (((LONG64) (expected)) == \
+   InterlockedCompareExchange64 ((volatile LONG64 *) (ptr), \
+                                 (LONG64) (desired), (LONG64) (expected)))
+#endif /* MHD_ATOMIC_W32_INTERLOCKED_ && _WIN64 */
+
+#endif /* ! MHD_ATOMIC_H */
@@ -0,0 +1,257 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_hdr_ids.c
+ * @brief  Matching of the request headers names with the identifiers of
+ *         the well-known headers
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_hdr_ids.h"
+#include "mhd_str.h"
+#include "mhd_str_types.h"
+#include "mhd_assert.h"
+
+/**
+ * The names of the well-known headers, indexed by #MHD_HeaderId
+ */
+static const struct _MHD_cstr_w_len hdr_names[] = {
+  {NULL, 0},
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCEPT),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCEPT_CHARSET),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCEPT_ENCODING),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCEPT_LANGUAGE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCESS_CONTROL_REQUEST_HEADERS),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ACCESS_CONTROL_REQUEST_METHOD),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_AUTHORIZATION),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_CACHE_CONTROL),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_CONNECTION),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_CONTENT_ENCODING),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_CONTENT_LENGTH),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_CONTENT_TYPE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_COOKIE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_DATE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_EXPECT),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_FORWARDED),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_FROM),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_HOST),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_IF_MATCH),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_IF_MODIFIED_SINCE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_IF_NONE_MATCH),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_IF_RANGE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_IF_UNMODIFIED_SINCE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_KEEP_ALIVE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_MAX_FORWARDS),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_ORIGIN),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_PRAGMA),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_PRIORITY),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_PROXY_AUTHORIZATION),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_RANGE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_REFERER),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_SEC_WEBSOCKET_KEY),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_SEC_WEBSOCKET_VERSION),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_TE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_TRAILER),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_TRANSFER_ENCODING),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_UPGRADE),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_USER_AGENT),
+  _MHD_S_STR_W_LEN (MHD_HTTP_HEADER_VIA)
+};
+
+/**
+ * The value in the #hdr_asso table for the characters not used
+ * as the first or the last characters of the well-known headers names.
+ */
+#define MHD_HDR_ID_NO_ASSO_ 0xFFU
+
+/**
+ * The hash values associated with the lower case letters.
+ * The hash of the name is the length of the name plus the values
+ * associated with the first and the last characters of the name.
+ * The values are selected to have no collisions for the well-known
+ * headers names.
+ */
+static const uint8_t hdr_asso[26] = {
+  /* a */ 1,
+  /* b */ MHD_HDR_ID_NO_ASSO_,
+  /* c */ 16,
+  /* d */ 15,
+  /* e */ 14,
+  /* f */ 8,
+  /* g */ 22,
+  /* h */ 7,
+  /* i */ 19,
+  /* j */ MHD_HDR_ID_NO_ASSO_,
+  /* k */ 0,
+  /* l */ 22,
+  /* m */ 7,
+  /* n */ 2,
+  /* o */ 2,
+  /* p */ 5,
+  /* q */ MHD_HDR_ID_NO_ASSO_,
+  /* r */ 1,
+  /* s */ 12,
+  /* t */ 7,
+  /* u */ 4,
+  /* v */ 7,
+  /* w */ MHD_HDR_ID_NO_ASSO_,
+  /* x */ MHD_HDR_ID_NO_ASSO_,
+  /* y */ 0,
+  /* z */ MHD_HDR_ID_NO_ASSO_
+};
+
+/**
+ * The identifiers of the headers, indexed by the hash of the name
+ */
+static const uint8_t hdr_ids_by_hash[] = {
+  /*  0 */ MHD_HEADER_ID_UNKNOWN,
+  /*  1 */ MHD_HEADER_ID_UNKNOWN,
+  /*  2 */ MHD_HEADER_ID_UNKNOWN,
+  /*  3 */ MHD_HEADER_ID_UNKNOWN,
+  /*  4 */ MHD_HEADER_ID_UNKNOWN,
+  /*  5 */ MHD_HEADER_ID_UNKNOWN,
+  /*  6 */ MHD_HEADER_ID_UNKNOWN,
+  /*  7 */ MHD_HEADER_ID_UNKNOWN,
+  /*  8 */ MHD_HEADER_ID_UNKNOWN,
+  /*  9 */ MHD_HEADER_ID_REFERER,
+  /* 10 */ MHD_HEADER_ID_ORIGIN,
+  /* 11 */ MHD_HEADER_ID_VIA,
+  /* 12 */ MHD_HEADER_ID_PRAGMA,
+  /* 13 */ MHD_HEADER_ID_PRIORITY,
+  /* 14 */ MHD_HEADER_ID_ACCEPT,
+  /* 15 */ MHD_HEADER_ID_TRAILER,
+  /* 16 */ MHD_HEADER_ID_AUTHORIZATION,
+  /* 17 */ MHD_HEADER_ID_UNKNOWN,
+  /* 18 */ MHD_HEADER_ID_HOST,
+  /* 19 */ MHD_HEADER_ID_FROM,
+  /* 20 */ MHD_HEADER_ID_RANGE,
+  /* 21 */ MHD_HEADER_ID_USER_AGENT,
+  /* 22 */ MHD_HEADER_ID_ACCEPT_CHARSET,
+  /* 23 */ MHD_HEADER_ID_TE,
+  /* 24 */ MHD_HEADER_ID_KEEP_ALIVE,
+  /* 25 */ MHD_HEADER_ID_UPGRADE,
+  /* 26 */ MHD_HEADER_ID_PROXY_AUTHORIZATION,
+  /* 27 */ MHD_HEADER_ID_EXPECT,
+  /* 28 */ MHD_HEADER_ID_CONNECTION,
+  /* 29 */ MHD_HEADER_ID_SEC_WEBSOCKET_KEY,
+  /* 30 */ MHD_HEADER_ID_ACCEPT_LANGUAGE,
+  /* 31 */ MHD_HEADER_ID_MAX_FORWARDS,
+  /* 32 */ MHD_HEADER_ID_FORWARDED,
+  /* 33 */ MHD_HEADER_ID_DATE,
+  /* 34 */ MHD_HEADER_ID_IF_MATCH,
+  /* 35 */ MHD_HEADER_ID_SEC_WEBSOCKET_VERSION,
+  /* 36 */ MHD_HEADER_ID_COOKIE,
+  /* 37 */ MHD_HEADER_ID_CONTENT_LENGTH,
+  /* 38 */ MHD_HEADER_ID_ACCEPT_ENCODING,
+  /* 39 */ MHD_HEADER_ID_IF_NONE_MATCH,
+  /* 40 */ MHD_HEADER_ID_UNKNOWN,
+  /* 41 */ MHD_HEADER_ID_IF_RANGE,
+  /* 42 */ MHD_HEADER_ID_CONTENT_TYPE,
+  /* 43 */ MHD_HEADER_ID_ACCESS_CONTROL_REQUEST_HEADERS,
+  /* 44 */ MHD_HEADER_ID_UNKNOWN,
+  /* 45 */ MHD_HEADER_ID_ACCESS_CONTROL_REQUEST_METHOD,
+  /* 46 */ MHD_HEADER_ID_TRANSFER_ENCODING,
+  /* 47 */ MHD_HEADER_ID_UNKNOWN,
+  /* 48 */ MHD_HEADER_ID_SEC_WEBSOCKET_EXTENSIONS,
+  /* 49 */ MHD_HEADER_ID_UNKNOWN,
+  /* 50 */ MHD_HEADER_ID_IF_MODIFIED_SINCE,
+  /* 51 */ MHD_HEADER_ID_CACHE_CONTROL,
+  /* 52 */ MHD_HEADER_ID_IF_UNMODIFIED_SINCE,
+  /* 53 */ MHD_HEADER_ID_UNKNOWN,
+  /* 54 */ MHD_HEADER_ID_CONTENT_ENCODING,
+  /* 55 */ MHD_HEADER_ID_UNKNOWN,
+  /* 56 */ MHD_HEADER_ID_SEC_WEBSOCKET_PROTOCOL
+};
+
+/**
+ * The length of the shortest well-known header name
+ */
+#define MHD_HDR_ID_MIN_LEN_ MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_TE)
+
+/**
+ * The length of the longest well-known header name
+ */
+#define MHD_HDR_ID_MAX_LEN_ \
+  MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_ACCESS_CONTROL_REQUEST_HEADERS)
+
+
+/**
+ * Get the value associated with the character for the hash calculation.
+ * @param c the character
+ * @return the associated value,
+ *         #MHD_HDR_ID_NO_ASSO_ if the character is not used
+ */
+_MHD_static_inline unsigned int
+hdr_char_asso (char c)
+{
+  if ((c >= 'a') && (c <= 'z'))
+    return hdr_asso[c - 'a'];
+  if ((c >= 'A') && (c <= 'Z'))
+    return hdr_asso[c - 'A'];
+  return MHD_HDR_ID_NO_ASSO_;
+}
+
+
+enum MHD_HeaderId
+MHD_get_header_id_ (const char *name,
+                    size_t name_len)
+{
+  unsigned int asso_first;
+  unsigned int asso_last;
+  size_t hash;
+  enum MHD_HeaderId id;
+
+  mhd_assert ((sizeof(hdr_names) / sizeof(hdr_names[0])) == \
+              (MHD_HEADER_ID_VIA + 1));
+  if ((MHD_HDR_ID_MIN_LEN_ > name_len) || (MHD_HDR_ID_MAX_LEN_ < name_len))
+    return MHD_HEADER_ID_UNKNOWN;
+  asso_first = hdr_char_asso (name[0]);
+  if (MHD_HDR_ID_NO_ASSO_ == asso_first)
+    return MHD_HEADER_ID_UNKNOWN;
+  asso_last = hdr_char_asso (name[name_len - 1]);
+  if (MHD_HDR_ID_NO_ASSO_ == asso_last)
+    return MHD_HEADER_ID_UNKNOWN;
+  hash = name_len + asso_first + asso_last;
+  if ((sizeof(hdr_ids_by_hash) / sizeof(hdr_ids_by_hash[0])) <= hash)
+    return MHD_HEADER_ID_UNKNOWN;
+  id = (enum MHD_HeaderId) hdr_ids_by_hash[hash];
+  if (MHD_HEADER_ID_UNKNOWN == id)
+    return MHD_HEADER_ID_UNKNOWN;
+  if ((hdr_names[id].len != name_len) ||
+      (! MHD_str_equal_caseless_bin_n_ (hdr_names[id].str,
+                                        name,
+                                        name_len)))
+    return MHD_HEADER_ID_UNKNOWN;
+  return id;
+}
+
+
+const char *
+MHD_get_header_name_ (enum MHD_HeaderId id,
+                      size_t *name_len)
+{
+  if ((MHD_HEADER_ID_UNKNOWN == id) ||
+      ((sizeof(hdr_names) / sizeof(hdr_names[0])) <= (size_t) id))
+    return NULL;
+  *name_len = hdr_names[id].len;
+  return hdr_names[id].str;
+}
@@ -0,0 +1,63 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_hdr_ids.h
+ * @brief  Declarations of the functions for the identifiers of
+ *         the well-known request headers
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_HDR_IDS_H
+#define MHD_HDR_IDS_H 1
+
+#include "mhd_options.h"
+#include <stdint.h>
+#ifdef HAVE_STDDEF_H
+#include <stddef.h>
+#endif /* HAVE_STDDEF_H */
+#include "microhttpd.h"
+
+/**
+ * Get the identifier of the well-known header by the name of the header.
+ * Case-insensitive match is used for the names.
+ * The identifier is found by the perfect hash of the name, only one
+ * string comparison is performed.
+ * @param name the name of the header, does not need to be zero-terminated
+ * @param name_len the length of the @a name
+ * @return the identifier of the header,
+ *         #MHD_HEADER_ID_UNKNOWN if @a name is not a well-known header
+ */
+enum MHD_HeaderId
+MHD_get_header_id_ (const char *name,
+                    size_t name_len);
+
+
+/**
+ * Get the name of the well-known header by the identifier.
+ * @param id the identifier of the header
+ * @param[out] name_len set to the length of the name
+ * @return the name of the header,
+ *         NULL if @a id is not a valid identifier of well-known header
+ */
+const char *
+MHD_get_header_name_ (enum MHD_HeaderId id,
+                      size_t *name_len);
+
+#endif /* ! MHD_HDR_IDS_H */
@@ -0,0 +1,742 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_iplimit.c
+ * @brief  Implementation of the table of the number of connections per
+ *         IP address
+ *
+ * Every slot of the table has the 32-bit state word combining the counter
+ * of connections, the "busy" flag and the generation number.  The slot key
+ * is written only when the slot is marked as "busy" and the generation is
+ * changed, so the readers can check the key without locks: the key is
+ * valid if the state is not changed after the key check.
+ * The free slot (with zero counter) is taken for the new address only
+ * under the lock selected by the hash of the new address, therefore the
+ * same address cannot be added to two slots.
+ * If both buckets of the new address are full, the address is counted in
+ * the overflow list protected by the separate lock.  The address in the
+ * overflow list never has the slot with non-zero counter: the list is
+ * checked under the lock of the address before the slots are used, and the
+ * lock-free path increments only non-zero counters.  With the default
+ * sizing of the table the list is normally empty.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_iplimit.h"
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+#include <string.h>
+#include "mhd_atomic.h"
+#include "mhd_locks.h"
+#include "mhd_compat.h"
+#include "mhd_assert.h"
+
+/**
+ * The number of slots in one bucket
+ */
+#define IPLIMIT_BUCKET_SLOTS 8
+
+/**
+ * The maximum number of buckets in the table.
+ * With IPv6 support the slot takes 24 bytes, the table of the maximum
+ * size takes 24 MiB and holds up to 1M addresses without using the
+ * overflow list.
+ */
+#define IPLIMIT_BUCKETS_MAX ((size_t) 1 << 17)
+
+/**
+ * The minimal number of buckets in the table
+ */
+#define IPLIMIT_BUCKETS_MIN ((size_t) 16)
+
+/**
+ * The bits of the slot state used for the connections counter
+ */
+#define IPLIMIT_COUNT_MASK ((uint32_t) 0x000FFFFFu)
+
+/**
+ * The slot state flag: the key of the slot is being written
+ */
+#define IPLIMIT_BUSY ((uint32_t) 0x00100000u)
+
+/**
+ * The increment of the generation in the slot state
+ */
+#define IPLIMIT_GEN_STEP ((uint32_t) 0x00200000u)
+
+#ifdef MHD_HAVE_ATOMIC_
+/**
+ * The number of locks used for adding of the new addresses
+ */
+#define IPLIMIT_NUM_LOCKS 64
+
+#define slot_state_get_(slot) mhd_atomic_u32_load_acq_ (&((slot)->state))
+#define slot_state_set_(slot,val) \
+  mhd_atomic_u32_store_rel_ (&((slot)->state), (val))
+#define slot_state_cas_(slot,expected,desired) \
+  mhd_atomic_u32_cas_acq_ (&((slot)->state), (expected), (desired))
+#define slot_fence_acq_() mhd_atomic_fence_acq_ ()
+#define overflow_num_get_(tbl) \
+  mhd_atomic_u32_load_rlx_ (&((tbl)->overflow_num))
+#define overflow_num_set_(tbl,val) \
+  mhd_atomic_u32_store_rlx_ (&((tbl)->overflow_num), (val))
+
+#else  /* ! MHD_HAVE_ATOMIC_ */
+/* The single lock protects all slots */
+#define IPLIMIT_NUM_LOCKS 1
+
+#define slot_state_get_(slot) ((slot)->state)
+#define slot_state_set_(slot,val) ((void) ((slot)->state = (val)))
+#define slot_state_cas_(slot,expected,desired) \
+  iplimit_state_cas_plain (&((slot)->state), (expected), (desired))
+#define slot_fence_acq_() ((void) 0)
+#define overflow_num_get_(tbl) ((tbl)->overflow_num)
+#define overflow_num_set_(tbl,val) ((void) ((tbl)->overflow_num = (val)))
+
+/**
+ * Non-atomic replacement of the slot state, the caller must hold the lock.
+ */
+static bool
+iplimit_state_cas_plain (volatile uint32_t *pstate,
+                         uint32_t expected,
+                         uint32_t desired)
+{
+  if (expected != *pstate)
+    return false;
+  *pstate = desired;
+  return true;
+}
+
+
+#endif /* ! MHD_HAVE_ATOMIC_ */
+
+
+/**
+ * The slot of the table
+ */
+struct IPLimitSlot
+{
+  /**
+   * The state of the slot: the counter, the "busy" flag and
+   * the generation
+   */
+  volatile uint32_t state;
+
+  /**
+   * The address, valid only if the counter is not zero or if the slot
+   * is checked without locks (see the file description)
+   */
+  struct MHD_IPLimitKey_ key;
+};
+
+
+/**
+ * The entry of the overflow list
+ */
+struct IPLimitOverflow
+{
+  /**
+   * The next entry in the list
+   */
+  struct IPLimitOverflow *next;
+
+  /**
+   * The address
+   */
+  struct MHD_IPLimitKey_ key;
+
+  /**
+   * The number of connections from the address, never zero
+   */
+  uint32_t count;
+};
+
+
+/**
+ * The table of the number of connections per IP address
+ */
+struct MHD_IPLimitTable_
+{
+  /**
+   * The array of slots, #IPLIMIT_BUCKET_SLOTS slots per bucket
+   */
+  struct IPLimitSlot *slots;
+
+  /**
+   * The number of buckets minus one
+   */
+  size_t buckets_mask;
+
+  /**
+   * The random value for the hash function
+   */
+  uint64_t seed;
+
+  /**
+   * The list of the addresses not fitted into their buckets
+   */
+  struct IPLimitOverflow *overflow;
+
+  /**
+   * The number of entries in the @a overflow list, modified only under
+   * the @a overflow_lock
+   */
+  volatile uint32_t overflow_num;
+
+#ifdef MHD_USE_THREADS
+  /**
+   * The locks for adding of the new addresses
+   */
+  MHD_mutex_ locks[IPLIMIT_NUM_LOCKS];
+
+  /**
+   * The lock for the @a overflow list
+   */
+  MHD_mutex_ overflow_lock;
+#endif /* MHD_USE_THREADS */
+};
+
+
+/**
+ * Calculate the hash of the address.
+ * @param tbl the table to use
+ * @param key the address
+ * @return the hash value
+ */
+static uint64_t
+iplimit_hash (const struct MHD_IPLimitTable_ *tbl,
+              const struct MHD_IPLimitKey_ *key)
+{
+  const uint8_t *const bytes = (const uint8_t *) key;
+  uint64_t h;
+  size_t i;
+
+  h = tbl->seed ^ UINT64_C (0xCBF29CE484222325);
+  for (i = 0; i < sizeof(*key); ++i)
+  {
+    h ^= bytes[i];
+    h *= UINT64_C (0x100000001B3);
+  }
+  /* Mix all bits as both halves of the value are used */
+  h ^= h >> 33;
+  h *= UINT64_C (0xFF51AFD7ED558CCD);
+  h ^= h >> 33;
+  h *= UINT64_C (0xC4CEB9FE1A85EC53);
+  h ^= h >> 33;
+  return h;
+}
+
+
+/**
+ * Select the buckets for the address.
+ * @param tbl the table to use
+ * @param h the hash of the address
+ * @param[out] buckets the pointers to the first slots of two buckets
+ */
+static void
+iplimit_get_buckets (const struct MHD_IPLimitTable_ *tbl,
+                     uint64_t h,
+                     struct IPLimitSlot *buckets[2])
+{
+  size_t b1;
+  size_t b2;
+
+  b1 = ((size_t) h) & tbl->buckets_mask;
+  b2 = ((size_t) (h >> 32)) & tbl->buckets_mask;
+  if (b1 == b2)
+    b2 = b1 ^ 1;
+  buckets[0] = tbl->slots + b1 * IPLIMIT_BUCKET_SLOTS;
+  buckets[1] = tbl->slots + b2 * IPLIMIT_BUCKET_SLOTS;
+}
+
+
+/**
+ * Find the slot with the address.
+ * @param buckets the buckets for the address
+ * @param key the address to find
+ * @param[out] pstate the state of the found slot
+ * @return the slot with the @a key,
+ *         NULL if the @a key is not in the table
+ */
+static struct IPLimitSlot *
+iplimit_find (struct IPLimitSlot *const buckets[2],
+              const struct MHD_IPLimitKey_ *key,
+              uint32_t *pstate)
+{
+  unsigned int i;
+  unsigned int j;
+
+restart:
+  for (i = 0; i < 2; ++i)
+  {
+    for (j = 0; j < IPLIMIT_BUCKET_SLOTS; ++j)
+    {
+      struct IPLimitSlot *const slot = buckets[i] + j;
+      const uint32_t state = slot_state_get_ (slot);
+
+      if (0 != (state & IPLIMIT_BUSY))
+        continue;
+      if (0 != memcmp (&slot->key,
+                       key,
+                       sizeof(*key)))
+        continue;
+      /* The key could be overwritten while it was compared, the match is
+         valid only if the slot has not been taken by other address */
+      slot_fence_acq_ ();
+      if (0 != ((state ^ slot_state_get_ (slot)) & ~IPLIMIT_COUNT_MASK))
+        goto restart;
+      *pstate = state;
+      return slot;
+    }
+  }
+  return NULL;
+}
+
+
+/**
+ * Try to increment the counter of the found slot.
+ * @param slot the slot to use
+ * @param state the state of the @a slot
+ * @param limit the maximum value of the counter
+ * @param revive if 'false' the zero counter is not incremented, must be
+ *               'true' only when the lock for the address is held
+ * @return #MHD_IPLIMIT_OK_ or #MHD_IPLIMIT_OVER_LIMIT_ if the slot has
+ *         been processed,
+ *         #MHD_IPLIMIT_NO_SPACE_ if the slot has been taken by other
+ *         address and the search must be repeated or if the counter is
+ *         zero and @a revive is 'false'
+ */
+static enum MHD_IPLimitResult_
+iplimit_inc (struct IPLimitSlot *slot,
+             uint32_t state,
+             uint32_t limit,
+             bool revive)
+{
+  const uint32_t hdr = state & ~IPLIMIT_COUNT_MASK;
+
+  while (1)
+  {
+    if ((! revive) && (0 == (state & IPLIMIT_COUNT_MASK)))
+      return MHD_IPLIMIT_NO_SPACE_;
+    if ((state & IPLIMIT_COUNT_MASK) >= limit)
+      return MHD_IPLIMIT_OVER_LIMIT_;
+    if (slot_state_cas_ (slot, state, state + 1))
+      return MHD_IPLIMIT_OK_;
+    state = slot_state_get_ (slot);
+    if ((state & ~IPLIMIT_COUNT_MASK) != hdr)
+      return MHD_IPLIMIT_NO_SPACE_;
+  }
+}
+
+
+/**
+ * Find the address in the overflow list.
+ * Must be called with the overflow lock held.
+ * @param tbl the table to use
+ * @param key the address to find
+ * @param[out] pprev the pointer to the link to the found entry
+ * @return the entry with the @a key,
+ *         NULL if the @a key is not in the list
+ */
+static struct IPLimitOverflow *
+iplimit_overflow_find (struct MHD_IPLimitTable_ *tbl,
+                       const struct MHD_IPLimitKey_ *key,
+                       struct IPLimitOverflow ***pprev)
+{
+  struct IPLimitOverflow **link;
+
+  for (link = &tbl->overflow; NULL != *link; link = &((*link)->next))
+  {
+    if (0 == memcmp (&((*link)->key),
+                     key,
+                     sizeof(*key)))
+    {
+      *pprev = link;
+      return *link;
+    }
+  }
+  return NULL;
+}
+
+
+/**
+ * Count the connection for the address in the overflow list.
+ * @param tbl the table to use
+ * @param key the address
+ * @param limit the maximum number of connections for the address
+ * @param create if 'true' the new entry is created when the address is
+ *               not in the list
+ * @return the result of the operation,
+ *         #MHD_IPLIMIT_NO_SPACE_ if the address is not in the list and
+ *         @a create is 'false' or if memory allocation failed
+ */
+static enum MHD_IPLimitResult_
+iplimit_overflow_add (struct MHD_IPLimitTable_ *tbl,
+                      const struct MHD_IPLimitKey_ *key,
+                      uint32_t limit,
+                      bool create)
+{
+  struct IPLimitOverflow *entry;
+  struct IPLimitOverflow **link;
+  enum MHD_IPLimitResult_ res;
+
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&tbl->overflow_lock);
+#endif /* MHD_USE_THREADS */
+  entry = iplimit_overflow_find (tbl,
+                                 key,
+                                 &link);
+  if (NULL != entry)
+  {
+    if (entry->count >= limit)
+      res = MHD_IPLIMIT_OVER_LIMIT_;
+    else
+    {
+      entry->count++;
+      res = MHD_IPLIMIT_OK_;
+    }
+  }
+  else if (! create)
+    res = MHD_IPLIMIT_NO_SPACE_;
+  else
+  {
+    entry = (struct IPLimitOverflow *) malloc (sizeof(*entry));
+    if (NULL == entry)
+      res = MHD_IPLIMIT_NO_SPACE_;
+    else
+    {
+      memcpy (&entry->key,
+              key,
+              sizeof(*key));
+      entry->count = 1;
+      entry->next = tbl->overflow;
+      tbl->overflow = entry;
+      overflow_num_set_ (tbl, overflow_num_get_ (tbl) + 1);
+      res = MHD_IPLIMIT_OK_;
+    }
+  }
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&tbl->overflow_lock);
+#endif /* MHD_USE_THREADS */
+  return res;
+}
+
+
+/**
+ * Decrement the number of connections for the address in the overflow
+ * list, remove the entry when the number reaches zero.
+ * @param tbl the table to use
+ * @param key the address
+ * @return 'true' if the number of the connections has been decremented,
+ *         'false' if the address is not in the list
+ */
+static bool
+iplimit_overflow_del (struct MHD_IPLimitTable_ *tbl,
+                      const struct MHD_IPLimitKey_ *key)
+{
+  struct IPLimitOverflow *entry;
+  struct IPLimitOverflow **link;
+
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&tbl->overflow_lock);
+#endif /* MHD_USE_THREADS */
+  entry = iplimit_overflow_find (tbl,
+                                 key,
+                                 &link);
+  if (NULL != entry)
+  {
+    mhd_assert (0 != entry->count);
+    if (0 == --(entry->count))
+    {
+      *link = entry->next;
+      overflow_num_set_ (tbl, overflow_num_get_ (tbl) - 1);
+      free (entry);
+    }
+  }
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&tbl->overflow_lock);
+#endif /* MHD_USE_THREADS */
+  return (NULL != entry);
+}
+
+
+/**
+ * Count the connection for the address, take the new slot if
+ * the address is not in the table.
+ * Must be called with the lock for the address held.
+ * @param tbl the table to use
+ * @param buckets the buckets for the address
+ * @param key the address
+ * @param limit the maximum value of the counter
+ * @return the result of the operation
+ */
+static enum MHD_IPLimitResult_
+iplimit_add_locked (struct MHD_IPLimitTable_ *tbl,
+                    struct IPLimitSlot *const buckets[2],
+                    const struct MHD_IPLimitKey_ *key,
+                    uint32_t limit)
+{
+  struct IPLimitSlot *slot;
+  uint32_t state;
+  unsigned int used[2];
+  unsigned int i;
+  unsigned int j;
+
+  /* The address is added to the overflow list only under the same lock,
+     the number of entries is up to date for this address */
+  if (0 != overflow_num_get_ (tbl))
+  {
+    const enum MHD_IPLimitResult_ res = iplimit_overflow_add (tbl,
+                                                              key,
+                                                              limit,
+                                                              false);
+    if (MHD_IPLIMIT_NO_SPACE_ != res)
+      return res;
+  }
+
+  /* The address could be added by other thread while waiting for
+     the lock */
+  while (NULL != (slot = iplimit_find (buckets,
+                                       key,
+                                       &state)))
+  {
+    const enum MHD_IPLimitResult_ res = iplimit_inc (slot,
+                                                     state,
+                                                     limit,
+                                                     true);
+    if (MHD_IPLIMIT_NO_SPACE_ != res)
+      return res;
+  }
+
+  /* Use the less loaded bucket first */
+  for (i = 0; i < 2; ++i)
+  {
+    used[i] = 0;
+    for (j = 0; j < IPLIMIT_BUCKET_SLOTS; ++j)
+    {
+      if (0 != (slot_state_get_ (buckets[i] + j)
+                & (IPLIMIT_BUSY | IPLIMIT_COUNT_MASK)))
+        used[i]++;
+    }
+  }
+  for (i = 0; i < 2; ++i)
+  {
+    struct IPLimitSlot *const bucket =
+      buckets[(used[1] < used[0]) ? (1 - i) : i];
+
+    for (j = 0; j < IPLIMIT_BUCKET_SLOTS; ++j)
+    {
+      uint32_t new_hdr;
+
+      slot = bucket + j;
+      state = slot_state_get_ (slot);
+      if (0 != (state & (IPLIMIT_BUSY | IPLIMIT_COUNT_MASK)))
+        continue;
+      new_hdr = (state & ~(IPLIMIT_BUSY | IPLIMIT_COUNT_MASK))
+                + IPLIMIT_GEN_STEP;
+      if (! slot_state_cas_ (slot, state, new_hdr | IPLIMIT_BUSY))
+        continue; /* The old address of the slot has been counted */
+      memcpy (&slot->key,
+              key,
+              sizeof(*key));
+      slot_state_set_ (slot, new_hdr | 1);
+      return MHD_IPLIMIT_OK_;
+    }
+  }
+  /* Both buckets are full */
+  return iplimit_overflow_add (tbl,
+                               key,
+                               limit,
+                               true);
+}
+
+
+struct MHD_IPLimitTable_ *
+MHD_iplimit_create_ (unsigned int max_conns,
+                     uint64_t seed)
+{
+  struct MHD_IPLimitTable_ *tbl;
+  size_t num_buckets;
+#ifdef MHD_USE_THREADS
+  unsigned int i;
+#endif /* MHD_USE_THREADS */
+
+  /* Not more than a half of the slots are used when the number of
+     connections is at the maximum and all addresses are different */
+  num_buckets = IPLIMIT_BUCKETS_MIN;
+  while ((num_buckets * (IPLIMIT_BUCKET_SLOTS / 2) < max_conns) &&
+         (num_buckets < IPLIMIT_BUCKETS_MAX))
+    num_buckets <<= 1;
+
+  tbl = (struct MHD_IPLimitTable_ *) MHD_calloc_ (1, sizeof(*tbl));
+  if (NULL == tbl)
+    return NULL;
+  tbl->slots = (struct IPLimitSlot *)
+               MHD_calloc_ (num_buckets * IPLIMIT_BUCKET_SLOTS,
+                            sizeof(struct IPLimitSlot));
+  if (NULL == tbl->slots)
+  {
+    free (tbl);
+    return NULL;
+  }
+  tbl->buckets_mask = num_buckets - 1;
+  tbl->seed = seed;
+#ifdef MHD_USE_THREADS
+  if (! MHD_mutex_init_ (&tbl->overflow_lock))
+  {
+    free (tbl->slots);
+    free (tbl);
+    return NULL;
+  }
+  for (i = 0; i < IPLIMIT_NUM_LOCKS; ++i)
+  {
+    if (! MHD_mutex_init_ (tbl->locks + i))
+    {
+      while (0 != i)
+        MHD_mutex_destroy_chk_ (tbl->locks + (--i));
+      MHD_mutex_destroy_chk_ (&tbl->overflow_lock);
+      free (tbl->slots);
+      free (tbl);
+      return NULL;
+    }
+  }
+#endif /* MHD_USE_THREADS */
+  return tbl;
+}
+
+
+void
+MHD_iplimit_destroy_ (struct MHD_IPLimitTable_ *tbl)
+{
+#ifdef MHD_USE_THREADS
+  unsigned int i;
+
+  for (i = 0; i < IPLIMIT_NUM_LOCKS; ++i)
+    MHD_mutex_destroy_chk_ (tbl->locks + i);
+  MHD_mutex_destroy_chk_ (&tbl->overflow_lock);
+#endif /* MHD_USE_THREADS */
+  while (NULL != tbl->overflow)
+  {
+    struct IPLimitOverflow *const entry = tbl->overflow;
+
+    tbl->overflow = entry->next;
+    free (entry);
+  }
+  free (tbl->slots);
+  free (tbl);
+}
+
+
+enum MHD_IPLimitResult_
+MHD_iplimit_add_ (struct MHD_IPLimitTable_ *tbl,
+                  const struct MHD_IPLimitKey_ *key,
+                  unsigned int limit)
+{
+  struct IPLimitSlot *buckets[2];
+  uint64_t h;
+  uint32_t lim;
+  enum MHD_IPLimitResult_ res;
+#ifdef MHD_USE_THREADS
+  MHD_mutex_ *lock;
+#endif /* MHD_USE_THREADS */
+
+  mhd_assert (0 != limit);
+  lim = (IPLIMIT_COUNT_MASK < limit) ? IPLIMIT_COUNT_MASK : (uint32_t) limit;
+  h = iplimit_hash (tbl,
+                    key);
+  iplimit_get_buckets (tbl,
+                       h,
+                       buckets);
+#ifdef MHD_HAVE_ATOMIC_
+  if (1)
+  {
+    /* Fast path: the address is already counted in the table */
+    struct IPLimitSlot *slot;
+    uint32_t state;
+
+    slot = iplimit_find (buckets,
+                         key,
+                         &state);
+    if (NULL != slot)
+    {
+      res = iplimit_inc (slot,
+                         state,
+                         lim,
+                         false);
+      if (MHD_IPLIMIT_NO_SPACE_ != res)
+        return res;
+    }
+  }
+#endif /* MHD_HAVE_ATOMIC_ */
+#ifdef MHD_USE_THREADS
+  lock = tbl->locks + (size_t) ((h >> 58) % IPLIMIT_NUM_LOCKS);
+  MHD_mutex_lock_chk_ (lock);
+#endif /* MHD_USE_THREADS */
+  res = iplimit_add_locked (tbl,
+                            buckets,
+                            key,
+                            lim);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (lock);
+#endif /* MHD_USE_THREADS */
+  return res;
+}
+
+
+bool
+MHD_iplimit_del_ (struct MHD_IPLimitTable_ *tbl,
+                  const struct MHD_IPLimitKey_ *key)
+{
+  struct IPLimitSlot *buckets[2];
+  struct IPLimitSlot *slot;
+  uint32_t state;
+  bool res;
+
+  iplimit_get_buckets (tbl,
+                       iplimit_hash (tbl,
+                                     key),
+                       buckets);
+#if ! defined(MHD_HAVE_ATOMIC_) && defined(MHD_USE_THREADS)
+  MHD_mutex_lock_chk_ (tbl->locks);
+#endif /* ! MHD_HAVE_ATOMIC_ && MHD_USE_THREADS */
+  res = false;
+  /* The slot cannot be taken by other address while the counter is not
+     zero, repeat the search only if the counter has been changed */
+  while (NULL != (slot = iplimit_find (buckets,
+                                       key,
+                                       &state)))
+  {
+    if (0 == (state & IPLIMIT_COUNT_MASK))
+      break;
+    if (slot_state_cas_ (slot, state, state - 1))
+    {
+      res = true;
+      break;
+    }
+  }
+  if (! res)
+    res = iplimit_overflow_del (tbl,
+                                key);
+#if ! defined(MHD_HAVE_ATOMIC_) && defined(MHD_USE_THREADS)
+  MHD_mutex_unlock_chk_ (tbl->locks);
+#endif /* ! MHD_HAVE_ATOMIC_ && MHD_USE_THREADS */
+  return res;
+}
@@ -0,0 +1,158 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_iplimit.h
+ * @brief  Header for the table of the number of connections per IP address
+ *
+ * The table is the fixed-size hash table of the counters.  Every address
+ * is placed in one of two buckets of slots selected by the hash of the
+ * address.  The counters are updated by the atomic operations without
+ * locks; the lock (one of several, selected by the hash of the address)
+ * is used only when the address is not in the table yet.  The slots with
+ * zero counter are reused for the new addresses.  If both buckets of the
+ * new address are full, the address is counted in the overflow list, so
+ * the lack of free slots never prevents counting of the connection.
+ * If lock-free atomic operations are not available, the single lock is
+ * used for all operations.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_IPLIMIT_H
+#define MHD_IPLIMIT_H 1
+
+#include "mhd_options.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "mhd_sockets.h"
+
+/**
+ * The key of the table: the IP address of the client.
+ * Must be zero-initialised before filling, as the whole structure is
+ * compared and hashed.
+ */
+struct MHD_IPLimitKey_
+{
+  /**
+   * The address family. AF_INET or AF_INET6 for now.
+   */
+  int family;
+
+  /**
+   * Actual address.
+   */
+  union
+  {
+    /**
+     * IPv4 address.
+     */
+    struct in_addr ipv4;
+#ifdef HAVE_INET6
+    /**
+     * IPv6 address.
+     */
+    struct in6_addr ipv6;
+#endif
+  } addr;
+};
+
+/**
+ * The table of the number of connections per IP address
+ */
+struct MHD_IPLimitTable_;
+
+/**
+ * The result of adding of the connection to the table
+ */
+enum MHD_IPLimitResult_
+{
+  /**
+   * The connection has been counted
+   */
+  MHD_IPLIMIT_OK_ = 0,
+
+  /**
+   * The limit for the address has been reached, the connection is not
+   * counted
+   */
+  MHD_IPLIMIT_OVER_LIMIT_ = 1,
+
+  /**
+   * Failed to allocate memory for the new address, the connection is not
+   * counted
+   */
+  MHD_IPLIMIT_NO_SPACE_ = 2
+};
+
+
+/**
+ * Create the table.
+ * The table has two slots per connection in @a max_conns, but not more
+ * than 1M slots.  The slot takes 24 bytes with IPv6 support, so the table
+ * takes 48 bytes per connection and not more than 24 MiB.
+ * @param max_conns the maximum number of concurrent connections, used
+ *                  to select the size of the table
+ * @param seed the random value for the hash function
+ * @return the pointer to the new table,
+ *         NULL if memory allocation or lock initialisation failed
+ */
+struct MHD_IPLimitTable_ *
+MHD_iplimit_create_ (unsigned int max_conns,
+                     uint64_t seed);
+
+
+/**
+ * Destroy the table.
+ * @param tbl the table to destroy
+ */
+void
+MHD_iplimit_destroy_ (struct MHD_IPLimitTable_ *tbl);
+
+
+/**
+ * Increment the number of connections for the address if the number
+ * is below the limit.
+ * Thread-safe.
+ * @param tbl the table to use
+ * @param key the address of the new connection
+ * @param limit the maximum number of connections per address, must not
+ *              be zero; values larger than 1048575 are treated as 1048575
+ * @return #MHD_IPLIMIT_OK_ if the connection has been counted,
+ *         error code otherwise
+ */
+enum MHD_IPLimitResult_
+MHD_iplimit_add_ (struct MHD_IPLimitTable_ *tbl,
+                  const struct MHD_IPLimitKey_ *key,
+                  unsigned int limit);
+
+
+/**
+ * Decrement the number of connections for the address.
+ * Thread-safe.
+ * @param tbl the table to use
+ * @param key the address of the closed connection
+ * @return 'true' if the number of the connections has been decremented,
+ *         'false' if the address was not found in the table or its
+ *         counter is already zero
+ */
+bool
+MHD_iplimit_del_ (struct MHD_IPLimitTable_ *tbl,
+                  const struct MHD_IPLimitKey_ *key);
+
+#endif /* ! MHD_IPLIMIT_H */
@@ -501,3 +501,59 @@ MHD_monotonic_msec_counter (void)
   /* The last resort fallback with very low resolution */
   return (uint64_t) (time (NULL) - sys_clock_start) * 1000;
 }
+
+
+/**
+ * Monotonic microseconds counter, useful for the measurement of
+ * the short durations.
+ * Tries to be not affected by manually setting the system real time
+ * clock or adjustments by NTP synchronization.
+ * The actual resolution could be lower on some platforms.
+ *
+ * @return number of microseconds from some fixed moment
+ */
+uint64_t
+MHD_monotonic_usec_counter (void)
+{
+#if defined(HAVE_CLOCK_GETTIME) || defined(HAVE_TIMESPEC_GET)
+  struct timespec ts;
+#endif /* HAVE_CLOCK_GETTIME || HAVE_TIMESPEC_GET */
+
+#ifdef HAVE_CLOCK_GETTIME
+  if ( (_MHD_UNWANTED_CLOCK != mono_clock_id) &&
+       (0 == clock_gettime (mono_clock_id,
+                            &ts)) )
+    return (uint64_t) (((uint64_t) (ts.tv_sec - mono_clock_start)) * 1000000
+                       + (uint64_t) (ts.tv_nsec / 1000));
+#endif /* HAVE_CLOCK_GETTIME */
+#ifdef HAVE_CLOCK_GET_TIME
+  if (_MHD_INVALID_CLOCK_SERV != mono_clock_service)
+  {
+    mach_timespec_t cur_time;
+
+    if (KERN_SUCCESS == clock_get_time (mono_clock_service,
+                                        &cur_time))
+      return (uint64_t) (((uint64_t) (cur_time.tv_sec - mono_clock_start))
+                         * 1000000 + (uint64_t) (cur_time.tv_nsec / 1000));
+  }
+#endif /* HAVE_CLOCK_GET_TIME */
+#if defined(_WIN32) && _WIN32_WINNT < 0x0600
+  if (0 != perf_freq)
+  {
+    LARGE_INTEGER perf_counter;
+    uint64_t num_ticks;
+
+    QueryPerformanceCounter (&perf_counter);   /* never fail on XP and later */
+    num_ticks = (uint64_t) (perf_counter.QuadPart - perf_start);
+    return ((num_ticks / perf_freq) * 1000000)
+           + ((num_ticks % perf_freq) * 1000000 / perf_freq);
+  }
+#endif /* _WIN32 && _WIN32_WINNT < 0x0600 */
+#ifdef HAVE_GETHRTIME
+  if (1)
+    return ((uint64_t) (gethrtime () - hrtime_start)) / 1000;
+#endif /* HAVE_GETHRTIME */
+
+  /* Use the milliseconds counter with the lower resolution */
+  return MHD_monotonic_msec_counter () * 1000;
+}
@@ -70,4 +70,17 @@ MHD_monotonic_sec_counter (void);
 uint64_t
 MHD_monotonic_msec_counter (void);
 
+
+/**
+ * Monotonic microseconds counter, useful for the measurement of
+ * the short durations.
+ * Tries to be not affected by manually setting the system real time
+ * clock or adjustments by NTP synchronization.
+ * The actual resolution could be lower on some platforms.
+ *
+ * @return number of microseconds from some fixed moment
+ */
+uint64_t
+MHD_monotonic_usec_counter (void);
+
 #endif /* MHD_MONO_CLOCK_H */
@@ -43,6 +43,9 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 #endif /* HAVE_FREEBSD_SENDFILE || HAVE_DARWIN_SENDFILE */
+#ifdef _MHD_HAVE_SPLICE
+#include <fcntl.h>
+#endif /* _MHD_HAVE_SPLICE */
 #ifdef HAVE_SYS_PARAM_H
 /* For FreeBSD version identification */
 #include <sys/param.h>
@@ -50,7 +53,29 @@
 #ifdef HAVE_SYSCONF
 #include <unistd.h>
 #endif /* HAVE_SYSCONF */
+#if defined(HAVE_LINUX_SENDFILE) && defined(HAVE_SYS_IOCTL_H) && \
+  defined(HAVE_LINUX_SOCKIOS_H)
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#if defined(SIOCOUTQ) && defined(SO_SNDBUF)
+/**
+ * The sendfile() chunks could be sized according to the free space in
+ * the socket send buffer
+ */
+#define MHD_SENDFILE_ADAPTIVE_ 1
+#endif /* SIOCOUTQ && SO_SNDBUF */
+#endif /* HAVE_LINUX_SENDFILE && HAVE_SYS_IOCTL_H &&
+          HAVE_LINUX_SOCKIOS_H */
+#ifdef MHD_USE_MSG_ZEROCOPY
+#include <linux/errqueue.h>
+#include "mhd_mono_clock.h"
+#include "response.h"
+#endif /* MHD_USE_MSG_ZEROCOPY */
+#ifdef IO_URING_SUPPORT
+#include "mhd_uring.h"
+#endif /* IO_URING_SUPPORT */
 #include "mhd_assert.h"
+#include "mhd_trace.h"
 
 #include "mhd_limits.h"
 
@@ -73,6 +98,13 @@
  */
 #define MHD_SENFILE_CHUNK_THR_P_C_ (0x200000)
 
+#ifdef MHD_SENDFILE_ADAPTIVE_
+/**
+ * The minimal sendfile() chuck size in the adaptive mode
+ */
+#define MHD_SENFILE_CHUNK_MIN_     (0x4000)
+#endif /* MHD_SENDFILE_ADAPTIVE_ */
+
 #ifdef HAVE_FREEBSD_SENDFILE
 #ifdef SF_FLAGS
 /**
@@ -170,6 +202,339 @@ MHD_send_init_static_vars_ (void)
 }
 
 
+#ifdef MHD_USE_MSG_ZEROCOPY
+
+/**
+ * The socket of the closed connection waiting for the completion of
+ * the zero-copy sends
+ */
+struct MHD_ZcLinger_
+{
+  /**
+   * The next socket in the list
+   */
+  struct MHD_ZcLinger_ *next;
+
+  /**
+   * The response with the data used by the zero-copy sends
+   */
+  struct MHD_Response *response;
+
+  /**
+   * The time when the connection was closed
+   */
+  uint64_t start;
+
+  /**
+   * The socket
+   */
+  MHD_socket fd;
+
+  /**
+   * The number of the zero-copy sends performed on the socket
+   */
+  uint32_t sent;
+
+  /**
+   * The number of the zero-copy sends reported as completed
+   */
+  uint32_t done;
+};
+
+
+/**
+ * Check whether the data should be sent with MSG_ZEROCOPY.
+ *
+ * Only the data of the response with the data in memory (the buffer or
+ * the iovec response) is sent with MSG_ZEROCOPY, as the data must stay
+ * unchanged until the kernel reports the send as completed.  The response
+ * is held by the connection until all sends are completed.
+ * @param connection the connection to use
+ * @param size the size of the data to send
+ * @return MSG_ZEROCOPY if the data should be sent with the zero-copy send,
+ *         zero otherwise
+ */
+static int
+zc_get_send_flag (struct MHD_Connection *connection,
+                  size_t size)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+  struct MHD_Response *const resp = connection->rp.response;
+
+  if ( (0 == daemon->zerocopy_threshold) ||
+       (daemon->zerocopy_threshold > size) )
+    return 0;
+  /* Kernel TLS does not support MSG_ZEROCOPY */
+  if (0 != (daemon->options & MHD_USE_TLS))
+    return 0;
+  if ( (MHD_CONNECTION_NORMAL_BODY_READY != connection->state) ||
+       (NULL == resp) ||
+       (NULL != resp->crc) )
+    return 0;
+  if ( (NULL != connection->zc_response) &&
+       (resp != connection->zc_response) )
+  {
+    /* Only one response could be held by the connection */
+    (void) MHD_send_zc_reap_ (connection);
+    if (NULL != connection->zc_response)
+      return 0;
+  }
+  if (_MHD_UNKNOWN == connection->zc_sk_state)
+  {
+    static const int on_val = 1;
+
+    /* MSG_ZEROCOPY is silently ignored if SO_ZEROCOPY is not set */
+    if (0 == setsockopt (connection->socket_fd,
+                         SOL_SOCKET,
+                         SO_ZEROCOPY,
+                         (const void *) &on_val,
+                         sizeof (on_val)))
+      connection->zc_sk_state = _MHD_ON;
+    else
+      connection->zc_sk_state = _MHD_OFF;
+  }
+  if (_MHD_ON != connection->zc_sk_state)
+    return 0;
+  return MSG_ZEROCOPY;
+}
+
+
+/**
+ * Track the successful zero-copy send.
+ * @param connection the connection used for the send
+ * @param sent the number of bytes sent
+ */
+static void
+zc_track_send (struct MHD_Connection *connection,
+               ssize_t sent)
+{
+  mhd_assert (0 < sent);
+  if (NULL == connection->zc_response)
+  {
+    MHD_increment_response_rc (connection->rp.response);
+    connection->zc_response = connection->rp.response;
+  }
+  mhd_assert (connection->rp.response == connection->zc_response);
+  connection->zc_sent++;
+  MHD_STATS_ADD_ (connection->daemon, bytes_sent_zerocopy, sent);
+}
+
+
+/**
+ * Read the completion notifications of the zero-copy sends from the error
+ * queue of the socket.
+ * @param daemon the daemon to use for the statistics
+ * @param fd the socket to use
+ * @param sent the number of the zero-copy sends performed on the socket
+ * @param[in,out] done the number of the sends reported as completed,
+ *                     updated by the read notifications
+ * @return 'true' if any notification has been read,
+ *         'false' otherwise
+ */
+static bool
+zc_read_notifications (struct MHD_Daemon *daemon,
+                       MHD_socket fd,
+                       uint32_t sent,
+                       uint32_t *done)
+{
+  bool got_any;
+
+  got_any = false;
+  while (sent != *done)
+  {
+    struct msghdr msg;
+    struct cmsghdr *cm;
+    union
+    {
+      struct cmsghdr align;
+      char buf[CMSG_SPACE (sizeof (struct sock_extended_err))];
+    } ctrl;
+
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof (ctrl.buf);
+    if (0 > recvmsg (fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT))
+      break; /* No more notifications */
+    got_any = true;
+    for (cm = CMSG_FIRSTHDR (&msg); NULL != cm; cm = CMSG_NXTHDR (&msg, cm))
+    {
+      struct sock_extended_err ee;
+
+      if (! ( ( (IPPROTO_IP == cm->cmsg_level) &&
+                (IP_RECVERR == cm->cmsg_type) ) ||
+              ( (IPPROTO_IPV6 == cm->cmsg_level) &&
+                (IPV6_RECVERR == cm->cmsg_type) ) ) )
+        continue;
+      memcpy (&ee, CMSG_DATA (cm), sizeof (ee));
+      if ( (0 != ee.ee_errno) ||
+           (SO_EE_ORIGIN_ZEROCOPY != ee.ee_origin) )
+        continue;
+      /* The notification reports the range of the completed sends */
+      *done += ee.ee_data - ee.ee_info + 1;
+      if (0 != (ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED))
+        MHD_STATS_ADD_ (daemon, zerocopy_copied, 1);
+    }
+  }
+  return got_any;
+}
+
+
+/**
+ * Reset and close the socket with the zero-copy sends not completed.
+ * The data not sent yet is dropped by the kernel.
+ * @param fd the socket to close
+ */
+static void
+zc_reset_socket (MHD_socket fd)
+{
+  struct linger lng;
+
+  lng.l_onoff = 1;
+  lng.l_linger = 0;
+  (void) setsockopt (fd,
+                     SOL_SOCKET,
+                     SO_LINGER,
+                     (const void *) &lng,
+                     sizeof (lng));
+  MHD_socket_close_chk_ (fd);
+}
+
+
+bool
+MHD_send_zc_reap_ (struct MHD_Connection *connection)
+{
+  bool got_any;
+
+  if ( (connection->zc_sent == connection->zc_done) ||
+       (MHD_INVALID_SOCKET == connection->socket_fd) )
+    return false;
+  got_any = zc_read_notifications (connection->daemon,
+                                   connection->socket_fd,
+                                   connection->zc_sent,
+                                   &connection->zc_done);
+  if (connection->zc_sent == connection->zc_done)
+  {
+    mhd_assert (NULL != connection->zc_response);
+    MHD_destroy_response (connection->zc_response);
+    connection->zc_response = NULL;
+  }
+  return got_any;
+}
+
+
+void
+MHD_send_zc_wait_ (struct MHD_Connection *connection)
+{
+  const uint64_t start = MHD_monotonic_msec_counter ();
+
+  while (1)
+  {
+    uint64_t elapsed;
+#ifdef HAVE_POLL
+    struct pollfd p[1];
+#endif /* HAVE_POLL */
+
+    (void) MHD_send_zc_reap_ (connection);
+    if (NULL == connection->zc_response)
+      return;
+    elapsed = MHD_monotonic_msec_counter () - start;
+    if (MHD_ZC_LINGER_MAX_MS_ <= elapsed)
+      return;
+#ifdef HAVE_POLL
+    /* The notifications are reported as POLLERR */
+    p[0].fd = connection->socket_fd;
+    p[0].events = 0;
+    p[0].revents = 0;
+    if ( (0 > MHD_sys_poll_ (p,
+                             1,
+                             (int) (MHD_ZC_LINGER_MAX_MS_ - elapsed))) &&
+         (! MHD_SCKT_LAST_ERR_IS_ (MHD_SCKT_EINTR_)) )
+      return;
+    if (0 != (p[0].revents & POLLNVAL))
+      return;
+#else  /* ! HAVE_POLL */
+    return;
+#endif /* ! HAVE_POLL */
+  }
+}
+
+
+void
+MHD_send_zc_linger_ (struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+  struct MHD_ZcLinger_ *zl;
+
+  if (NULL == connection->zc_response)
+    return;
+  (void) MHD_send_zc_reap_ (connection);
+  if (NULL == connection->zc_response)
+    return;
+  mhd_assert (MHD_INVALID_SOCKET != connection->socket_fd);
+  /* In thread-per-connection mode the connection thread has already
+     waited for the completion */
+  if (MHD_D_IS_USING_THREAD_PER_CONN_ (daemon))
+    zl = NULL;
+  else
+    zl = (struct MHD_ZcLinger_ *) malloc (sizeof (struct MHD_ZcLinger_));
+  if (NULL == zl)
+  {
+    zc_reset_socket (connection->socket_fd);
+    MHD_destroy_response (connection->zc_response);
+  }
+  else
+  {
+    zl->response = connection->zc_response;
+    zl->start = MHD_monotonic_msec_counter ();
+    zl->fd = connection->socket_fd;
+    zl->sent = connection->zc_sent;
+    zl->done = connection->zc_done;
+    zl->next = daemon->zc_linger;
+    daemon->zc_linger = zl;
+  }
+  connection->socket_fd = MHD_INVALID_SOCKET;
+  connection->zc_response = NULL;
+}
+
+
+void
+MHD_send_zc_linger_process_ (struct MHD_Daemon *daemon,
+                             bool force)
+{
+  struct MHD_ZcLinger_ **pzl;
+  struct MHD_ZcLinger_ *zl;
+  uint64_t now;
+
+  if (NULL == daemon->zc_linger)
+    return;
+  now = MHD_monotonic_msec_counter ();
+  pzl = &daemon->zc_linger;
+  while (NULL != (zl = *pzl))
+  {
+    (void) zc_read_notifications (daemon,
+                                  zl->fd,
+                                  zl->sent,
+                                  &zl->done);
+    if (zl->sent == zl->done)
+      MHD_socket_close_chk_ (zl->fd);
+    else if (force ||
+             (MHD_ZC_LINGER_MAX_MS_ <= now - zl->start))
+      zc_reset_socket (zl->fd);
+    else
+    {
+      pzl = &zl->next;
+      continue;
+    }
+    *pzl = zl->next;
+    MHD_destroy_response (zl->response);
+    free (zl);
+  }
+}
+
+
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
+
 bool
 MHD_connection_set_nodelay_state_ (struct MHD_Connection *connection,
                                    bool nodelay_state)
@@ -749,6 +1114,136 @@ post_send_setopt (struct MHD_Connection *connection,
 }
 
 
+#ifdef IO_URING_SUPPORT
+/**
+ * The maximum size of the data sent by the daemon's io_uring.
+ * The larger data is sent directly from the connection's buffers to
+ * avoid copying.
+ */
+#define MHD_URING_SEND_MAX_SIZE (16 * 1024)
+
+/**
+ * Send the data by the daemon's io_uring.
+ * The data is copied to the connection's io_uring context and the send
+ * request is queued, the attempt is reported as "try again" while the
+ * request is in flight.  When the request is completed, the next
+ * attempt to send the same data reports the result of the request
+ * without any system call.
+ * If the response is pushed and the connection is kept alive, the
+ * receive request for the next request is linked to the send request,
+ * so both requests are submitted by the same io_uring_enter() call as
+ * all other requests of the daemon's thread.
+ *
+ * @param connection the connection to use
+ * @param header the first part of the data to send
+ * @param header_size the size of the @a header
+ * @param body the second part of the data to send, could be NULL
+ * @param body_size the size of the @a body
+ * @param msg_flags the send() flags
+ * @param push_data set to 'true' if the data is pushed to the client
+ * @param[out] ret set to the number of bytes sent or to -1 with
+ *                 errno set
+ * @return 'true' if the data has been handled by the io_uring,
+ *         'false' if the data must be sent directly
+ */
+static bool
+uring_send (struct MHD_Connection *connection,
+            const char *header,
+            size_t header_size,
+            const char *body,
+            size_t body_size,
+            int msg_flags,
+            bool push_data,
+            ssize_t *ret)
+{
+  struct MHD_UringConn_ *const uc = connection->uring;
+  struct MHD_Uring_ *const ring = connection->daemon->uring;
+  const uint64_t ud = (uint64_t) (uintptr_t) uc;
+  const size_t size = header_size + body_size;
+  bool link_recv;
+
+  if (NULL == uc)
+    return false;
+  if (uc->send_pending)
+  {
+    errno = EAGAIN;
+    *ret = -1;
+    return true;
+  }
+  if (uc->send_done)
+  {
+    /* The same data must be provided again */
+    mhd_assert (uc->send_size == size);
+    uc->send_done = false;
+    if (0 > uc->send_res)
+    {
+      errno = -uc->send_res;
+      *ret = -1;
+    }
+    else
+      *ret = (ssize_t) uc->send_res;
+    return true;
+  }
+  if ( (0 == size) ||
+       (MHD_URING_SEND_MAX_SIZE < size) )
+    return false;
+  if (uc->send_buf_size < size)
+  {
+    char *const new_buf = (char *) realloc (uc->send_buf,
+                                            size);
+    if (NULL == new_buf)
+      return false;
+    uc->send_buf = new_buf;
+    uc->send_buf_size = size;
+  }
+  memcpy (uc->send_buf,
+          header,
+          header_size);
+  if (0 != body_size)
+    memcpy (uc->send_buf + header_size,
+            body,
+            body_size);
+  link_recv = push_data &&
+              (MHD_CONN_USE_KEEPALIVE == connection->keepalive) &&
+              (! uc->recv_pending) &&
+              (! uc->has_buf) &&
+              (! uc->eof) &&
+              (0 == uc->err);
+  if (! MHD_uring_prep_send_ (ring,
+                              connection->socket_fd,
+                              uc->send_buf,
+                              size,
+                              msg_flags | MSG_NOSIGNAL,
+                              link_recv,
+                              ud | MHD_URING_TAG_SEND_))
+    return false;
+  uc->send_pending = true;
+  uc->send_size = size;
+  uc->pending++;
+  connection->daemon->uring_ops++;
+  /* The linked request is cancelled if the data is not sent completely,
+     the data is received directly in this case */
+  if (link_recv &&
+      MHD_uring_prep_recv_ (ring,
+                            connection->socket_fd,
+                            0,
+                            ud | MHD_URING_TAG_RECV_))
+  {
+    uc->recv_pending = true;
+    uc->pending++;
+    connection->daemon->uring_ops++;
+    /* The next data is reported by the completion */
+    connection->epoll_state &=
+      ~((enum MHD_EpollState) MHD_EPOLL_STATE_READ_READY);
+  }
+  errno = EAGAIN;
+  *ret = -1;
+  return true;
+}
+
+
+#endif /* IO_URING_SUPPORT */
+
 ssize_t
 MHD_send_data_ (struct MHD_Connection *connection,
                 const char *buffer,
@@ -757,11 +1252,7 @@ MHD_send_data_ (struct MHD_Connection *connection,
 {
   MHD_socket s = connection->socket_fd;
   ssize_t ret;
-#ifdef HTTPS_SUPPORT
-  const bool tls_conn = (connection->daemon->options & MHD_USE_TLS);
-#else  /* ! HTTPS_SUPPORT */
-  const bool tls_conn = false;
-#endif /* ! HTTPS_SUPPORT */
+  const bool tls_conn = MHD_C_IS_TLS_LIB_SEND_ (connection);
 
   if ( (MHD_INVALID_SOCKET == s) ||
        (MHD_CONNECTION_CLOSED == connection->state) )
@@ -828,6 +1319,11 @@ MHD_send_data_ (struct MHD_Connection *connection,
   }
   else
   {
+    int flags;
+#ifdef MHD_USE_MSG_ZEROCOPY
+    int zc_flag;
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
     /* plaintext transmission */
     if (buffer_size > MHD_SCKT_SEND_MAX_SIZE_)
     {
@@ -835,18 +1331,51 @@ MHD_send_data_ (struct MHD_Connection *connection,
       push_data = false; /* Incomplete send */
     }
 
-    pre_send_setopt (connection, (! tls_conn), push_data);
+    flags = 0;
 #ifdef MHD_USE_MSG_MORE
-    ret = MHD_send4_ (s,
-                      buffer,
-                      buffer_size,
-                      push_data ? 0 : MSG_MORE);
-#else
-    ret = MHD_send4_ (s,
+    if (! push_data)
+      flags |= MSG_MORE;
+#endif /* MHD_USE_MSG_MORE */
+
+    pre_send_setopt (connection, (! tls_conn), push_data);
+#ifdef IO_URING_SUPPORT
+    if (! uring_send (connection,
                       buffer,
                       buffer_size,
-                      0);
-#endif
+                      NULL,
+                      0,
+                      flags,
+                      push_data,
+                      &ret))
+#endif /* IO_URING_SUPPORT */
+    {
+#ifdef MHD_USE_MSG_ZEROCOPY
+      zc_flag = zc_get_send_flag (connection,
+                                  buffer_size);
+      ret = MHD_send4_ (s,
+                        buffer,
+                        buffer_size,
+                        flags | zc_flag);
+      if ( (0 > ret) && (0 != zc_flag) &&
+           MHD_SCKT_ERR_IS_LOW_RESOURCES_ (MHD_socket_get_error_ ()) )
+      {
+        /* The limit of the locked memory is reached, copy the data */
+        zc_flag = 0;
+        ret = MHD_send4_ (s,
+                          buffer,
+                          buffer_size,
+                          flags);
+      }
+      if ( (0 < ret) && (0 != zc_flag) )
+        zc_track_send (connection,
+                       ret);
+#else  /* ! MHD_USE_MSG_ZEROCOPY */
+      ret = MHD_send4_ (s,
+                        buffer,
+                        buffer_size,
+                        flags);
+#endif /* ! MHD_USE_MSG_ZEROCOPY */
+    }
 
     if (0 > ret)
     {
@@ -897,6 +1426,12 @@ MHD_send_data_ (struct MHD_Connection *connection,
        (buffer_size == (size_t) ret) )
     post_send_setopt (connection, (! tls_conn), push_data);
 
+  if (0 < ret)
+  {
+    MHD_STATS_ADD_ (connection->daemon, bytes_sent_send, ret);
+    MHD_TRACE2_ (send__data, connection, ret);
+  }
+
   return ret;
 }
 
@@ -934,7 +1469,7 @@ MHD_send_hdr_and_body_ (struct MHD_Connection *connection,
 
   no_vec = false;
 #ifdef HTTPS_SUPPORT
-  no_vec = no_vec || (connection->daemon->options & MHD_USE_TLS);
+  no_vec = no_vec || MHD_C_IS_TLS_LIB_SEND_ (connection);
 #endif /* HTTPS_SUPPORT */
 #if (! defined(HAVE_SENDMSG) || ! defined(MSG_NOSIGNAL) ) && \
   defined(MHD_SEND_SPIPE_SEND_SUPPRESS_POSSIBLE) && \
@@ -1064,15 +1599,27 @@ MHD_send_hdr_and_body_ (struct MHD_Connection *connection,
   vector[1].iov_base = _MHD_DROP_CONST (body);
   vector[1].iov_len = body_size;
 
+#ifdef IO_URING_SUPPORT
+  if (! uring_send (connection,
+                    header,
+                    header_size,
+                    body,
+                    body_size,
+                    0,
+                    push_hdr || push_body,
+                    &ret))
+#endif /* IO_URING_SUPPORT */
+  {
 #if defined(HAVE_SENDMSG)
-  memset (&msg, 0, sizeof(msg));
-  msg.msg_iov = vector;
-  msg.msg_iovlen = 2;
+    memset (&msg, 0, sizeof(msg));
+    msg.msg_iov = vector;
+    msg.msg_iovlen = 2;
 
-  ret = sendmsg (s, &msg, MSG_NOSIGNAL_OR_ZERO);
+    ret = sendmsg (s, &msg, MSG_NOSIGNAL_OR_ZERO);
 #elif defined(HAVE_WRITEV)
-  ret = writev (s, vector, 2);
+    ret = writev (s, vector, 2);
 #endif /* HAVE_WRITEV */
+  }
 #endif /* HAVE_SENDMSG || HAVE_WRITEV */
 #ifdef _WIN32
   if ((size_t) UINT_MAX < body_size)
@@ -1158,14 +1705,20 @@ MHD_send_hdr_and_body_ (struct MHD_Connection *connection,
      * need to push the header data. */
     /* Luckily the type of send function will be used next is known. */
     post_send_setopt (connection,
-#if defined(_MHD_HAVE_SENDFILE)
+#if defined(_MHD_HAVE_SENDFILE) || defined(_MHD_HAVE_SPLICE)
                       MHD_resp_sender_std == connection->rp.resp_sender,
-#else  /* ! _MHD_HAVE_SENDFILE */
+#else  /* ! _MHD_HAVE_SENDFILE && ! _MHD_HAVE_SPLICE */
                       true,
-#endif /* ! _MHD_HAVE_SENDFILE */
+#endif /* ! _MHD_HAVE_SENDFILE && ! _MHD_HAVE_SPLICE */
                       true);
   }
 
+  if (0 < ret)
+  {
+    MHD_STATS_ADD_ (connection->daemon, bytes_sent_writev, ret);
+    MHD_TRACE2_ (send__writev, connection, ret);
+  }
+
   return ret;
 #else  /* ! MHD_VECT_SEND */
   mhd_assert (false);
@@ -1175,6 +1728,66 @@ MHD_send_hdr_and_body_ (struct MHD_Connection *connection,
 
 
 #if defined(_MHD_HAVE_SENDFILE)
+#ifdef MHD_SENDFILE_ADAPTIVE_
+/**
+ * Get the size of the next sendfile() chunk for the connection.
+ *
+ * If the previous sendfile() call has filled the socket send buffer,
+ * the chunk is limited by the free space in the send buffer, so the file
+ * data is not read by the kernel just to be dropped when the socket
+ * cannot take it.
+ * The size of the send buffer is cached in the connection, so only
+ * the amount of the queued data is queried for each chunk.
+ * @param connection the connection to use
+ * @param max_chunk the maximum size of the chunk
+ * @return the size of the chunk
+ */
+static size_t
+sendfile_chunk_size (struct MHD_Connection *connection,
+                     size_t max_chunk)
+{
+  int queued;
+  size_t space;
+
+  if ( (! connection->rp.sf_buf_full) ||
+       (! connection->daemon->sendfile_adaptive) ||
+       (! connection->sk_nonblck) )
+    return max_chunk;
+  if (0 != ioctl (connection->socket_fd,
+                  SIOCOUTQ,
+                  &queued))
+    return max_chunk;
+  if (0 == connection->sf_sndbuf)
+  {
+    int buf_size;
+    socklen_t opt_len;
+
+    opt_len = (socklen_t) sizeof(buf_size);
+    if ( (0 != getsockopt (connection->socket_fd,
+                           SOL_SOCKET,
+                           SO_SNDBUF,
+                           (void *) &buf_size,
+                           &opt_len)) ||
+         (0 >= buf_size) )
+      return max_chunk;
+    connection->sf_sndbuf = buf_size;
+  }
+  /* The size of the send buffer includes the bookkeeping overhead,
+     which is small for the large segments used by sendfile(). */
+  if (connection->sf_sndbuf > queued)
+    space = (size_t) (connection->sf_sndbuf - queued);
+  else
+    space = 0;
+  if (MHD_SENFILE_CHUNK_MIN_ > space)
+    space = MHD_SENFILE_CHUNK_MIN_;
+  if (max_chunk < space)
+    return max_chunk;
+  return space;
+}
+
+
+#endif /* MHD_SENDFILE_ADAPTIVE_ */
+
 ssize_t
 MHD_send_sendfile_ (struct MHD_Connection *connection)
 {
@@ -1203,12 +1816,18 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
 #endif /* HAVE_DARWIN_SENDFILE */
   const bool used_thr_p_c =
     MHD_D_IS_USING_THREAD_PER_CONN_ (connection->daemon);
-  const size_t chunk_size = used_thr_p_c ? MHD_SENFILE_CHUNK_THR_P_C_ :
-                            MHD_SENFILE_CHUNK_;
+  const size_t max_chunk = used_thr_p_c ? MHD_SENFILE_CHUNK_THR_P_C_ :
+                           MHD_SENFILE_CHUNK_;
+#ifndef MHD_SENDFILE_ADAPTIVE_
+  const size_t chunk_size = max_chunk;
+#else  /* MHD_SENDFILE_ADAPTIVE_ */
+  const size_t chunk_size = sendfile_chunk_size (connection,
+                                                 max_chunk);
+#endif /* MHD_SENDFILE_ADAPTIVE_ */
   size_t send_size = 0;
   bool push_data;
   mhd_assert (MHD_resp_sender_sendfile == connection->rp.resp_sender);
-  mhd_assert (0 == (connection->daemon->options & MHD_USE_TLS));
+  mhd_assert (! MHD_C_IS_TLS_LIB_SEND_ (connection));
 
   offsetu64 = connection->rp.rsp_write_position
               + connection->rp.response->fd_off;
@@ -1262,6 +1881,7 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
       connection->epoll_state &=
         ~((enum MHD_EpollState) MHD_EPOLL_STATE_WRITE_READY);
 #endif /* EPOLL_SUPPORT */
+      connection->rp.sf_buf_full = true;
       return MHD_ERR_AGAIN_;
     }
     if (MHD_SCKT_ERR_IS_EINTR_ (err))
@@ -1293,11 +1913,22 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
     return MHD_ERR_BADF_;   /* Fail hard */
 #endif /* HAVE_SOLARIS_SENDFILE */
   }
-#ifdef EPOLL_SUPPORT
   else if (send_size > (size_t) ret)
+  {
+#ifdef EPOLL_SUPPORT
     connection->epoll_state &=
       ~((enum MHD_EpollState) MHD_EPOLL_STATE_WRITE_READY);
 #endif /* EPOLL_SUPPORT */
+    connection->rp.sf_buf_full = true;
+    MHD_STATS_ADD_ (connection->daemon, sendfile_partial, 1);
+  }
+  else if (max_chunk == chunk_size)
+  {
+    connection->rp.sf_buf_full = false; /* The buffer takes the full chunks */
+    /* The send buffer could be grown by the kernel, get the new size when
+       the buffer is filled next time */
+    connection->sf_sndbuf = 0;
+  }
 #elif defined(HAVE_FREEBSD_SENDFILE)
 #ifdef SF_FLAGS
   flags = used_thr_p_c ?
@@ -1318,7 +1949,11 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
     {
       mhd_assert (SSIZE_MAX >= sent_bytes);
       if (0 != sent_bytes)
+      {
+        MHD_STATS_ADD_ (connection->daemon, bytes_sent_sendfile, sent_bytes);
+        MHD_TRACE2_ (send__sendfile, connection, sent_bytes);
         return (ssize_t) sent_bytes;
+      }
 
       return MHD_ERR_AGAIN_;
     }
@@ -1347,7 +1982,11 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
       mhd_assert (SSIZE_MAX >= len);
       mhd_assert (send_size >= (size_t) len);
       if (0 != len)
+      {
+        MHD_STATS_ADD_ (connection->daemon, bytes_sent_sendfile, len);
+        MHD_TRACE2_ (send__sendfile, connection, len);
         return (ssize_t) len;
+      }
 
       return MHD_ERR_AGAIN_;
     }
@@ -1377,19 +2016,126 @@ MHD_send_sendfile_ (struct MHD_Connection *connection)
        (send_size == (size_t) ret) )
     post_send_setopt (connection, false, push_data);
 
+  if (0 < ret)
+  {
+    MHD_STATS_ADD_ (connection->daemon, bytes_sent_sendfile, ret);
+    MHD_TRACE2_ (send__sendfile, connection, ret);
+  }
+
   return ret;
 }
 
 
 #endif /* _MHD_HAVE_SENDFILE */
 
+#if defined(_MHD_HAVE_SPLICE)
+ssize_t
+MHD_send_splice_ (struct MHD_Connection *connection)
+{
+  ssize_t ret;
+  const int pipe_fd = connection->rp.response->fd;
+  const bool used_thr_p_c =
+    MHD_D_IS_USING_THREAD_PER_CONN_ (connection->daemon);
+  const size_t chunk_size = used_thr_p_c ? MHD_SENFILE_CHUNK_THR_P_C_ :
+                            MHD_SENFILE_CHUNK_;
+  size_t send_size;
+  bool push_data;
+  unsigned int flags;
+  mhd_assert (MHD_resp_sender_splice == connection->rp.resp_sender);
+  mhd_assert (! MHD_C_IS_TLS_LIB_SEND_ (connection));
+  mhd_assert (connection->rp.response->is_pipe);
+
+  if (connection->rp.props.chunked)
+  {
+    /* The size of the chunk has been already sent in the chunk header,
+       the data is already in the pipe. */
+    mhd_assert (0 != connection->rp.splice_left);
+    send_size = connection->rp.splice_left;
+    push_data = false; /* The chunk is terminated by the separate CRLF */
+  }
+  else
+  {
+    /* The total size is unknown, the end of the data is detected by
+       the end of the pipe stream.
+       Do not allow system to stick sending on single fast connection:
+       use 128KiB chunks (2MiB for thread-per-connection). */
+    send_size = chunk_size;
+    push_data = true; /* The pipe may have no more data for some time */
+  }
+  if ((size_t) SSIZE_MAX < send_size)
+    send_size = (size_t) SSIZE_MAX;
+
+  flags = SPLICE_F_MOVE;
+  if (! push_data)
+    flags |= SPLICE_F_MORE;
+
+  pre_send_setopt (connection, false, push_data);
+
+  /* The pipe is in the blocking mode (as for the read() in the standard
+     pipe reader), the mode of the socket is used for the socket side. */
+  ret = splice (pipe_fd,
+                NULL,
+                connection->socket_fd,
+                NULL,
+                send_size,
+                flags);
+  if (0 > ret)
+  {
+    const int err = MHD_socket_get_error_ ();
+    if (MHD_SCKT_ERR_IS_EAGAIN_ (err))
+    {
+#ifdef EPOLL_SUPPORT
+      /* EAGAIN --- no longer write-ready */
+      connection->epoll_state &=
+        ~((enum MHD_EpollState) MHD_EPOLL_STATE_WRITE_READY);
+#endif /* EPOLL_SUPPORT */
+      return MHD_ERR_AGAIN_;
+    }
+    if (MHD_SCKT_ERR_IS_EINTR_ (err))
+      return MHD_ERR_AGAIN_;
+    if (MHD_SCKT_ERR_IS_REMOTE_DISCNN_ (err) ||
+        (EPIPE == err) ||
+        (ENOTCONN == err) )
+      return MHD_ERR_CONNRESET_;
+    if (MHD_SCKT_ERR_IS_ (err,
+                          MHD_SCKT_EBADF_))
+      return MHD_ERR_BADF_;
+    /* splice() failed with EINVAL if the socket or the pipe does not
+       support splicing, or other 'unusual' errors occurred.
+       Retry with the standard pipe reader and send(). */
+    connection->rp.resp_sender = MHD_resp_sender_std;
+    return MHD_ERR_AGAIN_;
+  }
+#ifdef EPOLL_SUPPORT
+  else if ((0 != ret) && (send_size > (size_t) ret))
+    connection->epoll_state &=
+      ~((enum MHD_EpollState) MHD_EPOLL_STATE_WRITE_READY);
+#endif /* EPOLL_SUPPORT */
+
+  if ( (push_data) &&
+       (0 != ret) )
+    post_send_setopt (connection, false, push_data);
+
+  if (0 < ret)
+  {
+    MHD_STATS_ADD_ (connection->daemon, bytes_sent_splice, ret);
+    MHD_TRACE2_ (send__splice, connection, ret);
+  }
+
+  return ret;
+}
+
+
+#endif /* _MHD_HAVE_SPLICE */
+
 #if defined(MHD_VECT_SEND)
 
 
 /**
  * Function sends iov data by system sendmsg or writev function.
  *
- * Connection must be in non-TLS (non-HTTPS) mode.
+ * Connection must be in non-TLS (non-HTTPS) mode or must use kernel TLS
+ * for sending.
  *
  * @param connection the MHD connection structure
  * @param r_iov the pointer to iov data structure with tracking
@@ -1408,12 +2154,16 @@ send_iov_nontls (struct MHD_Connection *connection,
   size_t items_to_send;
 #ifdef HAVE_SENDMSG
   struct msghdr msg;
+  int flags;
+#ifdef MHD_USE_MSG_ZEROCOPY
+  int zc_flag;
+#endif /* MHD_USE_MSG_ZEROCOPY */
 #elif defined(MHD_WINSOCK_SOCKETS)
   DWORD bytes_sent;
   DWORD cnt_w;
 #endif /* MHD_WINSOCK_SOCKETS */
 
-  mhd_assert (0 == (connection->daemon->options & MHD_USE_TLS));
+  mhd_assert (! MHD_C_IS_TLS_LIB_SEND_ (connection));
 
   if ( (MHD_INVALID_SOCKET == connection->socket_fd) ||
        (MHD_CONNECTION_CLOSED == connection->state) )
@@ -1437,13 +2187,43 @@ send_iov_nontls (struct MHD_Connection *connection,
   msg.msg_iov = r_iov->iov + r_iov->sent;
   msg.msg_iovlen = items_to_send;
 
-  pre_send_setopt (connection, true, push_data);
+  flags = MSG_NOSIGNAL_OR_ZERO;
 #ifdef MHD_USE_MSG_MORE
-  res = sendmsg (connection->socket_fd, &msg,
-                 MSG_NOSIGNAL_OR_ZERO | (push_data ? 0 : MSG_MORE));
-#else  /* ! MHD_USE_MSG_MORE */
-  res = sendmsg (connection->socket_fd, &msg, MSG_NOSIGNAL_OR_ZERO);
-#endif /* ! MHD_USE_MSG_MORE */
+  if (! push_data)
+    flags |= MSG_MORE;
+#endif /* MHD_USE_MSG_MORE */
+#ifdef MHD_USE_MSG_ZEROCOPY
+  zc_flag = 0;
+  if (0 != connection->daemon->zerocopy_threshold)
+  {
+    size_t i;
+    size_t total;
+
+    total = 0;
+    for (i = 0; (i < items_to_send) &&
+         (total < connection->daemon->zerocopy_threshold); ++i)
+      total += msg.msg_iov[i].iov_len;
+    zc_flag = zc_get_send_flag (connection,
+                                total);
+  }
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
+  pre_send_setopt (connection, true, push_data);
+#ifdef MHD_USE_MSG_ZEROCOPY
+  res = sendmsg (connection->socket_fd, &msg, flags | zc_flag);
+  if ( (0 > res) && (0 != zc_flag) &&
+       MHD_SCKT_ERR_IS_LOW_RESOURCES_ (MHD_socket_get_error_ ()) )
+  {
+    /* The limit of the locked memory is reached, copy the data */
+    zc_flag = 0;
+    res = sendmsg (connection->socket_fd, &msg, flags);
+  }
+  if ( (0 < res) && (0 != zc_flag) )
+    zc_track_send (connection,
+                   res);
+#else  /* ! MHD_USE_MSG_ZEROCOPY */
+  res = sendmsg (connection->socket_fd, &msg, flags);
+#endif /* ! MHD_USE_MSG_ZEROCOPY */
 #elif defined(HAVE_WRITEV)
   pre_send_setopt (connection, true, push_data);
   res = writev (connection->socket_fd, r_iov->iov + r_iov->sent,
@@ -1537,6 +2317,12 @@ send_iov_nontls (struct MHD_Connection *connection,
     }
   }
 
+  if (0 < res)
+  {
+    MHD_STATS_ADD_ (connection->daemon, bytes_sent_writev, res);
+    MHD_TRACE2_ (send__writev, connection, res);
+  }
+
   return res;
 }
 
@@ -1637,8 +2423,7 @@ MHD_send_iovec_ (struct MHD_Connection *connection,
 #if defined(HTTPS_SUPPORT) || \
   defined(_MHD_VECT_SEND_NEEDS_SPIPE_SUPPRESSED)
 #ifdef HTTPS_SUPPORT
-  use_iov_send = use_iov_send &&
-                 (0 == (connection->daemon->options & MHD_USE_TLS));
+  use_iov_send = use_iov_send && ! MHD_C_IS_TLS_LIB_SEND_ (connection);
 #endif /* HTTPS_SUPPORT */
 #ifdef _MHD_VECT_SEND_NEEDS_SPIPE_SUPPRESSED
   use_iov_send = use_iov_send && (connection->daemon->sigpipe_blocked ||
@@ -113,6 +113,24 @@ MHD_send_sendfile_ (struct MHD_Connection *connection);
 
 #endif
 
+#if defined(_MHD_HAVE_SPLICE)
+/**
+ * Function for sending responses backed by pipe FD.
+ *
+ * The data is moved from the pipe to the socket by the kernel, without
+ * copying to the user space.
+ * For chunked replies the size of the data to send is taken from
+ * @a connection->rp.splice_left.
+ *
+ * @param connection the MHD connection structure
+ * @return actual number of bytes sent, zero if the end of the pipe stream
+ *         has been reached, or negative error code
+ */
+ssize_t
+MHD_send_splice_ (struct MHD_Connection *connection);
+
+#endif /* _MHD_HAVE_SPLICE */
+
 
 /**
  * Set required TCP_NODELAY state for connection socket
@@ -159,5 +177,76 @@ MHD_send_iovec_ (struct MHD_Connection *connection,
                  struct MHD_iovec_track_ *const r_iov,
                  bool push_data);
 
+#ifdef MHD_USE_MSG_ZEROCOPY
+
+/**
+ * The maximum time in milliseconds to wait for the completion of
+ * the zero-copy sends after the connection is closed.
+ * The socket is reset if the sends are not completed in time.
+ */
+#define MHD_ZC_LINGER_MAX_MS_ 5000
+
+/**
+ * The interval in milliseconds of the checks of the sockets waiting for
+ * the completion of the zero-copy sends.
+ */
+#define MHD_ZC_LINGER_CHECK_MS_ 20
+
+/**
+ * Read the completion notifications of the zero-copy sends from the error
+ * queue of the connection socket.
+ * The response used by the zero-copy sends is released when all sends are
+ * completed.
+ *
+ * The notifications are reported by the sockets polling functions as
+ * the socket error (POLLERR / EPOLLERR), the error is not a real socket
+ * error if any notification has been read.
+ * @param connection the connection to process
+ * @return 'true' if any notification has been read,
+ *         'false' otherwise
+ */
+bool
+MHD_send_zc_reap_ (struct MHD_Connection *connection);
+
+
+/**
+ * Wait for the completion of the zero-copy sends of the connection.
+ * The wait is limited by #MHD_ZC_LINGER_MAX_MS_.
+ * @remark To be called only from the thread of the connection in
+ *         thread-per-connection mode.
+ * @param connection the connection to process
+ */
+void
+MHD_send_zc_wait_ (struct MHD_Connection *connection);
+
+
+/**
+ * Take the socket of the closed connection if the zero-copy sends are not
+ * completed.  The socket is closed and the response is released later by
+ * #MHD_send_zc_linger_process_().
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
+ * @param connection the closed connection, the socket is set to
+ *                   #MHD_INVALID_SOCKET if it has been taken
+ */
+void
+MHD_send_zc_linger_ (struct MHD_Connection *connection);
+
+
+/**
+ * Check the sockets of the closed connections waiting for the completion of
+ * the zero-copy sends.  The sockets with the completed sends are closed,
+ * the sockets with the sends not completed in time are reset.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
+ * @param daemon the daemon to process
+ * @param force set to 'true' to reset all waiting sockets
+ */
+void
+MHD_send_zc_linger_process_ (struct MHD_Daemon *daemon,
+                             bool force);
+
+#endif /* MHD_USE_MSG_ZEROCOPY */
+
 
 #endif /* MHD_SEND_H */
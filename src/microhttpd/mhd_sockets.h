@@ -297,6 +297,30 @@ typedef SOCKET MHD_socket;
 #endif /* __linux__ */
 #endif /* MSG_MORE */
 
+#if defined(HAVE_MSG_ZEROCOPY) && defined(HAVE_SENDMSG)
+/**
+ * Indicate MSG_ZEROCOPY is usable for send() and sendmsg() with
+ * the completion notifications read from the socket error queue.
+ */
+#define MHD_USE_MSG_ZEROCOPY 1
+#endif /* HAVE_MSG_ZEROCOPY && HAVE_SENDMSG */
+
+#if defined(SO_REUSEPORT_LB)
+/**
+ * The socket option to bind several sockets to the same address:port
+ * with load balancing of incoming connections between the sockets.
+ */
+#define MHD_SO_REUSEPORT_BALANCED SO_REUSEPORT_LB
+#elif defined(SO_REUSEPORT) && (defined(__linux__) || defined(__DragonFly__))
+/* SO_REUSEPORT balances incoming connections only on some platforms.
+ * Add more OSes if they are compatible. */
+/**
+ * The socket option to bind several sockets to the same address:port
+ * with load balancing of incoming connections between the sockets.
+ */
+#define MHD_SO_REUSEPORT_BALANCED SO_REUSEPORT
+#endif /* SO_REUSEPORT && (__linux__ || __DragonFly__) */
+
 
 /**
  * MHD_SCKT_OPT_BOOL_ is type for bool parameters for setsockopt()/getsockopt()
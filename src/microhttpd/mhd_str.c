@@ -33,6 +33,38 @@
 #include "mhd_assert.h"
 #include "mhd_limits.h"
 #include "mhd_assert.h"
+#include "mhd_byteorder.h"
+
+#ifndef MHD_FAVOR_SMALL_CODE
+#if defined(__AVX2__)
+#include <immintrin.h>
+/**
+ * Use 32 bytes and 16 bytes vectors for characters scanning
+ */
+#define MHD_STR_SCAN_AVX2_ 1
+#define MHD_STR_SCAN_SSE2_ 1
+#elif defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && (2 <= _M_IX86_FP))
+#include <emmintrin.h>
+/**
+ * Use 16 bytes vectors for characters scanning
+ */
+#define MHD_STR_SCAN_SSE2_ 1
+#elif defined(__ARM_NEON) && defined(__aarch64__) && \
+  (_MHD_BYTE_ORDER == _MHD_LITTLE_ENDIAN)
+#include <arm_neon.h>
+/**
+ * Use 16 bytes NEON vectors for characters scanning
+ */
+#define MHD_STR_SCAN_NEON_ 1
+#endif
+#if _MHD_BYTE_ORDER == _MHD_LITTLE_ENDIAN
+/**
+ * Process 8 characters at once in 64-bit words
+ */
+#define MHD_STR_SCAN_SWAR_ 1
+#endif /* _MHD_BYTE_ORDER == _MHD_LITTLE_ENDIAN */
+#endif /* ! MHD_FAVOR_SMALL_CODE */
 
 #ifdef MHD_FAVOR_SMALL_CODE
 #ifdef _MHD_static_inline
@@ -54,7 +86,6 @@
 
 #ifdef HAVE_INLINE_FUNCS
 
-#if 0 /* Disable unused functions. */
 /**
  * Check whether character is lower case letter in US-ASCII
  *
@@ -68,8 +99,6 @@ isasciilower (char c)
 }
 
 
-#endif /* Disable unused functions. */
-
 
 /**
  * Check whether character is upper case letter in US-ASCII
@@ -146,7 +175,6 @@ isasciialnum (char c)
 #endif /* Disable unused functions. */
 
 
-#if 0 /* Disable unused functions. */
 /**
  * Convert US-ASCII character to lower case.
  * If character is upper case letter in US-ASCII than it's converted to lower
@@ -163,6 +191,7 @@ toasciilower (char c)
 }
 
 
+#if 0 /* Disable unused functions. */
 /**
  * Convert US-ASCII character to upper case.
  * If character is lower case letter in US-ASCII than it's converted to upper
@@ -535,10 +564,9 @@ toxdigitvalue (char c)
 _MHD_static_inline bool
 charsequalcaseless (const char c1, const char c2)
 {
+  /* US-ASCII letters of different case differ only by 0x20 bit */
   return ( (c1 == c2) ||
-           (isasciiupper (c1) ?
-            ((c1 - 'A' + 'a') == c2) :
-            ((c1 == (c2 - 'A' + 'a')) && isasciiupper (c2))) );
+           ((0x20 == (c1 ^ c2)) && isasciilower ((char) (c1 | 0x20))) );
 }
 
 
@@ -664,9 +692,7 @@ charsequalcaseless (const char c1, const char c2)
  */
 #define charsequalcaseless(c1, c2) \
   ( ((c1) == (c2)) || \
-           (isasciiupper (c1) ? \
-             (((c1) - 'A' + 'a') == (c2)) : \
-             (((c1) == ((c2) - 'A' + 'a')) && isasciiupper (c2))) )
+    ((0x20 == ((c1) ^ (c2))) && isasciilower ((char) ((c1) | 0x20))) )
 
 #endif /* !HAVE_INLINE_FUNCS */
 
@@ -735,6 +761,140 @@ MHD_str_equal_caseless_n_ (const char *const str1,
 }
 
 
+#ifndef MHD_FAVOR_SMALL_CODE
+/**
+ * Convert all US-ASCII upper case letters in the 64-bit word to lower case.
+ * All eight bytes are converted independently, the byte order does not
+ * matter.
+ * @param w the word to convert
+ * @return the converted word
+ */
+_MHD_static_inline uint64_t
+mhd_word_tolower_ (uint64_t w)
+{
+  const uint64_t ones = UINT64_C (0x0101010101010101);
+  const uint64_t highs = UINT64_C (0x8080808080808080);
+  const uint64_t low7 = w & ~highs;
+  /* No carry to the next byte is possible: every byte of the sums is
+     not larger than 0xBE */
+  const uint64_t ge_a = low7 + ones * (uint8_t) (0x80 - 'A');
+  const uint64_t gt_z = low7 + ones * (uint8_t) (0x80 - 'Z' - 1);
+  /* The highest bit is set for the bytes in 'A'..'Z' range only */
+  const uint64_t upper = (ge_a ^ gt_z) & ~w & highs;
+  return w | (upper >> 2);
+}
+
+
+#if defined(MHD_STR_SCAN_SSE2_)
+/**
+ * Convert all US-ASCII upper case letters in the vector to lower case.
+ * @param v the vector to convert
+ * @return the converted vector
+ */
+_MHD_static_inline __m128i
+mhd_sse2_tolower_ (__m128i v)
+{
+  const __m128i t = _mm_sub_epi8 (v, _mm_set1_epi8 ('A'));
+  const __m128i lim = _mm_set1_epi8 ('Z' - 'A');
+  const __m128i is_upper = _mm_cmpeq_epi8 (_mm_min_epu8 (t, lim), t);
+  return _mm_or_si128 (v, _mm_and_si128 (is_upper, _mm_set1_epi8 (0x20)));
+}
+
+
+#elif defined(MHD_STR_SCAN_NEON_)
+/**
+ * Convert all US-ASCII upper case letters in the vector to lower case.
+ * @param v the vector to convert
+ * @return the converted vector
+ */
+_MHD_static_inline uint8x16_t
+mhd_neon_tolower_ (uint8x16_t v)
+{
+  const uint8x16_t t = vsubq_u8 (v, vdupq_n_u8 ('A'));
+  const uint8x16_t is_upper = vcleq_u8 (t, vdupq_n_u8 ('Z' - 'A'));
+  return vorrq_u8 (v, vandq_u8 (is_upper, vdupq_n_u8 (0x20)));
+}
+
+
+#endif /* MHD_STR_SCAN_NEON_ */
+#endif /* ! MHD_FAVOR_SMALL_CODE */
+
+
+/**
+ * Check two string for equality, ignoring case of US-ASCII letters and
+ * checking not more than @a len bytes.
+ * Inline version of #MHD_str_equal_caseless_bin_n_() for use in this file.
+ * @param str1 first string to compare
+ * @param str2 second string to compare
+ * @param len number of characters to compare
+ * @return non-zero if @a len bytes are equal, zero otherwise.
+ */
+_MHD_static_inline bool
+mhd_str_equal_caseless_bin_n_inl_ (const char *const str1,
+                                   const char *const str2,
+                                   size_t len)
+{
+  size_t i = 0;
+
+#ifndef MHD_FAVOR_SMALL_CODE
+#if defined(MHD_STR_SCAN_SSE2_)
+  for ( ; i + 16 <= len; i += 16)
+  {
+    const __m128i v1 =
+      _mm_loadu_si128 ((const __m128i *) (const void *) (str1 + i));
+    const __m128i v2 =
+      _mm_loadu_si128 ((const __m128i *) (const void *) (str2 + i));
+    const __m128i eq = _mm_cmpeq_epi8 (mhd_sse2_tolower_ (v1),
+                                       mhd_sse2_tolower_ (v2));
+    if (0xFFFF != _mm_movemask_epi8 (eq))
+      return 0;
+  }
+#elif defined(MHD_STR_SCAN_NEON_)
+  for ( ; i + 16 <= len; i += 16)
+  {
+    const uint8x16_t v1 = vld1q_u8 ((const uint8_t *) str1 + i);
+    const uint8x16_t v2 = vld1q_u8 ((const uint8_t *) str2 + i);
+    const uint8x16_t eq = vceqq_u8 (mhd_neon_tolower_ (v1),
+                                    mhd_neon_tolower_ (v2));
+    if (0xFF != vminvq_u8 (eq))
+      return 0;
+  }
+#endif /* MHD_STR_SCAN_NEON_ */
+  for ( ; i + 8 <= len; i += 8)
+  {
+    uint64_t w1;
+    uint64_t w2;
+    memcpy (&w1, str1 + i, sizeof(w1));
+    memcpy (&w2, str2 + i, sizeof(w2));
+    if ((w1 != w2) &&
+        (mhd_word_tolower_ (w1) != mhd_word_tolower_ (w2)))
+      return 0;
+  }
+  if (i + 4 <= len)
+  {
+    uint32_t w1;
+    uint32_t w2;
+    memcpy (&w1, str1 + i, sizeof(w1));
+    memcpy (&w2, str2 + i, sizeof(w2));
+    if ((w1 != w2) &&
+        (mhd_word_tolower_ (w1) != mhd_word_tolower_ (w2)))
+      return 0;
+    i += 4;
+  }
+#endif /* ! MHD_FAVOR_SMALL_CODE */
+  for ( ; i < len; ++i)
+  {
+    const char c1 = str1[i];
+    const char c2 = str2[i];
+    if (charsequalcaseless (c1, c2))
+      continue;
+    else
+      return 0;
+  }
+  return ! 0;
+}
+
+
 /**
  * Check two string for equality, ignoring case of US-ASCII letters and
  * checking not more than @a len bytes.
@@ -750,18 +910,184 @@ MHD_str_equal_caseless_bin_n_ (const char *const str1,
                                const char *const str2,
                                size_t len)
 {
+  return mhd_str_equal_caseless_bin_n_inl_ (str1, str2, len);
+}
+
+
+/**
+ * Calculate the hash of the string, ignoring case of US-ASCII letters.
+ * Strings equal by #MHD_str_equal_caseless_bin_n_() have equal hashes.
+ * Binary zero characters are processed as any other characters.
+ * @param str the string to hash
+ * @param len number of characters to hash
+ * @return the hash value
+ */
+uint32_t
+MHD_str_hash_caseless_bin_n_ (const char *str,
+                              size_t len)
+{
+  /* FNV-1a */
+  uint32_t hash = 2166136261U;
   size_t i;
 
   for (i = 0; i < len; ++i)
   {
-    const char c1 = str1[i];
-    const char c2 = str2[i];
-    if (charsequalcaseless (c1, c2))
-      continue;
-    else
-      return 0;
+    hash ^= (uint32_t) (uint8_t) toasciilower (str[i]);
+    hash *= 16777619U;
   }
-  return ! 0;
+  return hash;
+}
+
+
+#if defined(MHD_STR_SCAN_SSE2_)
+/**
+ * Get the number of trailing zero bits.
+ * @param v the value to check, must not be zero
+ * @return the number of trailing zero bits
+ */
+_MHD_static_inline unsigned int
+mhd_ctz32_ (uint32_t v)
+{
+#ifdef MHD_HAVE___BUILTIN_CTZ
+  return (unsigned int) __builtin_ctz (v);
+#else  /* ! MHD_HAVE___BUILTIN_CTZ */
+  unsigned int n = 0;
+  mhd_assert (0 != v);
+  while (0 == (v & 1))
+  {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif /* ! MHD_HAVE___BUILTIN_CTZ */
+}
+
+
+#endif /* MHD_STR_SCAN_SSE2_ */
+
+#if defined(MHD_STR_SCAN_NEON_) || defined(MHD_STR_SCAN_SWAR_)
+/**
+ * Get the number of trailing zero bits.
+ * @param v the value to check, must not be zero
+ * @return the number of trailing zero bits
+ */
+_MHD_static_inline unsigned int
+mhd_ctz64_ (uint64_t v)
+{
+#ifdef MHD_HAVE___BUILTIN_CTZLL
+  return (unsigned int) __builtin_ctzll (v);
+#else  /* ! MHD_HAVE___BUILTIN_CTZLL */
+  unsigned int n = 0;
+  mhd_assert (0 != v);
+  while (0 == (v & 1))
+  {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif /* ! MHD_HAVE___BUILTIN_CTZLL */
+}
+
+
+#endif /* MHD_STR_SCAN_NEON_ || MHD_STR_SCAN_SWAR_ */
+
+size_t
+MHD_str_find_delim_ (const char *str,
+                     size_t len,
+                     char delim)
+{
+  size_t i = 0;
+
+#ifdef MHD_STR_SCAN_AVX2_
+  if (32 <= len)
+  {
+    const __m256i lim = _mm256_set1_epi8 (0x20);
+    const __m256i dlm = _mm256_set1_epi8 (delim);
+    do
+    {
+      const __m256i v =
+        _mm256_loadu_si256 ((const __m256i *) (const void *) (str + i));
+      /* The unsigned value is not larger than 0x20 if the minimum is
+         the value itself */
+      const __m256i is_ctl = _mm256_cmpeq_epi8 (_mm256_min_epu8 (v, lim), v);
+      const __m256i is_dlm = _mm256_cmpeq_epi8 (v, dlm);
+      const uint32_t m =
+        (uint32_t) _mm256_movemask_epi8 (_mm256_or_si256 (is_ctl, is_dlm));
+      if (0 != m)
+        return i + mhd_ctz32_ (m);
+      i += 32;
+    } while (i + 32 <= len);
+  }
+#endif /* MHD_STR_SCAN_AVX2_ */
+#if defined(MHD_STR_SCAN_SSE2_)
+  if (i + 16 <= len)
+  {
+    const __m128i lim = _mm_set1_epi8 (0x20);
+    const __m128i dlm = _mm_set1_epi8 (delim);
+    do
+    {
+      const __m128i v =
+        _mm_loadu_si128 ((const __m128i *) (const void *) (str + i));
+      const __m128i is_ctl = _mm_cmpeq_epi8 (_mm_min_epu8 (v, lim), v);
+      const __m128i is_dlm = _mm_cmpeq_epi8 (v, dlm);
+      const uint32_t m =
+        (uint32_t) _mm_movemask_epi8 (_mm_or_si128 (is_ctl, is_dlm));
+      if (0 != m)
+        return i + mhd_ctz32_ (m);
+      i += 16;
+    } while (i + 16 <= len);
+  }
+#elif defined(MHD_STR_SCAN_NEON_)
+  if (i + 16 <= len)
+  {
+    const uint8x16_t lim = vdupq_n_u8 (0x20);
+    const uint8x16_t dlm = vdupq_n_u8 ((uint8_t) delim);
+    do
+    {
+      const uint8x16_t v = vld1q_u8 ((const uint8_t *) str + i);
+      const uint8x16_t m = vorrq_u8 (vcleq_u8 (v, lim), vceqq_u8 (v, dlm));
+      /* Narrow each byte of the mask to four bits */
+      const uint64_t bits =
+        vget_lane_u64 (vreinterpret_u64_u8 (vshrn_n_u16 ( \
+                                              vreinterpretq_u16_u8 (m), 4)),
+                       0);
+      if (0 != bits)
+        return i + (mhd_ctz64_ (bits) >> 2);
+      i += 16;
+    } while (i + 16 <= len);
+  }
+#endif /* MHD_STR_SCAN_NEON_ */
+#ifdef MHD_STR_SCAN_SWAR_
+  if (i + 8 <= len)
+  {
+    const uint64_t ones = UINT64_C (0x0101010101010101);
+    const uint64_t highs = UINT64_C (0x8080808080808080);
+    const uint64_t dlm = ones * (uint8_t) delim;
+    do
+    {
+      uint64_t w;
+      uint64_t x;
+      uint64_t m;
+      memcpy (&w, str + i, sizeof(w));
+      x = w ^ dlm;
+      /* The highest bit is set in the lowest byte that is smaller
+         than 0x21 (or equal to the delimiter). The bits in the higher
+         bytes could be wrong due to the borrow, but only the lowest
+         marked byte is used. */
+      m = ((w - ones * 0x21) & ~w & highs)
+          | ((x - ones) & ~x & highs);
+      if (0 != m)
+        return i + (mhd_ctz64_ (m) >> 3);
+      i += 8;
+    } while (i + 8 <= len);
+  }
+#endif /* MHD_STR_SCAN_SWAR_ */
+  for ( ; i < len; ++i)
+  {
+    if ((((unsigned char) str[i]) <= 0x20) || (delim == str[i]))
+      break;
+  }
+  return i;
 }
 
 
@@ -863,7 +1189,6 @@ MHD_str_remove_token_caseless_ (const char *str,
 {
   const char *s1; /**< the "input" string / character */
   char *s2;       /**< the "output" string / character */
-  size_t t_pos;   /**< position of matched character in the token */
   bool token_removed;
 
   mhd_assert (NULL == memchr (token, 0, token_len));
@@ -903,16 +1228,12 @@ MHD_str_remove_token_caseless_ (const char *str,
     cur_token = s1; /* the first char of input token */
 
     /* Check the token with case-insensetive match */
-    t_pos = 0;
-    while ( ((size_t) (s1 - str) < str_len) && (token_len > t_pos) &&
-            (charsequalcaseless (*s1, token[t_pos])) )
-    {
-      s1++;
-      t_pos++;
-    }
-    /* s1 may point just beyond the end of the input string */
-    if ( (token_len == t_pos) && (0 != token_len) )
+    if ( (0 != token_len) &&
+         (str_len - (size_t) (s1 - str) >= token_len) &&
+         mhd_str_equal_caseless_bin_n_inl_ (s1, token, token_len) )
     {
+      s1 += token_len;
+      /* s1 may point just beyond the end of the input string */
       /* 'token' matched, check that current input token does not have
        * any suffixes */
       while ( ((size_t) (s1 - str) < str_len) &&
@@ -1080,7 +1401,7 @@ MHD_str_remove_tokens_caseless_ (char *str,
 
     if (*str_len == tkn_len)
     {
-      if (MHD_str_equal_caseless_bin_n_ (str, tkn, tkn_len))
+      if (mhd_str_equal_caseless_bin_n_inl_ (str, tkn, tkn_len))
       {
         *str_len = 0;
         token_removed = true;
@@ -1107,7 +1428,7 @@ MHD_str_remove_tokens_caseless_ (char *str,
         mhd_assert (pr >= pw);
         mhd_assert ((*str_len) >= (pr + tkn_len));
         if ( ( ((*str_len) == (pr + tkn_len)) || (',' == str[pr + tkn_len]) ) &&
-             MHD_str_equal_caseless_bin_n_ (str + pr, tkn, tkn_len) )
+             mhd_str_equal_caseless_bin_n_inl_ (str + pr, tkn, tkn_len) )
         {
           /* current token in the input string matches the 'tkn', skip it */
           mhd_assert ((*str_len == pr + tkn_len) || \
@@ -1131,13 +1452,18 @@ MHD_str_remove_tokens_caseless_ (char *str,
             else
               pw += 2; /* 'str' is not yet modified in this round */
           }
-          do
+          if (1)
           {
+            const char *const next_comma =
+              (const char *) memchr (str + pr + 1, ',', *str_len - pr - 1);
+            const size_t copy_size =
+              ((NULL != next_comma) ? (size_t) (next_comma - str) : *str_len)
+              - pr;
             if (pr != pw)
-              str[pw] = str[pr];
-            pr++;
-            pw++;
-          } while (pr < *str_len && ',' != str[pr]);
+              memmove (str + pw, str + pr, copy_size);
+            pr += copy_size;
+            pw += copy_size;
+          }
           /* Advance to the next token in the input string or beyond
            * the end of the input string. */
           pr += 2;
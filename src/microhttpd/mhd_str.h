@@ -105,6 +105,39 @@ MHD_str_equal_caseless_bin_n_ (const char *const str1,
                                size_t len);
 
 
+/**
+ * Calculate the hash of the string, ignoring case of US-ASCII letters.
+ * Strings equal by #MHD_str_equal_caseless_bin_n_() have equal hashes.
+ * Binary zero characters are processed as any other characters.
+ * @param str the string to hash
+ * @param len number of characters to hash
+ * @return the hash value
+ */
+uint32_t
+MHD_str_hash_caseless_bin_n_ (const char *str,
+                              size_t len);
+
+
+/**
+ * Find the first delimiter character in the string.
+ * The delimiters are US-ASCII control characters (including NUL),
+ * the space character and the @a delim character.
+ * All other characters (including the characters with the highest bit set
+ * and DEL character) are skipped.
+ * Depending on the platform, several characters are checked at once.
+ * @param str the string to scan, does not need to be zero-terminated
+ * @param len the number of characters in the @a str
+ * @param delim the additional delimiter character, use NUL character
+ *              if no additional delimiter is needed
+ * @return the position of the first found delimiter,
+ *         @a len if no delimiters found
+ */
+size_t
+MHD_str_find_delim_ (const char *str,
+                     size_t len,
+                     char delim);
+
+
 /**
  * Check whether string is equal statically allocated another string,
  * ignoring case of US-ASCII letters and checking not more than @a len bytes.
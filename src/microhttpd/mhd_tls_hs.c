@@ -0,0 +1,289 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tls_hs.c
+ * @brief  Implementation of the pool of the TLS handshake threads
+ *
+ * The queued connections are kept in the FIFO list protected by the lock
+ * of the pool.  The idle threads wait for the ITC of the pool.  The thread
+ * that takes the connection from the list signals the ITC again if more
+ * connections are queued, so every queued connection wakes up one more
+ * thread.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_tls_hs.h"
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+#include "internal.h"
+#include "mhd_threads.h"
+#include "mhd_locks.h"
+#include "mhd_itc.h"
+#include "mhd_sockets.h"
+#include "mhd_compat.h"
+#include "mhd_assert.h"
+
+
+/**
+ * The pool of the TLS handshake threads
+ */
+struct MHD_TlsHsPool_
+{
+  /**
+   * The threads of the pool
+   */
+  MHD_thread_handle_ID_ *threads;
+
+  /**
+   * The number of the running threads
+   */
+  unsigned int num_threads;
+
+  /**
+   * The first queued connection, the next connection to process
+   */
+  struct MHD_Connection *queue_head;
+
+  /**
+   * The last queued connection
+   */
+  struct MHD_Connection *queue_tail;
+
+  /**
+   * Set to 'true' when the pool is stopping
+   */
+  bool stopped;
+
+  /**
+   * The lock for the queue and @e stopped
+   */
+  MHD_mutex_ lock;
+
+  /**
+   * The ITC to wake up the idle threads
+   */
+  struct MHD_itc_ itc;
+};
+
+
+/**
+ * Wait until the ITC of the pool is signalled.
+ * @param pool the pool to use
+ */
+static void
+tls_hs_wait (struct MHD_TlsHsPool_ *pool)
+{
+#ifdef HAVE_POLL
+  struct pollfd p[1];
+
+  p[0].fd = MHD_itc_r_fd_ (pool->itc);
+  p[0].events = POLLIN;
+  p[0].revents = 0;
+  /* Interrupted wait is not a problem, the queue is checked again */
+  (void) MHD_sys_poll_ (p,
+                        1,
+                        -1);
+#else  /* ! HAVE_POLL */
+  fd_set rs;
+
+  FD_ZERO (&rs);
+  if (! MHD_add_to_fd_set_ (MHD_itc_r_fd_ (pool->itc),
+                            &rs,
+                            NULL,
+                            FD_SETSIZE))
+    MHD_PANIC (_ ("Failed to add FD to fd_set.\n"));
+  (void) MHD_SYS_select_ (MHD_itc_r_fd_ (pool->itc) + 1,
+                          &rs,
+                          NULL,
+                          NULL,
+                          NULL);
+#endif /* ! HAVE_POLL */
+}
+
+
+/**
+ * The main function of the handshake thread.
+ * @param cls the pool
+ * @return always zero
+ */
+static MHD_THRD_RTRN_TYPE_ MHD_THRD_CALL_SPEC_
+tls_hs_thread (void *cls)
+{
+  struct MHD_TlsHsPool_ *const pool = (struct MHD_TlsHsPool_ *) cls;
+  struct MHD_Connection *c;
+  bool more;
+  bool stopped;
+
+  while (1)
+  {
+    MHD_mutex_lock_chk_ (&pool->lock);
+    c = pool->queue_head;
+    if (NULL != c)
+    {
+      pool->queue_head = c->tls_hs_next;
+      if (NULL == pool->queue_head)
+        pool->queue_tail = NULL;
+    }
+    more = (NULL != pool->queue_head);
+    stopped = pool->stopped;
+    MHD_mutex_unlock_chk_ (&pool->lock);
+
+    if ( more || ((NULL == c) && stopped) )
+    {
+      /* Wake up the next thread to take the next connection or
+         to notice the stop */
+      (void) MHD_itc_activate_ (pool->itc, "h");
+    }
+    if (NULL == c)
+    {
+      if (stopped)
+        break;
+      tls_hs_wait (pool);
+      MHD_itc_clear_ (pool->itc);
+      continue;
+    }
+    c->tls_hs_next = NULL;
+    c->tls_hs_ret = gnutls_handshake (c->tls_session);
+    /* The connection must not be used by this thread after resuming */
+    internal_resume_connection_ (c);
+  }
+  return (MHD_THRD_RTRN_TYPE_) 0;
+}
+
+
+struct MHD_TlsHsPool_ *
+MHD_tls_hs_pool_create_ (unsigned int num_threads,
+                         size_t stack_size)
+{
+  struct MHD_TlsHsPool_ *pool;
+
+  mhd_assert (0 != num_threads);
+  pool = (struct MHD_TlsHsPool_ *) MHD_calloc_ (1, sizeof(*pool));
+  if (NULL == pool)
+    return NULL;
+  pool->threads = (MHD_thread_handle_ID_ *)
+                  MHD_calloc_ (num_threads, sizeof(MHD_thread_handle_ID_));
+  if (NULL == pool->threads)
+  {
+    free (pool);
+    return NULL;
+  }
+  if (! MHD_mutex_init_ (&pool->lock))
+  {
+    free (pool->threads);
+    free (pool);
+    return NULL;
+  }
+  if (! MHD_itc_init_ (pool->itc))
+  {
+    MHD_mutex_destroy_chk_ (&pool->lock);
+    free (pool->threads);
+    free (pool);
+    return NULL;
+  }
+  for (pool->num_threads = 0; pool->num_threads < num_threads;
+       ++pool->num_threads)
+  {
+    if (! MHD_create_named_thread_ (pool->threads + pool->num_threads,
+                                    "MHD-tls-hs",
+                                    stack_size,
+                                    &tls_hs_thread,
+                                    pool))
+      break;
+  }
+  if (num_threads != pool->num_threads)
+  {
+    MHD_tls_hs_pool_destroy_ (pool);
+    return NULL;
+  }
+  return pool;
+}
+
+
+void
+MHD_tls_hs_pool_stop_ (struct MHD_TlsHsPool_ *pool)
+{
+  unsigned int i;
+
+  MHD_mutex_lock_chk_ (&pool->lock);
+  if (pool->stopped)
+  {
+    MHD_mutex_unlock_chk_ (&pool->lock);
+    return;
+  }
+  pool->stopped = true;
+  MHD_mutex_unlock_chk_ (&pool->lock);
+  (void) MHD_itc_activate_ (pool->itc, "s");
+  for (i = 0; i < pool->num_threads; ++i)
+  {
+    if (! MHD_thread_handle_ID_join_thread_ (pool->threads[i]))
+      MHD_PANIC (_ ("Failed to join a thread.\n"));
+  }
+  mhd_assert (NULL == pool->queue_head);
+  pool->num_threads = 0;
+}
+
+
+void
+MHD_tls_hs_pool_destroy_ (struct MHD_TlsHsPool_ *pool)
+{
+  MHD_tls_hs_pool_stop_ (pool);
+  MHD_itc_destroy_chk_ (pool->itc);
+  MHD_mutex_destroy_chk_ (&pool->lock);
+  free (pool->threads);
+  free (pool);
+}
+
+
+bool
+MHD_tls_hs_pool_submit_ (struct MHD_TlsHsPool_ *pool,
+                         struct MHD_Connection *connection)
+{
+  struct MHD_Daemon *const daemon = connection->daemon;
+  bool was_empty;
+
+  mhd_assert (! connection->tls_hs_offloaded);
+  mhd_assert (! connection->suspended);
+  mhd_assert (NULL == connection->tls_hs_next);
+  /* The lock is held while the connection is suspended, the pool thread
+     cannot take the connection before the suspending is completed */
+  MHD_mutex_lock_chk_ (&pool->lock);
+  if (pool->stopped)
+  {
+    /* The pool is stopped by the master daemon before the daemon
+       threads are stopped */
+    MHD_mutex_unlock_chk_ (&pool->lock);
+    return false;
+  }
+  connection->tls_hs_offloaded = true;
+  internal_suspend_connection_ (connection);
+  was_empty = (NULL == pool->queue_head);
+  if (was_empty)
+    pool->queue_head = connection;
+  else
+    pool->queue_tail->tls_hs_next = connection;
+  pool->queue_tail = connection;
+  MHD_mutex_unlock_chk_ (&pool->lock);
+  MHD_STATS_ADD_ (daemon, tls_hs_offloaded, 1);
+  if (was_empty)
+    (void) MHD_itc_activate_ (pool->itc, "q");
+  return true;
+}
@@ -0,0 +1,94 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tls_hs.h
+ * @brief  Header for the pool of the TLS handshake threads
+ *
+ * The daemon thread does not run the TLS handshake itself.  When
+ * the handshake of the connection can make progress, the connection is
+ * suspended and queued to the pool.  The pool thread performs one
+ * non-blocking step of the handshake (all crypto operations possible with
+ * the data available on the socket) and resumes the connection.  The result
+ * of the step is processed by the daemon thread, as if the step was
+ * performed by the daemon thread.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_TLS_HS_H
+#define MHD_TLS_HS_H 1
+
+#include "mhd_options.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+struct MHD_Connection;
+
+/**
+ * The pool of the TLS handshake threads
+ */
+struct MHD_TlsHsPool_;
+
+
+/**
+ * Create the pool and start the threads.
+ * @param num_threads the number of the threads, must not be zero
+ * @param stack_size the stack size of the threads, zero for the default
+ * @return the pointer to the new pool,
+ *         NULL if memory allocation or threads creation failed
+ */
+struct MHD_TlsHsPool_ *
+MHD_tls_hs_pool_create_ (unsigned int num_threads,
+                         size_t stack_size);
+
+
+/**
+ * Stop the threads of the pool.
+ * All queued connections are processed before the threads are stopped.
+ * The connections submitted after this call are not accepted.
+ * @param pool the pool to stop
+ */
+void
+MHD_tls_hs_pool_stop_ (struct MHD_TlsHsPool_ *pool);
+
+
+/**
+ * Destroy the pool.  The pool is stopped if it is not stopped yet.
+ * @param pool the pool to destroy
+ */
+void
+MHD_tls_hs_pool_destroy_ (struct MHD_TlsHsPool_ *pool);
+
+
+/**
+ * Suspend the connection and queue it for the handshake step.
+ * The connection is resumed when the step is performed.
+ * @remark To be called only from thread that process
+ * daemon's select()/poll()/etc.
+ * @param pool the pool to use
+ * @param connection the connection with the TLS handshake in progress
+ * @return 'true' if the connection has been queued,
+ *         'false' if the pool has been stopped, the handshake step must
+ *         be performed by the caller
+ */
+bool
+MHD_tls_hs_pool_submit_ (struct MHD_TlsHsPool_ *pool,
+                         struct MHD_Connection *connection);
+
+#endif /* ! MHD_TLS_HS_H */
@@ -0,0 +1,644 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tls_sess.c
+ * @brief  Implementation of the TLS session resumption support
+ *
+ * Every shard of the sessions cache has the hash table of the entries
+ * (with chaining) and the list of the entries in the order of storing,
+ * used to replace the oldest entry when the shard is full.
+ * The entries are allocated when stored, the key and the data of the
+ * session are placed in the same memory block after the entry header.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_tls_sess.h"
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+#include <string.h>
+#include "mhd_locks.h"
+#include "mhd_compat.h"
+#include "mhd_assert.h"
+#include "mhd_mono_clock.h"
+
+/**
+ * The number of shards of the cache, must be a power of two
+ */
+#define TLSSESS_NUM_SHARDS 16
+
+/**
+ * The maximum size of the session key (the session ID)
+ */
+#define TLSSESS_MAX_KEY_SIZE 256
+
+/**
+ * The maximum size of the session data.
+ * Larger sessions (with large client certificates) are not cached.
+ */
+#define TLSSESS_MAX_DATA_SIZE (16 * 1024)
+
+#if GNUTLS_VERSION_NUMBER + 0 >= 0x030604
+/**
+ * Defined if GnuTLS derives the ticket encryption keys from the master
+ * key, rotates the derived keys and accepts the tickets encrypted by
+ * the previous derived key.
+ * Replacing of the master key would invalidate all issued tickets at once,
+ * therefore the master key is not replaced by the daemon.
+ */
+#define MHD_TLS_TICKETS_GNUTLS_ROTATION_ 1
+#endif /* GNUTLS_VERSION_NUMBER >= 0x030604 */
+
+
+/**
+ * The session tickets keys
+ */
+struct MHD_TlsTickets_
+{
+  /**
+   * The current key
+   */
+  gnutls_datum_t key;
+
+  /**
+   * The lifetime of the tickets, in seconds
+   */
+  unsigned int lifetime_sec;
+
+#ifndef MHD_TLS_TICKETS_GNUTLS_ROTATION_
+  /**
+   * The time when the current key was generated, in milliseconds
+   */
+  uint64_t key_time;
+
+#ifdef MHD_USE_THREADS
+  /**
+   * The lock for the key rotation
+   */
+  MHD_mutex_ lock;
+#endif /* MHD_USE_THREADS */
+#endif /* ! MHD_TLS_TICKETS_GNUTLS_ROTATION_ */
+};
+
+
+/**
+ * Clear and free the key data.
+ * @param key the key to free
+ */
+static void
+tls_tickets_key_free (gnutls_datum_t *key)
+{
+  if (NULL == key->data)
+    return;
+#if GNUTLS_VERSION_NUMBER + 0 >= 0x030400
+  gnutls_memset (key->data, 0, key->size);
+#else  /* GNUTLS_VERSION_NUMBER < 0x030400 */
+  memset (key->data, 0, key->size);
+#endif /* GNUTLS_VERSION_NUMBER < 0x030400 */
+  gnutls_free (key->data);
+  key->data = NULL;
+  key->size = 0;
+}
+
+
+struct MHD_TlsTickets_ *
+MHD_tls_tickets_create_ (unsigned int lifetime_sec)
+{
+  struct MHD_TlsTickets_ *tk;
+
+  mhd_assert (0 != lifetime_sec);
+  tk = (struct MHD_TlsTickets_ *) MHD_calloc_ (1, sizeof(*tk));
+  if (NULL == tk)
+    return NULL;
+  if (GNUTLS_E_SUCCESS != gnutls_session_ticket_key_generate (&tk->key))
+  {
+    free (tk);
+    return NULL;
+  }
+#ifndef MHD_TLS_TICKETS_GNUTLS_ROTATION_
+#ifdef MHD_USE_THREADS
+  if (! MHD_mutex_init_ (&tk->lock))
+  {
+    tls_tickets_key_free (&tk->key);
+    free (tk);
+    return NULL;
+  }
+#endif /* MHD_USE_THREADS */
+  tk->key_time = MHD_monotonic_msec_counter ();
+#endif /* ! MHD_TLS_TICKETS_GNUTLS_ROTATION_ */
+  tk->lifetime_sec = lifetime_sec;
+  return tk;
+}
+
+
+void
+MHD_tls_tickets_destroy_ (struct MHD_TlsTickets_ *tk)
+{
+#if ! defined(MHD_TLS_TICKETS_GNUTLS_ROTATION_) && defined(MHD_USE_THREADS)
+  MHD_mutex_destroy_chk_ (&tk->lock);
+#endif /* ! MHD_TLS_TICKETS_GNUTLS_ROTATION_ && MHD_USE_THREADS */
+  tls_tickets_key_free (&tk->key);
+  free (tk);
+}
+
+
+bool
+MHD_tls_tickets_enable_ (struct MHD_TlsTickets_ *tk,
+                         gnutls_session_t session)
+{
+  int res;
+
+#ifdef MHD_TLS_TICKETS_GNUTLS_ROTATION_
+  /* The master key is never changed, the rotation of the derived keys
+     is based on the tickets lifetime set below */
+  res = gnutls_session_ticket_enable_server (session,
+                                             &tk->key);
+#else  /* ! MHD_TLS_TICKETS_GNUTLS_ROTATION_ */
+  const uint64_t now = MHD_monotonic_msec_counter ();
+
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&tk->lock);
+#endif /* MHD_USE_THREADS */
+  if (now - tk->key_time >= ((uint64_t) tk->lifetime_sec) * 1000)
+  {
+    gnutls_datum_t new_key;
+
+    /* If the new key cannot be generated, continue with the old key */
+    if (GNUTLS_E_SUCCESS == gnutls_session_ticket_key_generate (&new_key))
+    {
+      tls_tickets_key_free (&tk->key);
+      tk->key = new_key;
+      tk->key_time = now;
+    }
+  }
+  /* The key is copied to the session */
+  res = gnutls_session_ticket_enable_server (session,
+                                             &tk->key);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&tk->lock);
+#endif /* MHD_USE_THREADS */
+#endif /* ! MHD_TLS_TICKETS_GNUTLS_ROTATION_ */
+  if (GNUTLS_E_SUCCESS != res)
+    return false;
+  gnutls_db_set_cache_expiration (session,
+                                  (int) tk->lifetime_sec);
+  return true;
+}
+
+
+/**
+ * The cached session
+ */
+struct TlsSessEntry
+{
+  /**
+   * The next entry in the hash chain
+   */
+  struct TlsSessEntry *hnext;
+
+  /**
+   * The previous (older) entry in the shard
+   */
+  struct TlsSessEntry *prev;
+
+  /**
+   * The next (newer) entry in the shard
+   */
+  struct TlsSessEntry *next;
+
+  /**
+   * The hash of the key
+   */
+  uint64_t hash;
+
+  /**
+   * The size of the key, the key is placed right after the entry
+   */
+  size_t key_size;
+
+  /**
+   * The size of the data, the data is placed right after the key
+   */
+  size_t data_size;
+};
+
+/**
+ * Get the pointer to the key of the entry
+ */
+#define tls_sess_entry_key_(e) ((uint8_t *) ((e) + 1))
+
+/**
+ * Get the pointer to the data of the entry
+ */
+#define tls_sess_entry_data_(e) (tls_sess_entry_key_ (e) + (e)->key_size)
+
+
+/**
+ * The shard of the cache
+ */
+struct TlsSessShard
+{
+  /**
+   * The hash table of the entries
+   */
+  struct TlsSessEntry **buckets;
+
+  /**
+   * The oldest entry
+   */
+  struct TlsSessEntry *oldest;
+
+  /**
+   * The newest entry
+   */
+  struct TlsSessEntry *newest;
+
+  /**
+   * The number of the entries in the shard
+   */
+  size_t num_entries;
+
+#ifdef MHD_USE_THREADS
+  /**
+   * The lock of the shard
+   */
+  MHD_mutex_ lock;
+#endif /* MHD_USE_THREADS */
+};
+
+
+/**
+ * The cache of the TLS sessions
+ */
+struct MHD_TlsSessCache_
+{
+  /**
+   * The shards of the cache
+   */
+  struct TlsSessShard shards[TLSSESS_NUM_SHARDS];
+
+  /**
+   * The maximum number of the entries in one shard
+   */
+  size_t shard_max_entries;
+
+  /**
+   * The number of buckets in every shard minus one
+   */
+  size_t buckets_mask;
+
+  /**
+   * The random value for the hash function
+   */
+  uint64_t seed;
+};
+
+
+/**
+ * Calculate the hash of the session key.
+ * @param cache the cache to use
+ * @param key the session key
+ * @return the hash value
+ */
+static uint64_t
+tls_sess_hash (const struct MHD_TlsSessCache_ *cache,
+               const gnutls_datum_t *key)
+{
+  uint64_t h;
+  unsigned int i;
+
+  h = cache->seed ^ UINT64_C (0xCBF29CE484222325);
+  for (i = 0; i < key->size; ++i)
+  {
+    h ^= key->data[i];
+    h *= UINT64_C (0x100000001B3);
+  }
+  h ^= h >> 33;
+  h *= UINT64_C (0xFF51AFD7ED558CCD);
+  h ^= h >> 33;
+  return h;
+}
+
+
+/**
+ * Get the shard for the hash value.
+ * The high bits of the hash are used for the shard, the low bits are used
+ * for the bucket.
+ */
+#define tls_sess_get_shard_(cache,h) \
+  ((cache)->shards + (size_t) ((h) >> 60) % TLSSESS_NUM_SHARDS)
+
+
+/**
+ * Find the entry in the shard, the shard must be locked.
+ * @param cache the cache to use
+ * @param sh the shard to use
+ * @param h the hash of the @a key
+ * @param key the session key to find
+ * @param[out] pplace the pointer to the pointer to the found entry
+ *                    in the hash chain
+ * @return the found entry, NULL if not found
+ */
+static struct TlsSessEntry *
+tls_sess_find (const struct MHD_TlsSessCache_ *cache,
+               struct TlsSessShard *sh,
+               uint64_t h,
+               const gnutls_datum_t *key,
+               struct TlsSessEntry ***pplace)
+{
+  struct TlsSessEntry **place;
+  struct TlsSessEntry *e;
+
+  place = sh->buckets + ((size_t) h & cache->buckets_mask);
+  while (NULL != (e = *place))
+  {
+    if ( (h == e->hash) &&
+         (key->size == e->key_size) &&
+         (0 == memcmp (tls_sess_entry_key_ (e), key->data, key->size)) )
+      break;
+    place = &e->hnext;
+  }
+  *pplace = place;
+  return e;
+}
+
+
+/**
+ * Unlink the entry from the shard and free it, the shard must be locked.
+ * @param cache the cache to use
+ * @param sh the shard to use
+ * @param e the entry to remove
+ */
+static void
+tls_sess_remove_entry (const struct MHD_TlsSessCache_ *cache,
+                       struct TlsSessShard *sh,
+                       struct TlsSessEntry *e)
+{
+  struct TlsSessEntry **place;
+
+  place = sh->buckets + ((size_t) e->hash & cache->buckets_mask);
+  while (e != *place)
+  {
+    mhd_assert (NULL != *place);
+    place = &((*place)->hnext);
+  }
+  *place = e->hnext;
+  if (NULL == e->prev)
+    sh->oldest = e->next;
+  else
+    e->prev->next = e->next;
+  if (NULL == e->next)
+    sh->newest = e->prev;
+  else
+    e->next->prev = e->prev;
+  mhd_assert (0 != sh->num_entries);
+  sh->num_entries--;
+  memset (e, 0, sizeof(*e) + e->key_size + e->data_size);
+  free (e);
+}
+
+
+/**
+ * Store the session in the cache.
+ * The callback for GnuTLS, see gnutls_db_set_store_function().
+ * @param cls the cache
+ * @param key the session key
+ * @param data the session data
+ * @return zero on success, non-zero value on error
+ */
+static int
+tls_sess_store (void *cls,
+                gnutls_datum_t key,
+                gnutls_datum_t data)
+{
+  struct MHD_TlsSessCache_ *const cache = (struct MHD_TlsSessCache_ *) cls;
+  struct TlsSessShard *sh;
+  struct TlsSessEntry *e;
+  struct TlsSessEntry *old;
+  struct TlsSessEntry **place;
+  uint64_t h;
+
+  if ( (0 == key.size) || (TLSSESS_MAX_KEY_SIZE < key.size) ||
+       (0 == data.size) || (TLSSESS_MAX_DATA_SIZE < data.size) )
+    return -1;
+  e = (struct TlsSessEntry *) malloc (sizeof(*e) + key.size + data.size);
+  if (NULL == e)
+    return -1;
+  h = tls_sess_hash (cache, &key);
+  e->hash = h;
+  e->key_size = key.size;
+  e->data_size = data.size;
+  memcpy (tls_sess_entry_key_ (e), key.data, key.size);
+  memcpy (tls_sess_entry_data_ (e), data.data, data.size);
+
+  sh = tls_sess_get_shard_ (cache, h);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  old = tls_sess_find (cache, sh, h, &key, &place);
+  if (NULL != old)
+    tls_sess_remove_entry (cache, sh, old);
+  else if (cache->shard_max_entries <= sh->num_entries)
+    tls_sess_remove_entry (cache, sh, sh->oldest);
+  /* The chain could be changed by the removal */
+  e->hnext = sh->buckets[(size_t) h & cache->buckets_mask];
+  sh->buckets[(size_t) h & cache->buckets_mask] = e;
+  e->next = NULL;
+  e->prev = sh->newest;
+  if (NULL == sh->newest)
+    sh->oldest = e;
+  else
+    sh->newest->next = e;
+  sh->newest = e;
+  sh->num_entries++;
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  return 0;
+}
+
+
+/**
+ * Retrieve the session from the cache.
+ * The callback for GnuTLS, see gnutls_db_set_retrieve_function().
+ * @param cls the cache
+ * @param key the session key
+ * @return the copy of the session data allocated by gnutls_malloc(),
+ *         the empty datum if the session is not found
+ */
+static gnutls_datum_t
+tls_sess_retrieve (void *cls,
+                   gnutls_datum_t key)
+{
+  struct MHD_TlsSessCache_ *const cache = (struct MHD_TlsSessCache_ *) cls;
+  struct TlsSessShard *sh;
+  struct TlsSessEntry *e;
+  struct TlsSessEntry **place;
+  gnutls_datum_t res;
+  uint64_t h;
+
+  res.data = NULL;
+  res.size = 0;
+  if ( (0 == key.size) || (TLSSESS_MAX_KEY_SIZE < key.size) )
+    return res;
+  h = tls_sess_hash (cache, &key);
+  sh = tls_sess_get_shard_ (cache, h);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  e = tls_sess_find (cache, sh, h, &key, &place);
+  if (NULL != e)
+  {
+    res.data = (unsigned char *) gnutls_malloc (e->data_size);
+    if (NULL != res.data)
+    {
+      memcpy (res.data, tls_sess_entry_data_ (e), e->data_size);
+      res.size = (unsigned int) e->data_size;
+    }
+  }
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  return res;
+}
+
+
+/**
+ * Remove the session from the cache.
+ * The callback for GnuTLS, see gnutls_db_set_remove_function().
+ * @param cls the cache
+ * @param key the session key
+ * @return zero if the session has been removed, non-zero value otherwise
+ */
+static int
+tls_sess_remove (void *cls,
+                 gnutls_datum_t key)
+{
+  struct MHD_TlsSessCache_ *const cache = (struct MHD_TlsSessCache_ *) cls;
+  struct TlsSessShard *sh;
+  struct TlsSessEntry *e;
+  struct TlsSessEntry **place;
+  uint64_t h;
+
+  if ( (0 == key.size) || (TLSSESS_MAX_KEY_SIZE < key.size) )
+    return -1;
+  h = tls_sess_hash (cache, &key);
+  sh = tls_sess_get_shard_ (cache, h);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_lock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  e = tls_sess_find (cache, sh, h, &key, &place);
+  if (NULL != e)
+    tls_sess_remove_entry (cache, sh, e);
+#ifdef MHD_USE_THREADS
+  MHD_mutex_unlock_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+  return (NULL != e) ? 0 : -1;
+}
+
+
+struct MHD_TlsSessCache_ *
+MHD_tls_sess_cache_create_ (unsigned int max_entries,
+                            uint64_t seed)
+{
+  struct MHD_TlsSessCache_ *cache;
+  size_t shard_max;
+  size_t num_buckets;
+  unsigned int i;
+
+  mhd_assert (0 != max_entries);
+  shard_max = (max_entries + TLSSESS_NUM_SHARDS - 1) / TLSSESS_NUM_SHARDS;
+  /* On average not more than one entry per bucket */
+  num_buckets = 4;
+  while (num_buckets < shard_max)
+    num_buckets <<= 1;
+
+  cache = (struct MHD_TlsSessCache_ *) MHD_calloc_ (1, sizeof(*cache));
+  if (NULL == cache)
+    return NULL;
+  cache->shard_max_entries = shard_max;
+  cache->buckets_mask = num_buckets - 1;
+  cache->seed = seed;
+  for (i = 0; i < TLSSESS_NUM_SHARDS; ++i)
+  {
+    struct TlsSessShard *const sh = cache->shards + i;
+
+    sh->buckets = (struct TlsSessEntry **)
+                  MHD_calloc_ (num_buckets, sizeof(struct TlsSessEntry *));
+    if (NULL == sh->buckets)
+      break;
+#ifdef MHD_USE_THREADS
+    if (! MHD_mutex_init_ (&sh->lock))
+    {
+      free (sh->buckets);
+      break;
+    }
+#endif /* MHD_USE_THREADS */
+  }
+  if (TLSSESS_NUM_SHARDS != i)
+  {
+    while (0 != i)
+    {
+      struct TlsSessShard *const sh = cache->shards + (--i);
+#ifdef MHD_USE_THREADS
+      MHD_mutex_destroy_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+      free (sh->buckets);
+    }
+    free (cache);
+    return NULL;
+  }
+  return cache;
+}
+
+
+void
+MHD_tls_sess_cache_destroy_ (struct MHD_TlsSessCache_ *cache)
+{
+  unsigned int i;
+
+  for (i = 0; i < TLSSESS_NUM_SHARDS; ++i)
+  {
+    struct TlsSessShard *const sh = cache->shards + i;
+
+    while (NULL != sh->oldest)
+      tls_sess_remove_entry (cache, sh, sh->oldest);
+#ifdef MHD_USE_THREADS
+    MHD_mutex_destroy_chk_ (&sh->lock);
+#endif /* MHD_USE_THREADS */
+    free (sh->buckets);
+  }
+  free (cache);
+}
+
+
+void
+MHD_tls_sess_cache_attach_ (struct MHD_TlsSessCache_ *cache,
+                            gnutls_session_t session)
+{
+  gnutls_db_set_retrieve_function (session,
+                                   &tls_sess_retrieve);
+  gnutls_db_set_remove_function (session,
+                                 &tls_sess_remove);
+  gnutls_db_set_store_function (session,
+                                &tls_sess_store);
+  gnutls_db_set_ptr (session,
+                     cache);
+}
@@ -0,0 +1,128 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tls_sess.h
+ * @brief  Header for the TLS session resumption support: the session
+ *         tickets keys and the cache of the TLS sessions
+ *
+ * The master ticket key is generated by the daemon.  GnuTLS 3.6.4 and
+ * later derive the ticket encryption keys from the master key, rotate
+ * them with the period based on the tickets lifetime and accept
+ * the tickets encrypted by the previous derived key, so the master key is
+ * kept for the whole life of the daemon.  With older GnuTLS versions the
+ * key is used directly and the daemon replaces it with the new random key
+ * after the rotation period; the tickets encrypted by the previous key are
+ * not accepted after the replacement and the clients perform the full
+ * handshake in this case.
+ *
+ * The session cache is the hash table split into several shards, every
+ * shard has its own lock.  The cache is used by GnuTLS via
+ * gnutls_db_set_*() callbacks for the resumption by the session ID.
+ * When the shard is full, the oldest entry of the shard is replaced.
+ * Both objects are shared by all worker threads of the daemon.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_TLS_SESS_H
+#define MHD_TLS_SESS_H 1
+
+#include "mhd_options.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <gnutls/gnutls.h>
+
+/**
+ * The session tickets keys
+ */
+struct MHD_TlsTickets_;
+
+/**
+ * The cache of the TLS sessions
+ */
+struct MHD_TlsSessCache_;
+
+
+/**
+ * Create the session tickets keys and generate the first key.
+ * @param lifetime_sec the lifetime of the tickets and the rotation period
+ *                     of the key, in seconds, must not be zero
+ * @return the pointer to the new object,
+ *         NULL if memory allocation, lock initialisation or key generation
+ *         failed
+ */
+struct MHD_TlsTickets_ *
+MHD_tls_tickets_create_ (unsigned int lifetime_sec);
+
+
+/**
+ * Destroy the session tickets keys.
+ * The key data is cleared before freeing.
+ * @param tk the object to destroy
+ */
+void
+MHD_tls_tickets_destroy_ (struct MHD_TlsTickets_ *tk);
+
+
+/**
+ * Enable the session tickets for the new TLS session.
+ * With GnuTLS older than 3.6.4 the key is replaced if the rotation period
+ * has passed.
+ * Thread-safe.
+ * @param tk the tickets keys to use
+ * @param session the new server TLS session
+ * @return 'true' if succeed,
+ *         'false' if tickets cannot be enabled for the session
+ */
+bool
+MHD_tls_tickets_enable_ (struct MHD_TlsTickets_ *tk,
+                         gnutls_session_t session);
+
+
+/**
+ * Create the TLS sessions cache.
+ * @param max_entries the maximum number of the sessions in the cache,
+ *                    must not be zero
+ * @param seed the random value for the hash function
+ * @return the pointer to the new cache,
+ *         NULL if memory allocation or lock initialisation failed
+ */
+struct MHD_TlsSessCache_ *
+MHD_tls_sess_cache_create_ (unsigned int max_entries,
+                            uint64_t seed);
+
+
+/**
+ * Destroy the TLS sessions cache and all stored sessions.
+ * @param cache the cache to destroy
+ */
+void
+MHD_tls_sess_cache_destroy_ (struct MHD_TlsSessCache_ *cache);
+
+
+/**
+ * Set the cache as the sessions database for the new TLS session.
+ * @param cache the cache to use
+ * @param session the new server TLS session
+ */
+void
+MHD_tls_sess_cache_attach_ (struct MHD_TlsSessCache_ *cache,
+                            gnutls_session_t session);
+
+#endif /* ! MHD_TLS_SESS_H */
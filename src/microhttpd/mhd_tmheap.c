@@ -0,0 +1,160 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tmheap.c
+ * @brief  Implementation of the intrusive min-heap of the timeout deadlines
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_tmheap.h"
+#include "mhd_assert.h"
+
+
+/**
+ * Link two heaps together.
+ * @param a the root of the first heap, could be NULL
+ * @param b the root of the second heap, could be NULL
+ * @return the root of the resulting heap
+ */
+static struct MHD_TmHeapNode_ *
+tmheap_meld (struct MHD_TmHeapNode_ *a,
+             struct MHD_TmHeapNode_ *b)
+{
+  if (NULL == a)
+    return b;
+  if (NULL == b)
+    return a;
+  if (b->key < a->key)
+  {
+    struct MHD_TmHeapNode_ *const t = a;
+    a = b;
+    b = t;
+  }
+  /* 'b' becomes the first child of 'a' */
+  b->prev = a;
+  b->sibling = a->child;
+  if (NULL != a->child)
+    a->child->prev = b;
+  a->child = b;
+  a->sibling = NULL;
+  a->prev = NULL;
+  return a;
+}
+
+
+/**
+ * Combine the list of the siblings into a single heap by the standard
+ * two-pass pairing.
+ * @param first the first node in the list of the siblings, could be NULL
+ * @return the root of the resulting heap
+ */
+static struct MHD_TmHeapNode_ *
+tmheap_merge_pairs (struct MHD_TmHeapNode_ *first)
+{
+  struct MHD_TmHeapNode_ *pairs;
+  struct MHD_TmHeapNode_ *res;
+
+  /* The first pass: meld the nodes by pairs from left to right, the
+     results are linked in the reverse order by the 'sibling' pointers */
+  pairs = NULL;
+  while (NULL != first)
+  {
+    struct MHD_TmHeapNode_ *a = first;
+    struct MHD_TmHeapNode_ *const b = a->sibling;
+
+    if (NULL != b)
+    {
+      first = b->sibling;
+      b->sibling = NULL;
+      b->prev = NULL;
+    }
+    else
+      first = NULL;
+    a->sibling = NULL;
+    a->prev = NULL;
+    a = tmheap_meld (a, b);
+    a->sibling = pairs;
+    pairs = a;
+  }
+  /* The second pass: meld the results from right to left */
+  res = NULL;
+  while (NULL != pairs)
+  {
+    struct MHD_TmHeapNode_ *const next = pairs->sibling;
+
+    pairs->sibling = NULL;
+    res = tmheap_meld (res, pairs);
+    pairs = next;
+  }
+  return res;
+}
+
+
+void
+MHD_tmheap_insert_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node,
+                    uint64_t key)
+{
+  mhd_assert (! MHD_tmheap_is_in_ (heap, node));
+  node->child = NULL;
+  node->sibling = NULL;
+  node->prev = NULL;
+  node->key = key;
+  heap->root = tmheap_meld (heap->root, node);
+}
+
+
+void
+MHD_tmheap_remove_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node)
+{
+  struct MHD_TmHeapNode_ *sub;
+
+  mhd_assert (MHD_tmheap_is_in_ (heap, node));
+  sub = tmheap_merge_pairs (node->child);
+  if (heap->root == node)
+    heap->root = sub;
+  else
+  {
+    /* Detach the node from the list of the siblings */
+    if (node->prev->child == node)
+      node->prev->child = node->sibling;
+    else
+      node->prev->sibling = node->sibling;
+    if (NULL != node->sibling)
+      node->sibling->prev = node->prev;
+    heap->root = tmheap_meld (heap->root, sub);
+  }
+  node->child = NULL;
+  node->sibling = NULL;
+  node->prev = NULL;
+}
+
+
+void
+MHD_tmheap_update_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node,
+                    uint64_t key)
+{
+  if (key == node->key)
+    return;
+  MHD_tmheap_remove_ (heap, node);
+  MHD_tmheap_insert_ (heap, node, key);
+}
@@ -0,0 +1,145 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_tmheap.h
+ * @brief  Header for the intrusive min-heap of the timeout deadlines
+ *
+ * The heap is the pairing heap: insertion and getting of the earliest
+ * element are O(1), removal is O(log n) amortised.
+ * The nodes are embedded in the elements, no memory is allocated by
+ * the heap functions.
+ * The heap is not thread-safe, the caller must serialise the access.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_TMHEAP_H
+#define MHD_TMHEAP_H 1
+
+#include "mhd_options.h"
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef HAVE_STDDEF_H
+#include <stddef.h>
+#endif /* HAVE_STDDEF_H */
+
+/**
+ * The node of the heap, to be embedded in the element
+ */
+struct MHD_TmHeapNode_
+{
+  /**
+   * The first child of the node
+   */
+  struct MHD_TmHeapNode_ *child;
+
+  /**
+   * The next sibling of the node
+   */
+  struct MHD_TmHeapNode_ *sibling;
+
+  /**
+   * The previous sibling of the node or the parent if the node is
+   * the first child, NULL for the root node and for the nodes not
+   * in the heap
+   */
+  struct MHD_TmHeapNode_ *prev;
+
+  /**
+   * The key (the deadline) of the node
+   */
+  uint64_t key;
+};
+
+/**
+ * The heap
+ */
+struct MHD_TmHeap_
+{
+  /**
+   * The node with the smallest key, NULL if the heap is empty
+   */
+  struct MHD_TmHeapNode_ *root;
+};
+
+
+/**
+ * Get the node with the smallest key.
+ * @param heap the heap to use
+ * @return the node with the smallest key,
+ *         NULL if the heap is empty
+ */
+#define MHD_tmheap_first_(heap) ((heap)->root)
+
+
+/**
+ * Check whether the node is in the heap.
+ * @param heap the heap to check
+ * @param node the node to check, must be initialised by
+ *             #MHD_tmheap_node_init_() or inserted to the @a heap
+ * @return boolean 'true' if @a node is in the @a heap,
+ *         boolean 'false' otherwise
+ */
+#define MHD_tmheap_is_in_(heap,node) \
+  (((heap)->root == (node)) || (NULL != (node)->prev))
+
+
+/**
+ * Initialise the node not inserted in any heap.
+ * @param node the node to initialise
+ */
+#define MHD_tmheap_node_init_(node) \
+  do { (node)->child = NULL; (node)->sibling = NULL; \
+       (node)->prev = NULL; } while (0)
+
+
+/**
+ * Insert the node to the heap.
+ * @param heap the heap to use
+ * @param node the node to insert, must not be in any heap
+ * @param key the key for the @a node
+ */
+void
+MHD_tmheap_insert_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node,
+                    uint64_t key);
+
+
+/**
+ * Remove the node from the heap.
+ * @param heap the heap to use
+ * @param node the node to remove, must be in the @a heap
+ */
+void
+MHD_tmheap_remove_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node);
+
+
+/**
+ * Change the key of the node in the heap.
+ * @param heap the heap to use
+ * @param node the node to update, must be in the @a heap
+ * @param key the new key for the @a node
+ */
+void
+MHD_tmheap_update_ (struct MHD_TmHeap_ *heap,
+                    struct MHD_TmHeapNode_ *node,
+                    uint64_t key);
+
+#endif /* ! MHD_TMHEAP_H */
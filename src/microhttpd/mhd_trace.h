@@ -0,0 +1,102 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+/**
+ * @file microhttpd/mhd_trace.h
+ * @brief  Static tracing probes
+ *
+ * The probes are USDT (SystemTap/DTrace compatible) static tracepoints
+ * of the "libmicrohttpd" provider.  They are compiled in only if
+ * #MHD_USE_SDT_PROBES is defined (see "--enable-sdt-probes" configure
+ * parameter).  An inactive probe is a single "nop" instruction, but the
+ * probes do not use the semaphores, so the probe arguments are always
+ * evaluated, even when no tracer is attached.  Only the values already at
+ * hand (pointers, sizes, codes) must be used as the arguments, the values
+ * requiring any computation must not be passed to the probes.  Without
+ * #MHD_USE_SDT_PROBES the macros expand to nothing and the arguments are
+ * not evaluated.
+ *
+ * The probes (the first argument is always the pointer to
+ * the connection, except the probes of the daemon):
+ * + conn__accept (connection, socket_fd) - the new connection is accepted
+ *   for processing;
+ * + request__line (connection, method, url) - the request line is parsed;
+ * + headers__complete (connection, header_size) - the request header
+ *   is received and processed;
+ * + handler__invoke (connection, upload_size) - the access handler
+ *   callback is called, @a upload_size is the size of the upload data
+ *   provided to the callback;
+ * + response__queued (connection, status_code) - the response is queued
+ *   by the application;
+ * + send__data (connection, sent) - the data is sent by send();
+ * + send__writev (connection, sent) - the data is sent by writev() or
+ *   sendmsg();
+ * + send__sendfile (connection, sent) - the file data is sent by
+ *   sendfile();
+ * + send__splice (connection, sent) - the pipe data is sent by splice();
+ * + conn__close (connection, termination_code) - the connection is closed,
+ *   @a termination_code is the #MHD_RequestTerminationCode value;
+ * + conn__suspend (connection) - the connection is suspended;
+ * + conn__resume (connection) - the connection is resumed.
+ *
+ * Example for bpftrace:
+ * bpftrace -e 'usdt:/usr/lib/libmicrohttpd.so:libmicrohttpd:conn__close
+ *              { @[arg1] = count(); }'
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_TRACE_H
+#define MHD_TRACE_H 1
+
+#include "mhd_options.h"
+
+#ifdef MHD_USE_SDT_PROBES
+#include <sys/sdt.h>
+
+/**
+ * Fire the probe with one argument
+ * @param name the name of the probe
+ */
+#define MHD_TRACE1_(name,a1) \
+  DTRACE_PROBE1 (libmicrohttpd, name, a1)
+
+/**
+ * Fire the probe with two arguments
+ * @param name the name of the probe
+ */
+#define MHD_TRACE2_(name,a1,a2) \
+  DTRACE_PROBE2 (libmicrohttpd, name, a1, a2)
+
+/**
+ * Fire the probe with three arguments
+ * @param name the name of the probe
+ */
+#define MHD_TRACE3_(name,a1,a2,a3) \
+  DTRACE_PROBE3 (libmicrohttpd, name, a1, a2, a3)
+
+#else  /* ! MHD_USE_SDT_PROBES */
+
+#define MHD_TRACE1_(name,a1) ((void) 0)
+#define MHD_TRACE2_(name,a1,a2) ((void) 0)
+#define MHD_TRACE3_(name,a1,a2,a3) ((void) 0)
+
+#endif /* ! MHD_USE_SDT_PROBES */
+
+#endif /* ! MHD_TRACE_H */
@@ -0,0 +1,532 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_uring.c
+ * @brief  Implementation of the minimal io_uring wrapper
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_uring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include "mhd_atomic.h"
+
+#ifndef MHD_ATOMIC_GCC_BUILTINS_
+#error io_uring support requires GCC-compatible atomic builtins
+#endif /* ! MHD_ATOMIC_GCC_BUILTINS_ */
+
+/**
+ * The number of the operations in the probe buffer
+ */
+#define MHD_URING_PROBE_OPS_ 256
+
+
+static int
+uring_setup (unsigned int entries,
+             struct io_uring_params *p)
+{
+  return (int) syscall (SYS_io_uring_setup,
+                        entries,
+                        p);
+}
+
+
+static int
+uring_enter (int fd,
+             unsigned int to_submit,
+             unsigned int min_complete,
+             unsigned int flags,
+             const void *arg,
+             size_t argsz)
+{
+  return (int) syscall (SYS_io_uring_enter,
+                        fd,
+                        to_submit,
+                        min_complete,
+                        flags,
+                        arg,
+                        argsz);
+}
+
+
+static int
+uring_register (int fd,
+                unsigned int opcode,
+                void *arg,
+                unsigned int nr_args)
+{
+  return (int) syscall (SYS_io_uring_register,
+                        fd,
+                        opcode,
+                        arg,
+                        nr_args);
+}
+
+
+/**
+ * Check whether all required operations are supported by the ring.
+ * @param fd the ring FD
+ * @return 'true' if all operations are supported,
+ *         'false' otherwise
+ */
+static bool
+uring_probe_ops (int fd)
+{
+  static const uint8_t req_ops[] = {
+    IORING_OP_ACCEPT,
+    IORING_OP_RECV,
+    IORING_OP_SEND,
+    IORING_OP_POLL_ADD,
+    IORING_OP_PROVIDE_BUFFERS,
+    IORING_OP_ASYNC_CANCEL
+  };
+  struct io_uring_probe *probe;
+  const size_t probe_size = sizeof(struct io_uring_probe)
+                            + MHD_URING_PROBE_OPS_
+                            * sizeof(struct io_uring_probe_op);
+  bool ret;
+  size_t i;
+
+  probe = (struct io_uring_probe *) calloc (1, probe_size);
+  if (NULL == probe)
+    return false;
+  ret = (0 == uring_register (fd,
+                              IORING_REGISTER_PROBE,
+                              probe,
+                              MHD_URING_PROBE_OPS_));
+  for (i = 0; ret && (i < sizeof(req_ops) / sizeof(req_ops[0])); ++i)
+  {
+    if ((req_ops[i] > probe->last_op) ||
+        (0 == (probe->ops[req_ops[i]].flags & IO_URING_OP_SUPPORTED)))
+      ret = false;
+  }
+  free (probe);
+  return ret;
+}
+
+
+bool
+MHD_uring_is_supported_ (void)
+{
+  static const unsigned int req_features =
+    IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  struct io_uring_params p;
+  int fd;
+  bool ret;
+
+  memset (&p, 0, sizeof(p));
+  fd = uring_setup (4, &p);
+  if (0 > fd)
+    return false;
+  ret = (req_features == (p.features & req_features)) &&
+        uring_probe_ops (fd);
+  (void) close (fd);
+  return ret;
+}
+
+
+bool
+MHD_uring_init_ (struct MHD_Uring_ *ring,
+                 unsigned int entries,
+                 unsigned int cq_entries)
+{
+  /* The setup flags, from the most efficient to the most compatible.
+     The kernels before 5.18 reject IORING_SETUP_SUBMIT_ALL, without it
+     the submission stops at the first failed entry and the rest of
+     the entries are submitted by the next io_uring_enter() call. */
+  static const unsigned int setup_flags[] = {
+#ifdef IORING_SETUP_SUBMIT_ALL
+#ifdef IORING_SETUP_DEFER_TASKRUN
+    IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN
+    | IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL,
+#endif /* IORING_SETUP_DEFER_TASKRUN */
+#ifdef IORING_SETUP_COOP_TASKRUN
+    IORING_SETUP_COOP_TASKRUN | IORING_SETUP_CQSIZE
+    | IORING_SETUP_SUBMIT_ALL,
+#endif /* IORING_SETUP_COOP_TASKRUN */
+    IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL,
+#endif /* IORING_SETUP_SUBMIT_ALL */
+    IORING_SETUP_CQSIZE,
+    0
+  };
+  struct io_uring_params p;
+  char *sq_ptr;
+  char *cq_ptr;
+  unsigned int i;
+  int err;
+
+  memset (ring, 0, sizeof(*ring));
+  ring->fd = -1;
+  for (i = 0; i < sizeof(setup_flags) / sizeof(setup_flags[0]); ++i)
+  {
+    memset (&p, 0, sizeof(p));
+    p.flags = setup_flags[i];
+    p.cq_entries = cq_entries;
+    ring->fd = uring_setup (entries, &p);
+    if ((0 <= ring->fd) || (EINVAL != errno))
+      break;
+  }
+  if (0 > ring->fd)
+    return false;
+  ring->features = p.features;
+
+  ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+  ring->cq_ring_size = p.cq_off.cqes
+                       + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (0 != (p.features & IORING_FEAT_SINGLE_MMAP))
+  {
+    if (ring->cq_ring_size > ring->sq_ring_size)
+      ring->sq_ring_size = ring->cq_ring_size;
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+  ring->sq_ring = mmap (NULL, ring->sq_ring_size,
+                        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+  if (MAP_FAILED == ring->sq_ring)
+  {
+    ring->sq_ring = NULL;
+    err = errno;
+    MHD_uring_deinit_ (ring);
+    errno = err;
+    return false;
+  }
+  if (0 != (p.features & IORING_FEAT_SINGLE_MMAP))
+    ring->cq_ring = ring->sq_ring;
+  else
+  {
+    ring->cq_ring = mmap (NULL, ring->cq_ring_size,
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring->fd, IORING_OFF_CQ_RING);
+    if (MAP_FAILED == ring->cq_ring)
+    {
+      ring->cq_ring = NULL;
+      err = errno;
+      MHD_uring_deinit_ (ring);
+      errno = err;
+      return false;
+    }
+  }
+  ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = (struct io_uring_sqe *)
+               mmap (NULL, ring->sqes_size,
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring->fd, IORING_OFF_SQES);
+  if (MAP_FAILED == (void *) ring->sqes)
+  {
+    ring->sqes = NULL;
+    err = errno;
+    MHD_uring_deinit_ (ring);
+    errno = err;
+    return false;
+  }
+
+  sq_ptr = (char *) ring->sq_ring;
+  ring->sq_khead = (unsigned int *) (sq_ptr + p.sq_off.head);
+  ring->sq_ktail = (unsigned int *) (sq_ptr + p.sq_off.tail);
+  ring->sq_kflags = (unsigned int *) (sq_ptr + p.sq_off.flags);
+  ring->sq_array = (unsigned int *) (sq_ptr + p.sq_off.array);
+  ring->sq_mask = *((unsigned int *) (sq_ptr + p.sq_off.ring_mask));
+  ring->sq_entries = *((unsigned int *) (sq_ptr + p.sq_off.ring_entries));
+  ring->sqe_tail = *ring->sq_ktail;
+  /* Use the fixed mapping of the indirection array */
+  for (i = 0; i < ring->sq_entries; ++i)
+    ring->sq_array[i] = i;
+
+  cq_ptr = (char *) ring->cq_ring;
+  ring->cq_khead = (unsigned int *) (cq_ptr + p.cq_off.head);
+  ring->cq_ktail = (unsigned int *) (cq_ptr + p.cq_off.tail);
+  ring->cqes = (struct io_uring_cqe *) (cq_ptr + p.cq_off.cqes);
+  ring->cq_mask = *((unsigned int *) (cq_ptr + p.cq_off.ring_mask));
+
+  return true;
+}
+
+
+void
+MHD_uring_deinit_ (struct MHD_Uring_ *ring)
+{
+  if (NULL != ring->sqes)
+    (void) munmap (ring->sqes, ring->sqes_size);
+  if ((NULL != ring->cq_ring) && (ring->cq_ring != ring->sq_ring))
+    (void) munmap (ring->cq_ring, ring->cq_ring_size);
+  if (NULL != ring->sq_ring)
+    (void) munmap (ring->sq_ring, ring->sq_ring_size);
+  if (0 <= ring->fd)
+    (void) close (ring->fd);
+  if (NULL != ring->bufs)
+    free (ring->bufs);
+  memset (ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+
+/**
+ * Make the filled submission queue entries visible for the kernel.
+ * @param ring the ring to use
+ * @return the number of entries not yet consumed by the kernel
+ */
+static unsigned int
+uring_flush_sq (struct MHD_Uring_ *ring)
+{
+  mhd_atomic_u32_store_rel_ (ring->sq_ktail, ring->sqe_tail);
+  return ring->sqe_tail - mhd_atomic_u32_load_acq_ (ring->sq_khead);
+}
+
+
+struct io_uring_sqe *
+MHD_uring_get_sqe_ (struct MHD_Uring_ *ring)
+{
+  struct io_uring_sqe *sqe;
+
+  if (ring->sqe_tail - mhd_atomic_u32_load_acq_ (ring->sq_khead)
+      >= ring->sq_entries)
+  {
+    /* The queue is full, let the kernel consume the entries */
+    if (0 > uring_enter (ring->fd, uring_flush_sq (ring), 0, 0, NULL, 0))
+      return NULL;
+    if (ring->sqe_tail - mhd_atomic_u32_load_acq_ (ring->sq_khead)
+        >= ring->sq_entries)
+      return NULL;
+  }
+  sqe = ring->sqes + (ring->sqe_tail & ring->sq_mask);
+  ring->sqe_tail++;
+  memset (sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+
+int
+MHD_uring_submit_and_wait_ (struct MHD_Uring_ *ring,
+                            int32_t millisec)
+{
+  struct io_uring_getevents_arg arg;
+  struct __kernel_timespec ts;
+  unsigned int to_submit;
+  int res;
+
+  to_submit = uring_flush_sq (ring);
+  if (0 < millisec)
+  {
+    memset (&arg, 0, sizeof(arg));
+    ts.tv_sec = millisec / 1000;
+    ts.tv_nsec = (millisec % 1000) * 1000000;
+    arg.ts = (uint64_t) (uintptr_t) &ts;
+    res = uring_enter (ring->fd, to_submit, 1,
+                       IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                       &arg, sizeof(arg));
+  }
+  else
+    res = uring_enter (ring->fd, to_submit, (0 == millisec) ? 0 : 1,
+                       IORING_ENTER_GETEVENTS, NULL, 0);
+  if (0 > res)
+    return -errno;
+  return res;
+}
+
+
+struct io_uring_cqe *
+MHD_uring_peek_cqe_ (struct MHD_Uring_ *ring)
+{
+  const unsigned int head = *ring->cq_khead;
+
+  if (head == mhd_atomic_u32_load_acq_ (ring->cq_ktail))
+    return NULL;
+  return ring->cqes + (head & ring->cq_mask);
+}
+
+
+void
+MHD_uring_cqe_seen_ (struct MHD_Uring_ *ring)
+{
+  mhd_atomic_u32_store_rel_ (ring->cq_khead, *ring->cq_khead + 1);
+}
+
+
+/**
+ * Queue the request to provide the buffers to the kernel.
+ * @param ring the ring to use
+ * @param bid the ID of the first buffer
+ * @param num the number of buffers
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+static bool
+uring_provide_bufs (struct MHD_Uring_ *ring,
+                    unsigned int bid,
+                    unsigned int num)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = (int) num;
+  sqe->addr = (uint64_t) (uintptr_t) MHD_uring_buf_ (ring, bid);
+  sqe->len = (uint32_t) ring->buf_size;
+  sqe->off = bid;
+  sqe->buf_group = MHD_URING_BGID_;
+  sqe->user_data = 0;
+  return true;
+}
+
+
+bool
+MHD_uring_bufs_init_ (struct MHD_Uring_ *ring,
+                      unsigned int num,
+                      size_t size)
+{
+  ring->bufs = (char *) malloc (num * size);
+  if (NULL == ring->bufs)
+    return false;
+  ring->buf_num = num;
+  ring->buf_size = size;
+  if (uring_provide_bufs (ring, 0, num))
+    return true;
+  free (ring->bufs);
+  ring->bufs = NULL;
+  ring->buf_num = 0;
+  return false;
+}
+
+
+bool
+MHD_uring_buf_release_ (struct MHD_Uring_ *ring,
+                        unsigned int bid)
+{
+  return uring_provide_bufs (ring, bid, 1);
+}
+
+
+bool
+MHD_uring_prep_accept_ (struct MHD_Uring_ *ring,
+                        int fd,
+                        struct sockaddr *addr,
+                        socklen_t *addrlen,
+                        uint64_t user_data)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) (uintptr_t) addr;
+  sqe->addr2 = (uint64_t) (uintptr_t) addrlen;
+  sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  sqe->user_data = user_data;
+  return true;
+}
+
+
+bool
+MHD_uring_prep_recv_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      size_t size,
+                      uint64_t user_data)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+  if ((0 == size) || (ring->buf_size < size))
+    size = ring->buf_size;
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->len = (uint32_t) size;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = MHD_URING_BGID_;
+  sqe->user_data = user_data;
+  return true;
+}
+
+
+bool
+MHD_uring_prep_send_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      const void *buf,
+                      size_t size,
+                      int msg_flags,
+                      bool link,
+                      uint64_t user_data)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) (uintptr_t) buf;
+  sqe->len = (uint32_t) size;
+  sqe->msg_flags = (uint32_t) msg_flags;
+  if (link)
+    sqe->flags = IOSQE_IO_LINK;
+  sqe->user_data = user_data;
+  return true;
+}
+
+
+bool
+MHD_uring_prep_poll_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      unsigned int events,
+                      uint64_t user_data)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && \
+  (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  /* The kernel reads the 32-bit value as two 16-bit halves */
+  events = (events << 16) | (events >> 16);
+#endif /* __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ */
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->user_data = user_data;
+  return true;
+}
+
+
+bool
+MHD_uring_prep_cancel_ (struct MHD_Uring_ *ring,
+                        uint64_t user_data)
+{
+  struct io_uring_sqe *sqe;
+
+  sqe = MHD_uring_get_sqe_ (ring);
+  if (NULL == sqe)
+    return false;
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = user_data;
+  sqe->user_data = 0;
+  return true;
+}
@@ -0,0 +1,382 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/mhd_uring.h
+ * @brief  Header for the minimal io_uring wrapper
+ *
+ * The wrapper uses the kernel interface directly, no external library
+ * is required.  The ring must be used only by the thread that
+ * created it.
+ * The user data value zero is reserved for the internal requests
+ * (buffers providing, cancellation), the completions with zero user
+ * data must be ignored by the caller.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#ifndef MHD_URING_H
+#define MHD_URING_H 1
+
+#include "mhd_options.h"
+
+#ifdef IO_URING_SUPPORT
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+
+/**
+ * The buffer group ID used for the provided receive buffers
+ */
+#define MHD_URING_BGID_ 1
+
+/**
+ * The io_uring instance
+ */
+struct MHD_Uring_
+{
+  /**
+   * The ring FD, -1 if not initialised
+   */
+  int fd;
+
+  /**
+   * The features reported by the kernel
+   */
+  unsigned int features;
+
+  /**
+   * The kernel's head of the submission queue
+   */
+  unsigned int *sq_khead;
+
+  /**
+   * The kernel's tail of the submission queue
+   */
+  unsigned int *sq_ktail;
+
+  /**
+   * The flags of the submission queue
+   */
+  unsigned int *sq_kflags;
+
+  /**
+   * The indirection array of the submission queue
+   */
+  unsigned int *sq_array;
+
+  /**
+   * The array of the submission queue entries
+   */
+  struct io_uring_sqe *sqes;
+
+  /**
+   * The mask of the submission queue indices
+   */
+  unsigned int sq_mask;
+
+  /**
+   * The number of the entries in the submission queue
+   */
+  unsigned int sq_entries;
+
+  /**
+   * The local tail of the submission queue, the entries up to this
+   * position are filled, but may be not published yet
+   */
+  unsigned int sqe_tail;
+
+  /**
+   * The kernel's head of the completion queue
+   */
+  unsigned int *cq_khead;
+
+  /**
+   * The kernel's tail of the completion queue
+   */
+  unsigned int *cq_ktail;
+
+  /**
+   * The array of the completion queue entries
+   */
+  struct io_uring_cqe *cqes;
+
+  /**
+   * The mask of the completion queue indices
+   */
+  unsigned int cq_mask;
+
+  /**
+   * The mapped submission queue ring
+   */
+  void *sq_ring;
+
+  /**
+   * The size of @a sq_ring mapping
+   */
+  size_t sq_ring_size;
+
+  /**
+   * The mapped completion queue ring,
+   * could be the same as @a sq_ring
+   */
+  void *cq_ring;
+
+  /**
+   * The size of @a cq_ring mapping
+   */
+  size_t cq_ring_size;
+
+  /**
+   * The size of @a sqes mapping
+   */
+  size_t sqes_size;
+
+  /**
+   * The memory area of the provided receive buffers,
+   * NULL if buffers are not used
+   */
+  char *bufs;
+
+  /**
+   * The size of the single provided buffer
+   */
+  size_t buf_size;
+
+  /**
+   * The number of the provided buffers
+   */
+  unsigned int buf_num;
+};
+
+
+/**
+ * Check whether the running kernel supports all io_uring features and
+ * operations required by MHD.
+ * @return 'true' if io_uring can be used,
+ *         'false' otherwise
+ */
+bool
+MHD_uring_is_supported_ (void);
+
+
+/**
+ * Create the ring.
+ * @param ring the ring to initialise
+ * @param entries the number of the submission queue entries
+ * @param cq_entries the number of the completion queue entries
+ * @return 'true' on success,
+ *         'false' on failure, errno is set
+ */
+bool
+MHD_uring_init_ (struct MHD_Uring_ *ring,
+                 unsigned int entries,
+                 unsigned int cq_entries);
+
+
+/**
+ * Destroy the ring and free the provided buffers.
+ * All requests still in flight are cancelled by the kernel.
+ * @param ring the ring to destroy
+ */
+void
+MHD_uring_deinit_ (struct MHD_Uring_ *ring);
+
+
+/**
+ * Get the next free submission queue entry.
+ * If the queue is full, the queued entries are submitted to the kernel
+ * to free the space.
+ * @param ring the ring to use
+ * @return the pointer to the zeroed entry,
+ *         NULL if the queue cannot be flushed
+ */
+struct io_uring_sqe *
+MHD_uring_get_sqe_ (struct MHD_Uring_ *ring);
+
+
+/**
+ * Submit all queued entries and wait for at least one completion.
+ * @param ring the ring to use
+ * @param millisec the maximum time to wait for the completion,
+ *                 zero to not wait, negative value to wait
+ *                 indefinitely
+ * @return zero or positive value on success,
+ *         negative errno value on failure (-ETIME and -EINTR are
+ *         not errors)
+ */
+int
+MHD_uring_submit_and_wait_ (struct MHD_Uring_ *ring,
+                            int32_t millisec);
+
+
+/**
+ * Get the next available completion queue entry.
+ * The entry must be released by #MHD_uring_cqe_seen_().
+ * @param ring the ring to use
+ * @return the pointer to the entry,
+ *         NULL if no completions are available
+ */
+struct io_uring_cqe *
+MHD_uring_peek_cqe_ (struct MHD_Uring_ *ring);
+
+
+/**
+ * Release the completion queue entry returned by #MHD_uring_peek_cqe_().
+ * @param ring the ring to use
+ */
+void
+MHD_uring_cqe_seen_ (struct MHD_Uring_ *ring);
+
+
+/**
+ * Allocate the receive buffers and provide them to the kernel.
+ * @param ring the ring to use
+ * @param num the number of buffers
+ * @param size the size of the single buffer
+ * @return 'true' on success,
+ *         'false' on failure
+ */
+bool
+MHD_uring_bufs_init_ (struct MHD_Uring_ *ring,
+                      unsigned int num,
+                      size_t size);
+
+
+/**
+ * Get the pointer to the provided buffer.
+ * @param ring the ring to use
+ * @param bid the buffer ID reported by the completion
+ * @return the pointer to the buffer data
+ */
+#define MHD_uring_buf_(ring,bid) \
+  ((ring)->bufs + ((size_t) (bid)) * (ring)->buf_size)
+
+
+/**
+ * Return the buffer consumed by the completion back to the kernel.
+ * @param ring the ring to use
+ * @param bid the buffer ID reported by the completion
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_buf_release_ (struct MHD_Uring_ *ring,
+                        unsigned int bid);
+
+
+/**
+ * Queue single-shot accept request.
+ * The accepted sockets are in non-blocking and non-inheritable mode.
+ * The kernel writes the address of the client to @a addr before the
+ * completion is posted, the memory must be kept until the completion.
+ * @param ring the ring to use
+ * @param fd the listen socket
+ * @param addr the buffer for the address of the client
+ * @param addrlen the size of @a addr, updated by the kernel with
+ *                the actual size of the address
+ * @param user_data the user data for the completion
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_prep_accept_ (struct MHD_Uring_ *ring,
+                        int fd,
+                        struct sockaddr *addr,
+                        socklen_t *addrlen,
+                        uint64_t user_data);
+
+
+/**
+ * Queue receive request using the provided buffers.
+ * The request waits for the data in the kernel, the completion has
+ * the buffer ID if any data has been received.
+ * @param ring the ring to use
+ * @param fd the socket to receive from
+ * @param size the maximum size to receive, zero for the full buffer
+ * @param user_data the user data for the completion
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_prep_recv_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      size_t size,
+                      uint64_t user_data);
+
+
+/**
+ * Queue send request.
+ * The kernel reads the data when the request is executed, the memory
+ * must be kept until the completion.
+ * @param ring the ring to use
+ * @param fd the socket to send to
+ * @param buf the data to send
+ * @param size the size of the data
+ * @param msg_flags the send() flags
+ * @param link if 'true' then the next queued request is started only
+ *             after the full data is sent, otherwise the next request
+ *             is cancelled
+ * @param user_data the user data for the completion
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_prep_send_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      const void *buf,
+                      size_t size,
+                      int msg_flags,
+                      bool link,
+                      uint64_t user_data);
+
+
+/**
+ * Queue single-shot poll request.
+ * @param ring the ring to use
+ * @param fd the FD to poll
+ * @param events the poll() events to wait for
+ * @param user_data the user data for the completion
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_prep_poll_ (struct MHD_Uring_ *ring,
+                      int fd,
+                      unsigned int events,
+                      uint64_t user_data);
+
+
+/**
+ * Queue cancellation of the request.
+ * The completion of the cancellation request itself has zero user data.
+ * @param ring the ring to use
+ * @param user_data the user data of the request to cancel
+ * @return 'true' on success,
+ *         'false' if no submission entry is available
+ */
+bool
+MHD_uring_prep_cancel_ (struct MHD_Uring_ *ring,
+                        uint64_t user_data);
+
+#endif /* IO_URING_SUPPORT */
+
+#endif /* ! MHD_URING_H */
@@ -31,6 +31,9 @@
 #ifdef HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif /* HAVE_SYS_IOCTL_H */
+#ifdef HAVE_POSIX_FADVISE
+#include <fcntl.h>
+#endif /* HAVE_POSIX_FADVISE */
 #if defined(_WIN32) && ! defined(__CYGWIN__)
 #include <windows.h>
 #endif /* _WIN32 && !__CYGWIN__ */
@@ -71,6 +74,14 @@
 #endif /* _WIN32 */
 #endif /* !MHD_FD_BLOCK_SIZE */
 
+#ifdef HAVE_POSIX_FADVISE
+/**
+ * The size of the beginning of the file-backed response requested to be
+ * read ahead when the response is created.
+ */
+#define MHD_FILE_WILLNEED_SIZE 0x200000 /* 2M */
+#endif /* HAVE_POSIX_FADVISE */
+
 /**
  * Insert a new header at the first position of the response
  */
@@ -1310,6 +1321,26 @@ MHD_create_response_from_fd_at_offset64 (uint64_t size,
   response->is_pipe = false;
   response->fd_off = offset;
   response->crc_cls = response;
+#ifdef HAVE_POSIX_FADVISE
+  if ( (0 != size) &&
+       ( (sizeof(off_t) >= sizeof(uint64_t)) ||
+         ((size + offset) <= (uint64_t) INT32_MAX) ) )
+  {
+    /* The file is read sequentially by sendfile() or by the file reader.
+       Let the kernel read ahead more aggressively and start reading of
+       the beginning of the file, so the first sends are not blocked by
+       the disk reads.  The hints are advisory, the errors are ignored. */
+    (void) posix_fadvise (fd,
+                          (off_t) offset,
+                          (off_t) size,
+                          POSIX_FADV_SEQUENTIAL);
+    (void) posix_fadvise (fd,
+                          (off_t) offset,
+                          (off_t) ((MHD_FILE_WILLNEED_SIZE < size) ?
+                                   MHD_FILE_WILLNEED_SIZE : size),
+                          POSIX_FADV_WILLNEED);
+  }
+#endif /* HAVE_POSIX_FADVISE */
   return response;
 }
 
@@ -215,6 +215,7 @@ add_AuthHeader (const char *hdr, size_t hdr_len)
     req_header.value = hdr;
     req_header.value_size = hdr_len;
     req_header.kind = MHD_HEADER_KIND;
+    req_header.hdr_id = MHD_HEADER_ID_AUTHORIZATION;
     req_header.prev = NULL;
     req_header.next = NULL;
     conn.rq.headers_received = &req_header;
@@ -1559,18 +1560,21 @@ check_two_auths (void)
   h1.kind = MHD_HEADER_KIND;
   h1.header = MHD_HTTP_HEADER_HOST; /* Just some random header */
   h1.header_size = MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_HOST);
+  h1.hdr_id = MHD_HEADER_ID_HOST;
   h1.value = "localhost";
   h1.value_size = strlen (h1.value);
 
   h2.kind = MHD_HEADER_KIND;
   h2.header = MHD_HTTP_HEADER_AUTHORIZATION;
   h2.header_size = MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_AUTHORIZATION);
+  h2.hdr_id = MHD_HEADER_ID_AUTHORIZATION;
   h2.value = "Basic " TEST_AUTH_STR;
   h2.value_size = strlen (h2.value);
 
   h3.kind = MHD_HEADER_KIND;
   h3.header = MHD_HTTP_HEADER_AUTHORIZATION;
   h3.header_size = MHD_STATICSTR_LEN_ (MHD_HTTP_HEADER_AUTHORIZATION);
+  h3.hdr_id = MHD_HEADER_ID_AUTHORIZATION;
   h3.value = "Digest cnonce=" TEST_AUTH_STR;
   h3.value_size = strlen (h3.value);
 
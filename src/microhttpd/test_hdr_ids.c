@@ -0,0 +1,257 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This test tool is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2, or
+  (at your option) any later version.
+
+  This test tool is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/test_hdr_ids.c
+ * @brief  Unit tests for the identifiers of the well-known headers
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <string.h>
+#include "mhd_hdr_ids.h"
+#include "mhd_str.h"
+
+
+struct hdr_id_check
+{
+  const char *name;
+  enum MHD_HeaderId id;
+};
+
+#define HDR_ID_CHECK(n) { MHD_HTTP_HEADER_ ## n, MHD_HEADER_ID_ ## n }
+
+static const struct hdr_id_check known_hdrs[] = {
+  HDR_ID_CHECK (ACCEPT),
+  HDR_ID_CHECK (ACCEPT_CHARSET),
+  HDR_ID_CHECK (ACCEPT_ENCODING),
+  HDR_ID_CHECK (ACCEPT_LANGUAGE),
+  HDR_ID_CHECK (ACCESS_CONTROL_REQUEST_HEADERS),
+  HDR_ID_CHECK (ACCESS_CONTROL_REQUEST_METHOD),
+  HDR_ID_CHECK (AUTHORIZATION),
+  HDR_ID_CHECK (CACHE_CONTROL),
+  HDR_ID_CHECK (CONNECTION),
+  HDR_ID_CHECK (CONTENT_ENCODING),
+  HDR_ID_CHECK (CONTENT_LENGTH),
+  HDR_ID_CHECK (CONTENT_TYPE),
+  HDR_ID_CHECK (COOKIE),
+  HDR_ID_CHECK (DATE),
+  HDR_ID_CHECK (EXPECT),
+  HDR_ID_CHECK (FORWARDED),
+  HDR_ID_CHECK (FROM),
+  HDR_ID_CHECK (HOST),
+  HDR_ID_CHECK (IF_MATCH),
+  HDR_ID_CHECK (IF_MODIFIED_SINCE),
+  HDR_ID_CHECK (IF_NONE_MATCH),
+  HDR_ID_CHECK (IF_RANGE),
+  HDR_ID_CHECK (IF_UNMODIFIED_SINCE),
+  HDR_ID_CHECK (KEEP_ALIVE),
+  HDR_ID_CHECK (MAX_FORWARDS),
+  HDR_ID_CHECK (ORIGIN),
+  HDR_ID_CHECK (PRAGMA),
+  HDR_ID_CHECK (PRIORITY),
+  HDR_ID_CHECK (PROXY_AUTHORIZATION),
+  HDR_ID_CHECK (RANGE),
+  HDR_ID_CHECK (REFERER),
+  HDR_ID_CHECK (SEC_WEBSOCKET_EXTENSIONS),
+  HDR_ID_CHECK (SEC_WEBSOCKET_KEY),
+  HDR_ID_CHECK (SEC_WEBSOCKET_PROTOCOL),
+  HDR_ID_CHECK (SEC_WEBSOCKET_VERSION),
+  HDR_ID_CHECK (TE),
+  HDR_ID_CHECK (TRAILER),
+  HDR_ID_CHECK (TRANSFER_ENCODING),
+  HDR_ID_CHECK (UPGRADE),
+  HDR_ID_CHECK (USER_AGENT),
+  HDR_ID_CHECK (VIA)
+};
+
+
+static const char *const unknown_hdrs[] = {
+  "",
+  "T",
+  "X",
+  "Hos",
+  "Hosts",
+  "Host:",
+  "Xost",
+  "Hosx",
+  "Tf",
+  "Dat",
+  "Dote",
+  "Content-Lengti",
+  "Content-Lenght",
+  "Content_Length",
+  "Content-Location",
+  "Accept-Ranges",
+  "Access-Control-Request-Headerz",
+  "Access-Control-Request-Headers-",
+  "X-Forwarded-For",
+  "WWW-Authenticate",
+  "Sec-WebSocket-Accept",
+  "Zzzzzz",
+  "1ost",
+  "Hos1"
+};
+
+
+/**
+ * Convert the string to the mixed case: odd letters to upper case and
+ * even letters to lower case.
+ */
+static void
+to_mixed_case (char *str)
+{
+  size_t i;
+  for (i = 0; 0 != str[i]; ++i)
+  {
+    if ((str[i] >= 'a') && (str[i] <= 'z') && (0 == (i % 2)))
+      str[i] = (char) (str[i] - 'a' + 'A');
+    else if ((str[i] >= 'A') && (str[i] <= 'Z') && (0 != (i % 2)))
+      str[i] = (char) (str[i] - 'A' + 'a');
+  }
+}
+
+
+static int
+check_known (void)
+{
+  int errcount = 0;
+  size_t i;
+
+  for (i = 0; i < sizeof(known_hdrs) / sizeof(known_hdrs[0]); ++i)
+  {
+    char buf[64];
+    const size_t len = strlen (known_hdrs[i].name);
+    enum MHD_HeaderId id;
+
+    if ((MHD_HEADER_ID_UNKNOWN + 1 + i) != (size_t) known_hdrs[i].id)
+    {
+      fprintf (stderr, "The identifiers of the headers are not sequential: "
+               "'%s' has ID %u.\n", known_hdrs[i].name,
+               (unsigned int) known_hdrs[i].id);
+      errcount++;
+    }
+    id = MHD_get_header_id_ (known_hdrs[i].name, len);
+    if (known_hdrs[i].id != id)
+    {
+      fprintf (stderr, "MHD_get_header_id_(\"%s\", %u) FAILED: "
+               "returned %u, expected %u.\n", known_hdrs[i].name,
+               (unsigned int) len, (unsigned int) id,
+               (unsigned int) known_hdrs[i].id);
+      errcount++;
+    }
+    memcpy (buf, known_hdrs[i].name, len + 1);
+    to_mixed_case (buf);
+    id = MHD_get_header_id_ (buf, len);
+    if (known_hdrs[i].id != id)
+    {
+      fprintf (stderr, "MHD_get_header_id_(\"%s\", %u) FAILED: "
+               "returned %u, expected %u.\n", buf,
+               (unsigned int) len, (unsigned int) id,
+               (unsigned int) known_hdrs[i].id);
+      errcount++;
+    }
+    /* The name is not required to be zero-terminated */
+    memcpy (buf, known_hdrs[i].name, len);
+    buf[len] = 'x';
+    buf[len + 1] = 0;
+    id = MHD_get_header_id_ (buf, len);
+    if (known_hdrs[i].id != id)
+    {
+      fprintf (stderr, "MHD_get_header_id_(\"%s\", %u) FAILED: "
+               "returned %u, expected %u.\n", buf,
+               (unsigned int) len, (unsigned int) id,
+               (unsigned int) known_hdrs[i].id);
+      errcount++;
+    }
+    /* Prefix of the name */
+    id = MHD_get_header_id_ (known_hdrs[i].name, len - 1);
+    if (MHD_HEADER_ID_UNKNOWN != id)
+    {
+      fprintf (stderr, "MHD_get_header_id_(\"%s\", %u) FAILED: "
+               "returned %u, expected %u.\n", known_hdrs[i].name,
+               (unsigned int) (len - 1), (unsigned int) id,
+               (unsigned int) MHD_HEADER_ID_UNKNOWN);
+      errcount++;
+    }
+    if (1)
+    {
+      size_t name_len = 0;
+      const char *name = MHD_get_header_name_ (known_hdrs[i].id, &name_len);
+      if ((NULL == name) || (len != name_len) ||
+          (0 != memcmp (name, known_hdrs[i].name, len)))
+      {
+        fprintf (stderr, "MHD_get_header_name_(%u) FAILED: "
+                 "returned \"%s\", expected \"%s\".\n",
+                 (unsigned int) known_hdrs[i].id,
+                 (NULL != name) ? name : "(NULL)", known_hdrs[i].name);
+        errcount++;
+      }
+    }
+  }
+  return errcount;
+}
+
+
+static int
+check_unknown (void)
+{
+  int errcount = 0;
+  size_t i;
+
+  for (i = 0; i < sizeof(unknown_hdrs) / sizeof(unknown_hdrs[0]); ++i)
+  {
+    const enum MHD_HeaderId id =
+      MHD_get_header_id_ (unknown_hdrs[i], strlen (unknown_hdrs[i]));
+    if (MHD_HEADER_ID_UNKNOWN != id)
+    {
+      fprintf (stderr, "MHD_get_header_id_(\"%s\", %u) FAILED: "
+               "returned %u, expected %u.\n", unknown_hdrs[i],
+               (unsigned int) strlen (unknown_hdrs[i]), (unsigned int) id,
+               (unsigned int) MHD_HEADER_ID_UNKNOWN);
+      errcount++;
+    }
+  }
+  if (1)
+  {
+    size_t name_len = 0;
+    if ((NULL != MHD_get_header_name_ (MHD_HEADER_ID_UNKNOWN, &name_len)) ||
+        (NULL != MHD_get_header_name_ ((enum MHD_HeaderId) (MHD_HEADER_ID_VIA
+                                                            + 1),
+                                       &name_len)))
+    {
+      fprintf (stderr, "MHD_get_header_name_() FAILED: "
+               "returned the name for the invalid identifier.\n");
+      errcount++;
+    }
+  }
+  return errcount;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int errcount = 0;
+  (void) argc; (void) argv; /* Unused. Silent compiler warning. */
+  errcount += check_known ();
+  errcount += check_unknown ();
+  return errcount == 0 ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This test tool is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2, or
+  (at your option) any later version.
+
+  This test tool is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/test_iplimit.c
+ * @brief  Unit tests for the table of the number of connections per IP
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <string.h>
+#include "mhd_iplimit.h"
+#ifdef MHD_USE_POSIX_THREADS
+#include <pthread.h>
+#endif /* MHD_USE_POSIX_THREADS */
+
+#define MAX_CONNS 256
+
+#define NUM_THREADS 4
+
+#define THREAD_ITERATIONS 20000
+
+
+/**
+ * Make the key for the IPv4 address 127.x.y.z
+ * @param key the key to initialise
+ * @param num the number used for the lower 24 bits of the address
+ */
+static void
+make_key (struct MHD_IPLimitKey_ *key,
+          uint32_t num)
+{
+  uint8_t *const addr = (uint8_t *) &key->addr.ipv4;
+
+  memset (key, 0, sizeof(*key));
+  key->family = AF_INET;
+  addr[0] = 127;
+  addr[1] = (uint8_t) (num >> 16);
+  addr[2] = (uint8_t) (num >> 8);
+  addr[3] = (uint8_t) num;
+}
+
+
+static int
+check_limit (void)
+{
+  struct MHD_IPLimitTable_ *tbl;
+  struct MHD_IPLimitKey_ key1;
+  struct MHD_IPLimitKey_ key2;
+  int errcount = 0;
+  unsigned int i;
+
+  tbl = MHD_iplimit_create_ (MAX_CONNS, 0);
+  if (NULL == tbl)
+  {
+    fprintf (stderr, "Failed to create the table.\n");
+    return 1;
+  }
+  make_key (&key1, 1);
+  make_key (&key2, 2);
+  if (MHD_iplimit_del_ (tbl, &key1))
+  {
+    fprintf (stderr, "Removed the address not in the table.\n");
+    errcount++;
+  }
+  for (i = 0; i < 3; ++i)
+  {
+    if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key1, 3))
+    {
+      fprintf (stderr, "Failed to add the connection %u.\n", i);
+      errcount++;
+    }
+  }
+  if (MHD_IPLIMIT_OVER_LIMIT_ != MHD_iplimit_add_ (tbl, &key1, 3))
+  {
+    fprintf (stderr, "The limit has not been detected.\n");
+    errcount++;
+  }
+  if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key2, 3))
+  {
+    fprintf (stderr, "Failed to add the other address.\n");
+    errcount++;
+  }
+  if (! MHD_iplimit_del_ (tbl, &key1))
+  {
+    fprintf (stderr, "Failed to remove the connection.\n");
+    errcount++;
+  }
+  if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key1, 3))
+  {
+    fprintf (stderr, "Failed to add the connection after removal.\n");
+    errcount++;
+  }
+  for (i = 0; i < 3; ++i)
+  {
+    if (! MHD_iplimit_del_ (tbl, &key1))
+    {
+      fprintf (stderr, "Failed to remove the connection %u.\n", i);
+      errcount++;
+    }
+  }
+  if (MHD_iplimit_del_ (tbl, &key1))
+  {
+    fprintf (stderr, "Removed more connections than added.\n");
+    errcount++;
+  }
+  if (! MHD_iplimit_del_ (tbl, &key2))
+  {
+    fprintf (stderr, "Failed to remove the other address.\n");
+    errcount++;
+  }
+  MHD_iplimit_destroy_ (tbl);
+  return errcount;
+}
+
+
+static int
+check_many_addresses (void)
+{
+  struct MHD_IPLimitTable_ *tbl;
+  struct MHD_IPLimitKey_ key;
+  int errcount = 0;
+  uint32_t round;
+  uint32_t i;
+
+  tbl = MHD_iplimit_create_ (MAX_CONNS, 12345);
+  if (NULL == tbl)
+  {
+    fprintf (stderr, "Failed to create the table.\n");
+    return 1;
+  }
+  /* Fill the table with the maximum number of the addresses many times,
+     the slots of the released addresses must be reused */
+  for (round = 0; round < 50; ++round)
+  {
+    for (i = 0; i < MAX_CONNS; ++i)
+    {
+      make_key (&key, round * MAX_CONNS + i);
+      if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key, 1))
+      {
+        fprintf (stderr, "Failed to add the address %u in the round %u.\n",
+                 (unsigned int) i, (unsigned int) round);
+        errcount++;
+      }
+    }
+    for (i = 0; i < MAX_CONNS; ++i)
+    {
+      make_key (&key, round * MAX_CONNS + i);
+      if (! MHD_iplimit_del_ (tbl, &key))
+      {
+        fprintf (stderr, "Failed to remove the address %u in the round %u.\n",
+                 (unsigned int) i, (unsigned int) round);
+        errcount++;
+      }
+    }
+    if (0 != errcount)
+      break;
+  }
+  MHD_iplimit_destroy_ (tbl);
+  return errcount;
+}
+
+
+static int
+check_overflow (void)
+{
+  struct MHD_IPLimitTable_ *tbl;
+  struct MHD_IPLimitKey_ key;
+  int errcount = 0;
+  uint32_t i;
+
+  /* The smallest table, the most of the addresses do not fit the buckets */
+  tbl = MHD_iplimit_create_ (1, 54321);
+  if (NULL == tbl)
+  {
+    fprintf (stderr, "Failed to create the table.\n");
+    return 1;
+  }
+  for (i = 0; i < 16 * MAX_CONNS; ++i)
+  {
+    make_key (&key, i);
+    if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key, 2))
+    {
+      fprintf (stderr, "Failed to add the address %u.\n", (unsigned int) i);
+      errcount++;
+    }
+    if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (tbl, &key, 2))
+    {
+      fprintf (stderr, "Failed to add the second connection for "
+               "the address %u.\n", (unsigned int) i);
+      errcount++;
+    }
+    if (MHD_IPLIMIT_OVER_LIMIT_ != MHD_iplimit_add_ (tbl, &key, 2))
+    {
+      fprintf (stderr, "The limit has not been detected for "
+               "the address %u.\n", (unsigned int) i);
+      errcount++;
+    }
+    if (0 != errcount)
+      break;
+  }
+  for (i = 0; i < 16 * MAX_CONNS && 0 == errcount; ++i)
+  {
+    make_key (&key, i);
+    if (! MHD_iplimit_del_ (tbl, &key) ||
+        ! MHD_iplimit_del_ (tbl, &key))
+    {
+      fprintf (stderr, "Failed to remove the address %u.\n",
+               (unsigned int) i);
+      errcount++;
+    }
+    if (MHD_iplimit_del_ (tbl, &key))
+    {
+      fprintf (stderr, "Removed more connections than added for "
+               "the address %u.\n", (unsigned int) i);
+      errcount++;
+    }
+  }
+  MHD_iplimit_destroy_ (tbl);
+  return errcount;
+}
+
+
+#ifdef MHD_USE_POSIX_THREADS
+
+static struct MHD_IPLimitTable_ *thr_tbl;
+
+static volatile int thr_errors;
+
+static void *
+worker (void *cls)
+{
+  const uint32_t base = (uint32_t) (uintptr_t) cls;
+  struct MHD_IPLimitKey_ key;
+  unsigned int i;
+
+  for (i = 0; i < THREAD_ITERATIONS; ++i)
+  {
+    /* The shared addresses and the addresses unique for the thread */
+    const uint32_t num = (0 == (i % 2)) ? (i % 16) : (base + i % 32);
+
+    make_key (&key, num);
+    if (MHD_IPLIMIT_OK_ != MHD_iplimit_add_ (thr_tbl, &key, NUM_THREADS))
+      thr_errors++;
+    else if (! MHD_iplimit_del_ (thr_tbl, &key))
+      thr_errors++;
+  }
+  return NULL;
+}
+
+
+static int
+check_threads (void)
+{
+  pthread_t threads[NUM_THREADS];
+  struct MHD_IPLimitKey_ key;
+  int errcount = 0;
+  unsigned int i;
+  uint32_t num;
+
+  thr_tbl = MHD_iplimit_create_ (MAX_CONNS, 777);
+  if (NULL == thr_tbl)
+  {
+    fprintf (stderr, "Failed to create the table.\n");
+    return 1;
+  }
+  thr_errors = 0;
+  for (i = 0; i < NUM_THREADS; ++i)
+  {
+    if (0 != pthread_create (threads + i, NULL, &worker,
+                             (void *) (uintptr_t) ((i + 1) * 1000)))
+    {
+      fprintf (stderr, "Failed to start the thread.\n");
+      return 99;
+    }
+  }
+  for (i = 0; i < NUM_THREADS; ++i)
+    pthread_join (threads[i], NULL);
+  if (0 != thr_errors)
+  {
+    fprintf (stderr, "%d errors in the threads.\n", thr_errors);
+    errcount++;
+  }
+  /* All counters must be zero */
+  for (num = 0; num < 16; ++num)
+  {
+    make_key (&key, num);
+    if (MHD_iplimit_del_ (thr_tbl, &key))
+    {
+      fprintf (stderr, "The counter of the address %u is not zero.\n",
+               (unsigned int) num);
+      errcount++;
+    }
+  }
+  MHD_iplimit_destroy_ (thr_tbl);
+  return errcount;
+}
+
+
+#endif /* MHD_USE_POSIX_THREADS */
+
+
+int
+main (int argc, char *argv[])
+{
+  int errcount = 0;
+  (void) argc; (void) argv; /* Unused. Silent compiler warning. */
+  errcount += check_limit ();
+  errcount += check_many_addresses ();
+  errcount += check_overflow ();
+#ifdef MHD_USE_POSIX_THREADS
+  errcount += check_threads ();
+#endif /* MHD_USE_POSIX_THREADS */
+  return errcount == 0 ? 0 : 1;
+}
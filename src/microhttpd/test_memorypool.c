@@ -0,0 +1,377 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This test tool is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2, or
+  (at your option) any later version.
+
+  This test tool is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/test_memorypool.c
+ * @brief  Unit tests for the memory pools and the cache of the pools
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <string.h>
+#include "memorypool.h"
+
+#define POOL_SIZE (16 * 1024)
+
+#define CACHE_MAX_NUM 2
+
+#define CACHE_SLAB_NUM 3
+
+
+/**
+ * Allocate all free memory of the pool and fill it with non-zero bytes.
+ * @param pool the pool to use
+ * @param[out] size the size of the allocated block
+ * @return the allocated block, NULL on error
+ */
+static uint8_t *
+fill_pool (struct MemoryPool *pool,
+           size_t *size)
+{
+  uint8_t *block;
+
+  *size = MHD_pool_get_free (pool);
+  block = (uint8_t *) MHD_pool_allocate (pool,
+                                         *size,
+                                         false);
+  if (NULL != block)
+    memset (block, 0xA5, *size);
+  return block;
+}
+
+
+/**
+ * Check that all free memory of the pool is zeroed.
+ * The free memory of the pool is allocated by this function.
+ * @param pool the pool to check
+ * @return the number of errors
+ */
+static int
+check_pool_zeroed (struct MemoryPool *pool)
+{
+  const uint8_t *block;
+  size_t size;
+  size_t i;
+
+  size = MHD_pool_get_free (pool);
+  block = (const uint8_t *) MHD_pool_allocate (pool,
+                                               size,
+                                               false);
+  if (NULL == block)
+  {
+    fprintf (stderr, "Failed to allocate the free memory of the pool.\n");
+    return 1;
+  }
+  for (i = 0; i < size; ++i)
+  {
+    if (0 != block[i])
+    {
+      fprintf (stderr, "Non-zero byte at the position %lu of %lu.\n",
+               (unsigned long) i, (unsigned long) size);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+
+static int
+check_reset (void)
+{
+  struct MemoryPool *pool;
+  uint8_t *block;
+  size_t size;
+  int errcount = 0;
+  size_t i;
+
+  pool = MHD_pool_create (POOL_SIZE);
+  if (NULL == pool)
+  {
+    fprintf (stderr, "Failed to create the pool.\n");
+    return 1;
+  }
+  /* The kept data must be moved to the start of the pool, the rest of
+     the pool must be zeroed */
+  block = fill_pool (pool, &size);
+  if ((NULL == block) || (64 > size))
+  {
+    fprintf (stderr, "Failed to fill the pool.\n");
+    MHD_pool_destroy (pool);
+    return 1;
+  }
+  block = (uint8_t *) MHD_pool_reset (pool,
+                                      block + 32,
+                                      16,
+                                      16);
+  for (i = 0; i < 16; ++i)
+  {
+    if (0xA5 != block[i])
+    {
+      fprintf (stderr, "The kept data has not been preserved by reset.\n");
+      errcount++;
+      break;
+    }
+  }
+  errcount += check_pool_zeroed (pool);
+
+  /* The pool must be fully zeroed when nothing is kept */
+  (void) MHD_pool_reset (pool, NULL, 0, 0);
+  if (POOL_SIZE > MHD_pool_get_free (pool))
+  {
+    fprintf (stderr, "The memory of the pool is not free after reset.\n");
+    errcount++;
+  }
+  if (NULL == fill_pool (pool, &size))
+  {
+    fprintf (stderr, "Failed to fill the pool after reset.\n");
+    errcount++;
+  }
+  (void) MHD_pool_reset (pool, NULL, 0, 0);
+  errcount += check_pool_zeroed (pool);
+
+  MHD_pool_destroy (pool);
+  return errcount;
+}
+
+
+static int
+check_cache_reuse (void)
+{
+  struct MemoryPoolCache cache;
+  struct MemoryPool *pools[CACHE_MAX_NUM + 1];
+  struct MemoryPool *pool;
+  size_t size;
+  int errcount = 0;
+  unsigned int i;
+
+  MHD_pool_cache_init (&cache, POOL_SIZE, CACHE_MAX_NUM, 0);
+  for (i = 0; i <= CACHE_MAX_NUM; ++i)
+  {
+    pools[i] = MHD_pool_cache_get (&cache);
+    if (NULL == pools[i])
+    {
+      fprintf (stderr, "Failed to get the pool from the cache.\n");
+      return 1;
+    }
+    if (NULL == fill_pool (pools[i], &size))
+    {
+      fprintf (stderr, "Failed to fill the pool.\n");
+      errcount++;
+    }
+  }
+  for (i = 0; i <= CACHE_MAX_NUM; ++i)
+    MHD_pool_cache_put (&cache, pools[i]);
+  /* The extra pool must have been destroyed */
+  if (CACHE_MAX_NUM != cache.num)
+  {
+    fprintf (stderr, "Wrong number of the cached pools: %u.\n", cache.num);
+    errcount++;
+  }
+  /* The cached pools must be returned in the reverse order, reset and
+     with the all memory available */
+  for (i = CACHE_MAX_NUM; 0 < i; --i)
+  {
+    pool = MHD_pool_cache_get (&cache);
+    if (pools[i - 1] != pool)
+    {
+      fprintf (stderr, "The cached pool has not been reused.\n");
+      errcount++;
+    }
+    if (NULL == pool)
+      continue;
+    if (POOL_SIZE > MHD_pool_get_free (pool))
+    {
+      fprintf (stderr, "The memory of the cached pool is not free.\n");
+      errcount++;
+    }
+    errcount += check_pool_zeroed (pool);
+    pools[i - 1] = pool;
+  }
+  if ((0 != cache.num) || (NULL != cache.head))
+  {
+    fprintf (stderr, "The cache is not empty.\n");
+    errcount++;
+  }
+  for (i = 0; i < CACHE_MAX_NUM; ++i)
+    MHD_pool_cache_put (&cache, pools[i]);
+  MHD_pool_cache_clear (&cache);
+  if ((0 != cache.num) || (NULL != cache.head))
+  {
+    fprintf (stderr, "The cache has not been cleared.\n");
+    errcount++;
+  }
+
+  /* The cache with zero size must not keep the pools */
+  MHD_pool_cache_init (&cache, POOL_SIZE, 0, 0);
+  pool = MHD_pool_cache_get (&cache);
+  if (NULL == pool)
+  {
+    fprintf (stderr, "Failed to get the pool from the cache.\n");
+    return errcount + 1;
+  }
+  MHD_pool_cache_put (&cache, pool);
+  if ((0 != cache.num) || (NULL != cache.head))
+  {
+    fprintf (stderr, "The pool has been kept by the disabled cache.\n");
+    errcount++;
+  }
+  MHD_pool_cache_clear (&cache);
+  return errcount;
+}
+
+
+/**
+ * Check whether the memory of the pool is in the slab of the cache.
+ * The free memory of the pool is allocated by this function.
+ * @param cache the cache to use
+ * @param pool the pool to check
+ * @return 'true' if the pool memory is in the slab
+ */
+static bool
+is_in_slab (const struct MemoryPoolCache *cache,
+            struct MemoryPool *pool)
+{
+  const uint8_t *block;
+  size_t size;
+
+  size = MHD_pool_get_free (pool);
+  block = (const uint8_t *) MHD_pool_allocate (pool,
+                                               size,
+                                               false);
+  if ((NULL == block) || (NULL == cache->slab))
+    return false;
+  return (block >= cache->slab) &&
+         (block + size <= cache->slab + cache->slab_size);
+}
+
+
+static int
+check_cache_slab (void)
+{
+  struct MemoryPoolCache cache;
+  struct MemoryPool *pools[CACHE_SLAB_NUM + 1];
+  struct MemoryPool *pool;
+  size_t size;
+  int errcount = 0;
+  unsigned int i;
+
+  /* The slab pools are always kept, even if the cache is disabled */
+  MHD_pool_cache_init (&cache, POOL_SIZE, 0, CACHE_SLAB_NUM);
+  if (NULL != cache.slab)
+  {
+    fprintf (stderr, "The slab has been allocated before the first use.\n");
+    errcount++;
+  }
+  for (i = 0; i <= CACHE_SLAB_NUM; ++i)
+  {
+    pools[i] = MHD_pool_cache_get (&cache);
+    if (NULL == pools[i])
+    {
+      fprintf (stderr, "Failed to get the pool from the cache.\n");
+      return errcount + 1;
+    }
+  }
+  if (0 == cache.slab_num)
+  {
+    /* The slab memory cannot be mapped on this system, the pools
+       must be created as usual */
+    printf ("The slab is not available, skipping the slab checks.\n");
+    for (i = 0; i <= CACHE_SLAB_NUM; ++i)
+      MHD_pool_cache_put (&cache, pools[i]);
+    MHD_pool_cache_clear (&cache);
+    return errcount;
+  }
+  if (CACHE_SLAB_NUM != cache.slab_used)
+  {
+    fprintf (stderr, "Wrong number of the pools taken from the slab: %u.\n",
+             cache.slab_used);
+    errcount++;
+  }
+  for (i = 0; i < CACHE_SLAB_NUM; ++i)
+  {
+    if (! is_in_slab (&cache, pools[i]))
+    {
+      fprintf (stderr, "The pool %u is not in the slab.\n", i);
+      errcount++;
+    }
+  }
+  /* The slab is exhausted, the next pool is allocated separately */
+  if (is_in_slab (&cache, pools[CACHE_SLAB_NUM]))
+  {
+    fprintf (stderr, "The extra pool is in the slab.\n");
+    errcount++;
+  }
+  for (i = 0; i <= CACHE_SLAB_NUM; ++i)
+    MHD_pool_cache_put (&cache, pools[i]);
+  if (0 != cache.num)
+  {
+    fprintf (stderr, "The extra pool has been kept by the disabled cache.\n");
+    errcount++;
+  }
+  /* The slab pools must be reused before the new pools are created */
+  for (i = 0; i < CACHE_SLAB_NUM; ++i)
+  {
+    pool = MHD_pool_cache_get (&cache);
+    if ((NULL == pool) || ! is_in_slab (&cache, pool))
+    {
+      fprintf (stderr, "The slab pool has not been reused.\n");
+      errcount++;
+    }
+    else
+    {
+      (void) MHD_pool_reset (pool, NULL, 0, 0);
+      errcount += check_pool_zeroed (pool);
+      (void) MHD_pool_reset (pool, NULL, 0, 0);
+      if (NULL == fill_pool (pool, &size))
+      {
+        fprintf (stderr, "Failed to fill the slab pool.\n");
+        errcount++;
+      }
+    }
+    pools[i] = pool;
+  }
+  if (CACHE_SLAB_NUM != cache.slab_used)
+  {
+    fprintf (stderr, "New pools have been taken from the slab.\n");
+    errcount++;
+  }
+  for (i = 0; i < CACHE_SLAB_NUM; ++i)
+    MHD_pool_cache_put (&cache, pools[i]);
+  MHD_pool_cache_clear (&cache);
+  if (NULL != cache.slab)
+  {
+    fprintf (stderr, "The slab has not been released.\n");
+    errcount++;
+  }
+  return errcount;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int errcount = 0;
+  (void) argc; (void) argv; /* Unused. Silent compiler warning. */
+  MHD_init_mem_pools_ ();
+  errcount += check_reset ();
+  errcount += check_cache_reuse ();
+  errcount += check_cache_slab ();
+  return errcount == 0 ? 0 : 1;
+}
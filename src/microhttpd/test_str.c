@@ -778,6 +778,124 @@ check_neq_strings_n (void)
 }
 
 
+static size_t
+check_eq_strings_bin_n (void)
+{
+  size_t t_failed = 0;
+  size_t i, k;
+  static const size_t n_checks = sizeof(eq_strings) / sizeof(eq_strings[0]);
+
+  for (i = 0; i < n_checks; i++)
+  {
+    const struct two_eq_strs *const t = eq_strings + i;
+    const size_t m_len = (t->s1.len < t->s2.len) ? t->s1.len : t->s2.len;
+    for (k = 0; k <= m_len; k++)
+    {
+      if ((! MHD_str_equal_caseless_bin_n_ (t->s1.str, t->s2.str, k)) ||
+          (! MHD_str_equal_caseless_bin_n_ (t->s2.str, t->s1.str, k)))
+      {
+        t_failed++;
+        fprintf (stderr,
+                 "FAILED: MHD_str_equal_caseless_bin_n_(\"%s\", \"%s\", %u) "
+                 "returned zero, while expected non-zero.\n",
+                 n_prnt (t->s1.str), n_prnt (t->s2.str), (unsigned int) k);
+        break;
+      }
+    }
+    if ((verbose > 1) && (k > m_len))
+      printf ("PASSED: MHD_str_equal_caseless_bin_n_(\"%s\", \"%s\", N) "
+              "!= 0, where N is 0..%u\n",
+              n_prnt (t->s1.str), n_prnt (t->s2.str), (unsigned int) m_len);
+  }
+  return t_failed;
+}
+
+
+static size_t
+check_neq_strings_bin_n (void)
+{
+  size_t t_failed = 0;
+  size_t i, k;
+  static const size_t n_checks = sizeof(neq_strings) / sizeof(neq_strings[0]);
+
+  for (i = 0; i < n_checks; i++)
+  {
+    const struct two_neq_strs *const t = neq_strings + i;
+    const size_t m_len = (t->s1.len < t->s2.len) ? t->s1.len : t->s2.len;
+    for (k = 0; k <= m_len; k++)
+    {
+      const bool expected = (k <= t->dif_pos);
+      if ((expected !=
+           MHD_str_equal_caseless_bin_n_ (t->s1.str, t->s2.str, k)) ||
+          (expected !=
+           MHD_str_equal_caseless_bin_n_ (t->s2.str, t->s1.str, k)))
+      {
+        t_failed++;
+        fprintf (stderr,
+                 "FAILED: MHD_str_equal_caseless_bin_n_(\"%s\", \"%s\", %u) "
+                 "returned %s, while expected %s.\n",
+                 n_prnt (t->s1.str), n_prnt (t->s2.str), (unsigned int) k,
+                 expected ? "zero" : "non-zero",
+                 expected ? "non-zero" : "zero");
+        break;
+      }
+    }
+  }
+  return t_failed;
+}
+
+
+/**
+ * Check all pairs of characters at all positions within the range
+ * processed by the vector and the word-at-a-time code.
+ */
+static size_t
+check_all_chars_bin_n (void)
+{
+  static const size_t buf_len = 41;
+  char buf1[41];
+  char buf2[41];
+  size_t t_failed = 0;
+  unsigned int c1, c2;
+  size_t pos;
+
+  memset (buf1, 'x', sizeof(buf1));
+  memset (buf2, 'X', sizeof(buf2));
+  for (c1 = 0; c1 <= 255; c1++)
+  {
+    for (c2 = 0; c2 <= 255; c2++)
+    {
+      const char ch1 = (char) c1;
+      const char ch2 = (char) c2;
+      const bool expected =
+        (ch1 == ch2) ||
+        ((('A' <= ch1) && ('Z' >= ch1)) && ((ch1 - 'A' + 'a') == ch2)) ||
+        ((('A' <= ch2) && ('Z' >= ch2)) && ((ch2 - 'A' + 'a') == ch1));
+      for (pos = 0; pos < buf_len; pos += (0 == (c1 & 1)) ? 1 : 7)
+      {
+        buf1[pos] = ch1;
+        buf2[pos] = ch2;
+        if ((expected !=
+             MHD_str_equal_caseless_bin_n_ (buf1, buf2, buf_len)) ||
+            (expected !=
+             MHD_str_equal_caseless_bin_n_ (buf2 + pos, buf1 + pos,
+                                            buf_len - pos)))
+        {
+          t_failed++;
+          fprintf (stderr,
+                   "FAILED: MHD_str_equal_caseless_bin_n_() returned wrong "
+                   "result for characters 0x%02X and 0x%02X at position %u.\n",
+                   c1, c2, (unsigned int) pos);
+        }
+        buf1[pos] = 'x';
+        buf2[pos] = 'X';
+      }
+    }
+  }
+  return t_failed;
+}
+
+
 /*
  * Run eq/neq strings tests
  */
@@ -786,6 +904,7 @@ run_eq_neq_str_tests (void)
 {
   size_t str_equal_caseless_fails = 0;
   size_t str_equal_caseless_n_fails = 0;
+  size_t str_equal_caseless_bin_n_fails = 0;
   size_t res;
 
   res = check_eq_strings ();
@@ -844,7 +963,24 @@ run_eq_neq_str_tests (void)
     printf (
       "PASSED: function MHD_str_equal_caseless_n_() successfully passed all checks.\n\n");
 
-  if (str_equal_caseless_fails || str_equal_caseless_n_fails)
+  res = check_eq_strings_bin_n ();
+  res += check_neq_strings_bin_n ();
+  res += check_all_chars_bin_n ();
+  if (res != 0)
+  {
+    str_equal_caseless_bin_n_fails += res;
+    fprintf (stderr,
+             "FAILED: function MHD_str_equal_caseless_bin_n_() failed %lu time%s.\n\n",
+             (unsigned long) str_equal_caseless_bin_n_fails,
+             str_equal_caseless_bin_n_fails == 1 ? "" :
+             "s");
+  }
+  else if (verbose > 0)
+    printf (
+      "PASSED: function MHD_str_equal_caseless_bin_n_() successfully passed all checks.\n\n");
+
+  if (str_equal_caseless_fails || str_equal_caseless_n_fails ||
+      str_equal_caseless_bin_n_fails)
   {
     if (verbose > 0)
       printf ("At least one test failed.\n");
@@ -0,0 +1,140 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This test tool is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2, or
+  (at your option) any later version.
+
+  This test tool is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/test_str_delim.c
+ * @brief  Unit tests for MHD_str_find_delim_() function
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <string.h>
+#include "mhd_str.h"
+
+/**
+ * The size of the test buffer, larger than several vectors
+ */
+#define TEST_BUF_SIZE 160
+
+/**
+ * The reference implementation
+ */
+static size_t
+find_delim_ref (const char *str, size_t len, char delim)
+{
+  size_t i;
+  for (i = 0; i < len; ++i)
+  {
+    if ((((unsigned char) str[i]) <= 0x20) || (delim == str[i]))
+      break;
+  }
+  return i;
+}
+
+
+static int
+check_result (const char *str, size_t len, char delim, size_t offset)
+{
+  const size_t expected = find_delim_ref (str, len, delim);
+  const size_t res = MHD_str_find_delim_ (str, len, delim);
+  if (expected != res)
+  {
+    fprintf (stderr, "MHD_str_find_delim_() FAILED: "
+             "offset %u, length %u, delimiter 0x%02X: "
+             "returned %u, expected %u.\n",
+             (unsigned int) offset, (unsigned int) len,
+             (unsigned int) (unsigned char) delim,
+             (unsigned int) res, (unsigned int) expected);
+    return 1;
+  }
+  return 0;
+}
+
+
+/**
+ * Check every character value at every position with various
+ * alignments and lengths.
+ */
+static int
+check_all_chars (char delim)
+{
+  static char buf[TEST_BUF_SIZE + 32];
+  int errcount = 0;
+  unsigned int c;
+
+  for (c = 0; c < 256; ++c)
+  {
+    size_t offset;
+    for (offset = 0; offset < 32; offset += 7)
+    {
+      size_t pos;
+      for (pos = 0; pos < TEST_BUF_SIZE; ++pos)
+      {
+        size_t len;
+        memset (buf, 'a', sizeof(buf));
+        buf[offset + pos] = (char) c;
+        for (len = pos; len <= TEST_BUF_SIZE; len += 13)
+          errcount += check_result (buf + offset, len, delim, offset);
+        errcount += check_result (buf + offset, TEST_BUF_SIZE, delim, offset);
+        if (0 != errcount)
+          return errcount;
+      }
+    }
+  }
+  return errcount;
+}
+
+
+/**
+ * Check the strings with several delimiters
+ */
+static int
+check_several (char delim)
+{
+  static char buf[TEST_BUF_SIZE];
+  int errcount = 0;
+  size_t first;
+
+  for (first = 0; first < TEST_BUF_SIZE; ++first)
+  {
+    size_t i;
+    for (i = 0; i < TEST_BUF_SIZE; ++i)
+      buf[i] = (char) (0x80 + (i % 0x7F)); /* No delimiters */
+    for (i = first; i < TEST_BUF_SIZE; i += 3)
+      buf[i] = (0 == (i % 2)) ? ' ' : '\r';
+    buf[first] = delim;
+    errcount += check_result (buf, TEST_BUF_SIZE, delim, 0);
+  }
+  return errcount;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int errcount = 0;
+  (void) argc; (void) argv; /* Unused. Silent compiler warning. */
+  errcount += check_all_chars (0);
+  errcount += check_all_chars (':');
+  errcount += check_all_chars ('?');
+  errcount += check_several (':');
+  errcount += check_several (0);
+  return errcount == 0 ? 0 : 1;
+}
@@ -85,6 +85,12 @@ check_match (void)
   errcount += expect_found (",,,,,, test", "TESt");
   errcount += expect_found (",,,,,, test      ", "TESt");
   errcount += expect_found ("no test,,,,,, test      ", "TESt");
+  errcount += expect_found ("Sec-WebSocket-Extensions",
+                            "sec-websocket-extensions");
+  errcount += expect_found ("gzip, x-Long-Token-Name-With-Many-Characters",
+                            "X-LONG-TOKEN-NAME-WITH-MANY-CHARACTERS");
+  errcount += expect_found ("x-Long-Token-Name-With-Many-Characters\t, gzip",
+                            "X-LONG-TOKEN-NAME-WITH-MANY-CHARACTERS");
   return errcount;
 }
 
@@ -113,6 +119,17 @@ check_not_match (void)
   errcount += expect_not_found (",,,,,,2 test", "TESt");
   errcount += expect_not_found (",,,,,,test test      ", "test");
   errcount += expect_not_found ("no test,,,,,, test      test", "test");
+  errcount += expect_not_found ("a,abc", "ab");
+  errcount += expect_not_found ("Sec-WebSocket-Extension",
+                                "sec-websocket-extensions");
+  errcount += expect_not_found ("Sec-WebSocket-Extensionz",
+                                "sec-websocket-extensions");
+  errcount += expect_not_found ("x-Long-Token-Name-With-Many-Characters",
+                                "X-LONG-TOKEN-NAME-WITH-MANY-CHARACTERZ");
+  errcount += expect_not_found ("x-Long-Token-Name-With-Many-Characters",
+                                "X_LONG-TOKEN-NAME-WITH-MANY-CHARACTERS");
+  errcount += expect_not_found ("x-Long-Token-Name-With-Many-Character",
+                                "X-LONG-TOKEN-NAME-WITH-MANY-CHARACTERS");
   return errcount;
 }
 
@@ -0,0 +1,179 @@
+/*
+  This file is part of libmicrohttpd
+  Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+  This test tool is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2, or
+  (at your option) any later version.
+
+  This test tool is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/**
+ * @file microhttpd/test_tmheap.c
+ * @brief  Unit tests for the min-heap of the timeout deadlines
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <string.h>
+#include "mhd_tmheap.h"
+
+#define NODES_NUM 1000
+
+static struct MHD_TmHeapNode_ nodes[NODES_NUM];
+
+static uint32_t rnd_state = 1;
+
+
+/**
+ * Simple deterministic pseudo-random generator.
+ */
+static uint32_t
+next_rnd (void)
+{
+  rnd_state = rnd_state * 1103515245u + 12345u;
+  return (rnd_state >> 8);
+}
+
+
+/**
+ * Remove all nodes from the heap in the order of the keys and check
+ * the order.
+ * @param heap the heap to drain
+ * @param expected_num the expected number of the nodes in the heap
+ * @return the number of errors
+ */
+static int
+drain_and_check (struct MHD_TmHeap_ *heap,
+                 unsigned int expected_num)
+{
+  int errcount = 0;
+  unsigned int num = 0;
+  uint64_t prev_key = 0;
+  struct MHD_TmHeapNode_ *n;
+
+  while (NULL != (n = MHD_tmheap_first_ (heap)))
+  {
+    if (n->key < prev_key)
+    {
+      fprintf (stderr, "Wrong order of keys: %lu after %lu.\n",
+               (unsigned long) n->key, (unsigned long) prev_key);
+      errcount++;
+    }
+    prev_key = n->key;
+    MHD_tmheap_remove_ (heap, n);
+    if (MHD_tmheap_is_in_ (heap, n))
+    {
+      fprintf (stderr, "Removed node is still in the heap.\n");
+      errcount++;
+    }
+    if (++num > NODES_NUM)
+    {
+      fprintf (stderr, "Too many nodes in the heap.\n");
+      return errcount + 1;
+    }
+  }
+  if (expected_num != num)
+  {
+    fprintf (stderr, "Wrong number of nodes in the heap: %u, expected %u.\n",
+             num, expected_num);
+    errcount++;
+  }
+  return errcount;
+}
+
+
+static int
+check_insert (void)
+{
+  struct MHD_TmHeap_ heap = { NULL };
+  unsigned int i;
+
+  for (i = 0; i < NODES_NUM; ++i)
+  {
+    MHD_tmheap_node_init_ (nodes + i);
+    MHD_tmheap_insert_ (&heap, nodes + i, next_rnd () % 5000);
+  }
+  for (i = 0; i < NODES_NUM; ++i)
+  {
+    if (! MHD_tmheap_is_in_ (&heap, nodes + i))
+    {
+      fprintf (stderr, "Inserted node %u is not in the heap.\n", i);
+      return 1;
+    }
+  }
+  return drain_and_check (&heap, NODES_NUM);
+}
+
+
+static int
+check_remove_update (void)
+{
+  struct MHD_TmHeap_ heap = { NULL };
+  unsigned int i;
+  unsigned int num;
+
+  for (i = 0; i < NODES_NUM; ++i)
+  {
+    MHD_tmheap_node_init_ (nodes + i);
+    MHD_tmheap_insert_ (&heap, nodes + i, next_rnd () % 100000);
+  }
+  /* Pop several nodes to build the multi-level tree */
+  for (i = 0; i < 10; ++i)
+    MHD_tmheap_remove_ (&heap, MHD_tmheap_first_ (&heap));
+  num = NODES_NUM - 10;
+  /* Remove and update the arbitrary nodes */
+  for (i = 0; i < NODES_NUM; ++i)
+  {
+    struct MHD_TmHeapNode_ *const n = nodes + (next_rnd () % NODES_NUM);
+    if (! MHD_tmheap_is_in_ (&heap, n))
+      continue;
+    if (0 == (i % 3))
+    {
+      MHD_tmheap_remove_ (&heap, n);
+      num--;
+    }
+    else
+      MHD_tmheap_update_ (&heap, n, n->key + next_rnd () % 100000);
+  }
+  return drain_and_check (&heap, num);
+}
+
+
+static int
+check_equal_keys (void)
+{
+  struct MHD_TmHeap_ heap = { NULL };
+  unsigned int i;
+
+  for (i = 0; i < NODES_NUM; ++i)
+  {
+    MHD_tmheap_node_init_ (nodes + i);
+    MHD_tmheap_insert_ (&heap, nodes + i, (i % 2) ? 7 : UINT64_MAX);
+  }
+  for (i = 0; i < NODES_NUM; i += 4)
+    MHD_tmheap_remove_ (&heap, nodes + i);
+  return drain_and_check (&heap, NODES_NUM - NODES_NUM / 4);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int errcount = 0;
+  (void) argc; (void) argv; /* Unused. Silent compiler warning. */
+  errcount += check_insert ();
+  errcount += check_remove_update ();
+  errcount += check_equal_keys ();
+  return errcount == 0 ? 0 : 1;
+}
@@ -237,6 +237,331 @@ testEmptyGet (unsigned int poll_flag)
 }
 
 
+/**
+ * The size of the file used for the kTLS test
+ */
+#define KTLS_FILE_SIZE (256 * 1024)
+
+static enum MHD_Result
+ahc_file (void *cls,
+          struct MHD_Connection *connection,
+          const char *url,
+          const char *method,
+          const char *version,
+          const char *upload_data,
+          size_t *upload_data_size,
+          void **req_cls)
+{
+  static int marker;
+  FILE *const f = (FILE *) cls;
+  struct MHD_Response *response;
+  enum MHD_Result ret;
+  int fd;
+  (void) url; (void) version;                      /* Unused. Silent compiler warning. */
+  (void) upload_data; (void) upload_data_size;     /* Unused. Silent compiler warning. */
+
+  if (0 != strcmp (method, MHD_HTTP_METHOD_GET))
+    return MHD_NO;              /* unexpected method */
+  if (&marker != *req_cls)
+  {
+    *req_cls = &marker;
+    return MHD_YES;
+  }
+  *req_cls = NULL;
+  fd = dup (fileno (f));
+  if (-1 == fd)
+    return MHD_NO;
+  response = MHD_create_response_from_fd (KTLS_FILE_SIZE, fd);
+  if (NULL == response)
+  {
+    close (fd);
+    return MHD_NO;
+  }
+  ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+  MHD_destroy_response (response);
+  return ret;
+}
+
+
+/**
+ * Start the daemon with TLS using the test key and certificate.
+ * @param flags the additional flags for the daemon
+ * @param fallback_port the port to use if the port cannot be detected
+ *                      automatically
+ * @param ahc the access handler callback
+ * @param ahc_cls the closure for @a ahc
+ * @param options the additional options, terminated by #MHD_OPTION_END
+ * @param[out] pport the port of the daemon
+ * @return the started daemon, NULL on error
+ */
+static struct MHD_Daemon *
+start_tls_daemon (unsigned int flags,
+                  uint16_t fallback_port,
+                  MHD_AccessHandlerCallback ahc,
+                  void *ahc_cls,
+                  const struct MHD_OptionItem *options,
+                  uint16_t *pport)
+{
+  struct MHD_Daemon *d;
+  const union MHD_DaemonInfo *dinfo;
+  uint16_t port;
+
+  if (MHD_NO != MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT))
+    port = 0;
+  else
+    port = fallback_port;
+
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_TLS
+                        | MHD_USE_ERROR_LOG | flags, port,
+                        NULL, NULL,
+                        ahc, ahc_cls,
+                        MHD_OPTION_HTTPS_MEM_KEY, srv_signed_key_pem,
+                        MHD_OPTION_HTTPS_MEM_CERT, srv_signed_cert_pem,
+                        MHD_OPTION_ARRAY, options,
+                        MHD_OPTION_END);
+  if (d == NULL)
+  {
+    fprintf (stderr, MHD_E_SERVER_INIT);
+    return NULL;
+  }
+  if (0 == port)
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d);
+      return NULL;
+    }
+    port = dinfo->port;
+  }
+  *pport = port;
+  return d;
+}
+
+
+/**
+ * Perform several GET requests via TLS, every request on the new
+ * connection.
+ * @param port the port of the daemon
+ * @param num_requests the number of requests to perform
+ * @param ssl_version the value for CURLOPT_SSLVERSION
+ * @param reuse_session if non-zero, the TLS session is kept by the client
+ *                      and resumed by the next connection
+ * @return zero if succeed, non-zero otherwise
+ */
+static unsigned int
+perform_new_conn_gets (uint16_t port,
+                       unsigned int num_requests,
+                       long ssl_version,
+                       int reuse_session)
+{
+  CURL *c;
+  char buf[2048];
+  struct CBC cbc;
+  CURLcode errornum;
+  unsigned int i;
+
+  cbc.buf = buf;
+  cbc.size = sizeof(buf);
+  c = curl_easy_init ();
+#ifdef _DEBUG
+  curl_easy_setopt (c, CURLOPT_VERBOSE, 1L);
+#endif
+  curl_easy_setopt (c, CURLOPT_URL, "https://127.0.0.1/");
+  curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  curl_easy_setopt (c, CURLOPT_PORT, (long) port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_SSL_VERIFYPEER, 0L);
+  curl_easy_setopt (c, CURLOPT_SSL_VERIFYHOST, 0L);
+  curl_easy_setopt (c, CURLOPT_SSLVERSION, ssl_version);
+  /* The TLS session is kept by the easy handle */
+  curl_easy_setopt (c, CURLOPT_SSL_SESSIONID_CACHE,
+                    reuse_session ? 1L : 0L);
+  curl_easy_setopt (c, CURLOPT_FORBID_REUSE, 1L);
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  for (i = 0; i < num_requests; ++i)
+  {
+    cbc.pos = 0;
+    if (CURLE_OK != (errornum = curl_easy_perform (c)))
+    {
+      fprintf (stderr,
+               "curl_easy_perform failed: `%s'\n",
+               curl_easy_strerror (errornum));
+      curl_easy_cleanup (c);
+      return 1;
+    }
+  }
+  curl_easy_cleanup (c);
+  return 0;
+}
+
+
+/* perform a GET request of the file via TLS with kernel TLS enabled */
+static unsigned int
+testKtlsFileGet (void)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_HTTPS_KTLS, 1, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+  struct MHD_Daemon *d;
+  uint16_t port;
+  FILE *f;
+  char *data;
+  struct CBC cbc;
+  char url[255];
+  const union MHD_DaemonInfo *dinfo;
+  unsigned int ret;
+  size_t i;
+
+  data = malloc (KTLS_FILE_SIZE);
+  cbc.buf = malloc (KTLS_FILE_SIZE);
+  f = tmpfile ();
+  if ((NULL == data) || (NULL == cbc.buf) || (NULL == f))
+  {
+    fprintf (stderr, "Failed to prepare the test file.\n");
+    free (data);
+    free (cbc.buf);
+    if (NULL != f)
+      fclose (f);
+    return 1;
+  }
+  for (i = 0; i < KTLS_FILE_SIZE; ++i)
+    data[i] = (char) ('a' + (char) (i % 23));
+  if ((1 != fwrite (data, KTLS_FILE_SIZE, 1, f)) || (0 != fflush (f)))
+  {
+    fprintf (stderr, "Failed to write the test file.\n");
+    ret = 1;
+    goto cleanup;
+  }
+  cbc.size = KTLS_FILE_SIZE;
+  cbc.pos = 0;
+
+  d = start_tls_daemon (0, 3043, &ahc_file, f, options, &port);
+  if (d == NULL)
+  {
+    ret = 1;
+    goto cleanup;
+  }
+  ret = 0;
+  if (gen_test_uri (url, sizeof (url), port) ||
+      (CURLE_OK != send_curl_req (url, &cbc, NULL, CURL_SSLVERSION_DEFAULT)))
+    ret = 1;
+  else if ((KTLS_FILE_SIZE != cbc.pos) ||
+           (0 != memcmp (cbc.buf, data, KTLS_FILE_SIZE)))
+  {
+    fprintf (stderr, "Error: original data & received data differ.\n");
+    ret = 1;
+  }
+  else
+  {
+    /* The data must be transferred correctly with and without kernel TLS */
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+    if ((NULL == dinfo) ||
+        (dinfo->stats.tls_ktls_send > dinfo->stats.tls_handshakes))
+    {
+      fprintf (stderr, "Wrong kernel TLS statistics.\n");
+      ret = 1;
+    }
+  }
+  MHD_stop_daemon (d);
+
+cleanup:
+  fclose (f);
+  free (cbc.buf);
+  free (data);
+  return ret;
+}
+
+
+/* perform several GET requests via TLS on new connections with the session
+   resumption enabled.  Without the tickets TLS 1.2 is used, as the sessions
+   of TLS 1.3 can be resumed only by the tickets. */
+static unsigned int
+testSessionResumeGet (int use_tickets)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_THREAD_POOL_SIZE, 2, NULL },
+    { MHD_OPTION_HTTPS_SESSION_TICKETS, use_tickets ? 600 : 0, NULL },
+    { MHD_OPTION_HTTPS_SESSION_CACHE, 64, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+  struct MHD_Daemon *d;
+  uint16_t port;
+  const union MHD_DaemonInfo *dinfo;
+
+  d = start_tls_daemon (0, 3044, &ahc_empty, NULL, options, &port);
+  if (d == NULL)
+    return 1;
+  if (0 != perform_new_conn_gets (port, 3,
+                                  use_tickets ?
+                                  (long) CURL_SSLVERSION_DEFAULT :
+                                  (long) (CURL_SSLVERSION_TLSv1_2
+                                          | CURL_SSLVERSION_MAX_TLSv1_2),
+                                  ! 0))
+  {
+    MHD_stop_daemon (d);
+    return 1;
+  }
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+  if ((NULL == dinfo) ||
+      (3 != dinfo->stats.tls_handshakes) ||
+      (0 == dinfo->stats.tls_resumed) ||
+      (dinfo->stats.tls_resumed >= dinfo->stats.tls_handshakes))
+  {
+    fprintf (stderr, "Wrong TLS session resumption statistics.\n");
+    MHD_stop_daemon (d);
+    return 1;
+  }
+  MHD_stop_daemon (d);
+  return 0;
+}
+
+
+/* perform several GET requests via TLS on new connections with the TLS
+   handshakes performed by the handshake threads */
+static unsigned int
+testHandshakeThreadsGet (unsigned int poll_flag)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_THREAD_POOL_SIZE, 2, NULL },
+    { MHD_OPTION_HTTPS_HANDSHAKE_THREADS, 2, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+  struct MHD_Daemon *d;
+  uint16_t port;
+  const union MHD_DaemonInfo *dinfo;
+
+  d = start_tls_daemon (poll_flag, 3045, &ahc_empty, NULL, options, &port);
+  if (d == NULL)
+    return 1;
+  /* Every connection performs the full handshake */
+  if (0 != perform_new_conn_gets (port, 4, CURL_SSLVERSION_DEFAULT, 0))
+  {
+    MHD_stop_daemon (d);
+    return 1;
+  }
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+  /* Parking for the handshake is not reported as suspending */
+  if ((NULL == dinfo) ||
+      (4 != dinfo->stats.tls_handshakes) ||
+      (4 > dinfo->stats.tls_hs_offloaded) ||
+      (0 != dinfo->stats.suspends) ||
+      (0 != dinfo->stats.resumes))
+  {
+    fprintf (stderr, "Wrong TLS handshake threads statistics.\n");
+    MHD_stop_daemon (d);
+    return 1;
+  }
+  MHD_stop_daemon (d);
+  return 0;
+}
+
+
 int
 main (int argc, char *const *argv)
 {
@@ -260,6 +585,12 @@ main (int argc, char *const *argv)
   errorCount +=
     test_secure_get (NULL, CURL_SSLVERSION_DEFAULT);
   errorCount += testEmptyGet (0);
+  errorCount += testKtlsFileGet ();
+  errorCount += testSessionResumeGet (! 0);
+  errorCount += testSessionResumeGet (0);
+  errorCount += testHandshakeThreadsGet (0);
+  if (MHD_NO != MHD_is_feature_supported (MHD_FEATURE_EPOLL))
+    errorCount += testHandshakeThreadsGet (MHD_USE_EPOLL);
   curl_global_cleanup ();
 
   return errorCount != 0 ? 1 : 0;
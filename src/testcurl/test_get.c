@@ -344,6 +344,8 @@ testMultithreadedPoolGet (uint32_t poll_flag)
                         global_port, NULL, NULL,
                         &ahc_echo, NULL,
                         MHD_OPTION_THREAD_POOL_SIZE, MHD_CPU_COUNT,
+                        MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB,
+                        (unsigned int) 4,
                         MHD_OPTION_URI_LOG_CALLBACK, &log_cb, NULL,
                         MHD_OPTION_END);
   if (d == NULL)
@@ -393,6 +395,107 @@ testMultithreadedPoolGet (uint32_t poll_flag)
 }
 
 
+static unsigned int
+testPoolListenGet (uint32_t poll_flag,
+                   enum MHD_ListenSharding sharding,
+                   int epoll_exclusive)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  char buf[2048];
+  struct CBC cbc;
+  CURLcode errornum;
+  MHD_socket fd;
+  unsigned int i;
+
+  if ( (0 == global_port) &&
+       (MHD_NO == MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT)) )
+  {
+    global_port = 1223;
+    if (oneone)
+      global_port += 20;
+  }
+
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | MHD_USE_ITC | (enum MHD_FLAG) poll_flag,
+                        global_port, NULL, NULL,
+                        &ahc_echo, NULL,
+                        MHD_OPTION_THREAD_POOL_SIZE, MHD_CPU_COUNT,
+                        MHD_OPTION_LISTEN_SHARDING, (unsigned int) sharding,
+                        MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE, epoll_exclusive,
+                        MHD_OPTION_ACCEPT_BATCH_SIZE, (unsigned int) 2,
+                        MHD_OPTION_CONNECTION_MEMORY_POOL_CACHE,
+                        (unsigned int) 2,
+                        MHD_OPTION_CONNECTION_MEMORY_POOL_SLAB,
+                        (unsigned int) 1,
+                        MHD_OPTION_URI_LOG_CALLBACK, &log_cb, NULL,
+                        MHD_OPTION_END);
+  if (d == NULL)
+    return 16;
+  if (0 == global_port)
+  {
+    const union MHD_DaemonInfo *dinfo;
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d); return 32;
+    }
+    global_port = dinfo->port;
+  }
+  /* Use new connection for every request so the kernel distributes them
+     over the listening sockets of all workers */
+  for (i = 0; i < 4 * MHD_CPU_COUNT; ++i)
+  {
+    cbc.buf = buf;
+    cbc.size = 2048;
+    cbc.pos = 0;
+    c = curl_easy_init ();
+    curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1" EXPECTED_URI_PATH);
+    curl_easy_setopt (c, CURLOPT_PORT, (long) global_port);
+    curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+    curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+    curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+    curl_easy_setopt (c, CURLOPT_FORBID_REUSE, 1L);
+    if (oneone)
+      curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    else
+      curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+    curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+    curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+    if (CURLE_OK != (errornum = curl_easy_perform (c)))
+    {
+      fprintf (stderr,
+               "curl_easy_perform failed: `%s'\n",
+               curl_easy_strerror (errornum));
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 32;
+    }
+    curl_easy_cleanup (c);
+    if (cbc.pos != strlen ("/hello_world"))
+    {
+      MHD_stop_daemon (d);
+      return 64;
+    }
+    if (0 != strncmp ("/hello_world", cbc.buf, strlen ("/hello_world")))
+    {
+      MHD_stop_daemon (d);
+      return 128;
+    }
+  }
+  fd = MHD_quiesce_daemon (d);
+  if (MHD_INVALID_SOCKET == fd)
+  {
+    MHD_stop_daemon (d);
+    return 256;
+  }
+  MHD_stop_daemon (d);
+  MHD_socket_close_chk_ (fd);
+  return 0;
+}
+
+
 static unsigned int
 testExternalGet (int thread_unsafe)
 {
@@ -877,122 +980,1045 @@ testEmptyGet (uint32_t poll_flag)
 }
 
 
-int
-main (int argc, char *const *argv)
+/**
+ * The number of the custom headers sent with the request, large enough
+ * to make MHD build the hash index of the request headers.
+ */
+#define MANY_HDRS_NUM 12
+
+static enum MHD_Result
+ahc_many_headers (void *cls,
+                  struct MHD_Connection *connection,
+                  const char *url,
+                  const char *method,
+                  const char *version,
+                  const char *upload_data,
+                  size_t *upload_data_size,
+                  void **req_cls)
 {
-  unsigned int errorCount = 0;
-  unsigned int test_result = 0;
-  int verbose = 0;
+  static int ptr;
+  struct MHD_Response *response;
+  enum MHD_Result ret;
+  const char *v;
+  unsigned int i;
+  (void) cls;
+  (void) url;
+  (void) version;          /* Unused. Silent compiler warning. */
+  (void) upload_data;
+  (void) upload_data_size; /* Unused. Silent compiler warning. */
 
-  if ((NULL == argv) || (0 == argv[0]))
-    return 99;
-  oneone = has_in_name (argv[0], "11");
-  verbose = has_param (argc, argv, "-v") || has_param (argc, argv, "--verbose");
-  if (0 != curl_global_init (CURL_GLOBAL_WIN32))
-    return 2;
-  global_port = 0;
-  test_result = testExternalGet (! 0);
-  if (test_result)
-    fprintf (stderr, "FAILED: testExternalGet (!0) - %u.\n", test_result);
-  else if (verbose)
-    printf ("PASSED: testExternalGet ().\n");
-  errorCount += test_result;
-  if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_THREADS))
+  if (0 != strcmp ("GET", method))
+    return MHD_NO;              /* unexpected method */
+  if (&ptr != *req_cls)
   {
-    test_result += testExternalGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testExternalGet (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testExternalGet ().\n");
-    errorCount += test_result;
-    test_result += testInternalGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testInternalGet (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testInternalGet (0).\n");
-    errorCount += test_result;
-    test_result += testMultithreadedGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testMultithreadedGet (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testMultithreadedGet (0).\n");
-    errorCount += test_result;
-    test_result += testMultithreadedPoolGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testMultithreadedPoolGet (0) - %u.\n",
-               test_result);
-    else if (verbose)
-      printf ("PASSED: testMultithreadedPoolGet (0).\n");
-    errorCount += test_result;
-    test_result += testUnknownPortGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testUnknownPortGet (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testUnknownPortGet (0).\n");
-    errorCount += test_result;
-    test_result += testStopRace (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testStopRace (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testStopRace (0).\n");
-    errorCount += test_result;
-    test_result += testEmptyGet (0);
-    if (test_result)
-      fprintf (stderr, "FAILED: testEmptyGet (0) - %u.\n", test_result);
-    else if (verbose)
-      printf ("PASSED: testEmptyGet (0).\n");
-    errorCount += test_result;
-    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_POLL))
+    *req_cls = &ptr;
+    return MHD_YES;
+  }
+  *req_cls = NULL;
+  for (i = 0; i < MANY_HDRS_NUM; ++i)
+  {
+    char name[32];
+    char val[32];
+    snprintf (name, sizeof(name), "x-HDR-%u", i);
+    snprintf (val, sizeof(val), "val%u", i);
+    v = MHD_lookup_connection_value (connection, MHD_HEADER_KIND, name);
+    if ((NULL == v) || (0 != strcmp (val, v)))
     {
-      test_result += testInternalGet (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testInternalGet (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testInternalGet (MHD_USE_POLL).\n");
-      errorCount += test_result;
-      test_result += testMultithreadedGet (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testMultithreadedGet (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testMultithreadedGet (MHD_USE_POLL).\n");
-      errorCount += test_result;
-      test_result += testMultithreadedPoolGet (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr,
-                 "FAILED: testMultithreadedPoolGet (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testMultithreadedPoolGet (MHD_USE_POLL).\n");
-      errorCount += test_result;
-      test_result += testUnknownPortGet (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testUnknownPortGet (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testUnknownPortGet (MHD_USE_POLL).\n");
-      errorCount += test_result;
-      test_result += testStopRace (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testStopRace (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testStopRace (MHD_USE_POLL).\n");
-      errorCount += test_result;
-      test_result += testEmptyGet (MHD_USE_POLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testEmptyGet (MHD_USE_POLL) - %u.\n",
-                 test_result);
-      else if (verbose)
-        printf ("PASSED: testEmptyGet (MHD_USE_POLL).\n");
-      errorCount += test_result;
+      fprintf (stderr, "Wrong value of '%s' header: '%s'.\n",
+               name, NULL == v ? "NULL" : v);
+      _exit (21);
     }
-    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_EPOLL))
+  }
+  v = MHD_lookup_connection_value (connection, MHD_HEADER_KIND, "X-Dup");
+  if ((NULL == v) || (0 != strcmp ("first", v)))
+  {
+    fprintf (stderr, "Wrong value of 'X-Dup' header: '%s'.\n",
+             NULL == v ? "NULL" : v);
+    _exit (22);
+  }
+  v = NULL;
+  if ((MHD_YES != MHD_lookup_connection_header_by_id (connection,
+                                                      MHD_HEADER_ID_CONNECTION,
+                                                      &v, NULL)) ||
+      (NULL == v) || (0 != strcmp ("x-custom, close", v)))
+  {
+    fprintf (stderr, "Wrong value of 'Connection' header: '%s'.\n",
+             NULL == v ? "NULL" : v);
+    _exit (27);
+  }
+  if (MHD_NO != MHD_lookup_connection_header_by_id (connection,
+                                                    MHD_HEADER_ID_COOKIE,
+                                                    NULL, NULL))
+  {
+    fprintf (stderr, "Found non-existing 'Cookie' header.\n");
+    _exit (28);
+  }
+  if (NULL != MHD_lookup_connection_value (connection, MHD_HEADER_KIND,
+                                           "X-Missing"))
+  {
+    fprintf (stderr, "Found non-existing header.\n");
+    _exit (23);
+  }
+  if (MHD_YES != MHD_set_connection_value (connection, MHD_HEADER_KIND,
+                                           "X-Added", "added"))
+  {
+    fprintf (stderr, "Failed to add header.\n");
+    _exit (24);
+  }
+  v = MHD_lookup_connection_value (connection, MHD_HEADER_KIND, "x-added");
+  if ((NULL == v) || (0 != strcmp ("added", v)))
+  {
+    fprintf (stderr, "Wrong value of 'X-Added' header: '%s'.\n",
+             NULL == v ? "NULL" : v);
+    _exit (25);
+  }
+  response = MHD_create_response_empty (MHD_RF_NONE);
+  ret = MHD_queue_response (connection,
+                            MHD_HTTP_OK,
+                            response);
+  MHD_destroy_response (response);
+  if (ret == MHD_NO)
+  {
+    fprintf (stderr, "Failed to queue response.\n");
+    _exit (26);
+  }
+  return ret;
+}
+
+
+static size_t
+checkConnCloseHeader (char *buffer, size_t size, size_t nitems, void *cls)
+{
+  static const char hdr[] = "Connection: close";
+  const size_t len = size * nitems;
+
+  if ((len >= sizeof(hdr) - 1) &&
+      (0 == strncmp (hdr, buffer, sizeof(hdr) - 1)))
+    *(int *) cls = 1;
+  return len;
+}
+
+
+static unsigned int
+testManyHeadersGet (uint32_t poll_flag)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  char buf[2048];
+  struct CBC cbc;
+  CURLcode errornum;
+  struct curl_slist *hdrs = NULL;
+  int conn_close_found = 0;
+  unsigned int i;
+
+  if ( (0 == global_port) &&
+       (MHD_NO == MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT)) )
+  {
+    global_port = 1227;
+    if (oneone)
+      global_port += 20;
+  }
+
+  cbc.buf = buf;
+  cbc.size = 2048;
+  cbc.pos = 0;
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | (enum MHD_FLAG) poll_flag,
+                        global_port, NULL, NULL,
+                        &ahc_many_headers, NULL,
+                        MHD_OPTION_END);
+  if (d == NULL)
+    return 67108864;
+  if (0 == global_port)
+  {
+    const union MHD_DaemonInfo *dinfo;
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
     {
-      test_result += testInternalGet (MHD_USE_EPOLL);
-      if (test_result)
-        fprintf (stderr, "FAILED: testInternalGet (MHD_USE_EPOLL) - %u.\n",
+      MHD_stop_daemon (d); return 32;
+    }
+    global_port = dinfo->port;
+  }
+  for (i = 0; i < MANY_HDRS_NUM; ++i)
+  {
+    char hdr[48];
+    snprintf (hdr, sizeof(hdr), "X-Hdr-%u: val%u", i, i);
+    hdrs = curl_slist_append (hdrs, hdr);
+  }
+  hdrs = curl_slist_append (hdrs, "X-Dup: first");
+  hdrs = curl_slist_append (hdrs, "X-Dup: second");
+  hdrs = curl_slist_append (hdrs, "Connection: x-custom, close");
+  if (NULL == hdrs)
+  {
+    MHD_stop_daemon (d);
+    return 134217728;
+  }
+  c = curl_easy_init ();
+  curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1" EXPECTED_URI_PATH);
+  curl_easy_setopt (c, CURLOPT_PORT, (long) global_port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+  curl_easy_setopt (c, CURLOPT_HEADERFUNCTION, &checkConnCloseHeader);
+  curl_easy_setopt (c, CURLOPT_HEADERDATA, &conn_close_found);
+  curl_easy_setopt (c, CURLOPT_HTTPHEADER, hdrs);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  /* NOTE: use of CONNECTTIMEOUT without also
+     setting NOSIGNAL results in really weird
+     crashes on my system!*/
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  if (CURLE_OK != (errornum = curl_easy_perform (c)))
+  {
+    fprintf (stderr,
+             "curl_easy_perform failed: `%s'\n",
+             curl_easy_strerror (errornum));
+    curl_easy_cleanup (c);
+    curl_slist_free_all (hdrs);
+    MHD_stop_daemon (d);
+    return 268435456;
+  }
+  curl_easy_cleanup (c);
+  curl_slist_free_all (hdrs);
+  MHD_stop_daemon (d);
+  if (! conn_close_found)
+    return 536870912;
+  return 0;
+}
+
+
+/**
+ * Check the state of the daemon after the requests.
+ * @param d the daemon to check
+ * @return zero if the check succeeded, the error code otherwise
+ */
+typedef unsigned int (*DaemonCheckCallback)(struct MHD_Daemon *d);
+
+
+/**
+ * Perform several GET requests over one connection to the daemon started
+ * with the given options and check the state of the daemon afterwards.
+ * @param poll_flag the flags for the daemon, in addition to
+ *                  #MHD_USE_INTERNAL_POLLING_THREAD and #MHD_USE_ERROR_LOG
+ * @param options the options for the daemon, terminated by #MHD_OPTION_END
+ * @param num_requests the number of requests to perform
+ * @param check the check of the daemon, called before the daemon is stopped
+ * @return zero if succeed, the error code otherwise
+ */
+static unsigned int
+testCheckedGet (uint32_t poll_flag,
+                const struct MHD_OptionItem *options,
+                unsigned int num_requests,
+                DaemonCheckCallback check)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  char buf[2048];
+  struct CBC cbc;
+  CURLcode errornum;
+  const union MHD_DaemonInfo *dinfo;
+  unsigned int ret;
+  unsigned int i;
+
+  if ( (0 == global_port) &&
+       (MHD_NO == MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT)) )
+  {
+    global_port = 1228;
+    if (oneone)
+      global_port += 20;
+  }
+
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | (enum MHD_FLAG) poll_flag,
+                        global_port, NULL, NULL,
+                        &ahc_echo, NULL,
+                        MHD_OPTION_ARRAY, options,
+                        MHD_OPTION_END);
+  if (d == NULL)
+    return 1;
+  if (0 == global_port)
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d); return 32;
+    }
+    global_port = dinfo->port;
+  }
+  c = curl_easy_init ();
+  curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1" EXPECTED_URI_PATH);
+  curl_easy_setopt (c, CURLOPT_PORT, (long) global_port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  if (oneone)
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  else
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+  /* NOTE: use of CONNECTTIMEOUT without also
+     setting NOSIGNAL results in really weird
+     crashes on my system!*/
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  for (i = 0; i < num_requests; ++i)
+  {
+    cbc.buf = buf;
+    cbc.size = 2048;
+    cbc.pos = 0;
+    if (CURLE_OK != (errornum = curl_easy_perform (c)))
+    {
+      fprintf (stderr,
+               "curl_easy_perform failed: `%s'\n",
+               curl_easy_strerror (errornum));
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 2;
+    }
+    if (cbc.pos != strlen ("/hello_world"))
+    {
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 4;
+    }
+    if (0 != strncmp ("/hello_world", cbc.buf, strlen ("/hello_world")))
+    {
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 8;
+    }
+  }
+  curl_easy_cleanup (c);
+  ret = check (d);
+  MHD_stop_daemon (d);
+  return ret;
+}
+
+
+static unsigned int
+checkEpollStats (struct MHD_Daemon *d)
+{
+  const union MHD_DaemonInfo *dinfo;
+
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_EPOLL_STATS);
+  if (NULL == dinfo)
+    return 16;
+  if ( (0 == dinfo->epoll_stats.wakeups) ||
+       (dinfo->epoll_stats.events < dinfo->epoll_stats.wakeups) ||
+       (0 == dinfo->epoll_stats.full_batches) ||
+       (0 == dinfo->epoll_stats.max_events) )
+  {
+    fprintf (stderr,
+             "Wrong epoll statistics: wakeups %lu, events %lu, "
+             "full batches %lu, max events %u.\n",
+             (unsigned long) dinfo->epoll_stats.wakeups,
+             (unsigned long) dinfo->epoll_stats.events,
+             (unsigned long) dinfo->epoll_stats.full_batches,
+             dinfo->epoll_stats.max_events);
+    return 64;
+  }
+  return 0;
+}
+
+
+/**
+ * Check the batch processing mode with the smallest events array and
+ * the statistics of the event loop.
+ */
+static unsigned int
+testEpollBatchGet (void)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_EPOLL_EVENTS_SIZE, 1, NULL },
+    { MHD_OPTION_EPOLL_BATCH_PROCESSING, 1, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+
+  return testCheckedGet (MHD_USE_EPOLL, options, 3, &checkEpollStats);
+}
+
+
+static unsigned int
+checkBufferStats (struct MHD_Daemon *d)
+{
+  const union MHD_DaemonInfo *dinfo;
+
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BUFFER_STATS);
+  if (NULL == dinfo)
+    return 16;
+  /* The requests are small, the learned size must be much smaller than
+     the default half of the memory pool */
+  if ( (0 == dinfo->buffer_stats.avg_request_size) ||
+       (4096 < dinfo->buffer_stats.avg_request_size) ||
+       (0 == dinfo->buffer_stats.write_grows) )
+  {
+    fprintf (stderr,
+             "Wrong buffers statistics: read grows %lu, read shrinks %lu, "
+             "write grows %lu, average request size %lu.\n",
+             (unsigned long) dinfo->buffer_stats.read_grows,
+             (unsigned long) dinfo->buffer_stats.read_shrinks,
+             (unsigned long) dinfo->buffer_stats.write_grows,
+             (unsigned long) dinfo->buffer_stats.avg_request_size);
+    return 64;
+  }
+  return 0;
+}
+
+
+/**
+ * Check the adaptive sizing of the buffers and the statistics of
+ * the buffers.
+ */
+static unsigned int
+testAdaptiveBuffersGet (uint32_t poll_flag)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_CONNECTION_MEMORY_LIMIT, 32768, NULL },
+    { MHD_OPTION_CONNECTION_ADAPTIVE_BUFFERS, 1, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+
+  return testCheckedGet (poll_flag, options, 4, &checkBufferStats);
+}
+
+
+static unsigned int
+checkDaemonStats (struct MHD_Daemon *d)
+{
+  const union MHD_DaemonInfo *dinfo;
+
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+  if (NULL == dinfo)
+    return 16;
+  /* The reply to the last request could be received by the client before
+     the daemon finished the processing of the request */
+  if ( (0 == dinfo->stats.conns_accepted) ||
+       (3 > dinfo->stats.requests_served) ||
+       (0 == dinfo->stats.bytes_received) ||
+       (0 == dinfo->stats.bytes_sent_send + dinfo->stats.bytes_sent_writev) ||
+       (0 == dinfo->stats.pool_max_used) ||
+       (0 != dinfo->stats.conns_rejected) )
+  {
+    fprintf (stderr,
+             "Wrong daemon statistics: accepted %lu, rejected %lu, "
+             "requests %lu, received %lu, sent %lu, pool used %lu.\n",
+             (unsigned long) dinfo->stats.conns_accepted,
+             (unsigned long) dinfo->stats.conns_rejected,
+             (unsigned long) dinfo->stats.requests_served,
+             (unsigned long) dinfo->stats.bytes_received,
+             (unsigned long) (dinfo->stats.bytes_sent_send
+                              + dinfo->stats.bytes_sent_writev),
+             (unsigned long) dinfo->stats.pool_max_used);
+    return 64;
+  }
+  return 0;
+}
+
+
+/**
+ * Check the statistics of the daemon collected from the worker threads
+ * of the thread pool.
+ */
+static unsigned int
+testDaemonStatsGet (uint32_t poll_flag)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_THREAD_POOL_SIZE, MHD_CPU_COUNT, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+
+  return testCheckedGet (poll_flag, options, 4, &checkDaemonStats);
+}
+
+
+static unsigned int
+checkPhaseHistograms (struct MHD_Daemon *d)
+{
+  const union MHD_DaemonInfo *dinfo;
+  unsigned int i;
+
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_PHASE_HISTOGRAMS);
+  if ((NULL == dinfo) || (NULL == dinfo->phase_histograms))
+    return 16;
+  for (i = 0; i < MHD_REQUEST_PHASE_COUNT; ++i)
+  {
+    const struct MHD_PhaseHistogram *const h =
+      dinfo->phase_histograms->phases + i;
+    uint64_t sum;
+    unsigned int b;
+
+    sum = 0;
+    for (b = 0; b < MHD_PHASE_HISTOGRAM_BUCKETS; ++b)
+      sum += h->buckets[b];
+    if ((sum != h->count) || (h->max_us > h->sum_us))
+    {
+      fprintf (stderr,
+               "Wrong histogram of the phase %u: count %lu, buckets %lu.\n",
+               i, (unsigned long) h->count, (unsigned long) sum);
+      return 64;
+    }
+  }
+  /* The reply to the last request could be received by the client before
+     the daemon finished the processing of the request */
+  if ( (0 == dinfo->phase_histograms->phases
+        [MHD_REQUEST_PHASE_ACCEPT_TO_FIRST_BYTE].count) ||
+       (4 > dinfo->phase_histograms->phases
+        [MHD_REQUEST_PHASE_HEADER_PARSE].count) ||
+       (3 > dinfo->phase_histograms->phases
+        [MHD_REQUEST_PHASE_HANDLER].count) ||
+       (3 > dinfo->phase_histograms->phases
+        [MHD_REQUEST_PHASE_BODY_TRANSMIT].count) )
+  {
+    fprintf (stderr,
+             "Wrong number of the measured phases.\n");
+    return 64;
+  }
+  return 0;
+}
+
+
+/**
+ * Check the timing of the request phases and the histograms of
+ * the phases.
+ */
+static unsigned int
+testPhaseTimingGet (uint32_t poll_flag)
+{
+  const struct MHD_OptionItem options[] = {
+    { MHD_OPTION_CONNECTION_PHASE_TIMING, 1, NULL },
+    { MHD_OPTION_END, 0, NULL }
+  };
+
+  return testCheckedGet (poll_flag, options, 4, &checkPhaseHistograms);
+}
+
+
+/**
+ * The number of suspend/resume cycles for each request
+ */
+#define SUSPEND_CYCLES 5
+
+static enum MHD_Result
+ahc_suspend (void *cls,
+             struct MHD_Connection *connection,
+             const char *url,
+             const char *method,
+             const char *version,
+             const char *upload_data, size_t *upload_data_size,
+             void **req_cls)
+{
+  static int marker;
+  unsigned int *const cycles = (unsigned int *) cls;
+  struct MHD_Response *response;
+  enum MHD_Result ret;
+  (void) version;
+  (void) upload_data;
+  (void) upload_data_size;       /* Unused. Silence compiler warning. */
+
+  if (0 != strcmp (MHD_HTTP_METHOD_GET, method))
+    return MHD_NO;              /* unexpected method */
+  if (&marker != *req_cls)
+  {
+    *req_cls = &marker;
+    *cycles = 0;
+    return MHD_YES;
+  }
+  if (SUSPEND_CYCLES > *cycles)
+  {
+    (*cycles)++;
+    MHD_suspend_connection (connection);
+    /* The second resume must be merged with the first one */
+    MHD_resume_connection (connection);
+    MHD_resume_connection (connection);
+    return MHD_YES;
+  }
+  *req_cls = NULL;
+  response = MHD_create_response_from_buffer_copy (strlen (url),
+                                                   (const void *) url);
+  ret = MHD_queue_response (connection,
+                            MHD_HTTP_OK,
+                            response);
+  MHD_destroy_response (response);
+  if (ret == MHD_NO)
+  {
+    fprintf (stderr, "Failed to queue response.\n");
+    _exit (19);
+  }
+  return ret;
+}
+
+
+static unsigned int
+testSuspendResumeGet (uint32_t poll_flag)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  char buf[2048];
+  struct CBC cbc;
+  CURLcode errornum;
+  const union MHD_DaemonInfo *dinfo;
+  unsigned int cycles;
+  unsigned int i;
+
+  if ( (0 == global_port) &&
+       (MHD_NO == MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT)) )
+  {
+    global_port = 1232;
+    if (oneone)
+      global_port += 20;
+  }
+
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | MHD_ALLOW_SUSPEND_RESUME
+                        | (enum MHD_FLAG) poll_flag,
+                        global_port, NULL, NULL,
+                        &ahc_suspend, &cycles,
+                        MHD_OPTION_END);
+  if (d == NULL)
+    return 1;
+  if (0 == global_port)
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d); return 32;
+    }
+    global_port = dinfo->port;
+  }
+  c = curl_easy_init ();
+  curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1" EXPECTED_URI_PATH);
+  curl_easy_setopt (c, CURLOPT_PORT, (long) global_port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  if (oneone)
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  else
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  for (i = 0; i < 4; ++i)
+  {
+    cbc.buf = buf;
+    cbc.size = 2048;
+    cbc.pos = 0;
+    if (CURLE_OK != (errornum = curl_easy_perform (c)))
+    {
+      fprintf (stderr,
+               "curl_easy_perform failed: `%s'\n",
+               curl_easy_strerror (errornum));
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 2;
+    }
+    if (cbc.pos != strlen ("/hello_world"))
+    {
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      return 4;
+    }
+  }
+  curl_easy_cleanup (c);
+  dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+  if (NULL == dinfo)
+  {
+    MHD_stop_daemon (d);
+    return 16;
+  }
+  /* All resumes are processed before the reply is sent */
+  if ( (4 * SUSPEND_CYCLES != dinfo->stats.suspends) ||
+       (4 * SUSPEND_CYCLES != dinfo->stats.resumes) )
+  {
+    fprintf (stderr,
+             "Wrong number of suspends (%lu) or resumes (%lu).\n",
+             (unsigned long) dinfo->stats.suspends,
+             (unsigned long) dinfo->stats.resumes);
+    MHD_stop_daemon (d);
+    return 64;
+  }
+  MHD_stop_daemon (d);
+  return 0;
+}
+
+
+/**
+ * The size of the data of the zero-copy test responses
+ */
+#define ZC_DATA_SIZE (4 * 1024 * 1024)
+
+/**
+ * The data of the iovec zero-copy test response
+ */
+static char *zc_iov_data;
+
+static void
+zc_fill (char *data)
+{
+  size_t i;
+
+  for (i = 0; i < ZC_DATA_SIZE; ++i)
+    data[i] = (char) ('a' + (i % 23));
+}
+
+
+static enum MHD_Result
+ahc_zerocopy (void *cls,
+              struct MHD_Connection *connection,
+              const char *url,
+              const char *method,
+              const char *version,
+              const char *upload_data, size_t *upload_data_size,
+              void **req_cls)
+{
+  static int marker;
+  struct MHD_Response *response;
+  enum MHD_Result ret;
+  (void) cls;
+  (void) version;
+  (void) upload_data;
+  (void) upload_data_size;       /* Unused. Silence compiler warning. */
+
+  if (0 != strcmp (MHD_HTTP_METHOD_GET, method))
+    return MHD_NO;              /* unexpected method */
+  if (&marker != *req_cls)
+  {
+    *req_cls = &marker;
+    return MHD_YES;
+  }
+  *req_cls = NULL;
+  if (0 == strcmp ("/iov", url))
+  {
+    struct MHD_IoVec iov[2];
+
+    iov[0].iov_base = zc_iov_data;
+    iov[0].iov_len = ZC_DATA_SIZE / 2;
+    iov[1].iov_base = zc_iov_data + ZC_DATA_SIZE / 2;
+    iov[1].iov_len = ZC_DATA_SIZE / 2;
+    response = MHD_create_response_from_iovec (iov, 2, NULL, NULL);
+  }
+  else
+  {
+    char *data;
+
+    /* The data is freed when the response is destroyed, the zero-copy
+       sends must keep the response until the kernel is done */
+    data = (char *) malloc (ZC_DATA_SIZE);
+    if (NULL == data)
+      _exit (20);
+    zc_fill (data);
+    response = MHD_create_response_from_buffer_with_free_callback (
+      ZC_DATA_SIZE, data, &free);
+  }
+  ret = MHD_queue_response (connection,
+                            MHD_HTTP_OK,
+                            response);
+  MHD_destroy_response (response);
+  if (ret == MHD_NO)
+  {
+    fprintf (stderr, "Failed to queue response.\n");
+    _exit (19);
+  }
+  return ret;
+}
+
+
+/**
+ * Check the zero-copy sends of the buffer and the iovec responses.
+ */
+static unsigned int
+testZerocopyGet (uint32_t daemon_flags)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  char *expected;
+  char *buf;
+  struct CBC cbc;
+  CURLcode errornum;
+  const union MHD_DaemonInfo *dinfo;
+  unsigned int ret;
+  unsigned int i;
+
+  if ( (0 == global_port) &&
+       (MHD_NO == MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT)) )
+  {
+    global_port = 1233;
+    if (oneone)
+      global_port += 20;
+  }
+  expected = (char *) malloc (ZC_DATA_SIZE);
+  buf = (char *) malloc (ZC_DATA_SIZE);
+  zc_iov_data = (char *) malloc (ZC_DATA_SIZE);
+  if ((NULL == expected) || (NULL == buf) || (NULL == zc_iov_data))
+  {
+    free (expected);
+    free (buf);
+    free (zc_iov_data);
+    return 1;
+  }
+  zc_fill (expected);
+  zc_fill (zc_iov_data);
+  ret = 0;
+
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | (enum MHD_FLAG) daemon_flags,
+                        global_port, NULL, NULL,
+                        &ahc_zerocopy, NULL,
+                        MHD_OPTION_SEND_ZEROCOPY_THRESHOLD, (size_t) 65536,
+                        MHD_OPTION_END);
+  if (d == NULL)
+    ret = 1;
+  if ((0 == ret) && (0 == global_port))
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+      ret = 32;
+    else
+      global_port = dinfo->port;
+  }
+  if (0 == ret)
+  {
+    c = curl_easy_init ();
+    curl_easy_setopt (c, CURLOPT_PORT, (long) global_port);
+    curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+    curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+    curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+    curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+    if (oneone)
+      curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    else
+      curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+    curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+    for (i = 0; (i < 4) && (0 == ret); ++i)
+    {
+      curl_easy_setopt (c, CURLOPT_URL, (0 == (i % 2)) ?
+                        "http://127.0.0.1/buffer" : "http://127.0.0.1/iov");
+      cbc.buf = buf;
+      cbc.size = ZC_DATA_SIZE;
+      cbc.pos = 0;
+      if (CURLE_OK != (errornum = curl_easy_perform (c)))
+      {
+        fprintf (stderr,
+                 "curl_easy_perform failed: `%s'\n",
+                 curl_easy_strerror (errornum));
+        ret = 2;
+      }
+      else if ( (ZC_DATA_SIZE != cbc.pos) ||
+                (0 != memcmp (expected, buf, ZC_DATA_SIZE)) )
+      {
+        fprintf (stderr,
+                 "Wrong data received, %lu bytes.\n",
+                 (unsigned long) cbc.pos);
+        ret = 4;
+      }
+    }
+    curl_easy_cleanup (c);
+  }
+  if (0 == ret)
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+    if (NULL == dinfo)
+      ret = 16;
+#ifdef HAVE_MSG_ZEROCOPY
+    else if (0 == dinfo->stats.bytes_sent_zerocopy)
+    {
+      fprintf (stderr,
+               "No data sent with MSG_ZEROCOPY, %lu bytes sent by send() "
+               "and %lu bytes by sendmsg().\n",
+               (unsigned long) dinfo->stats.bytes_sent_send,
+               (unsigned long) dinfo->stats.bytes_sent_writev);
+      ret = 64;
+    }
+#endif /* HAVE_MSG_ZEROCOPY */
+  }
+  if (NULL != d)
+    MHD_stop_daemon (d);
+  free (expected);
+  free (buf);
+  free (zc_iov_data);
+  zc_iov_data = NULL;
+  return ret;
+}
+
+
+int
+main (int argc, char *const *argv)
+{
+  unsigned int errorCount = 0;
+  unsigned int test_result = 0;
+  int verbose = 0;
+
+  if ((NULL == argv) || (0 == argv[0]))
+    return 99;
+  oneone = has_in_name (argv[0], "11");
+  verbose = has_param (argc, argv, "-v") || has_param (argc, argv, "--verbose");
+  if (0 != curl_global_init (CURL_GLOBAL_WIN32))
+    return 2;
+  global_port = 0;
+  test_result = testExternalGet (! 0);
+  if (test_result)
+    fprintf (stderr, "FAILED: testExternalGet (!0) - %u.\n", test_result);
+  else if (verbose)
+    printf ("PASSED: testExternalGet ().\n");
+  errorCount += test_result;
+  if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_THREADS))
+  {
+    test_result += testExternalGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testExternalGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testExternalGet ().\n");
+    errorCount += test_result;
+    test_result += testInternalGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testInternalGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testInternalGet (0).\n");
+    errorCount += test_result;
+    test_result += testMultithreadedGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testMultithreadedGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testMultithreadedGet (0).\n");
+    errorCount += test_result;
+    test_result += testMultithreadedPoolGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testMultithreadedPoolGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testMultithreadedPoolGet (0).\n");
+    errorCount += test_result;
+    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_LISTEN_SHARDING))
+    {
+      test_result += testPoolListenGet (0, MHD_LISTEN_SHARDING_REUSEPORT, 0);
+      if (test_result)
+        fprintf (stderr, "FAILED: testPoolListenGet (0, sharding) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testPoolListenGet (0, sharding).\n");
+      errorCount += test_result;
+    }
+    test_result += testUnknownPortGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testUnknownPortGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testUnknownPortGet (0).\n");
+    errorCount += test_result;
+    test_result += testStopRace (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testStopRace (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testStopRace (0).\n");
+    errorCount += test_result;
+    test_result += testEmptyGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testEmptyGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testEmptyGet (0).\n");
+    errorCount += test_result;
+    test_result += testManyHeadersGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testManyHeadersGet (0) - %u.\n", test_result);
+    else if (verbose)
+      printf ("PASSED: testManyHeadersGet (0).\n");
+    errorCount += test_result;
+    test_result += testAdaptiveBuffersGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testAdaptiveBuffersGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testAdaptiveBuffersGet (0).\n");
+    errorCount += test_result;
+    test_result += testDaemonStatsGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testDaemonStatsGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testDaemonStatsGet (0).\n");
+    errorCount += test_result;
+    test_result += testPhaseTimingGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testPhaseTimingGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testPhaseTimingGet (0).\n");
+    errorCount += test_result;
+    test_result += testSuspendResumeGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testSuspendResumeGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testSuspendResumeGet (0).\n");
+    errorCount += test_result;
+    test_result += testZerocopyGet (0);
+    if (test_result)
+      fprintf (stderr, "FAILED: testZerocopyGet (0) - %u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testZerocopyGet (0).\n");
+    errorCount += test_result;
+    test_result += testZerocopyGet (MHD_USE_THREAD_PER_CONNECTION);
+    if (test_result)
+      fprintf (stderr,
+               "FAILED: testZerocopyGet (MHD_USE_THREAD_PER_CONNECTION) - "
+               "%u.\n",
+               test_result);
+    else if (verbose)
+      printf ("PASSED: testZerocopyGet (MHD_USE_THREAD_PER_CONNECTION).\n");
+    errorCount += test_result;
+    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_POLL))
+    {
+      test_result += testInternalGet (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testInternalGet (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testInternalGet (MHD_USE_POLL).\n");
+      errorCount += test_result;
+      test_result += testMultithreadedGet (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testMultithreadedGet (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testMultithreadedGet (MHD_USE_POLL).\n");
+      errorCount += test_result;
+      test_result += testMultithreadedPoolGet (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testMultithreadedPoolGet (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testMultithreadedPoolGet (MHD_USE_POLL).\n");
+      errorCount += test_result;
+      test_result += testUnknownPortGet (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testUnknownPortGet (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testUnknownPortGet (MHD_USE_POLL).\n");
+      errorCount += test_result;
+      test_result += testStopRace (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testStopRace (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testStopRace (MHD_USE_POLL).\n");
+      errorCount += test_result;
+      test_result += testEmptyGet (MHD_USE_POLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testEmptyGet (MHD_USE_POLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testEmptyGet (MHD_USE_POLL).\n");
+      errorCount += test_result;
+    }
+    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_EPOLL))
+    {
+      test_result += testInternalGet (MHD_USE_EPOLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testInternalGet (MHD_USE_EPOLL) - %u.\n",
                  test_result);
       else if (verbose)
         printf ("PASSED: testInternalGet (MHD_USE_EPOLL).\n");
@@ -1005,6 +2031,32 @@ main (int argc, char *const *argv)
       else if (verbose)
         printf ("PASSED: testMultithreadedPoolGet (MHD_USE_EPOLL).\n");
       errorCount += test_result;
+      if (MHD_YES ==
+          MHD_is_feature_supported (MHD_FEATURE_LISTEN_SHARDING))
+      {
+        test_result += testPoolListenGet (MHD_USE_EPOLL,
+                                          MHD_LISTEN_SHARDING_REUSEPORT_CPU,
+                                          0);
+        if (test_result)
+          fprintf (stderr,
+                   "FAILED: testPoolListenGet (MHD_USE_EPOLL, sharding) "
+                   "- %u.\n",
+                   test_result);
+        else if (verbose)
+          printf ("PASSED: testPoolListenGet (MHD_USE_EPOLL, sharding).\n");
+        errorCount += test_result;
+      }
+      test_result += testPoolListenGet (MHD_USE_EPOLL,
+                                        MHD_LISTEN_SHARDING_NONE,
+                                        ! 0);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testPoolListenGet (MHD_USE_EPOLL, exclusive) "
+                 "- %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testPoolListenGet (MHD_USE_EPOLL, exclusive).\n");
+      errorCount += test_result;
       test_result += testUnknownPortGet (MHD_USE_EPOLL);
       if (test_result)
         fprintf (stderr, "FAILED: testUnknownPortGet (MHD_USE_EPOLL) - %u.\n",
@@ -1019,6 +2071,76 @@ main (int argc, char *const *argv)
       else if (verbose)
         printf ("PASSED: testEmptyGet (MHD_USE_EPOLL).\n");
       errorCount += test_result;
+      test_result += testSuspendResumeGet (MHD_USE_EPOLL);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testSuspendResumeGet (MHD_USE_EPOLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testSuspendResumeGet (MHD_USE_EPOLL).\n");
+      errorCount += test_result;
+      test_result += testZerocopyGet (MHD_USE_EPOLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testZerocopyGet (MHD_USE_EPOLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testZerocopyGet (MHD_USE_EPOLL).\n");
+      errorCount += test_result;
+      test_result += testManyHeadersGet (MHD_USE_EPOLL);
+      if (test_result)
+        fprintf (stderr, "FAILED: testManyHeadersGet (MHD_USE_EPOLL) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testManyHeadersGet (MHD_USE_EPOLL).\n");
+      errorCount += test_result;
+      test_result += testEpollBatchGet ();
+      if (test_result)
+        fprintf (stderr, "FAILED: testEpollBatchGet () - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testEpollBatchGet ().\n");
+      errorCount += test_result;
+    }
+    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_IO_URING))
+    {
+      test_result += testInternalGet (MHD_USE_IO_URING);
+      if (test_result)
+        fprintf (stderr, "FAILED: testInternalGet (MHD_USE_IO_URING) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testInternalGet (MHD_USE_IO_URING).\n");
+      errorCount += test_result;
+      test_result += testMultithreadedPoolGet (MHD_USE_IO_URING);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testMultithreadedPoolGet (MHD_USE_IO_URING) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testMultithreadedPoolGet (MHD_USE_IO_URING).\n");
+      errorCount += test_result;
+      test_result += testUnknownPortGet (MHD_USE_IO_URING);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testUnknownPortGet (MHD_USE_IO_URING) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testUnknownPortGet (MHD_USE_IO_URING).\n");
+      errorCount += test_result;
+      test_result += testEmptyGet (MHD_USE_IO_URING);
+      if (test_result)
+        fprintf (stderr, "FAILED: testEmptyGet (MHD_USE_IO_URING) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testEmptyGet (MHD_USE_IO_URING).\n");
+      errorCount += test_result;
+      test_result += testManyHeadersGet (MHD_USE_IO_URING);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testManyHeadersGet (MHD_USE_IO_URING) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testManyHeadersGet (MHD_USE_IO_URING).\n");
+      errorCount += test_result;
     }
   }
   if (0 != errorCount)
@@ -925,6 +925,7 @@ enum testMhdPollType
   testMhdPollBySelect = 0,
   testMhdPollByPoll   = MHD_USE_POLL,
   testMhdPollByEpoll  = MHD_USE_EPOLL,
+  testMhdPollByIoUring = MHD_USE_IO_URING,
   testMhdPollAuto     = MHD_USE_AUTO
 };
 
@@ -1131,6 +1132,26 @@ main (int argc, char *const *argv)
         printf ("PASSED: testInternalGet (testMhdPollByEpoll).\n");
       errorCount += test_result;
     }
+    if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_IO_URING))
+    {
+      test_result = testInternalGet (testMhdPollByIoUring);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testInternalGet (testMhdPollByIoUring) - %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testInternalGet (testMhdPollByIoUring).\n");
+      errorCount += test_result;
+      test_result = testMultithreadedPoolGet (testMhdPollByIoUring);
+      if (test_result)
+        fprintf (stderr,
+                 "FAILED: testMultithreadedPoolGet (testMhdPollByIoUring) "
+                 "- %u.\n",
+                 test_result);
+      else if (verbose)
+        printf ("PASSED: testMultithreadedPoolGet (testMhdPollByIoUring).\n");
+      errorCount += test_result;
+    }
   }
   if (0 != errorCount)
     fprintf (stderr,
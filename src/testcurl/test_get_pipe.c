@@ -0,0 +1,501 @@
+/*
+     This file is part of libmicrohttpd
+     Copyright (C) 2026 Karlson2k (Evgeny Grin)
+
+     libmicrohttpd is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 2, or (at your
+     option) any later version.
+
+     libmicrohttpd is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libmicrohttpd; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file test_get_pipe.c
+ * @brief  Testcase for libmicrohttpd response from pipe
+ *
+ * The data is written to the pipe by a separate thread in portions of
+ * various sizes with pauses, so the pipe is sometimes empty when MHD needs
+ * the next piece of the data.
+ * With HTTP/1.1 the reply is sent with the chunked encoding, with HTTP/1.0
+ * the end of the reply is indicated by closing of the connection.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "MHD_config.h"
+#include "platform.h"
+#include <curl/curl.h>
+#include <microhttpd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include "mhd_has_in_name.h"
+
+#ifndef WINDOWS
+#include <unistd.h>
+#endif
+
+/**
+ * The size of the response body
+ */
+#define BODY_SIZE (700 * 1024 + 123)
+
+static int oneone;
+
+/**
+ * The writer thread, started by the access handler
+ */
+static pthread_t writer_thread;
+
+/**
+ * Set to non-zero when the writer thread is started
+ */
+static volatile int writer_started;
+
+struct CBC
+{
+  char *buf;
+  size_t pos;
+  size_t size;
+};
+
+
+static char
+body_char (size_t pos)
+{
+  return (char) ('a' + (pos * 7 + pos / 1000) % 26);
+}
+
+
+static size_t
+copyBuffer (void *ptr, size_t size, size_t nmemb, void *ctx)
+{
+  struct CBC *cbc = ctx;
+
+  if (cbc->pos + size * nmemb > cbc->size)
+    return 0;                   /* overflow */
+  memcpy (&cbc->buf[cbc->pos], ptr, size * nmemb);
+  cbc->pos += size * nmemb;
+  return size * nmemb;
+}
+
+
+static void *
+pipe_writer (void *cls)
+{
+  static const size_t portions[] = {1, 100, 5000, 64 * 1024, 3, 200 * 1024,
+                                    4096, 17, 100 * 1024};
+  const int fd = *((int *) cls);
+  char *data;
+  size_t pos;
+  unsigned int i;
+
+  free (cls);
+  data = malloc (BODY_SIZE);
+  if (NULL == data)
+    abort ();
+  for (pos = 0; pos < BODY_SIZE; ++pos)
+    data[pos] = body_char (pos);
+
+  pos = 0;
+  i = 0;
+  while (pos < BODY_SIZE)
+  {
+    size_t portion = portions[i % (sizeof(portions) / sizeof(portions[0]))];
+    size_t written;
+    if (BODY_SIZE - pos < portion)
+      portion = BODY_SIZE - pos;
+    written = 0;
+    while (written < portion)
+    {
+      const ssize_t res = write (fd, data + pos + written, portion - written);
+      if (0 > res)
+      {
+        if (EINTR == errno)
+          continue;
+        fprintf (stderr, "write() to the pipe failed: %s\n",
+                 strerror (errno));
+        abort ();
+      }
+      written += (size_t) res;
+    }
+    pos += portion;
+    if (0 == (i % 3))
+      usleep (2000); /* Let the pipe be emptied */
+    i++;
+  }
+  close (fd);
+  free (data);
+  return NULL;
+}
+
+
+static enum MHD_Result
+ahc_echo (void *cls,
+          struct MHD_Connection *connection,
+          const char *url,
+          const char *method,
+          const char *version,
+          const char *upload_data, size_t *upload_data_size,
+          void **req_cls)
+{
+  static int ptr;
+  struct MHD_Response *response;
+  enum MHD_Result ret;
+  int fds[2];
+  int *write_fd;
+  (void) cls;
+  (void) url; (void) version;                      /* Unused. Silent compiler warning. */
+  (void) upload_data; (void) upload_data_size;     /* Unused. Silent compiler warning. */
+
+  if (0 != strcmp (MHD_HTTP_METHOD_GET, method))
+    return MHD_NO;              /* unexpected method */
+  if (&ptr != *req_cls)
+  {
+    *req_cls = &ptr;
+    return MHD_YES;
+  }
+  *req_cls = NULL;
+  if (0 != pipe (fds))
+  {
+    fprintf (stderr, "pipe() failed: %s\n", strerror (errno));
+    abort ();
+  }
+  write_fd = malloc (sizeof(int));
+  if (NULL == write_fd)
+    abort ();
+  *write_fd = fds[1];
+  if (0 != pthread_create (&writer_thread, NULL, &pipe_writer, write_fd))
+    abort ();
+  writer_started = ! 0;
+  response = MHD_create_response_from_pipe (fds[0]);
+  if (NULL == response)
+    abort ();
+  ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+  MHD_destroy_response (response);
+  if (ret == MHD_NO)
+    abort ();
+  return ret;
+}
+
+
+static CURL *
+setupCURL (void *cbc, uint16_t port)
+{
+  CURL *c;
+
+  c = curl_easy_init ();
+  if (NULL == c)
+    abort ();
+  curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1/");
+  curl_easy_setopt (c, CURLOPT_PORT, (long) port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, cbc);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  if (oneone)
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  else
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+  /* NOTE: use of CONNECTTIMEOUT without also
+     setting NOSIGNAL results in really weird
+     crashes on my system!*/
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  return c;
+}
+
+
+static unsigned int
+checkResult (const struct CBC *cbc)
+{
+  size_t pos;
+
+  if (writer_started)
+  {
+    if (0 != pthread_join (writer_thread, NULL))
+      abort ();
+    writer_started = 0;
+  }
+  if (cbc->pos != BODY_SIZE)
+  {
+    fprintf (stderr, "Got %u bytes instead of %u bytes.\n",
+             (unsigned int) cbc->pos, (unsigned int) BODY_SIZE);
+    return 1;
+  }
+  for (pos = 0; pos < BODY_SIZE; ++pos)
+  {
+    if (body_char (pos) != cbc->buf[pos])
+    {
+      fprintf (stderr, "Wrong data at position %u.\n", (unsigned int) pos);
+      return 2;
+    }
+  }
+  return 0;
+}
+
+
+static unsigned int
+testInternalGet (unsigned int flags)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  struct CBC cbc;
+  CURLcode errornum;
+  uint16_t port;
+  unsigned int ret;
+
+  if (MHD_NO != MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT))
+    port = 0;
+  else
+  {
+    port = 1250;
+    if (oneone)
+      port += 10;
+    if (0 != (flags & MHD_USE_THREAD_PER_CONNECTION))
+      port += 1;
+  }
+
+  cbc.buf = malloc (BODY_SIZE + 1);
+  if (NULL == cbc.buf)
+    abort ();
+  cbc.size = BODY_SIZE + 1;
+  cbc.pos = 0;
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | flags,
+                        port, NULL, NULL, &ahc_echo, NULL, MHD_OPTION_END);
+  if (d == NULL)
+  {
+    free (cbc.buf);
+    return 16;
+  }
+  if (0 == port)
+  {
+    const union MHD_DaemonInfo *dinfo;
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d);
+      free (cbc.buf);
+      return 32;
+    }
+    port = dinfo->port;
+  }
+  c = setupCURL (&cbc, port);
+  if (CURLE_OK != (errornum = curl_easy_perform (c)))
+  {
+    fprintf (stderr,
+             "curl_easy_perform failed: `%s'\n",
+             curl_easy_strerror (errornum));
+    curl_easy_cleanup (c);
+    MHD_stop_daemon (d);
+    free (cbc.buf);
+    return 64;
+  }
+  curl_easy_cleanup (c);
+  MHD_stop_daemon (d);
+  ret = checkResult (&cbc);
+  free (cbc.buf);
+  return ret ? 128 : 0;
+}
+
+
+static unsigned int
+testExternalGet (void)
+{
+  struct MHD_Daemon *d;
+  CURL *c;
+  struct CBC cbc;
+  CURLM *multi;
+  CURLMcode mret;
+  fd_set rs;
+  fd_set ws;
+  fd_set es;
+  MHD_socket maxsock;
+  int maxposixs;
+  int running;
+  struct CURLMsg *msg;
+  time_t start;
+  struct timeval tv;
+  uint16_t port;
+  unsigned int ret;
+
+  if (MHD_NO != MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT))
+    port = 0;
+  else
+  {
+    port = 1252;
+    if (oneone)
+      port += 10;
+  }
+
+  multi = NULL;
+  cbc.buf = malloc (BODY_SIZE + 1);
+  if (NULL == cbc.buf)
+    abort ();
+  cbc.size = BODY_SIZE + 1;
+  cbc.pos = 0;
+  /* SIGPIPE is ignored by the application */
+  d = MHD_start_daemon (MHD_USE_ERROR_LOG,
+                        port, NULL, NULL, &ahc_echo, NULL,
+                        MHD_OPTION_APP_FD_SETSIZE, (int) FD_SETSIZE,
+                        MHD_OPTION_SIGPIPE_HANDLED_BY_APP, 1,
+                        MHD_OPTION_END);
+  if (d == NULL)
+  {
+    free (cbc.buf);
+    return 256;
+  }
+  if (0 == port)
+  {
+    const union MHD_DaemonInfo *dinfo;
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d);
+      free (cbc.buf);
+      return 32;
+    }
+    port = dinfo->port;
+  }
+  c = setupCURL (&cbc, port);
+
+  multi = curl_multi_init ();
+  if (multi == NULL)
+  {
+    curl_easy_cleanup (c);
+    MHD_stop_daemon (d);
+    free (cbc.buf);
+    return 512;
+  }
+  mret = curl_multi_add_handle (multi, c);
+  if (mret != CURLM_OK)
+  {
+    curl_multi_cleanup (multi);
+    curl_easy_cleanup (c);
+    MHD_stop_daemon (d);
+    free (cbc.buf);
+    return 1024;
+  }
+  start = time (NULL);
+  while ((time (NULL) - start < 15) && (multi != NULL))
+  {
+    maxsock = MHD_INVALID_SOCKET;
+    maxposixs = -1;
+    FD_ZERO (&rs);
+    FD_ZERO (&ws);
+    FD_ZERO (&es);
+    curl_multi_perform (multi, &running);
+    mret = curl_multi_fdset (multi, &rs, &ws, &es, &maxposixs);
+    if (mret != CURLM_OK)
+    {
+      curl_multi_remove_handle (multi, c);
+      curl_multi_cleanup (multi);
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      free (cbc.buf);
+      return 2048;
+    }
+    if (MHD_YES != MHD_get_fdset (d, &rs, &ws, &es, &maxsock))
+    {
+      curl_multi_remove_handle (multi, c);
+      curl_multi_cleanup (multi);
+      curl_easy_cleanup (c);
+      MHD_stop_daemon (d);
+      free (cbc.buf);
+      return 4096;
+    }
+    if (maxposixs < (int) maxsock)
+      maxposixs = (int) maxsock;
+    tv.tv_sec = 0;
+    tv.tv_usec = 1000;
+    if (-1 == select (maxposixs + 1, &rs, &ws, &es, &tv))
+    {
+      if (EINTR != errno)
+      {
+        fprintf (stderr, "Unexpected select() error: %d. Line: %d\n",
+                 (int) errno, __LINE__);
+        fflush (stderr);
+        exit (99);
+      }
+    }
+    curl_multi_perform (multi, &running);
+    if (0 == running)
+    {
+      int pending;
+      int curl_fine = 0;
+      while (NULL != (msg = curl_multi_info_read (multi, &pending)))
+      {
+        if (msg->msg == CURLMSG_DONE)
+        {
+          if (msg->data.result == CURLE_OK)
+            curl_fine = 1;
+          else
+          {
+            fprintf (stderr,
+                     "%s failed at %s:%d: `%s'\n",
+                     "curl_multi_perform",
+                     __FILE__,
+                     __LINE__, curl_easy_strerror (msg->data.result));
+            abort ();
+          }
+        }
+      }
+      if (! curl_fine)
+      {
+        fprintf (stderr, "libcurl haven't returned OK code\n");
+        abort ();
+      }
+      curl_multi_remove_handle (multi, c);
+      curl_multi_cleanup (multi);
+      curl_easy_cleanup (c);
+      c = NULL;
+      multi = NULL;
+    }
+    MHD_run (d);
+  }
+  if (multi != NULL)
+  {
+    curl_multi_remove_handle (multi, c);
+    curl_easy_cleanup (c);
+    curl_multi_cleanup (multi);
+  }
+  MHD_stop_daemon (d);
+  ret = checkResult (&cbc);
+  free (cbc.buf);
+  return ret ? 8192 : 0;
+}
+
+
+int
+main (int argc, char *const *argv)
+{
+  unsigned int errorCount = 0;
+  (void) argc;   /* Unused. Silent compiler warning. */
+
+  if ((NULL == argv) || (0 == argv[0]))
+    return 99;
+  oneone = has_in_name (argv[0], "11");
+#ifdef SIGPIPE
+  signal (SIGPIPE, SIG_IGN);
+#endif /* SIGPIPE */
+  if (0 != curl_global_init (CURL_GLOBAL_WIN32))
+    return 2;
+  errorCount += testInternalGet (0);
+  errorCount += testInternalGet (MHD_USE_THREAD_PER_CONNECTION);
+  errorCount += testExternalGet ();
+  if (errorCount != 0)
+    fprintf (stderr, "Error (code: %u)\n", errorCount);
+  curl_global_cleanup ();
+  return (0 == errorCount) ? 0 : 1;       /* 0 == pass */
+}
@@ -53,8 +53,22 @@
 #define TESTSTR \
   "This is the content of the test file we are sending using sendfile (if available)"
 
+/**
+ * The size of the file used to fill the socket send buffer
+ */
+#define LARGE_SIZE (1024 * 1024)
+
+/**
+ * The size of the socket send and receive buffers for the large file
+ */
+#define LARGE_SOCK_BUF (16 * 1024)
+
 static char *sourcefile;
 
+static char *largefile;
+
+static uint8_t *largedata;
+
 static int oneone;
 
 struct CBC
@@ -79,21 +93,16 @@ copyBuffer (void *ptr, size_t size, size_t nmemb, void *ctx)
 
 
 static enum MHD_Result
-ahc_echo (void *cls,
-          struct MHD_Connection *connection,
-          const char *url,
-          const char *method,
-          const char *version,
-          const char *upload_data, size_t *upload_data_size,
-          void **req_cls)
+queue_file (struct MHD_Connection *connection,
+            const char *method,
+            void **req_cls,
+            const char *filename,
+            size_t size)
 {
   static int ptr;
   struct MHD_Response *response;
   enum MHD_Result ret;
   int fd;
-  (void) cls;
-  (void) url; (void) version;                      /* Unused. Silent compiler warning. */
-  (void) upload_data; (void) upload_data_size;     /* Unused. Silent compiler warning. */
 
   if (0 != strcmp (MHD_HTTP_METHOD_GET, method))
     return MHD_NO;              /* unexpected method */
@@ -103,15 +112,15 @@ ahc_echo (void *cls,
     return MHD_YES;
   }
   *req_cls = NULL;
-  fd = open (sourcefile, O_RDONLY);
+  fd = open (filename, O_RDONLY);
   if (fd == -1)
   {
     fprintf (stderr, "Failed to open `%s': %s\n",
-             sourcefile,
+             filename,
              strerror (errno));
     exit (1);
   }
-  response = MHD_create_response_from_fd (strlen (TESTSTR), fd);
+  response = MHD_create_response_from_fd (size, fd);
   ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
   MHD_destroy_response (response);
   if (ret == MHD_NO)
@@ -120,6 +129,85 @@ ahc_echo (void *cls,
 }
 
 
+static enum MHD_Result
+ahc_echo (void *cls,
+          struct MHD_Connection *connection,
+          const char *url,
+          const char *method,
+          const char *version,
+          const char *upload_data, size_t *upload_data_size,
+          void **req_cls)
+{
+  (void) cls;
+  (void) url; (void) version;                      /* Unused. Silent compiler warning. */
+  (void) upload_data; (void) upload_data_size;     /* Unused. Silent compiler warning. */
+
+  return queue_file (connection, method, req_cls,
+                     sourcefile, strlen (TESTSTR));
+}
+
+
+static enum MHD_Result
+ahc_large (void *cls,
+           struct MHD_Connection *connection,
+           const char *url,
+           const char *method,
+           const char *version,
+           const char *upload_data, size_t *upload_data_size,
+           void **req_cls)
+{
+  (void) cls;
+  (void) url; (void) version;                      /* Unused. Silent compiler warning. */
+  (void) upload_data; (void) upload_data_size;     /* Unused. Silent compiler warning. */
+
+  return queue_file (connection, method, req_cls,
+                     largefile, LARGE_SIZE);
+}
+
+
+static void
+set_sock_buf (MHD_socket sock,
+              int optname)
+{
+  int size = LARGE_SOCK_BUF;
+
+  /* Errors are ignored, the default buffers just make the check weaker */
+  (void) setsockopt (sock, SOL_SOCKET, optname,
+                     (const void *) &size, sizeof(size));
+}
+
+
+static void
+notify_conn_small_sndbuf (void *cls,
+                          struct MHD_Connection *connection,
+                          void **socket_context,
+                          enum MHD_ConnectionNotificationCode toe)
+{
+  const union MHD_ConnectionInfo *cinfo;
+  (void) cls; (void) socket_context; /* Unused. Silent compiler warning. */
+
+  if (MHD_CONNECTION_NOTIFY_STARTED != toe)
+    return;
+  cinfo = MHD_get_connection_info (connection,
+                                   MHD_CONNECTION_INFO_CONNECTION_FD);
+  if (NULL != cinfo)
+    set_sock_buf (cinfo->connect_fd, SO_SNDBUF);
+}
+
+
+static int
+sockopt_small_rcvbuf (void *clientp,
+                      curl_socket_t curlfd,
+                      curlsocktype purpose)
+{
+  (void) clientp; /* Unused. Silent compiler warning. */
+
+  if (CURLSOCKTYPE_IPCXN == purpose)
+    set_sock_buf ((MHD_socket) curlfd, SO_RCVBUF);
+  return CURL_SOCKOPT_OK;
+}
+
+
 static unsigned int
 testInternalGet (void)
 {
@@ -619,6 +707,107 @@ testUnknownPortGet (void)
 }
 
 
+/**
+ * Send the large file with the small socket buffers, so the sendfile()
+ * calls fill the send buffer and the adaptive chunks are used.
+ */
+static unsigned int
+testAdaptiveChunkGet (void)
+{
+  struct MHD_Daemon *d;
+  const union MHD_DaemonInfo *dinfo;
+  CURL *c;
+  struct CBC cbc;
+  CURLcode errornum;
+  uint16_t port;
+  unsigned int ret;
+
+  if (MHD_NO != MHD_is_feature_supported (MHD_FEATURE_AUTODETECT_BIND_PORT))
+    port = 0;
+  else
+  {
+    port = 1204;
+    if (oneone)
+      port += 10;
+  }
+
+  cbc.buf = malloc (LARGE_SIZE);
+  if (NULL == cbc.buf)
+    return 4194304;
+  cbc.size = LARGE_SIZE;
+  cbc.pos = 0;
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG,
+                        port, NULL, NULL, &ahc_large, NULL,
+                        MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK, (int) 1,
+                        MHD_OPTION_NOTIFY_CONNECTION,
+                        &notify_conn_small_sndbuf, NULL,
+                        MHD_OPTION_END);
+  if (d == NULL)
+  {
+    free (cbc.buf);
+    return 4194304;
+  }
+  if (0 == port)
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+    if ((NULL == dinfo) || (0 == dinfo->port) )
+    {
+      MHD_stop_daemon (d); free (cbc.buf); return 32;
+    }
+    port = dinfo->port;
+  }
+  c = curl_easy_init ();
+  curl_easy_setopt (c, CURLOPT_URL, "http://127.0.0.1/");
+  curl_easy_setopt (c, CURLOPT_PORT, (long) port);
+  curl_easy_setopt (c, CURLOPT_WRITEFUNCTION, &copyBuffer);
+  curl_easy_setopt (c, CURLOPT_WRITEDATA, &cbc);
+  curl_easy_setopt (c, CURLOPT_SOCKOPTFUNCTION, &sockopt_small_rcvbuf);
+  curl_easy_setopt (c, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt (c, CURLOPT_TIMEOUT, 150L);
+  curl_easy_setopt (c, CURLOPT_CONNECTTIMEOUT, 150L);
+  if (oneone)
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  else
+    curl_easy_setopt (c, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
+  /* NOTE: use of CONNECTTIMEOUT without also
+     setting NOSIGNAL results in really weird
+     crashes on my system!*/
+  curl_easy_setopt (c, CURLOPT_NOSIGNAL, 1L);
+  if (CURLE_OK != (errornum = curl_easy_perform (c)))
+  {
+    fprintf (stderr,
+             "curl_easy_perform failed: `%s'\n",
+             curl_easy_strerror (errornum));
+    curl_easy_cleanup (c);
+    MHD_stop_daemon (d);
+    free (cbc.buf);
+    return 8388608;
+  }
+  curl_easy_cleanup (c);
+  ret = 0;
+  if (cbc.pos != LARGE_SIZE)
+    ret |= 16777216;
+  else if (0 != memcmp (largedata, cbc.buf, LARGE_SIZE))
+    ret |= 33554432;
+#ifdef __linux__
+  /* The response is larger than the socket buffers, at least one
+     sendfile() call must have filled the send buffer */
+  if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_SENDFILE))
+  {
+    dinfo = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+    if ((NULL == dinfo) || (0 == dinfo->stats.sendfile_partial))
+    {
+      fprintf (stderr, "No partial sendfile() calls have been counted.\n");
+      ret |= 67108864;
+    }
+  }
+#endif /* __linux__ */
+  MHD_stop_daemon (d);
+  free (cbc.buf);
+  return ret;
+}
+
+
 int
 main (int argc, char *const *argv)
 {
@@ -653,6 +842,38 @@ main (int argc, char *const *argv)
       fwrite (TESTSTR, strlen (TESTSTR), 1, f))
     abort ();
   fclose (f);
+  largefile = malloc (strlen (tmp) + 32);
+  largedata = malloc (LARGE_SIZE);
+  if ((NULL == largefile) || (NULL == largedata))
+    abort ();
+  snprintf (largefile,
+            strlen (tmp) + 32,
+            "%s/%s%s",
+            tmp,
+            "test-mhd-sendfile-large",
+            oneone ? "11" : "");
+  if (1)
+  {
+    size_t i;
+    /* The pattern does not repeat with the period of any power of two
+       smaller than the file, so a misplaced chunk is detected */
+    for (i = 0; i < LARGE_SIZE; ++i)
+      largedata[i] = (uint8_t) (i ^ (i >> 8) ^ (i >> 16));
+  }
+  f = fopen (largefile, "wb");
+  if (NULL == f)
+  {
+    fprintf (stderr, "failed to write test file\n");
+    unlink (sourcefile);
+    free (sourcefile);
+    free (largefile);
+    free (largedata);
+    return 1;
+  }
+  if (1 !=
+      fwrite (largedata, LARGE_SIZE, 1, f))
+    abort ();
+  fclose (f);
   if (0 != curl_global_init (CURL_GLOBAL_WIN32))
     return 2;
   if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_THREADS))
@@ -662,12 +883,16 @@ main (int argc, char *const *argv)
     errorCount += testMultithreadedPoolGet ();
     errorCount += testUnknownPortGet ();
     errorCount += testExternalGet (0);
+    errorCount += testAdaptiveChunkGet ();
   }
   errorCount += testExternalGet (! 0);
   if (errorCount != 0)
     fprintf (stderr, "Error (code: %u)\n", errorCount);
   curl_global_cleanup ();
   unlink (sourcefile);
+  unlink (largefile);
   free (sourcefile);
+  free (largefile);
+  free (largedata);
   return (0 == errorCount) ? 0 : 1;       /* 0 == pass */
 }
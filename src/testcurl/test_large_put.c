@@ -871,6 +871,19 @@ main (int argc, char *const *argv)
                  "Error during testing with thread pool per connection with epoll.\n");
       errorCount += lastErr;
     }
+    if (MHD_is_feature_supported (MHD_FEATURE_IO_URING))
+    {
+      lastErr = testPutInternalThread (MHD_USE_IO_URING);
+      if (verbose && (0 != lastErr) )
+        fprintf (stderr,
+                 "Error during testing with internal thread with io_uring.\n");
+      errorCount += lastErr;
+      lastErr = testPutThreadPool (MHD_USE_IO_URING);
+      if (verbose && (0 != lastErr) )
+        fprintf (stderr,
+                 "Error during testing with thread pool per connection with io_uring.\n");
+      errorCount += lastErr;
+    }
   }
   free (put_buffer);
   if (errorCount != 0)
@@ -85,6 +85,12 @@ static int withTimeout = 0;
 
 static int withoutTimeout = 0;
 
+/**
+ * The timeout to be set for the connection by #MHD_set_connection_option(),
+ * zero to use the daemon's timeout.
+ */
+static unsigned int connTimeout = 0;
+
 struct CBC
 {
   char *buf;
@@ -199,6 +205,13 @@ ahc_echo (void *cls,
 
   if (0 != strcmp (MHD_HTTP_METHOD_PUT, method))
     return MHD_NO;              /* unexpected method */
+  if (0 != connTimeout)
+  {
+    if (MHD_YES != MHD_set_connection_option (connection,
+                                              MHD_CONNECTION_OPTION_TIMEOUT,
+                                              connTimeout))
+      return MHD_NO;
+  }
   if ((*done) == 0)
   {
     if (*upload_data_size != 8)
@@ -311,7 +324,9 @@ testWithoutTimeout (void)
 
 
 static unsigned int
-testWithTimeout (void)
+testWithTimeout (uint32_t poll_flag,
+                 unsigned int conn_timeout,
+                 int coarse_time)
 {
   struct MHD_Daemon *d;
   CURL *c;
@@ -333,10 +348,14 @@ testWithTimeout (void)
   cbc.buf = buf;
   cbc.size = 2048;
   cbc.pos = 0;
-  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG,
+  connTimeout = conn_timeout;
+  d = MHD_start_daemon (MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_ERROR_LOG
+                        | (enum MHD_FLAG) poll_flag,
                         port,
                         NULL, NULL, &ahc_echo, &done_flag,
-                        MHD_OPTION_CONNECTION_TIMEOUT, 2,
+                        MHD_OPTION_CONNECTION_TIMEOUT,
+                        (0 == conn_timeout) ? 2 : 120,
+                        MHD_OPTION_COARSE_ACTIVITY_TIME, coarse_time,
                         MHD_OPTION_NOTIFY_COMPLETED, &termination_cb,
                         &withTimeout,
                         MHD_OPTION_END);
@@ -417,7 +436,15 @@ main (int argc, char *const *argv)
   if (0 != curl_global_init (CURL_GLOBAL_WIN32))
     return 16;
   errorCount += testWithoutTimeout ();
-  errorCount += testWithTimeout ();
+  errorCount += testWithTimeout (0, 0, 0);
+  errorCount += testWithTimeout (0, 2, 0);
+  errorCount += testWithTimeout (0, 0, 1);
+  if (MHD_YES == MHD_is_feature_supported (MHD_FEATURE_EPOLL))
+  {
+    errorCount += testWithTimeout (MHD_USE_EPOLL, 0, 0);
+    errorCount += testWithTimeout (MHD_USE_EPOLL, 2, 0);
+    errorCount += testWithTimeout (MHD_USE_EPOLL, 0, 1);
+  }
   if (errorCount != 0)
     fprintf (stderr,
              "Error during test execution (code: %u)\n",
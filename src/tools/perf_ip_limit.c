@@ -0,0 +1,581 @@
+/*
+    This file is part of GNU libmicrohttpd
+    Copyright (C) 2026 Evgeny Grin (Karlson2k)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice unmodified, this list of conditions and the following
+       disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+    INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+ * @file tools/perf_ip_limit.c
+ * @brief  Benchmark of the per-IP connection limit.
+ *
+ * The first part measures the table of the connection counters directly:
+ * several threads add and remove connections for many distinct addresses
+ * from 127.0.0.0/8.  The table is compared with the global mutex and
+ * the binary tree (tsearch()), used previously.
+ * The second part runs the daemon with the thread pool and
+ * #MHD_OPTION_PER_IP_CONNECTION_LIMIT, the client threads open the
+ * connections from the different addresses of the loopback /8 network
+ * (the client sockets are bound to 127.x.y.z before connecting).
+ * The loopback addresses other than 127.0.0.1 are usable without any
+ * configuration on Linux only.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <search.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "microhttpd.h"
+#include "mhd_iplimit.h"
+#include "mhd_tool_str_to_uint.h"
+
+#define PERF_IPLIM_ERR_CODE_BAD_PARAM 65
+#define PERF_IPLIM_ERR_CODE_FAILED 99
+
+#define PERF_IPLIM_MAX_THREADS 256
+
+/* Settings */
+static unsigned int num_threads = 8;
+static unsigned int num_iterations = 1000000;
+static unsigned int num_addresses = 65536;
+static unsigned int num_connections = 2000;
+
+/**
+ * The per-IP limit used for the checks
+ */
+#define PERF_IPLIM_LIMIT 4
+
+
+static void
+show_help (const char *self_name)
+{
+  printf ("Usage: %s [OPTIONS]\n", self_name);
+  printf ("Measure the speed of the per-IP connection limit.\n\n");
+  printf ("  -t, --threads=NUM     the number of threads (default: %u)\n",
+          num_threads);
+  printf ("  -n, --iterations=NUM  the number of table operations per "
+          "thread (default: %u)\n", num_iterations);
+  printf ("  -a, --addresses=NUM   the number of distinct client addresses "
+          "(default: %u)\n", num_addresses);
+  printf ("  -c, --connections=NUM the number of connections per client "
+          "thread, zero to skip (default: %u)\n", num_connections);
+  printf ("  -h, --help            show this help\n");
+}
+
+
+/**
+ * Get the value of the parameter
+ * @return pointer to the value, NULL if @a argv[*pi] is not @a short_name
+ *         nor @a long_name
+ */
+static const char *
+get_param_value (int argc, char *const *argv, int *pi,
+                 const char *short_name, const char *long_name)
+{
+  const char *const arg = argv[*pi];
+  const size_t long_len = strlen (long_name);
+
+  if ((0 == strcmp (arg, short_name)) && (*pi + 1 < argc))
+    return argv[++(*pi)];
+  if ((0 == strncmp (arg, long_name, long_len)) && ('=' == arg[long_len]))
+    return arg + long_len + 1;
+  return NULL;
+}
+
+
+static int
+process_params (int argc, char *const *argv)
+{
+  int i;
+  for (i = 1; i < argc; ++i)
+  {
+    const char *val;
+    unsigned int *pvar;
+    if ((0 == strcmp (argv[i], "-h")) || (0 == strcmp (argv[i], "--help")))
+    {
+      show_help (argv[0]);
+      exit (0);
+    }
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-t",
+                                             "--threads")))
+      pvar = &num_threads;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-n",
+                                             "--iterations")))
+      pvar = &num_iterations;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-a",
+                                             "--addresses")))
+      pvar = &num_addresses;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-c",
+                                             "--connections")))
+      pvar = &num_connections;
+    else
+    {
+      fprintf (stderr, "Unrecognised parameter: '%s'.\n", argv[i]);
+      return PERF_IPLIM_ERR_CODE_BAD_PARAM;
+    }
+    if (mhd_tool_str_to_uint (val, pvar) != strlen (val))
+    {
+      fprintf (stderr, "Wrong value: '%s'.\n", val);
+      return PERF_IPLIM_ERR_CODE_BAD_PARAM;
+    }
+  }
+  if ((0 == num_threads) || (PERF_IPLIM_MAX_THREADS < num_threads))
+  {
+    fprintf (stderr, "The number of threads must be from 1 to %u.\n",
+             (unsigned int) PERF_IPLIM_MAX_THREADS);
+    return PERF_IPLIM_ERR_CODE_BAD_PARAM;
+  }
+  if ((0 == num_addresses) || (0xFFFFFFU < num_addresses))
+  {
+    fprintf (stderr, "The number of addresses must be from 1 to %u.\n",
+             0xFFFFFFU);
+    return PERF_IPLIM_ERR_CODE_BAD_PARAM;
+  }
+  return 0;
+}
+
+
+static uint64_t
+get_time_nsec (void)
+{
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return ((uint64_t) ts.tv_sec) * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif /* CLOCK_MONOTONIC */
+  (void) ts;
+  return ((uint64_t) time (NULL)) * 1000000000;
+}
+
+
+/**
+ * Get the IPv4 address number @a num from 127.0.0.0/8 network
+ * in network byte order, 127.0.0.1 is number zero.
+ */
+static uint32_t
+get_addr (uint32_t num)
+{
+  return htonl ((UINT32_C (127) << 24) + ((num + 1) & 0xFFFFFFU));
+}
+
+
+static void
+make_key (struct MHD_IPLimitKey_ *key, uint32_t num)
+{
+  memset (key, 0, sizeof(*key));
+  key->family = AF_INET;
+  key->addr.ipv4.s_addr = get_addr (num);
+}
+
+
+/**
+ * Simple deterministic pseudo-random generator.
+ */
+static uint32_t
+next_rnd (uint32_t *state)
+{
+  *state = *state * 1103515245u + 12345u;
+  return (*state >> 8);
+}
+
+
+/* The reference implementation: the global mutex and the binary tree */
+
+struct RefIPCount
+{
+  struct MHD_IPLimitKey_ key;
+  unsigned int count;
+};
+
+static void *ref_tree = NULL;
+static pthread_mutex_t ref_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+ref_compare (const void *a1, const void *a2)
+{
+  return memcmp (a1, a2, sizeof(struct MHD_IPLimitKey_));
+}
+
+
+static int
+ref_add (const struct MHD_IPLimitKey_ *key)
+{
+  struct RefIPCount *newkey;
+  struct RefIPCount **node;
+  int res;
+
+  newkey = (struct RefIPCount *) malloc (sizeof(*newkey));
+  if (NULL == newkey)
+    return 0;
+  newkey->key = *key;
+  newkey->count = 0;
+  pthread_mutex_lock (&ref_mutex);
+  node = (struct RefIPCount **) tsearch (newkey, &ref_tree, &ref_compare);
+  if (NULL == node)
+    res = 0;
+  else
+  {
+    res = ((*node)->count < PERF_IPLIM_LIMIT);
+    if (res)
+      (*node)->count++;
+  }
+  pthread_mutex_unlock (&ref_mutex);
+  if ((NULL == node) || (*node != newkey))
+    free (newkey);
+  return res;
+}
+
+
+static void
+ref_del (const struct MHD_IPLimitKey_ *key)
+{
+  struct RefIPCount **node;
+  struct RefIPCount *found = NULL;
+
+  pthread_mutex_lock (&ref_mutex);
+  node = (struct RefIPCount **) tfind (key, &ref_tree, &ref_compare);
+  if ((NULL != node) && (0 == --(*node)->count))
+  {
+    found = *node;
+    tdelete (found, &ref_tree, &ref_compare);
+  }
+  pthread_mutex_unlock (&ref_mutex);
+  free (found);
+}
+
+
+static struct MHD_IPLimitTable_ *table;
+
+static volatile unsigned int table_errors;
+
+/**
+ * Count the connection.
+ * @return non-zero if the connection has been counted
+ */
+static int
+conn_add (int use_ref, const struct MHD_IPLimitKey_ *key)
+{
+  enum MHD_IPLimitResult_ res;
+
+  if (use_ref)
+    return ref_add (key);
+  res = MHD_iplimit_add_ (table, key, PERF_IPLIM_LIMIT);
+  if (MHD_IPLIMIT_NO_SPACE_ == res)
+    table_errors++;
+  return (MHD_IPLIMIT_OK_ == res);
+}
+
+
+/**
+ * Remove the counted connection.
+ */
+static void
+conn_del (int use_ref, const struct MHD_IPLimitKey_ *key)
+{
+  if (use_ref)
+    ref_del (key);
+  else if (! MHD_iplimit_del_ (table, key))
+    table_errors++;
+}
+
+
+/**
+ * The thread function for the table checks.
+ * Every thread keeps up to #PERF_IPLIM_LIMIT connections open and
+ * replaces the oldest connection with the new one on every iteration.
+ * @param cls non-NULL to check the reference implementation
+ */
+static void *
+table_thread (void *cls)
+{
+  const int use_ref = (NULL != cls);
+  struct MHD_IPLimitKey_ keys[PERF_IPLIM_LIMIT];
+  int counted[PERF_IPLIM_LIMIT];
+  uint32_t rnd = (uint32_t) (uintptr_t) &keys;
+  unsigned int i;
+
+  memset (counted, 0, sizeof(counted));
+  for (i = 0; i < num_iterations; ++i)
+  {
+    const unsigned int pos = i % PERF_IPLIM_LIMIT;
+    if (counted[pos])
+      conn_del (use_ref, keys + pos);
+    make_key (keys + pos, next_rnd (&rnd) % num_addresses);
+    counted[pos] = conn_add (use_ref, keys + pos);
+  }
+  for (i = 0; i < PERF_IPLIM_LIMIT; ++i)
+  {
+    if (counted[i])
+      conn_del (use_ref, keys + i);
+  }
+  return NULL;
+}
+
+
+static int
+bench_table (void)
+{
+  pthread_t threads[PERF_IPLIM_MAX_THREADS];
+  int use_ref;
+
+  printf ("%-24s %9s %12s %12s\n", "Implementation", "Threads",
+          "Total time", "Per operation");
+  for (use_ref = 1; use_ref >= 0; --use_ref)
+  {
+    uint64_t start;
+    uint64_t duration;
+    unsigned int i;
+
+    table = MHD_iplimit_create_ (num_threads * PERF_IPLIM_LIMIT, 1);
+    if (NULL == table)
+    {
+      fprintf (stderr, "Failed to create the table.\n");
+      return PERF_IPLIM_ERR_CODE_FAILED;
+    }
+    table_errors = 0;
+    start = get_time_nsec ();
+    for (i = 0; i < num_threads; ++i)
+    {
+      if (0 != pthread_create (threads + i, NULL, &table_thread,
+                               use_ref ? (void *) &use_ref : NULL))
+      {
+        fprintf (stderr, "Failed to start the thread.\n");
+        exit (PERF_IPLIM_ERR_CODE_FAILED);
+      }
+    }
+    for (i = 0; i < num_threads; ++i)
+      pthread_join (threads[i], NULL);
+    duration = get_time_nsec () - start;
+    MHD_iplimit_destroy_ (table);
+    printf ("%-24s %9u %9.3f s %10.2f ns\n",
+            use_ref ? "mutex + tsearch()" : "MHD counters table",
+            num_threads, (double) duration / 1e9,
+            (double) duration / ((double) num_iterations * num_threads));
+    if (0 != table_errors)
+    {
+      fprintf (stderr, "%u errors detected.\n", table_errors);
+      return PERF_IPLIM_ERR_CODE_FAILED;
+    }
+  }
+  return 0;
+}
+
+
+static const char resp_body[] = "OK";
+
+static uint16_t daemon_port;
+
+static volatile unsigned int conn_errors;
+
+static volatile unsigned int conn_rejected;
+
+
+static enum MHD_Result
+answer_cb (void *cls,
+           struct MHD_Connection *connection,
+           const char *url,
+           const char *method,
+           const char *version,
+           const char *upload_data,
+           size_t *upload_data_size,
+           void **req_cls)
+{
+  struct MHD_Response *r;
+  enum MHD_Result ret;
+  (void) cls; (void) url; (void) method; (void) version;   /* Unused */
+  (void) upload_data; (void) upload_data_size; (void) req_cls; /* Unused */
+
+  r = MHD_create_response_from_buffer_static (sizeof(resp_body) - 1,
+                                              resp_body);
+  if (NULL == r)
+    return MHD_NO;
+  ret = MHD_queue_response (connection, MHD_HTTP_OK, r);
+  MHD_destroy_response (r);
+  return ret;
+}
+
+
+/**
+ * Perform one request from the specified local address.
+ * @return zero on success, one if the connection has been rejected,
+ *         negative value on error
+ */
+static int
+do_request (uint32_t local_addr)
+{
+  static const char req[] =
+    "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+  static const char resp_start[] = "HTTP/1.1 200";
+  struct sockaddr_in sa;
+  char buf[512];
+  size_t received;
+  ssize_t res;
+  int fd;
+
+  fd = socket (AF_INET, SOCK_STREAM, 0);
+  if (0 > fd)
+    return -1;
+  memset (&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = local_addr;
+  if (0 != bind (fd, (struct sockaddr *) &sa, sizeof(sa)))
+  {
+    close (fd);
+    return -1;
+  }
+  sa.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  sa.sin_port = htons (daemon_port);
+  if ((0 != connect (fd, (struct sockaddr *) &sa, sizeof(sa))) ||
+      (sizeof(req) - 1 != (size_t) send (fd, req, sizeof(req) - 1, 0)))
+  {
+    close (fd);
+    return -1;
+  }
+  received = 0;
+  do
+  {
+    res = recv (fd, buf + received, sizeof(buf) - received, 0);
+    if (0 < res)
+      received += (size_t) res;
+  } while ((0 < res) && (sizeof(buf) > received));
+  close (fd);
+  if ((0 > res) && (ECONNRESET != errno))
+    return -1;
+  if ((sizeof(resp_start) - 1 > received) ||
+      (0 != memcmp (buf, resp_start, sizeof(resp_start) - 1)))
+    return 1;
+  return 0;
+}
+
+
+static void *
+client_thread (void *cls)
+{
+  const unsigned int idx = (unsigned int) (uintptr_t) cls;
+  unsigned int i;
+
+  for (i = 0; i < num_connections; ++i)
+  {
+    const uint32_t num = (idx * num_connections + i) % num_addresses;
+    const int res = do_request (get_addr (num));
+    if (0 > res)
+    {
+      conn_errors++;
+      break;
+    }
+    else if (0 < res)
+      conn_rejected++;
+  }
+  return NULL;
+}
+
+
+static int
+bench_daemon (void)
+{
+  pthread_t threads[PERF_IPLIM_MAX_THREADS];
+  struct MHD_Daemon *d;
+  const union MHD_DaemonInfo *d_info;
+  uint64_t start;
+  uint64_t duration;
+  unsigned int i;
+
+  d = MHD_start_daemon (MHD_USE_AUTO_INTERNAL_THREAD,
+                        0, NULL, NULL,
+                        &answer_cb, NULL,
+                        MHD_OPTION_THREAD_POOL_SIZE, num_threads,
+                        MHD_OPTION_PER_IP_CONNECTION_LIMIT,
+                        (unsigned int) PERF_IPLIM_LIMIT,
+                        MHD_OPTION_END);
+  if (NULL == d)
+  {
+    fprintf (stderr, "Failed to start the daemon.\n");
+    return PERF_IPLIM_ERR_CODE_FAILED;
+  }
+  d_info = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+  if ((NULL == d_info) || (0 == d_info->port))
+  {
+    fprintf (stderr, "Failed to get the daemon port.\n");
+    MHD_stop_daemon (d);
+    return PERF_IPLIM_ERR_CODE_FAILED;
+  }
+  daemon_port = d_info->port;
+  conn_errors = 0;
+  conn_rejected = 0;
+  start = get_time_nsec ();
+  for (i = 0; i < num_threads; ++i)
+  {
+    if (0 != pthread_create (threads + i, NULL, &client_thread,
+                             (void *) (uintptr_t) i))
+    {
+      fprintf (stderr, "Failed to start the thread.\n");
+      exit (PERF_IPLIM_ERR_CODE_FAILED);
+    }
+  }
+  for (i = 0; i < num_threads; ++i)
+    pthread_join (threads[i], NULL);
+  duration = get_time_nsec () - start;
+  MHD_stop_daemon (d);
+  if (0 != conn_errors)
+  {
+    fprintf (stderr, "Failed to connect from the loopback addresses: %s\n",
+             strerror (errno));
+    return PERF_IPLIM_ERR_CODE_FAILED;
+  }
+  printf ("\n%u client threads, %u connections from %u addresses: "
+          "%.3f s, %.0f connections per second, %u rejected\n",
+          num_threads, num_threads * num_connections,
+          (num_threads * num_connections < num_addresses) ?
+          num_threads * num_connections : num_addresses,
+          (double) duration / 1e9,
+          (double) num_threads * num_connections * 1e9 / (double) duration,
+          conn_rejected);
+  return 0;
+}
+
+
+int
+main (int argc, char *const *argv)
+{
+  int ret;
+
+  ret = process_params (argc, argv);
+  if (0 != ret)
+    return ret;
+
+  ret = bench_table ();
+  if ((0 == ret) && (0 != num_connections))
+    ret = bench_daemon ();
+  return ret;
+}
@@ -41,6 +41,15 @@
 #include "mhd_tool_str_to_uint.h"
 #include "mhd_tool_get_cpu_count.h"
 
+#if defined(MHD_USE_POSIX_THREADS) && defined(HAVE_CLOCK_GETTIME)
+#include <pthread.h>
+#include <time.h>
+#ifdef CLOCK_MONOTONIC
+/* Collect the statistics of accepted connections */
+#define PERF_REPL_ACCEPT_STATS 1
+#endif /* CLOCK_MONOTONIC */
+#endif /* MHD_USE_POSIX_THREADS && HAVE_CLOCK_GETTIME */
+
 #if defined(MHD_REAL_CPU_COUNT)
 #if MHD_REAL_CPU_COUNT == 0
 #undef MHD_REAL_CPU_COUNT
@@ -349,6 +358,17 @@ show_help (void)
           "                            zero means no timeout\n");
   printf ("          --date-header     use the 'Date:' header in every\n"
           "                            reply\n");
+  printf ("\n");
+  printf ("Accepting of connections options:\n");
+  printf ("  -X,     --epoll-exclusive wake up only one worker thread for new\n"
+          "                            connection (with 'epoll' only)\n");
+  printf ("  -B NUM, --accept-batch=NUM accept up to NUM connections at once\n");
+#ifdef PERF_REPL_ACCEPT_STATS
+  printf ("          --accept-stats    print the rate of accepting and the\n"
+          "                            distribution of connections between\n"
+          "                            the threads when stopped\n");
+#endif /* PERF_REPL_ACCEPT_STATS */
+  printf ("\n");
   printf ("          --help            display this help and exit\n");
   printf ("  -V,     --version         output version information and exit\n");
   printf ("\n");
@@ -376,6 +396,9 @@ struct PerfRepl_parameters
   unsigned int connections;
   unsigned int timeout;
   int date_header;
+  int epoll_exclusive;
+  unsigned int accept_batch;
+  int accept_stats;
   int help;
   int version;
 };
@@ -399,6 +422,9 @@ static struct PerfRepl_parameters tool_params = {
   0,
   0,
   0,
+  0,
+  0,
+  0,
   0
 };
 
@@ -790,6 +816,62 @@ process_param__date_header (const char *param_name)
 }
 
 
+static enum PerfRepl_param_result
+process_param__epoll_exclusive (const char *param_name)
+{
+  tool_params.epoll_exclusive = ! 0;
+  return '-' == param_name[1] ?
+         PERF_RPL_PARAM_FULL_STR :PERF_RPL_PARAM_ONE_CHAR;
+}
+
+
+/**
+ * Process parameter '-B' or '--accept-batch'
+ * @param param_name the name of the parameter as specified in command line
+ * @param param_tail the pointer to the character after parameter name in
+ *                   the parameter string
+ * @param next_param the pointer to the next parameter (if any) or NULL
+ * @return enum value, the PERF_PERPL_SPARAM_ONE_CHAR is not used by
+ *                     this function
+ */
+static enum PerfRepl_param_result
+process_param__accept_batch (const char *param_name, const char *param_tail,
+                             const char *next_param)
+{
+  unsigned int param_value;
+  enum PerfRepl_param_result value_res;
+
+  value_res = get_param_value (param_name, param_tail, next_param,
+                               &param_value);
+  if (PERF_RPL_PARAM_ERROR == value_res)
+    return value_res;
+
+  if (0 == param_value)
+  {
+    fprintf (stderr, "'0' is not valid value for parameter '%s'.\n",
+             param_name);
+    return PERF_RPL_PARAM_ERROR;
+  }
+  tool_params.accept_batch = param_value;
+  return value_res;
+}
+
+
+static enum PerfRepl_param_result
+process_param__accept_stats (const char *param_name)
+{
+#ifdef PERF_REPL_ACCEPT_STATS
+  tool_params.accept_stats = ! 0;
+  return '-' == param_name[1] ?
+         PERF_RPL_PARAM_FULL_STR :PERF_RPL_PARAM_ONE_CHAR;
+#else  /* ! PERF_REPL_ACCEPT_STATS */
+  fprintf (stderr, "Parameter '%s' is not supported on this platform.\n",
+           param_name);
+  return PERF_RPL_PARAM_ERROR;
+#endif /* ! PERF_REPL_ACCEPT_STATS */
+}
+
+
 static enum PerfRepl_param_result
 process_param__help (const char *param_name)
 {
@@ -854,6 +936,10 @@ process_short_param (const char *param, const char *next_param)
     return process_param__connections ("-c", param + 1, next_param);
   else if ('O' == param_chr)
     return process_param__timeout ("-O", param + 1, next_param);
+  else if ('X' == param_chr)
+    return process_param__epoll_exclusive ("-X");
+  else if ('B' == param_chr)
+    return process_param__accept_batch ("-B", param + 1, next_param);
   else if ('V' == param_chr)
     return process_param__version ("-V");
 
@@ -960,6 +1046,21 @@ process_long_param (const char *param, const char *next_param)
            (0 == memcmp (param, "date-header",
                          MHD_STATICSTR_LEN_ ("date-header"))))
     return process_param__date_header ("--date-header");
+  else if ((MHD_STATICSTR_LEN_ ("epoll-exclusive") == param_len) &&
+           (0 == memcmp (param, "epoll-exclusive",
+                         MHD_STATICSTR_LEN_ ("epoll-exclusive"))))
+    return process_param__epoll_exclusive ("--epoll-exclusive");
+  else if ((MHD_STATICSTR_LEN_ ("accept-batch") <= param_len) &&
+           (0 == memcmp (param, "accept-batch",
+                         MHD_STATICSTR_LEN_ ("accept-batch"))))
+    return process_param__accept_batch ("--accept-batch",
+                                        param
+                                        + MHD_STATICSTR_LEN_ ("accept-batch"),
+                                        next_param);
+  else if ((MHD_STATICSTR_LEN_ ("accept-stats") == param_len) &&
+           (0 == memcmp (param, "accept-stats",
+                         MHD_STATICSTR_LEN_ ("accept-stats"))))
+    return process_param__accept_stats ("--accept-stats");
   else if ((MHD_STATICSTR_LEN_ ("help") == param_len) &&
            (0 == memcmp (param, "help", MHD_STATICSTR_LEN_ ("help"))))
     return process_param__help ("--help");
@@ -1139,6 +1240,32 @@ check_apply_param__thread_per_conn (void)
 }
 
 
+/**
+ * Apply parameter '-X' or '--epoll-exclusive'
+ * @return non-zero - OK, zero - error
+ */
+static int
+check_apply_param__epoll_exclusive (void)
+{
+  if (! tool_params.epoll_exclusive)
+    return ! 0;
+  if (tool_params.poll || tool_params.select)
+  {
+    fprintf (stderr, "Exclusive wake-up of the threads can be used only "
+             "with 'epoll'.\n");
+    return 0;
+  }
+  tool_params.epoll = ! 0;
+  if (tool_params.thread_per_conn)
+  {
+    fprintf (stderr, "'Thread-per-connection' mode cannot be used together "
+             "with 'epoll'.\n");
+    return 0;
+  }
+  return ! 0;
+}
+
+
 /* non-zero - OK, zero - error */
 static int
 check_param__epoll (void)
@@ -1231,6 +1358,8 @@ check_apply_params (void)
   check_apply_param__threads ();
   if (! check_apply_param__thread_per_conn ())
     return PERF_RPL_ERR_CODE_BAD_PARAM;
+  if (! check_apply_param__epoll_exclusive ())
+    return PERF_RPL_ERR_CODE_BAD_PARAM;
   if (! check_param__epoll ())
     return PERF_RPL_ERR_CODE_BAD_PARAM;
   if (! check_param__poll ())
@@ -1625,6 +1754,133 @@ answer_unique_dyn_response (void *cls,
 }
 
 
+#ifdef PERF_REPL_ACCEPT_STATS
+
+/**
+ * The statistics of connections accepted by one MHD thread
+ */
+struct PerfRepl_accept_stats
+{
+  /**
+   * The MHD daemon (the worker daemon in the thread pool)
+   */
+  const struct MHD_Daemon *d;
+  /**
+   * The number of connections accepted by the daemon
+   */
+  unsigned long long num_conns;
+};
+
+/**
+ * The statistics for every MHD thread, the slot is assigned to the thread
+ * when the thread accepts the first connection
+ */
+static struct PerfRepl_accept_stats *accept_stats = NULL;
+static unsigned int accept_stats_size = 0;
+static unsigned int accept_stats_used = 0;
+static pthread_mutex_t accept_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec accept_first;
+static struct timespec accept_last;
+
+
+static void
+notify_conn_accept_stats (void *cls,
+                          struct MHD_Connection *connection,
+                          void **socket_context,
+                          enum MHD_ConnectionNotificationCode toe)
+{
+  const union MHD_ConnectionInfo *c_info;
+  struct PerfRepl_accept_stats *slot;
+  struct timespec ts;
+  unsigned int i;
+  (void) cls;            /* Unused */
+  (void) socket_context; /* Unused */
+
+  if (MHD_CONNECTION_NOTIFY_STARTED != toe)
+    return;
+  c_info = MHD_get_connection_info (connection, MHD_CONNECTION_INFO_DAEMON);
+  if (NULL == c_info)
+    abort ();
+  if (0 != clock_gettime (CLOCK_MONOTONIC, &ts))
+    abort ();
+  if (0 != pthread_mutex_lock (&accept_stats_lock))
+    abort ();
+  for (i = 0; i < accept_stats_used; ++i)
+  {
+    if (c_info->daemon == accept_stats[i].d)
+      break;
+  }
+  if (i == accept_stats_used)
+  {
+    if (accept_stats_size == accept_stats_used)
+      abort ();
+    accept_stats[i].d = c_info->daemon;
+    accept_stats[i].num_conns = 0;
+    ++accept_stats_used;
+  }
+  slot = accept_stats + i;
+  if ((0 == slot->num_conns) && (1 == accept_stats_used))
+    accept_first = ts;
+  slot->num_conns++;
+  accept_last = ts;
+  if (0 != pthread_mutex_unlock (&accept_stats_lock))
+    abort ();
+}
+
+
+/* Non-zero - success, zero - failure */
+static int
+init_accept_stats (unsigned int num_threads_stats)
+{
+  accept_stats = (struct PerfRepl_accept_stats *)
+                 calloc (num_threads_stats, sizeof (accept_stats[0]));
+  if (NULL == accept_stats)
+  {
+    fprintf (stderr, "Failed to allocate memory.\n");
+    return 0;
+  }
+  accept_stats_size = num_threads_stats;
+  accept_stats_used = 0;
+  return ! 0;
+}
+
+
+static void
+print_deinit_accept_stats (void)
+{
+  unsigned long long total;
+  double duration;
+  unsigned int i;
+
+  if (NULL == accept_stats)
+    return;
+  total = 0;
+  for (i = 0; i < accept_stats_used; ++i)
+    total += accept_stats[i].num_conns;
+  printf ("\nAccepted connections: %llu\n", total);
+  if (0 != total)
+  {
+    duration = (double) (accept_last.tv_sec - accept_first.tv_sec)
+               + ((double) (accept_last.tv_nsec - accept_first.tv_nsec))
+               / 1000000000.0;
+    if (0.0 < duration)
+      printf ("  Accept rate: %.1f connections per second "
+              "(during %.3f seconds)\n", (double) total / duration, duration);
+    printf ("  Distribution between %u MHD thread(s), %u thread(s) "
+            "accepted connections:\n", accept_stats_size, accept_stats_used);
+    for (i = 0; i < accept_stats_used; ++i)
+      printf ("    Thread #%u: %llu (%.1f%%)\n", i + 1,
+              accept_stats[i].num_conns,
+              (double) accept_stats[i].num_conns * 100.0 / (double) total);
+  }
+  free (accept_stats);
+  accept_stats = NULL;
+}
+
+
+#endif /* PERF_REPL_ACCEPT_STATS */
+
+
 static void
 print_perf_warnings (void)
 {
@@ -1778,6 +2034,31 @@ run_mhd (void)
     opt_arr[opt_count].ptr_value = NULL;
     ++opt_count;
   }
+  if (tool_params.epoll_exclusive)
+  {
+    opt_arr[opt_count].option = MHD_OPTION_EPOLL_LISTEN_EXCLUSIVE;
+    opt_arr[opt_count].value = (intptr_t) 1;
+    opt_arr[opt_count].ptr_value = NULL;
+    ++opt_count;
+  }
+  if (0 != tool_params.accept_batch)
+  {
+    opt_arr[opt_count].option = MHD_OPTION_ACCEPT_BATCH_SIZE;
+    opt_arr[opt_count].value = (intptr_t) tool_params.accept_batch;
+    opt_arr[opt_count].ptr_value = NULL;
+    ++opt_count;
+  }
+#ifdef PERF_REPL_ACCEPT_STATS
+  if (tool_params.accept_stats)
+  {
+    if (! init_accept_stats (0 == use_num_threads ? 1 : use_num_threads))
+      return 16;
+    opt_arr[opt_count].option = MHD_OPTION_NOTIFY_CONNECTION;
+    opt_arr[opt_count].value = (intptr_t) &notify_conn_accept_stats;
+    opt_arr[opt_count].ptr_value = NULL;
+    ++opt_count;
+  }
+#endif /* PERF_REPL_ACCEPT_STATS */
   if (1)
   {
     struct MHD_OptionItem option =
@@ -1791,6 +2072,10 @@ run_mhd (void)
   if (NULL == d)
   {
     fprintf (stderr, "Error starting MHD daemon.\n");
+#ifdef PERF_REPL_ACCEPT_STATS
+    free (accept_stats);
+    accept_stats = NULL;
+#endif /* PERF_REPL_ACCEPT_STATS */
     return 15;
   }
   d_info = MHD_get_daemon_info (d, MHD_DAEMON_INFO_FLAGS);
@@ -1826,6 +2111,12 @@ run_mhd (void)
           0 == tool_params.timeout ? " (no timeout)" : "");
   printf ("  'Date:' header:     %s\n",
           tool_params.date_header ? "Yes" : "No");
+  printf ("  Exclusive wake-up:  %s\n",
+          tool_params.epoll_exclusive ? "Yes" : "No");
+  if (0 != tool_params.accept_batch)
+    printf ("  Accept batch size:  %u\n", tool_params.accept_batch);
+  else
+    printf ("  Accept batch size:  default\n");
   printf ("To test with remote client use            "
           "http://HOST_IP:%u/\n", (unsigned int) port);
   printf ("To test with client on the same host use  "
@@ -1837,6 +2128,9 @@ run_mhd (void)
     (void) fgets (buf, sizeof(buf), stdin);
   }
   MHD_stop_daemon (d);
+#ifdef PERF_REPL_ACCEPT_STATS
+  print_deinit_accept_stats ();
+#endif /* PERF_REPL_ACCEPT_STATS */
   return 0;
 }
 
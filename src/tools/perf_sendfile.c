@@ -0,0 +1,643 @@
+/*
+    This file is part of GNU libmicrohttpd
+    Copyright (C) 2026 Evgeny Grin (Karlson2k)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice unmodified, this list of conditions and the following
+       disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+    INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+ * @file tools/perf_sendfile.c
+ * @brief  Benchmark of the file responses sent to many slow clients.
+ *
+ * The daemon with the single internal thread serves the temporary file
+ * by the response created by MHD_create_response_from_fd().  Many slow
+ * clients download the file over the loopback interface with the small
+ * receive buffers, every client reads with the limited rate and
+ * reconnects when the download is finished.  At the same time the probe
+ * client sends the small requests one by one and measures the latency of
+ * the replies.  The send buffers of the daemon sockets are limited (as
+ * on the busy servers), the loopback interface uses the large buffers by
+ * default.
+ * The benchmark is performed with the fixed sendfile() chunks and with
+ * #MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK.  The CPU time is measured for
+ * the whole process, the clients load is the same for both modes.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "microhttpd.h"
+#include "mhd_tool_str_to_uint.h"
+
+#define PERF_SF_ERR_CODE_BAD_PARAM 65
+#define PERF_SF_ERR_CODE_FAILED 99
+
+#define PERF_SF_MAX_CLIENTS 900
+
+/**
+ * The interval of the slow clients reads, in milliseconds
+ */
+#define PERF_SF_TICK_MS 10
+
+/**
+ * The receive buffer size of the slow clients
+ */
+#define PERF_SF_CLIENT_RCVBUF 16384
+
+/* Settings */
+static unsigned int num_clients = 200;
+static unsigned int file_size_kib = 8192;
+static unsigned int client_rate_kib = 256;
+static unsigned int duration_sec = 5;
+static unsigned int sndbuf_kib = 64;
+
+
+static void
+show_help (const char *self_name)
+{
+  printf ("Usage: %s [OPTIONS]\n", self_name);
+  printf ("Measure the file responses sent to many slow clients.\n\n");
+  printf ("  -c, --clients=NUM     the number of slow clients "
+          "(default: %u)\n", num_clients);
+  printf ("  -s, --size=NUM        the size of the file in KiB "
+          "(default: %u)\n", file_size_kib);
+  printf ("  -r, --rate=NUM        the download rate of every slow client "
+          "in KiB/s (default: %u)\n", client_rate_kib);
+  printf ("  -d, --duration=NUM    the duration of every test in seconds "
+          "(default: %u)\n", duration_sec);
+  printf ("  -b, --sndbuf=NUM      the send buffer size of the daemon "
+          "sockets in KiB,\n"
+          "                        zero to use the system default "
+          "(default: %u)\n", sndbuf_kib);
+  printf ("  -h, --help            show this help\n");
+}
+
+
+/**
+ * Get the value of the parameter
+ * @return pointer to the value, NULL if @a argv[*pi] is not @a short_name
+ *         nor @a long_name
+ */
+static const char *
+get_param_value (int argc, char *const *argv, int *pi,
+                 const char *short_name, const char *long_name)
+{
+  const char *const arg = argv[*pi];
+  const size_t long_len = strlen (long_name);
+
+  if ((0 == strcmp (arg, short_name)) && (*pi + 1 < argc))
+    return argv[++(*pi)];
+  if ((0 == strncmp (arg, long_name, long_len)) && ('=' == arg[long_len]))
+    return arg + long_len + 1;
+  return NULL;
+}
+
+
+static int
+process_params (int argc, char *const *argv)
+{
+  int i;
+  for (i = 1; i < argc; ++i)
+  {
+    const char *val;
+    unsigned int *pvar;
+    if ((0 == strcmp (argv[i], "-h")) || (0 == strcmp (argv[i], "--help")))
+    {
+      show_help (argv[0]);
+      exit (0);
+    }
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-c",
+                                             "--clients")))
+      pvar = &num_clients;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-s",
+                                             "--size")))
+      pvar = &file_size_kib;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-r",
+                                             "--rate")))
+      pvar = &client_rate_kib;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-d",
+                                             "--duration")))
+      pvar = &duration_sec;
+    else if (NULL != (val = get_param_value (argc, argv, &i, "-b",
+                                             "--sndbuf")))
+      pvar = &sndbuf_kib;
+    else
+    {
+      fprintf (stderr, "Unrecognised parameter: '%s'.\n", argv[i]);
+      return PERF_SF_ERR_CODE_BAD_PARAM;
+    }
+    if (mhd_tool_str_to_uint (val, pvar) != strlen (val))
+    {
+      fprintf (stderr, "Wrong value: '%s'.\n", val);
+      return PERF_SF_ERR_CODE_BAD_PARAM;
+    }
+  }
+  if ((0 == num_clients) || (PERF_SF_MAX_CLIENTS < num_clients))
+  {
+    fprintf (stderr, "The number of clients must be from 1 to %u.\n",
+             (unsigned int) PERF_SF_MAX_CLIENTS);
+    return PERF_SF_ERR_CODE_BAD_PARAM;
+  }
+  if ((0 == file_size_kib) || (0x100000 < file_size_kib))
+  {
+    fprintf (stderr, "The size of the file must be from 1 to %u KiB.\n",
+             0x100000);
+    return PERF_SF_ERR_CODE_BAD_PARAM;
+  }
+  if ((0 == client_rate_kib) || (0 == duration_sec))
+  {
+    fprintf (stderr, "The rate and the duration must not be zero.\n");
+    return PERF_SF_ERR_CODE_BAD_PARAM;
+  }
+  if (0x100000 < sndbuf_kib)
+  {
+    fprintf (stderr, "The send buffer size must not exceed %u KiB.\n",
+             0x100000);
+    return PERF_SF_ERR_CODE_BAD_PARAM;
+  }
+  return 0;
+}
+
+
+static uint64_t
+get_time_nsec (void)
+{
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return ((uint64_t) ts.tv_sec) * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif /* CLOCK_MONOTONIC */
+  (void) ts;
+  return ((uint64_t) time (NULL)) * 1000000000;
+}
+
+
+/**
+ * Get the CPU time used by the process, in nanoseconds.
+ */
+static uint64_t
+get_cpu_nsec (void)
+{
+  struct rusage ru;
+
+  if (0 != getrusage (RUSAGE_SELF, &ru))
+    return 0;
+  return ((uint64_t) ru.ru_utime.tv_sec + (uint64_t) ru.ru_stime.tv_sec)
+         * 1000000000
+         + ((uint64_t) ru.ru_utime.tv_usec + (uint64_t) ru.ru_stime.tv_usec)
+         * 1000;
+}
+
+
+/**
+ * Create the unnamed temporary file with the data to send.
+ * @return the file descriptor, negative value on error
+ */
+static int
+create_file (void)
+{
+  char name[] = "/tmp/mhd_perf_sendfile_XXXXXX";
+  char buf[4096];
+  unsigned int i;
+  int fd;
+
+  fd = mkstemp (name);
+  if (0 > fd)
+    return -1;
+  (void) unlink (name);
+  for (i = 0; i < sizeof(buf); ++i)
+    buf[i] = (char) ('A' + (i % 26));
+  for (i = 0; i < file_size_kib / 4; ++i)
+  {
+    if (sizeof(buf) != (size_t) write (fd, buf, sizeof(buf)))
+    {
+      close (fd);
+      return -1;
+    }
+  }
+  if (((file_size_kib % 4) * 1024) !=
+      (size_t) write (fd, buf, (file_size_kib % 4) * 1024))
+  {
+    close (fd);
+    return -1;
+  }
+  return fd;
+}
+
+
+static const char small_body[] = "OK";
+
+static struct MHD_Response *file_response;
+
+static uint16_t daemon_port;
+
+static volatile int stop_clients;
+
+static volatile unsigned int conn_errors;
+
+
+static enum MHD_Result
+answer_cb (void *cls,
+           struct MHD_Connection *connection,
+           const char *url,
+           const char *method,
+           const char *version,
+           const char *upload_data,
+           size_t *upload_data_size,
+           void **req_cls)
+{
+  struct MHD_Response *r;
+  enum MHD_Result ret;
+  (void) cls; (void) method; (void) version;   /* Unused */
+  (void) upload_data; (void) upload_data_size; (void) req_cls; /* Unused */
+
+  if (0 == strcmp (url, "/file"))
+    return MHD_queue_response (connection, MHD_HTTP_OK, file_response);
+  r = MHD_create_response_from_buffer_static (sizeof(small_body) - 1,
+                                              small_body);
+  if (NULL == r)
+    return MHD_NO;
+  ret = MHD_queue_response (connection, MHD_HTTP_OK, r);
+  MHD_destroy_response (r);
+  return ret;
+}
+
+
+/**
+ * Set the send buffer size of the new connection.
+ * The system grows the send buffers automatically, the large buffers on
+ * the loopback interface leave enough space for the full sendfile()
+ * chunks.  The limited buffers are typical for the servers with many
+ * connections.
+ */
+static void
+notify_conn_cb (void *cls,
+                struct MHD_Connection *connection,
+                void **socket_context,
+                enum MHD_ConnectionNotificationCode toe)
+{
+  const union MHD_ConnectionInfo *c_info;
+  int sndbuf;
+  (void) cls; (void) socket_context; /* Unused */
+
+  if ((MHD_CONNECTION_NOTIFY_STARTED != toe) || (0 == sndbuf_kib))
+    return;
+  c_info = MHD_get_connection_info (connection,
+                                    MHD_CONNECTION_INFO_CONNECTION_FD);
+  if (NULL == c_info)
+  {
+    conn_errors++;
+    return;
+  }
+  sndbuf = (int) sndbuf_kib * 1024;
+  if (0 != setsockopt (c_info->connect_fd, SOL_SOCKET, SO_SNDBUF,
+                       &sndbuf, sizeof(sndbuf)))
+    conn_errors++;
+}
+
+
+/**
+ * Connect to the daemon and send the request.
+ * @param url the URL to request
+ * @param rcvbuf the size of the receive buffer, zero to use the default
+ * @return the socket, negative value on error
+ */
+static int
+start_request (const char *url, int rcvbuf)
+{
+  struct sockaddr_in sa;
+  char req[128];
+  int req_len;
+  int fd;
+
+  req_len = snprintf (req, sizeof(req),
+                      "GET %s HTTP/1.1\r\nHost: localhost\r\n"
+                      "Connection: close\r\n\r\n", url);
+  if ((0 >= req_len) || (sizeof(req) <= (size_t) req_len))
+    return -1;
+  fd = socket (AF_INET, SOCK_STREAM, 0);
+  if (0 > fd)
+    return -1;
+  if ((0 != rcvbuf) &&
+      (0 != setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf))))
+  {
+    close (fd);
+    return -1;
+  }
+  memset (&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  sa.sin_port = htons (daemon_port);
+  if ((0 != connect (fd, (struct sockaddr *) &sa, sizeof(sa))) ||
+      ((size_t) req_len != (size_t) send (fd, req, (size_t) req_len, 0)))
+  {
+    close (fd);
+    return -1;
+  }
+  return fd;
+}
+
+
+static uint64_t slow_received;
+
+static unsigned int slow_downloads;
+
+
+/**
+ * The thread function of the slow clients.
+ * Every client reads up to the rate limit every #PERF_SF_TICK_MS
+ * milliseconds.
+ */
+static void *
+slow_clients_thread (void *cls)
+{
+  const size_t tick_limit =
+    (size_t) client_rate_kib * 1024 * PERF_SF_TICK_MS / 1000;
+  const struct timespec tick = { 0, PERF_SF_TICK_MS * 1000000L };
+  static char buf[65536];
+  int *fds;
+  unsigned int i;
+  (void) cls; /* Unused */
+
+  fds = (int *) malloc (sizeof(int) * num_clients);
+  if (NULL == fds)
+  {
+    conn_errors++;
+    return NULL;
+  }
+  for (i = 0; i < num_clients; ++i)
+    fds[i] = -1;
+  while (! stop_clients)
+  {
+    for (i = 0; i < num_clients; ++i)
+    {
+      size_t left = (0 != tick_limit) ? tick_limit : 1;
+
+      if (0 > fds[i])
+      {
+        fds[i] = start_request ("/file", PERF_SF_CLIENT_RCVBUF);
+        if (0 > fds[i])
+        {
+          conn_errors++;
+          continue;
+        }
+      }
+      while (0 != left)
+      {
+        const ssize_t res =
+          recv (fds[i], buf, (sizeof(buf) < left) ? sizeof(buf) : left,
+                MSG_DONTWAIT);
+        if (0 < res)
+        {
+          left -= (size_t) res;
+          slow_received += (uint64_t) res;
+          continue;
+        }
+        if ((0 > res) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+          break;
+        if (0 == res)
+          slow_downloads++;
+        else
+          conn_errors++;
+        close (fds[i]);
+        fds[i] = -1;
+        break;
+      }
+    }
+    nanosleep (&tick, NULL);
+  }
+  for (i = 0; i < num_clients; ++i)
+  {
+    if (0 <= fds[i])
+      close (fds[i]);
+  }
+  free (fds);
+  return NULL;
+}
+
+
+static unsigned int probe_requests;
+
+static uint64_t probe_time_sum;
+
+static uint64_t probe_time_max;
+
+
+/**
+ * The thread function of the probe client.
+ * The small requests are sent one by one, the time from the connection
+ * start till the end of the reply is measured.
+ */
+static void *
+probe_thread (void *cls)
+{
+  static const char resp_start[] = "HTTP/1.1 200";
+  (void) cls; /* Unused */
+
+  while (! stop_clients)
+  {
+    const uint64_t start = get_time_nsec ();
+    char buf[512];
+    size_t received;
+    ssize_t res;
+    uint64_t req_time;
+    int fd;
+
+    fd = start_request ("/small", 0);
+    if (0 > fd)
+    {
+      conn_errors++;
+      break;
+    }
+    received = 0;
+    do
+    {
+      res = recv (fd, buf + received, sizeof(buf) - received, 0);
+      if (0 < res)
+        received += (size_t) res;
+    } while ((0 < res) && (sizeof(buf) > received));
+    close (fd);
+    req_time = get_time_nsec () - start;
+    if ((0 > res) ||
+        (sizeof(resp_start) - 1 > received) ||
+        (0 != memcmp (buf, resp_start, sizeof(resp_start) - 1)))
+    {
+      conn_errors++;
+      break;
+    }
+    probe_requests++;
+    probe_time_sum += req_time;
+    if (probe_time_max < req_time)
+      probe_time_max = req_time;
+  }
+  return NULL;
+}
+
+
+static int
+bench_daemon (int file_fd, int adaptive)
+{
+  const struct timespec test_time = { (time_t) duration_sec, 0 };
+  pthread_t slow_thread;
+  pthread_t probe_thr;
+  struct MHD_Daemon *d;
+  const union MHD_DaemonInfo *d_info;
+  uint64_t start;
+  uint64_t start_cpu;
+  uint64_t duration;
+  uint64_t duration_cpu;
+  int fd;
+
+  fd = dup (file_fd);
+  if (0 > fd)
+  {
+    fprintf (stderr, "Failed to duplicate the file descriptor.\n");
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  file_response = MHD_create_response_from_fd ((size_t) file_size_kib * 1024,
+                                               fd);
+  if (NULL == file_response)
+  {
+    fprintf (stderr, "Failed to create the file response.\n");
+    close (fd);
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  d = MHD_start_daemon (MHD_USE_AUTO_INTERNAL_THREAD,
+                        0, NULL, NULL,
+                        &answer_cb, NULL,
+                        MHD_OPTION_CONNECTION_LIMIT,
+                        (unsigned int) (PERF_SF_MAX_CLIENTS + 16),
+                        MHD_OPTION_NOTIFY_CONNECTION,
+                        &notify_conn_cb, NULL,
+                        MHD_OPTION_SENDFILE_ADAPTIVE_CHUNK, adaptive,
+                        MHD_OPTION_END);
+  if (NULL == d)
+  {
+    fprintf (stderr, "Failed to start the daemon.\n");
+    MHD_destroy_response (file_response);
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  d_info = MHD_get_daemon_info (d, MHD_DAEMON_INFO_BIND_PORT);
+  if ((NULL == d_info) || (0 == d_info->port))
+  {
+    fprintf (stderr, "Failed to get the daemon port.\n");
+    MHD_stop_daemon (d);
+    MHD_destroy_response (file_response);
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  daemon_port = d_info->port;
+  stop_clients = 0;
+  conn_errors = 0;
+  slow_received = 0;
+  slow_downloads = 0;
+  probe_requests = 0;
+  probe_time_sum = 0;
+  probe_time_max = 0;
+  start = get_time_nsec ();
+  start_cpu = get_cpu_nsec ();
+  if ((0 != pthread_create (&slow_thread, NULL, &slow_clients_thread,
+                            NULL)) ||
+      (0 != pthread_create (&probe_thr, NULL, &probe_thread, NULL)))
+  {
+    fprintf (stderr, "Failed to start the thread.\n");
+    exit (PERF_SF_ERR_CODE_FAILED);
+  }
+  nanosleep (&test_time, NULL);
+  stop_clients = ! 0;
+  pthread_join (slow_thread, NULL);
+  pthread_join (probe_thr, NULL);
+  duration = get_time_nsec () - start;
+  duration_cpu = get_cpu_nsec () - start_cpu;
+  d_info = MHD_get_daemon_info (d, MHD_DAEMON_INFO_STATS);
+  if (NULL == d_info)
+  {
+    fprintf (stderr, "Failed to get the daemon statistics.\n");
+    MHD_stop_daemon (d);
+    MHD_destroy_response (file_response);
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  printf ("%-16s %10.1f %9u %10u %8.3f %8.3f %12.1f %13llu %7.3f\n",
+          adaptive ? "adaptive chunks" : "fixed chunks",
+          (double) slow_received * 1e9 / ((double) duration * 1048576.0),
+          slow_downloads,
+          probe_requests,
+          (0 != probe_requests) ?
+          (double) probe_time_sum / ((double) probe_requests * 1e6) : 0.0,
+          (double) probe_time_max / 1e6,
+          (double) d_info->stats.bytes_sent_sendfile / 1048576.0,
+          (unsigned long long) d_info->stats.sendfile_partial,
+          (double) duration_cpu / 1e9);
+  MHD_stop_daemon (d);
+  MHD_destroy_response (file_response);
+  if (0 != conn_errors)
+  {
+    fprintf (stderr, "%u connection errors detected.\n", conn_errors);
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  return 0;
+}
+
+
+int
+main (int argc, char *const *argv)
+{
+  int file_fd;
+  int ret;
+
+  ret = process_params (argc, argv);
+  if (0 != ret)
+    return ret;
+
+  file_fd = create_file ();
+  if (0 > file_fd)
+  {
+    fprintf (stderr, "Failed to create the temporary file.\n");
+    return PERF_SF_ERR_CODE_FAILED;
+  }
+  printf ("%u slow clients at %u KiB/s, %u KiB file, %u s per test, ",
+          num_clients, client_rate_kib, file_size_kib, duration_sec);
+  if (0 != sndbuf_kib)
+    printf ("%u KiB send buffers\n\n", sndbuf_kib);
+  else
+    printf ("default send buffers\n\n");
+  printf ("%-16s %10s %9s %10s %8s %8s %12s %13s %7s\n", "Mode",
+          "Slow MiB/s", "Downloads", "Probe reqs", "Avg ms", "Max ms",
+          "Sendfile MiB", "Partial sends", "CPU s");
+  ret = bench_daemon (file_fd, 0);
+  if (0 == ret)
+    ret = bench_daemon (file_fd, 1);
+  close (file_fd);
+  return ret;
+}
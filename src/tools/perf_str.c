@@ -0,0 +1,331 @@
+/*
+    This file is part of GNU libmicrohttpd
+    Copyright (C) 2026 Evgeny Grin (Karlson2k)
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice unmodified, this list of conditions and the following
+       disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+    INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+ * @file tools/perf_str.c
+ * @brief  Microbenchmark of the caseless strings functions used for
+ *         the headers processing.
+ *
+ * The MHD functions are compared with the simple character-by-character
+ * implementation.
+ * @author Karlson2k (Evgeny Grin)
+ */
+
+#include "mhd_options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "mhd_str.h"
+#include "mhd_tool_str_to_uint.h"
+
+#define PERF_STR_ERR_CODE_BAD_PARAM 65
+
+/* Settings */
+static unsigned int num_iterations = 2000000;
+
+/* Prevent optimising out the results */
+static volatile size_t results_sink;
+
+/**
+ * The pair of strings to compare
+ */
+struct str_pair
+{
+  const char *str1;
+  const char *str2;
+};
+
+static const struct str_pair name_pairs[] = {
+  { "Host", "host" },
+  { "Content-Type", "content-type" },
+  { "Content-Length", "Content-Length" },
+  { "Transfer-Encoding", "transfer-encoding" },
+  { "Sec-WebSocket-Extensions", "sec-websocket-extensions" },
+  { "Access-Control-Request-Headers", "access-control-request-headers" },
+  { "Accept-Language", "accept-encoding" }, /* Mismatch at the end */
+  { NULL, NULL }
+};
+
+/**
+ * The header value and the token to find in it
+ */
+struct str_token
+{
+  const char *str;
+  const char *token;
+};
+
+static const struct str_token token_values[] = {
+  { "keep-alive", "close" },
+  { "Keep-Alive, Upgrade", "upgrade" },
+  { "gzip, deflate, br, zstd", "br" },
+  { "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+    "application/xml" },
+  { "no-cache, no-store, must-revalidate, proxy-revalidate, max-age=0",
+    "proxy-revalidate" },
+  { NULL, NULL }
+};
+
+
+static void
+show_help (const char *self_name)
+{
+  printf ("Usage: %s [OPTIONS]\n", self_name);
+  printf ("Measure the speed of the caseless string functions.\n\n");
+  printf ("  -n, --iterations=NUM the number of iterations for each check "
+          "(default: %u)\n", num_iterations);
+  printf ("  -h, --help           show this help\n");
+}
+
+
+static int
+process_params (int argc, char *const *argv)
+{
+  int i;
+  for (i = 1; i < argc; ++i)
+  {
+    const char *val = NULL;
+    if ((0 == strcmp (argv[i], "-h")) || (0 == strcmp (argv[i], "--help")))
+    {
+      show_help (argv[0]);
+      exit (0);
+    }
+    else if ((0 == strcmp (argv[i], "-n")) && (i + 1 < argc))
+      val = argv[++i];
+    else if (0 == strncmp (argv[i], "--iterations=",
+                           MHD_STATICSTR_LEN_ ("--iterations=")))
+      val = argv[i] + MHD_STATICSTR_LEN_ ("--iterations=");
+    else
+    {
+      fprintf (stderr, "Unrecognised parameter: '%s'.\n", argv[i]);
+      return PERF_STR_ERR_CODE_BAD_PARAM;
+    }
+    if ((mhd_tool_str_to_uint (val, &num_iterations) != strlen (val)) ||
+        (0 == num_iterations))
+    {
+      fprintf (stderr, "Wrong number of iterations: '%s'.\n", val);
+      return PERF_STR_ERR_CODE_BAD_PARAM;
+    }
+  }
+  return 0;
+}
+
+
+static uint64_t
+get_time_nsec (void)
+{
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return ((uint64_t) ts.tv_sec) * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif /* CLOCK_MONOTONIC */
+  (void) ts;
+  return ((uint64_t) time (NULL)) * 1000000000;
+}
+
+
+/**
+ * The reference character-by-character caseless comparison
+ */
+static int
+ref_equal_caseless_bin_n (const char *str1, const char *str2, size_t len)
+{
+  size_t i;
+  for (i = 0; i < len; ++i)
+  {
+    char c1 = str1[i];
+    char c2 = str2[i];
+    if (('A' <= c1) && ('Z' >= c1))
+      c1 = (char) (c1 - 'A' + 'a');
+    if (('A' <= c2) && ('Z' >= c2))
+      c2 = (char) (c2 - 'A' + 'a');
+    if (c1 != c2)
+      return 0;
+  }
+  return ! 0;
+}
+
+
+/**
+ * The reference character-by-character token search
+ */
+static int
+ref_has_token_caseless (const char *str, const char *token, size_t token_len)
+{
+  while (0 != *str)
+  {
+    size_t i;
+    while (' ' == *str || '\t' == *str || ',' == *str)
+      str++;
+    for (i = 0; i < token_len && 0 != str[i]; ++i)
+    {
+      if (! ref_equal_caseless_bin_n (str + i, token + i, 1))
+        break;
+    }
+    if (i == token_len)
+    {
+      const char *p = str + token_len;
+      while (' ' == *p || '\t' == *p)
+        p++;
+      if ((0 == *p) || (',' == *p))
+        return ! 0;
+    }
+    while (0 != *str && ',' != *str)
+      str++;
+  }
+  return 0;
+}
+
+
+/* The functions are called by pointers to avoid inlining of the reference
+   functions, to get the same overhead for all measured functions */
+static int (*volatile ref_equal_func)(const char *, const char *, size_t) =
+  &ref_equal_caseless_bin_n;
+static bool (*volatile mhd_equal_func)(const char *, const char *, size_t) =
+  &MHD_str_equal_caseless_bin_n_;
+static int (*volatile ref_token_func)(const char *, const char *, size_t) =
+  &ref_has_token_caseless;
+static bool (*volatile mhd_token_func)(const char *, const char *, size_t) =
+  &MHD_str_has_token_caseless_;
+
+
+static void
+print_result (const char *func_name, const char *arg, uint64_t ref_time,
+              uint64_t mhd_time)
+{
+  if (0 == mhd_time)
+    mhd_time = 1;
+  printf ("%-22s %-36.36s %8.2f ns %8.2f ns %6.2fx\n", func_name, arg,
+          (double) ref_time / num_iterations,
+          (double) mhd_time / num_iterations,
+          (double) ref_time / (double) mhd_time);
+}
+
+
+static void
+bench_equal_caseless_bin_n (void)
+{
+  unsigned int i;
+  for (i = 0; NULL != name_pairs[i].str1; ++i)
+  {
+    const char *const s1 = name_pairs[i].str1;
+    const char *const s2 = name_pairs[i].str2;
+    const size_t len = strlen (s1);
+    uint64_t start;
+    uint64_t ref_time;
+    unsigned int n;
+    size_t res = 0;
+
+    start = get_time_nsec ();
+    for (n = 0; n < num_iterations; ++n)
+      res += (size_t) ref_equal_func (s1, s2, len);
+    ref_time = get_time_nsec () - start;
+
+    start = get_time_nsec ();
+    for (n = 0; n < num_iterations; ++n)
+      res += (size_t) mhd_equal_func (s1, s2, len);
+    print_result ("equal_caseless_bin_n", s1, ref_time,
+                  get_time_nsec () - start);
+    results_sink += res;
+  }
+}
+
+
+static void
+bench_has_token_caseless (void)
+{
+  unsigned int i;
+  for (i = 0; NULL != token_values[i].str; ++i)
+  {
+    const char *const str = token_values[i].str;
+    const char *const token = token_values[i].token;
+    const size_t token_len = strlen (token);
+    uint64_t start;
+    uint64_t ref_time;
+    unsigned int n;
+    size_t res = 0;
+
+    start = get_time_nsec ();
+    for (n = 0; n < num_iterations; ++n)
+      res += (size_t) ref_token_func (str, token, token_len);
+    ref_time = get_time_nsec () - start;
+
+    start = get_time_nsec ();
+    for (n = 0; n < num_iterations; ++n)
+      res += (size_t) mhd_token_func (str, token, token_len);
+    print_result ("has_token_caseless", str, ref_time,
+                  get_time_nsec () - start);
+    results_sink += res;
+  }
+}
+
+
+static void
+bench_remove_tokens_caseless (void)
+{
+  static const char str[] = "keep-alive, Upgrade, HTTP2-Settings, TE";
+  static const char tokens[] = "te, http2-settings";
+  char buf[sizeof(str)];
+  size_t len;
+  uint64_t start;
+  unsigned int n;
+  size_t res = 0;
+
+  start = get_time_nsec ();
+  for (n = 0; n < num_iterations; ++n)
+  {
+    memcpy (buf, str, sizeof(buf));
+    len = MHD_STATICSTR_LEN_ (str);
+    res += (size_t) MHD_str_remove_tokens_caseless_ (buf, &len, tokens,
+                                                     MHD_STATICSTR_LEN_ ( \
+                                                       tokens));
+    res += len;
+  }
+  printf ("%-22s %-36.36s %11s %8.2f ns\n", "remove_tokens_caseless", str,
+          "", (double) (get_time_nsec () - start) / num_iterations);
+  results_sink += res;
+}
+
+
+int
+main (int argc, char *const *argv)
+{
+  int ret;
+
+  ret = process_params (argc, argv);
+  if (0 != ret)
+    return ret;
+
+  printf ("%-22s %-36s %11s %11s %7s\n", "Function", "Argument",
+          "Reference", "MHD", "Speedup");
+  bench_equal_caseless_bin_n ();
+  bench_has_token_caseless ();
+  bench_remove_tokens_caseless ();
+  return 0;
+}